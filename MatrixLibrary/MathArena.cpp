@@ -0,0 +1,127 @@
+#include "pch.h"
+#include "MathArena.h"
+#include <cstdint>
+#include <new>
+
+// The arena allocations on this thread come from, set by MathArenaScope
+static thread_local MathArena* currentArena = nullptr;
+
+MathArena::MathArena(size_t initialBlockSize)
+	: initialBlockSize_(initialBlockSize == 0 ? DEFAULT_BLOCK_SIZE : initialBlockSize)
+{
+}
+
+MathArena* MathArena::getCurrent()
+{
+	return currentArena;
+}
+
+/**
+ * @brief Hands out the next @ref size bytes of the current block, starting a new block
+ *     when they do not fit.  The rest of the old block is left unused until @ref reset.
+ */
+void* MathArena::allocate(size_t size, size_t alignment)
+{
+	if (!blocks_.empty())
+	{
+		uintptr_t start = (uintptr_t)blocks_.back().memory + offset_;
+		size_t padding = (size_t)((alignment - start % alignment) % alignment);
+
+		if (offset_ + padding + size <= blocks_.back().size)
+		{
+			offset_ += padding;
+			void* result = blocks_.back().memory + offset_;
+			offset_ += size;
+			bytesUsed_ += size;
+			return result;
+		}
+	}
+
+	addBlock(size + alignment);
+
+	uintptr_t start = (uintptr_t)blocks_.back().memory;
+	offset_ = (size_t)((alignment - start % alignment) % alignment);
+	void* result = blocks_.back().memory + offset_;
+	offset_ += size;
+	bytesUsed_ += size;
+	return result;
+}
+
+/**
+ * @brief Frees every buffer handed out by the arena at once.  If it took more than one
+ *     block since the last reset they are replaced by a single block as big as all of them,
+ *     so a loop that needs about the same memory every time stops allocating blocks after
+ *     its first pass.
+ */
+void MathArena::reset()
+{
+	if (blocks_.size() > 1)
+	{
+		size_t total = capacity_;
+		releaseBlocks();
+		addBlock(total);
+	}
+	offset_ = 0;
+	bytesUsed_ = 0;
+}
+
+void MathArena::addBlock(size_t minimumSize)
+{
+	size_t size = blocks_.empty() ? initialBlockSize_ : blocks_.back().size * 2;
+	if (size < minimumSize)
+	{
+		size = minimumSize;
+	}
+
+	Block block;
+	block.memory = static_cast<char*>(::operator new(size));
+	block.size = size;
+	blocks_.push_back(block);
+
+	capacity_ += size;
+}
+
+void MathArena::releaseBlocks()
+{
+	for (Block& block : blocks_)
+	{
+		::operator delete(block.memory);
+	}
+	blocks_.clear();
+	capacity_ = 0;
+	offset_ = 0;
+}
+
+/**
+ * @brief Allocates @ref size bytes from the heap starting on a multiple of
+ *     @ref MATH_BUFFER_ALIGNMENT.  The pointer operator new returned is kept just in front
+ *     of the aligned memory so @ref freeAlignedBytes can give it back.
+ */
+void* allocateAlignedBytes(size_t size)
+{
+	char* memory = static_cast<char*>(::operator new(size + MATH_BUFFER_ALIGNMENT + sizeof(void*)));
+
+	uintptr_t start = (uintptr_t)(memory + sizeof(void*));
+	char* aligned = memory + sizeof(void*) + (MATH_BUFFER_ALIGNMENT - start % MATH_BUFFER_ALIGNMENT) % MATH_BUFFER_ALIGNMENT;
+	reinterpret_cast<void**>(aligned)[-1] = memory;
+	return aligned;
+}
+
+void freeAlignedBytes(void* memory)
+{
+	if (memory != nullptr)
+	{
+		::operator delete(reinterpret_cast<void**>(memory)[-1]);
+	}
+}
+
+MathArenaScope::MathArenaScope(MathArena& arena)
+	: previous_(currentArena)
+{
+	currentArena = &arena;
+}
+
+MathArenaScope::~MathArenaScope()
+{
+	currentArena = previous_;
+}
@@ -0,0 +1,171 @@
+#pragma once
+
+#ifndef __MATH_ARENA_H
+#define __MATH_ARENA_H
+
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+/**
+ * @brief A bump allocator that hands out element buffers for @ref MathVector and
+ *     @ref MathMatrix from a few big blocks.  Allocating is a pointer increment, freeing a
+ *     single buffer does nothing, and @ref reset frees everything at once.
+ * @note Buffers come from an arena only while a @ref MathArenaScope for it is open on the
+ *     calling thread.  A vector or matrix remembers where its buffer came from, so it can
+ *     be destroyed or grow after the scope closes, but it must not be used after the arena
+ *     is reset or destroyed.  Copy results you want to keep outside of the scope.
+ * @note That includes objects made before the scope opened.  A heap backed vector or matrix
+ *     that grows inside the scope (push_back, appendRows, reserve, ...) moves its buffer into
+ *     the arena, and so does a @ref MathLUDecomposition or @ref MathCholeskyDecomposition
+ *     whose @ref factor is called inside it.  They dangle after @ref reset.
+ * @note An arena is not thread safe.  Threads that allocate at the same time each need
+ *     their own.  Work done by @ref MathThreadPool workers always uses the heap.
+ */
+class MathArena
+{
+public:
+
+	// The size of the first block.  Every later block is at least double the one before it.
+	static constexpr size_t DEFAULT_BLOCK_SIZE = 64 * 1024;
+
+	explicit MathArena(size_t initialBlockSize = DEFAULT_BLOCK_SIZE);
+	~MathArena() { releaseBlocks(); }
+
+	MathArena(const MathArena& other) = delete;
+	MathArena& operator=(const MathArena& other) = delete;
+
+	// Returns uninitialized memory for @ref size bytes aligned to @ref alignment (a power of 2)
+	void* allocate(size_t size, size_t alignment);
+
+	template <typename T>
+	T* allocateElements(size_t count)
+	{
+		static_assert(std::is_trivially_destructible<T>::value, "Arena buffers are never destroyed");
+		return static_cast<T*>(allocate(count * sizeof(T), alignof(T)));
+	}
+
+	void reset();
+
+	// The bytes handed out since the last reset and the bytes held in blocks
+	size_t getBytesUsed() const { return bytesUsed_; }
+	size_t getCapacity() const { return capacity_; }
+
+	// The arena of the innermost open @ref MathArenaScope on this thread, nullptr if none is open
+	static MathArena* getCurrent();
+
+private:
+
+	void addBlock(size_t minimumSize);
+	void releaseBlocks();
+
+	struct Block
+	{
+		char* memory;
+		size_t size;
+	};
+
+	std::vector<Block> blocks_;
+
+	// Allocations are taken from blocks_.back() starting at offset_
+	size_t offset_ = 0;
+
+	size_t bytesUsed_ = 0;
+	size_t capacity_ = 0;
+	size_t initialBlockSize_;
+};
+
+/**
+ * @brief Makes every @ref MathVector and @ref MathMatrix buffer allocated on this thread
+ *     come from @ref arena until the scope ends.  Scopes nest, the innermost one wins.
+ *
+ *     MathArena arena;
+ *     for (const Request& request : requests)
+ *     {
+ *         {
+ *             MathArenaScope scope(arena);
+ *             ... build and discard as many matrices as the request needs ...
+ *         }
+ *         arena.reset();
+ *     }
+ */
+class MathArenaScope
+{
+public:
+
+	explicit MathArenaScope(MathArena& arena);
+	~MathArenaScope();
+
+	MathArenaScope(const MathArenaScope& other) = delete;
+	MathArenaScope& operator=(const MathArenaScope& other) = delete;
+
+private:
+
+	MathArena* previous_;
+};
+
+// =============================================================================================
+// Element buffers used by the vector and matrix classes
+// =============================================================================================
+
+// Every element buffer starts on a cache line, so no SIMD load of its first elements is split
+//     between two lines and every matrix column whose leading dimension is padded to a
+//     whole number of lines starts on a line as well
+static constexpr size_t MATH_BUFFER_ALIGNMENT = 64;
+
+// Heap memory aligned to MATH_BUFFER_ALIGNMENT, freed with freeAlignedBytes
+void* allocateAlignedBytes(size_t size);
+void freeAlignedBytes(void* memory);
+
+/**
+ * @brief Allocates @ref count uninitialized elements aligned to @ref MATH_BUFFER_ALIGNMENT
+ *     from the current arena, or the heap when no arena scope is open.  @ref arena is set to
+ *     where the buffer came from and must be handed to @ref freeElements with it.
+ */
+template <typename T>
+T* allocateElements(size_t count, MathArena*& arena)
+{
+	static_assert(std::is_trivially_destructible<T>::value, "Element buffers are never destroyed");
+	arena = MathArena::getCurrent();
+	if (arena != nullptr)
+	{
+		return static_cast<T*>(arena->allocate(count * sizeof(T), MATH_BUFFER_ALIGNMENT));
+	}
+	return static_cast<T*>(allocateAlignedBytes(count * sizeof(T)));
+}
+
+// Buffers from an arena are only freed with the whole arena
+template <typename T>
+void freeElements(T* data, MathArena* arena)
+{
+	if (arena == nullptr)
+	{
+		freeAlignedBytes(data);
+	}
+}
+
+/**
+ * @brief A std::vector allocator for scratch buffers, such as the packed blocks of a matrix
+ *     product, that should start on a cache line like the element buffers do.
+ */
+template <typename T>
+class MathAlignedAllocator
+{
+public:
+
+	typedef T value_type;
+
+	MathAlignedAllocator() {}
+	template <typename U>
+	MathAlignedAllocator(const MathAlignedAllocator<U>&) {}
+
+	T* allocate(size_t count) { return static_cast<T*>(allocateAlignedBytes(count * sizeof(T))); }
+	void deallocate(T* memory, size_t) { freeAlignedBytes(memory); }
+
+	template <typename U>
+	bool operator==(const MathAlignedAllocator<U>&) const { return true; }
+	template <typename U>
+	bool operator!=(const MathAlignedAllocator<U>&) const { return false; }
+};
+
+#endif // __MATH_ARENA_H
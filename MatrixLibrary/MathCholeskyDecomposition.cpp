@@ -0,0 +1,299 @@
+#include "pch.h"
+#include "MathCholeskyDecomposition.h"
+#include "MathMatrixMultiply.h"
+#include "MathSimdKernels.h"
+#include "MathThreadPool.h"
+#include "MathTriangularSolve.h"
+#include <algorithm>
+#include <cmath>
+
+// The number of columns factored at a time, the inner dimension of the trailing update
+static constexpr unsigned int CHOLESKY_BLOCK_SIZE = 128;
+
+// The width of the columns of the trailing update handed to each task of the pool.  Columns
+//     further right are shorter since only the lower triangle is updated, so there should be
+//     several of them per thread.
+static constexpr unsigned int CHOLESKY_UPDATE_COLS = 64;
+
+/**
+ * @brief Factors a copy of @ref a.
+ * @return false and forgets any earlier factorization if @ref a is empty, not square or not
+ *     positive definite
+ */
+bool MathCholeskyDecomposition::factor(const MathMatrixView& a)
+{
+	n_ = 0;
+	failedColumn_ = -1;
+	l_ = MathMatrix();
+
+	unsigned int n = a.getNumRows();
+	if (n == 0 || a.getNumCols() != n)
+	{
+		return false;
+	}
+
+	// Only the lower triangle is copied, by column so every column operation is contiguous
+	MathMatrix l(n, n);
+	double* lData = l.getData();
+	size_t ld = l.getLeadingDimension();
+	for (unsigned int c = 0; c < n; ++c)
+	{
+		for (unsigned int r = c; r < n; ++r)
+		{
+			lData[r + c * ld] = a.getData()[r * a.getRowStride() + c * a.getColStride()];
+		}
+	}
+	l_ = std::move(l);
+
+	std::vector<double> inverse((size_t)CHOLESKY_BLOCK_SIZE * CHOLESKY_BLOCK_SIZE);
+	std::vector<double> panel;
+
+	for (unsigned int k = 0; k < n; k += CHOLESKY_BLOCK_SIZE)
+	{
+		unsigned int nb = (n - k < CHOLESKY_BLOCK_SIZE) ? n - k : CHOLESKY_BLOCK_SIZE;
+		unsigned int rest = n - k - nb;
+
+		if (!factorDiagonalBlock(k, nb))
+		{
+			l_ = MathMatrix();
+			return false;
+		}
+
+		if (rest == 0)
+		{
+			break;
+		}
+
+		solvePanel(k, nb, inverse, panel);
+		updateTrailingMatrix(k, nb);
+	}
+
+	n_ = n;
+	return true;
+}
+
+MathMatrix MathCholeskyDecomposition::getL() const
+{
+	if (!isFactored())
+	{
+		return MathMatrix();
+	}
+
+	MathMatrix l(n_, n_);
+	for (unsigned int c = 0; c < n_; ++c)
+	{
+		for (unsigned int r = c; r < n_; ++r)
+		{
+			l.setVal(r, c, l_.getVal(r, c));
+		}
+	}
+	return l;
+}
+
+/**
+ * @brief Solves A * X = B for every column of B
+ * @return An empty matrix if nothing is factored or B does not have as many rows as A
+ */
+MathMatrix MathCholeskyDecomposition::solve(const MathMatrixView& b) const
+{
+	if (!isFactored() || b.getNumRows() != n_ || b.getNumCols() == 0)
+	{
+		return MathMatrix();
+	}
+
+	MathMatrix x(b.getNumRows(), b.getNumCols());
+	MathMatrixView xView = x.getView();
+	for (unsigned int c = 0; c < b.getNumCols(); ++c)
+	{
+		for (unsigned int r = 0; r < b.getNumRows(); ++r)
+		{
+			xView.setVal(r, c, b.getVal(r, c));
+		}
+	}
+
+	solveInPlace(xView);
+	return x;
+}
+
+MathVector MathCholeskyDecomposition::solve(const MathVector& b) const
+{
+	if (!isFactored() || b.getOperationSize() != n_)
+	{
+		return MathVector();
+	}
+
+	MathVector x(b);
+	solveInPlace(MathMatrixView(x.getData(), n_, 1, 1, n_));
+	return x;
+}
+
+/**
+ * @brief Returns log(det(A)) = 2 * (log(L(0, 0)) + ... + log(L(n-1, n-1)))
+ * @return NAN if nothing is factored
+ */
+double MathCholeskyDecomposition::logDeterminant() const
+{
+	if (!isFactored())
+	{
+		return NAN;
+	}
+
+	const double* lData = l_.getData();
+	size_t ld = l_.getLeadingDimension();
+
+	double sum = 0.0;
+	for (unsigned int i = 0; i < n_; ++i)
+	{
+		sum += std::log(lData[i + i * ld]);
+	}
+	return 2.0 * sum;
+}
+
+/**
+ * @brief Returns the inverse of A by solving A * X = I
+ * @return An empty matrix if nothing is factored
+ */
+MathMatrix MathCholeskyDecomposition::inverse() const
+{
+	if (!isFactored())
+	{
+		return MathMatrix();
+	}
+
+	MathMatrix identity(n_, n_);
+	for (unsigned int i = 0; i < n_; ++i)
+	{
+		identity.setVal(i, i, 1.0);
+	}
+
+	solveInPlace(identity.getView());
+	return identity;
+}
+
+// ==============================================================================
+// Private Member functions
+// ==============================================================================
+
+/**
+ * @brief Factors the nb x nb block on the diagonal at k one column at a time
+ * @return false, and sets failedColumn_, if a pivot is not positive
+ */
+bool MathCholeskyDecomposition::factorDiagonalBlock(unsigned int k, unsigned int nb)
+{
+	double* lData = l_.getData();
+	size_t ld = l_.getLeadingDimension();
+
+	for (unsigned int j = k; j < k + nb; ++j)
+	{
+		double* col = lData + j * ld;
+
+		// Also catches NAN
+		if (!(col[j] > 0.0))
+		{
+			failedColumn_ = (int)j;
+			return false;
+		}
+
+		col[j] = std::sqrt(col[j]);
+		unsigned int below = k + nb - j - 1;
+		simdScale(1.0 / col[j], col + j + 1, below);
+
+		// The lower triangle of the rest of the block, column c from row c down
+		for (unsigned int c = j + 1; c < k + nb; ++c)
+		{
+			double* other = lData + c * ld;
+			simdAxpy(-col[c], col + c, other + c, k + nb - c);
+		}
+	}
+	return true;
+}
+
+/**
+ * @brief L21 = A21 * L11^-T for the panel below the block on the diagonal at k.
+ * @note Solving with A21 read transposed gives every row of the panel its own right-hand side
+ *     and runs at the speed of the vector kernels.  Inverting the small L11 instead and
+ *     multiplying by its transpose does twice the arithmetic, but all of it on @ref gemm, which
+ *     is several times faster.  L11 is the factor of a positive definite block, so its inverse
+ *     is as well conditioned as the solve.
+ */
+void MathCholeskyDecomposition::solvePanel(unsigned int k, unsigned int nb,
+	std::vector<double>& inverse, std::vector<double>& panel)
+{
+	double* lData = l_.getData();
+	size_t ld = l_.getLeadingDimension();
+	unsigned int rest = l_.getNumRows() - k - nb;
+	const double* l11 = lData + k + k * ld;
+	double* l21 = lData + (k + nb) + k * ld;
+
+	// inverse = L11^-1, nb x nb by column
+	std::fill(inverse.begin(), inverse.begin() + (size_t)nb * nb, 0.0);
+	for (unsigned int i = 0; i < nb; ++i)
+	{
+		inverse[i + (size_t)i * nb] = 1.0;
+	}
+	triangularSolve(LOWER_TRIANGLE, false, nb, nb, l11, 1, ld, inverse.data(), 1, nb);
+
+	// The panel is overwritten, so it is multiplied from a copy
+	panel.resize((size_t)rest * nb);
+	for (unsigned int c = 0; c < nb; ++c)
+	{
+		std::copy(l21 + c * ld, l21 + c * ld + rest, panel.data() + (size_t)c * rest);
+	}
+
+	gemm(rest, nb, nb, 1.0, panel.data(), 1, rest, inverse.data(), nb, 1, 0.0, l21, 1, ld);
+}
+
+/**
+ * @brief A22 -= L21 * L21^T for the lower triangle of A22 only.  Each task updates a column of
+ *     blocks from its diagonal down with one call to @ref gemm, which runs on its own thread
+ *     since the calls are nested in the pool.
+ */
+void MathCholeskyDecomposition::updateTrailingMatrix(unsigned int k, unsigned int nb)
+{
+	double* lData = l_.getData();
+	size_t ld = l_.getLeadingDimension();
+	unsigned int first = k + nb;
+	unsigned int rest = l_.getNumRows() - first;
+	const double* l21 = lData + first + k * ld;
+
+	unsigned int numTasks = (rest + CHOLESKY_UPDATE_COLS - 1) / CHOLESKY_UPDATE_COLS;
+	MathThreadPool::getInstance().parallelFor(numTasks, [&](unsigned int task)
+	{
+		unsigned int c0 = task * CHOLESKY_UPDATE_COLS;
+		unsigned int cols = (rest - c0 < CHOLESKY_UPDATE_COLS) ? rest - c0 : CHOLESKY_UPDATE_COLS;
+
+		// A22(c0:rest, c0:c0+cols) -= L21(c0:rest, :) * L21(c0:c0+cols, :)^T
+		gemm(rest - c0, cols, nb, -1.0, l21 + c0, 1, ld, l21 + c0, ld, 1,
+			1.0, lData + (first + c0) + (first + c0) * ld, 1, ld);
+	});
+}
+
+/**
+ * @brief Overwrites @ref x, which holds B, with the solution of L * L^T * X = B
+ */
+void MathCholeskyDecomposition::solveInPlace(const MathMatrixView& x) const
+{
+	const double* lData = l_.getData();
+	size_t ld = l_.getLeadingDimension();
+	unsigned int nrhs = x.getNumCols();
+
+	// L * Y = B, then L^T * X = Y with L^T read by swapping the strides of L
+	triangularSolve(LOWER_TRIANGLE, false, n_, nrhs, lData, 1, ld,
+		x.getData(), x.getRowStride(), x.getColStride());
+	triangularSolve(UPPER_TRIANGLE, false, n_, nrhs, lData, ld, 1,
+		x.getData(), x.getRowStride(), x.getColStride());
+}
+
+// =============================================================================================
+// Outside of class functions
+// =============================================================================================
+
+MathVector choleskySolve(const MathMatrix& a, const MathVector& b)
+{
+	return MathCholeskyDecomposition(a.getView()).solve(b);
+}
+
+MathMatrix choleskySolve(const MathMatrix& a, const MathMatrix& b)
+{
+	return MathCholeskyDecomposition(a.getView()).solve(b.getView());
+}
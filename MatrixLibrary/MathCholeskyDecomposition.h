@@ -0,0 +1,72 @@
+#pragma once
+
+#ifndef __MATH_CHOLESKY_DECOMPOSITION_H
+#define __MATH_CHOLESKY_DECOMPOSITION_H
+
+#include <vector>
+#include "MathMatrix.h"
+#include "MathMatrixView.h"
+#include "MathVector.h"
+
+/**
+ * @brief The Cholesky factorization A = L * L^T of a symmetric positive definite matrix A, where
+ *     L is lower triangular with a positive diagonal.  It takes half the work of
+ *     @ref MathLUDecomposition and needs no pivoting, so covariance and Gram matrices should be
+ *     factored with it once and then solved against as often as needed.
+ * @note Only the lower triangle of A is read, the upper triangle is taken to mirror it.
+ * @note The factorization is blocked and right-looking.  The block on the diagonal is factored
+ *     with vector kernels, the panel below it is multiplied by the inverse of that block and the
+ *     lower triangle of the rest of the matrix is updated in columns of blocks that are split
+ *     between the threads of @ref MathThreadPool, each one a call to @ref gemm.
+ * @note A pivot that is not positive means A is not positive definite.  @ref factor then
+ *     returns false and @ref getFailedColumn says where it happened.
+ */
+class MathCholeskyDecomposition
+{
+public:
+
+	MathCholeskyDecomposition() {}
+	explicit MathCholeskyDecomposition(const MathMatrixView& a) { factor(a); }
+
+	// Factors a copy of @ref a.  Returns false if @ref a is empty, not square or not positive
+	//     definite.
+	bool factor(const MathMatrixView& a);
+
+	bool isFactored() const { return n_ != 0; }
+	unsigned int getSize() const { return n_; }
+
+	// The column of A whose pivot was not positive the last time @ref factor failed because of
+	//     one, -1 otherwise
+	int getFailedColumn() const { return failedColumn_; }
+
+	// L as a COLUMNSPACE matrix with zeros above the diagonal
+	MathMatrix getL() const;
+
+	MathMatrix solve(const MathMatrixView& b) const;
+	MathVector solve(const MathVector& b) const;
+
+	// log(det(A)), which does not overflow the way the determinant of a big covariance does
+	double logDeterminant() const;
+	MathMatrix inverse() const;
+
+private:
+
+	bool factorDiagonalBlock(unsigned int k, unsigned int nb);
+	void solvePanel(unsigned int k, unsigned int nb, std::vector<double>& inverse,
+		std::vector<double>& panel);
+	void updateTrailingMatrix(unsigned int k, unsigned int nb);
+	void solveInPlace(const MathMatrixView& x) const;
+
+	// L on and below the diagonal, what is left of the copy of A above it
+	MathMatrix l_;
+
+	unsigned int n_ = 0;
+	int failedColumn_ = -1;
+};
+
+// Outside of class functions that factor @ref a and throw the factorization away.  They return
+//     an empty vector or matrix if @ref a is not positive definite or the sizes do not match.
+MathVector choleskySolve(const MathMatrix& a, const MathVector& b);
+MathMatrix choleskySolve(const MathMatrix& a, const MathMatrix& b);
+
+#endif // __MATH_CHOLESKY_DECOMPOSITION_H
@@ -0,0 +1,476 @@
+#pragma once
+
+#ifndef __MATH_FIXED_MATRIX_H
+#define __MATH_FIXED_MATRIX_H
+
+#include <cmath>
+#include <initializer_list>
+#include <limits>
+#include "MathFixedVector.h"
+#include "MathMatrix.h"
+#include "MathMatrixView.h"
+
+/**
+ * @brief An R x C matrix whose size is known at compile time, stored by row inside the object
+ *     so making, copying and doing math with one never allocates.  Everything but the
+ *     conversions is constexpr, so a transform known at compile time can be built, inverted
+ *     and applied there.
+ * @note Products are unrolled completely by templates, one dot product per element.  The
+ *     other operations run loops over the compile time sizes, which the compiler unrolls.
+ *     The determinant and inverse of 2 x 2, 3 x 3 and 4 x 4 matrices are closed formulas with
+ *     no branches but the test for a singular matrix.
+ * @note getView() lets the functions of the library that take a @ref MathMatrixView work on
+ *     the elements in place.
+ */
+template <unsigned int R, unsigned int C>
+class MathFixedMatrix
+{
+	static_assert(R > 0 && C > 0, "MathFixedMatrix needs at least one row and one column");
+
+public:
+
+	constexpr MathFixedMatrix() : data_{} {}
+
+	// The inner lists are the rows.  Missing elements are zero, extra ones are ignored.
+	constexpr MathFixedMatrix(std::initializer_list<std::initializer_list<double>> list2d) : data_{}
+	{
+		unsigned int r = 0;
+		for (auto row = list2d.begin(); row != list2d.end() && r < R; ++row, ++r)
+		{
+			unsigned int c = 0;
+			for (auto it = row->begin(); it != row->end() && c < C; ++it, ++c)
+			{
+				data_[r * C + c] = *it;
+			}
+		}
+	}
+
+	// Copies the top left R x C block of @ref view, anything it does not cover is zero
+	explicit MathFixedMatrix(const MathMatrixView& view) : data_{}
+	{
+		unsigned int rows = (view.getNumRows() < R) ? view.getNumRows() : R;
+		unsigned int cols = (view.getNumCols() < C) ? view.getNumCols() : C;
+		for (unsigned int r = 0; r < rows; ++r)
+		{
+			for (unsigned int c = 0; c < cols; ++c)
+			{
+				data_[r * C + c] = view.getVal(r, c);
+			}
+		}
+	}
+
+	MathMatrix toMathMatrix() const
+	{
+		MathMatrix m(R, C);
+		double* data = m.getData();
+		size_t rowStride = m.getRowStride();
+		size_t colStride = m.getColStride();
+		for (unsigned int r = 0; r < R; ++r)
+		{
+			for (unsigned int c = 0; c < C; ++c)
+			{
+				data[r * rowStride + c * colStride] = data_[r * C + c];
+			}
+		}
+		return m;
+	}
+
+	static constexpr MathFixedMatrix identity()
+	{
+		MathFixedMatrix i;
+		for (unsigned int d = 0; d < R && d < C; ++d)
+		{
+			i.data_[d * C + d] = 1.0;
+		}
+		return i;
+	}
+
+	static constexpr unsigned int getNumRows() { return R; }
+	static constexpr unsigned int getNumCols() { return C; }
+
+	// Unchecked access to element (row, col)
+	constexpr double& operator()(unsigned int row, unsigned int col) { return data_[row * C + col]; }
+	constexpr const double& operator()(unsigned int row, unsigned int col) const { return data_[row * C + col]; }
+
+	// Element (row, col) is getData()[row * C + col]
+	constexpr double* getData() { return data_; }
+	constexpr const double* getData() const { return data_; }
+
+	MathMatrixView getView() { return MathMatrixView(data_, R, C, C, 1); }
+
+	constexpr MathFixedMatrix& operator+=(const MathFixedMatrix& other)
+	{
+		for (unsigned int i = 0; i < R * C; ++i) data_[i] += other.data_[i];
+		return *this;
+	}
+
+	constexpr MathFixedMatrix& operator-=(const MathFixedMatrix& other)
+	{
+		for (unsigned int i = 0; i < R * C; ++i) data_[i] -= other.data_[i];
+		return *this;
+	}
+
+	constexpr MathFixedMatrix& operator*=(double alpha)
+	{
+		for (unsigned int i = 0; i < R * C; ++i) data_[i] *= alpha;
+		return *this;
+	}
+
+	constexpr bool operator==(const MathFixedMatrix& other) const
+	{
+		for (unsigned int i = 0; i < R * C; ++i)
+		{
+			if (data_[i] != other.data_[i]) return false;
+		}
+		return true;
+	}
+
+	constexpr bool operator!=(const MathFixedMatrix& other) const { return !(*this == other); }
+
+private:
+
+	double data_[R * C];
+};
+
+typedef MathFixedMatrix<2, 2> MathFixedMatrix2;
+typedef MathFixedMatrix<3, 3> MathFixedMatrix3;
+typedef MathFixedMatrix<4, 4> MathFixedMatrix4;
+
+// =============================================================================================
+// Outside of class functions
+// =============================================================================================
+
+template <unsigned int R, unsigned int C>
+constexpr MathFixedMatrix<R, C> operator+(MathFixedMatrix<R, C> m1, const MathFixedMatrix<R, C>& m2)
+{
+	return m1 += m2;
+}
+
+template <unsigned int R, unsigned int C>
+constexpr MathFixedMatrix<R, C> operator-(MathFixedMatrix<R, C> m1, const MathFixedMatrix<R, C>& m2)
+{
+	return m1 -= m2;
+}
+
+template <unsigned int R, unsigned int C>
+constexpr MathFixedMatrix<R, C> operator*(MathFixedMatrix<R, C> m, double alpha)
+{
+	return m *= alpha;
+}
+
+template <unsigned int R, unsigned int C>
+constexpr MathFixedMatrix<R, C> operator*(double alpha, MathFixedMatrix<R, C> m)
+{
+	return m *= alpha;
+}
+
+/**
+ * @brief a[0] * b[0] + a[aStride] * b[bStride] + ... over K terms, written out completely by
+ *     the recursion so it does not depend on the optimizer unrolling a loop
+ */
+template <unsigned int K>
+struct MathFixedDot
+{
+	static constexpr double run(const double* a, unsigned int aStride, const double* b, unsigned int bStride)
+	{
+		return a[0] * b[0] + MathFixedDot<K - 1>::run(a + aStride, aStride, b + bStride, bStride);
+	}
+};
+
+template <>
+struct MathFixedDot<1>
+{
+	static constexpr double run(const double* a, unsigned int, const double* b, unsigned int)
+	{
+		return a[0] * b[0];
+	}
+};
+
+/**
+ * @brief Sets the last @ref Remaining elements of the R x C product of an R x K matrix @ref a
+ *     and a K x C matrix @ref b, all stored by row, one unrolled dot product each
+ */
+template <unsigned int Remaining, unsigned int K, unsigned int C>
+struct MathFixedProduct
+{
+	static constexpr void run(const double* a, const double* b, double* product, unsigned int numElements)
+	{
+		unsigned int i = numElements - Remaining;
+		product[i] = MathFixedDot<K>::run(a + (i / C) * K, 1, b + i % C, C);
+		MathFixedProduct<Remaining - 1, K, C>::run(a, b, product, numElements);
+	}
+};
+
+template <unsigned int K, unsigned int C>
+struct MathFixedProduct<0, K, C>
+{
+	static constexpr void run(const double*, const double*, double*, unsigned int) {}
+};
+
+template <unsigned int R, unsigned int K, unsigned int C>
+constexpr MathFixedMatrix<R, C> operator*(const MathFixedMatrix<R, K>& m1, const MathFixedMatrix<K, C>& m2)
+{
+	MathFixedMatrix<R, C> product;
+	MathFixedProduct<R * C, K, C>::run(m1.getData(), m2.getData(), product.getData(), R * C);
+	return product;
+}
+
+template <unsigned int R, unsigned int C>
+constexpr MathFixedVector<R> operator*(const MathFixedMatrix<R, C>& m, const MathFixedVector<C>& v)
+{
+	MathFixedVector<R> product;
+	MathFixedProduct<R, C, 1>::run(m.getData(), v.getData(), product.getData(), R);
+	return product;
+}
+
+template <unsigned int R, unsigned int C>
+constexpr MathFixedMatrix<C, R> transpose(const MathFixedMatrix<R, C>& m)
+{
+	MathFixedMatrix<C, R> t;
+	for (unsigned int r = 0; r < R; ++r)
+	{
+		for (unsigned int c = 0; c < C; ++c)
+		{
+			t(c, r) = m(r, c);
+		}
+	}
+	return t;
+}
+
+/**
+ * @brief The determinant by Gaussian elimination with partial pivoting, for the sizes that
+ *     have no closed formula below
+ */
+template <unsigned int N>
+constexpr double determinant(MathFixedMatrix<N, N> a)
+{
+	double det = 1.0;
+	for (unsigned int k = 0; k < N; ++k)
+	{
+		unsigned int pivot = k;
+		for (unsigned int r = k + 1; r < N; ++r)
+		{
+			double candidate = (a(r, k) < 0.0) ? -a(r, k) : a(r, k);
+			double best = (a(pivot, k) < 0.0) ? -a(pivot, k) : a(pivot, k);
+			if (candidate > best) pivot = r;
+		}
+		if (a(pivot, k) == 0.0)
+		{
+			return 0.0;
+		}
+		if (pivot != k)
+		{
+			for (unsigned int c = k; c < N; ++c)
+			{
+				double temp = a(k, c); a(k, c) = a(pivot, c); a(pivot, c) = temp;
+			}
+			det = -det;
+		}
+
+		det *= a(k, k);
+		for (unsigned int r = k + 1; r < N; ++r)
+		{
+			double factor = a(r, k) / a(k, k);
+			for (unsigned int c = k + 1; c < N; ++c)
+			{
+				a(r, c) -= factor * a(k, c);
+			}
+		}
+	}
+	return det;
+}
+
+constexpr double determinant(const MathFixedMatrix<1, 1>& a)
+{
+	return a(0, 0);
+}
+
+constexpr double determinant(const MathFixedMatrix<2, 2>& a)
+{
+	return a(0, 0) * a(1, 1) - a(0, 1) * a(1, 0);
+}
+
+constexpr double determinant(const MathFixedMatrix<3, 3>& a)
+{
+	return a(0, 0) * (a(1, 1) * a(2, 2) - a(1, 2) * a(2, 1))
+		- a(0, 1) * (a(1, 0) * a(2, 2) - a(1, 2) * a(2, 0))
+		+ a(0, 2) * (a(1, 0) * a(2, 1) - a(1, 1) * a(2, 0));
+}
+
+/**
+ * @brief Laplace expansion along the first two rows, from the 2 x 2 determinants of the
+ *     top two rows (s) and of the bottom two rows (c)
+ */
+constexpr double determinant(const MathFixedMatrix<4, 4>& a)
+{
+	double s0 = a(0, 0) * a(1, 1) - a(0, 1) * a(1, 0);
+	double s1 = a(0, 0) * a(1, 2) - a(0, 2) * a(1, 0);
+	double s2 = a(0, 0) * a(1, 3) - a(0, 3) * a(1, 0);
+	double s3 = a(0, 1) * a(1, 2) - a(0, 2) * a(1, 1);
+	double s4 = a(0, 1) * a(1, 3) - a(0, 3) * a(1, 1);
+	double s5 = a(0, 2) * a(1, 3) - a(0, 3) * a(1, 2);
+
+	double c0 = a(2, 0) * a(3, 1) - a(2, 1) * a(3, 0);
+	double c1 = a(2, 0) * a(3, 2) - a(2, 2) * a(3, 0);
+	double c2 = a(2, 0) * a(3, 3) - a(2, 3) * a(3, 0);
+	double c3 = a(2, 1) * a(3, 2) - a(2, 2) * a(3, 1);
+	double c4 = a(2, 1) * a(3, 3) - a(2, 3) * a(3, 1);
+	double c5 = a(2, 2) * a(3, 3) - a(2, 3) * a(3, 2);
+
+	return s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+}
+
+/**
+ * @brief A matrix with every element NAN, what inverse() returns for a singular matrix
+ */
+template <unsigned int N>
+constexpr MathFixedMatrix<N, N> makeNanFixedMatrix()
+{
+	MathFixedMatrix<N, N> m;
+	for (unsigned int r = 0; r < N; ++r)
+	{
+		for (unsigned int c = 0; c < N; ++c)
+		{
+			m(r, c) = std::numeric_limits<double>::quiet_NaN();
+		}
+	}
+	return m;
+}
+
+/**
+ * @brief The inverse by Gauss-Jordan elimination with partial pivoting, for the sizes that
+ *     have no closed formula below
+ * @return A matrix of NANs if @ref a is singular
+ */
+template <unsigned int N>
+constexpr MathFixedMatrix<N, N> inverse(MathFixedMatrix<N, N> a)
+{
+	MathFixedMatrix<N, N> inv = MathFixedMatrix<N, N>::identity();
+	for (unsigned int k = 0; k < N; ++k)
+	{
+		unsigned int pivot = k;
+		for (unsigned int r = k + 1; r < N; ++r)
+		{
+			double candidate = (a(r, k) < 0.0) ? -a(r, k) : a(r, k);
+			double best = (a(pivot, k) < 0.0) ? -a(pivot, k) : a(pivot, k);
+			if (candidate > best) pivot = r;
+		}
+		if (a(pivot, k) == 0.0)
+		{
+			return makeNanFixedMatrix<N>();
+		}
+		if (pivot != k)
+		{
+			for (unsigned int c = 0; c < N; ++c)
+			{
+				double temp = a(k, c); a(k, c) = a(pivot, c); a(pivot, c) = temp;
+				temp = inv(k, c); inv(k, c) = inv(pivot, c); inv(pivot, c) = temp;
+			}
+		}
+
+		double scale = 1.0 / a(k, k);
+		for (unsigned int c = 0; c < N; ++c)
+		{
+			a(k, c) *= scale;
+			inv(k, c) *= scale;
+		}
+		for (unsigned int r = 0; r < N; ++r)
+		{
+			if (r == k) continue;
+			double factor = a(r, k);
+			for (unsigned int c = 0; c < N; ++c)
+			{
+				a(r, c) -= factor * a(k, c);
+				inv(r, c) -= factor * inv(k, c);
+			}
+		}
+	}
+	return inv;
+}
+
+constexpr MathFixedMatrix<1, 1> inverse(const MathFixedMatrix<1, 1>& a)
+{
+	return (a(0, 0) == 0.0) ? makeNanFixedMatrix<1>() : MathFixedMatrix<1, 1>({ { 1.0 / a(0, 0) } });
+}
+
+constexpr MathFixedMatrix<2, 2> inverse(const MathFixedMatrix<2, 2>& a)
+{
+	double det = determinant(a);
+	if (det == 0.0)
+	{
+		return makeNanFixedMatrix<2>();
+	}
+
+	double invDet = 1.0 / det;
+	return { { a(1, 1) * invDet, -a(0, 1) * invDet },
+		{ -a(1, 0) * invDet, a(0, 0) * invDet } };
+}
+
+/**
+ * @brief The adjugate, the transposed matrix of cofactors, over the determinant
+ */
+constexpr MathFixedMatrix<3, 3> inverse(const MathFixedMatrix<3, 3>& a)
+{
+	double c00 = a(1, 1) * a(2, 2) - a(1, 2) * a(2, 1);
+	double c01 = a(1, 2) * a(2, 0) - a(1, 0) * a(2, 2);
+	double c02 = a(1, 0) * a(2, 1) - a(1, 1) * a(2, 0);
+
+	double det = a(0, 0) * c00 + a(0, 1) * c01 + a(0, 2) * c02;
+	if (det == 0.0)
+	{
+		return makeNanFixedMatrix<3>();
+	}
+
+	double invDet = 1.0 / det;
+	return { { c00 * invDet, (a(0, 2) * a(2, 1) - a(0, 1) * a(2, 2)) * invDet, (a(0, 1) * a(1, 2) - a(0, 2) * a(1, 1)) * invDet },
+		{ c01 * invDet, (a(0, 0) * a(2, 2) - a(0, 2) * a(2, 0)) * invDet, (a(0, 2) * a(1, 0) - a(0, 0) * a(1, 2)) * invDet },
+		{ c02 * invDet, (a(0, 1) * a(2, 0) - a(0, 0) * a(2, 1)) * invDet, (a(0, 0) * a(1, 1) - a(0, 1) * a(1, 0)) * invDet } };
+}
+
+/**
+ * @brief The adjugate over the determinant, with the cofactors built from the same 2 x 2
+ *     determinants as @ref determinant uses
+ */
+constexpr MathFixedMatrix<4, 4> inverse(const MathFixedMatrix<4, 4>& a)
+{
+	double s0 = a(0, 0) * a(1, 1) - a(0, 1) * a(1, 0);
+	double s1 = a(0, 0) * a(1, 2) - a(0, 2) * a(1, 0);
+	double s2 = a(0, 0) * a(1, 3) - a(0, 3) * a(1, 0);
+	double s3 = a(0, 1) * a(1, 2) - a(0, 2) * a(1, 1);
+	double s4 = a(0, 1) * a(1, 3) - a(0, 3) * a(1, 1);
+	double s5 = a(0, 2) * a(1, 3) - a(0, 3) * a(1, 2);
+
+	double c0 = a(2, 0) * a(3, 1) - a(2, 1) * a(3, 0);
+	double c1 = a(2, 0) * a(3, 2) - a(2, 2) * a(3, 0);
+	double c2 = a(2, 0) * a(3, 3) - a(2, 3) * a(3, 0);
+	double c3 = a(2, 1) * a(3, 2) - a(2, 2) * a(3, 1);
+	double c4 = a(2, 1) * a(3, 3) - a(2, 3) * a(3, 1);
+	double c5 = a(2, 2) * a(3, 3) - a(2, 3) * a(3, 2);
+
+	double det = s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+	if (det == 0.0)
+	{
+		return makeNanFixedMatrix<4>();
+	}
+
+	double invDet = 1.0 / det;
+	return {
+		{ (a(1, 1) * c5 - a(1, 2) * c4 + a(1, 3) * c3) * invDet,
+			(-a(0, 1) * c5 + a(0, 2) * c4 - a(0, 3) * c3) * invDet,
+			(a(3, 1) * s5 - a(3, 2) * s4 + a(3, 3) * s3) * invDet,
+			(-a(2, 1) * s5 + a(2, 2) * s4 - a(2, 3) * s3) * invDet },
+		{ (-a(1, 0) * c5 + a(1, 2) * c2 - a(1, 3) * c1) * invDet,
+			(a(0, 0) * c5 - a(0, 2) * c2 + a(0, 3) * c1) * invDet,
+			(-a(3, 0) * s5 + a(3, 2) * s2 - a(3, 3) * s1) * invDet,
+			(a(2, 0) * s5 - a(2, 2) * s2 + a(2, 3) * s1) * invDet },
+		{ (a(1, 0) * c4 - a(1, 1) * c2 + a(1, 3) * c0) * invDet,
+			(-a(0, 0) * c4 + a(0, 1) * c2 - a(0, 3) * c0) * invDet,
+			(a(3, 0) * s4 - a(3, 1) * s2 + a(3, 3) * s0) * invDet,
+			(-a(2, 0) * s4 + a(2, 1) * s2 - a(2, 3) * s0) * invDet },
+		{ (-a(1, 0) * c3 + a(1, 1) * c1 - a(1, 2) * c0) * invDet,
+			(a(0, 0) * c3 - a(0, 1) * c1 + a(0, 2) * c0) * invDet,
+			(-a(3, 0) * s3 + a(3, 1) * s1 - a(3, 2) * s0) * invDet,
+			(a(2, 0) * s3 - a(2, 1) * s1 + a(2, 2) * s0) * invDet } };
+}
+
+#endif // __MATH_FIXED_MATRIX_H
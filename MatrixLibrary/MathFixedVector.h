@@ -0,0 +1,149 @@
+#pragma once
+
+#ifndef __MATH_FIXED_VECTOR_H
+#define __MATH_FIXED_VECTOR_H
+
+#include <cmath>
+#include <initializer_list>
+#include "MathVector.h"
+
+/**
+ * @brief A vector of N doubles whose size is known at compile time.  The elements live inside
+ *     the object, on the stack or in whatever holds it, so making, copying and doing math with
+ *     one never allocates.  Everything but the conversions is constexpr.
+ * @note Meant for the small vectors of geometry and transforms.  Loops run over the
+ *     compile time size, so the compiler unrolls them completely.
+ */
+template <unsigned int N>
+class MathFixedVector
+{
+	static_assert(N > 0, "MathFixedVector needs at least one element");
+
+public:
+
+	constexpr MathFixedVector() : data_{} {}
+
+	// Elements past the end of @ref list are zero, extra ones are ignored
+	constexpr MathFixedVector(std::initializer_list<double> list) : data_{}
+	{
+		unsigned int i = 0;
+		for (auto it = list.begin(); it != list.end() && i < N; ++it, ++i)
+		{
+			data_[i] = *it;
+		}
+	}
+
+	// Copies the first N elements of the operation size of @ref v, the rest are zero
+	explicit MathFixedVector(const MathVector& v) : data_{}
+	{
+		unsigned int size = (v.getOperationSize() < N) ? v.getOperationSize() : N;
+		for (unsigned int i = 0; i < size; ++i)
+		{
+			data_[i] = v[i];
+		}
+	}
+
+	MathVector toMathVector() const
+	{
+		MathVector v(N);
+		for (unsigned int i = 0; i < N; ++i)
+		{
+			v[i] = data_[i];
+		}
+		return v;
+	}
+
+	static constexpr unsigned int getSize() { return N; }
+
+	constexpr double& operator[](unsigned int index) { return data_[index]; }
+	constexpr const double& operator[](unsigned int index) const { return data_[index]; }
+
+	constexpr double* getData() { return data_; }
+	constexpr const double* getData() const { return data_; }
+
+	constexpr double dotProduct(const MathFixedVector& other) const
+	{
+		double sum = 0.0;
+		for (unsigned int i = 0; i < N; ++i)
+		{
+			sum += data_[i] * other.data_[i];
+		}
+		return sum;
+	}
+
+	double getMagnitude() const { return std::sqrt(dotProduct(*this)); }
+
+	constexpr MathFixedVector& operator+=(const MathFixedVector& other)
+	{
+		for (unsigned int i = 0; i < N; ++i) data_[i] += other.data_[i];
+		return *this;
+	}
+
+	constexpr MathFixedVector& operator-=(const MathFixedVector& other)
+	{
+		for (unsigned int i = 0; i < N; ++i) data_[i] -= other.data_[i];
+		return *this;
+	}
+
+	constexpr MathFixedVector& operator*=(double alpha)
+	{
+		for (unsigned int i = 0; i < N; ++i) data_[i] *= alpha;
+		return *this;
+	}
+
+	constexpr bool operator==(const MathFixedVector& other) const
+	{
+		for (unsigned int i = 0; i < N; ++i)
+		{
+			if (data_[i] != other.data_[i]) return false;
+		}
+		return true;
+	}
+
+	constexpr bool operator!=(const MathFixedVector& other) const { return !(*this == other); }
+
+private:
+
+	double data_[N];
+};
+
+// =============================================================================================
+// Outside of class functions
+// =============================================================================================
+
+template <unsigned int N>
+constexpr MathFixedVector<N> operator+(MathFixedVector<N> v1, const MathFixedVector<N>& v2)
+{
+	return v1 += v2;
+}
+
+template <unsigned int N>
+constexpr MathFixedVector<N> operator-(MathFixedVector<N> v1, const MathFixedVector<N>& v2)
+{
+	return v1 -= v2;
+}
+
+template <unsigned int N>
+constexpr MathFixedVector<N> operator*(MathFixedVector<N> v, double alpha)
+{
+	return v *= alpha;
+}
+
+template <unsigned int N>
+constexpr MathFixedVector<N> operator*(double alpha, MathFixedVector<N> v)
+{
+	return v *= alpha;
+}
+
+template <unsigned int N>
+constexpr double dotProduct(const MathFixedVector<N>& v1, const MathFixedVector<N>& v2)
+{
+	return v1.dotProduct(v2);
+}
+
+constexpr MathFixedVector<3> crossProduct(const MathFixedVector<3>& a, const MathFixedVector<3>& b)
+{
+	return { a[1] * b[2] - a[2] * b[1], a[2] * b[0] - a[0] * b[2], a[0] * b[1] - a[1] * b[0] };
+}
+
+#endif // __MATH_FIXED_VECTOR_H
@@ -0,0 +1,301 @@
+#include "pch.h"
+#include "MathLUDecomposition.h"
+#include "MathMatrixMultiply.h"
+#include "MathSimdKernels.h"
+#include "MathTriangularSolve.h"
+#include <cmath>
+
+// The number of columns factored at a time.  This is the inner dimension of the product that
+//     updates the rest of the matrix, so it should be big enough for the multiplication kernel
+//     to run at full speed, and small enough that the panel, which is factored with vector
+//     kernels, is only a small part of the work.
+static constexpr unsigned int LU_BLOCK_SIZE = 128;
+
+/**
+ * @brief Factors a copy of @ref a.
+ * @return false and forgets any earlier factorization if @ref a is empty or not square
+ */
+bool MathLUDecomposition::factor(const MathMatrixView& a)
+{
+	n_ = 0;
+	singular_ = false;
+	pivots_.clear();
+	lu_ = MathMatrix();
+
+	unsigned int n = a.getNumRows();
+	if (n == 0 || a.getNumCols() != n)
+	{
+		return false;
+	}
+
+	// The factors are kept by column so every column operation below is contiguous
+	lu_ = MathMatrix(n, n);
+	double* luData = lu_.getData();
+	size_t ld = lu_.getLeadingDimension();
+	for (unsigned int c = 0; c < n; ++c)
+	{
+		for (unsigned int r = 0; r < n; ++r)
+		{
+			luData[r + c * ld] = a.getData()[r * a.getRowStride() + c * a.getColStride()];
+		}
+	}
+
+	n_ = n;
+	pivots_.assign(n, 0);
+
+	for (unsigned int k = 0; k < n; k += LU_BLOCK_SIZE)
+	{
+		unsigned int nb = (n - k < LU_BLOCK_SIZE) ? n - k : LU_BLOCK_SIZE;
+		unsigned int rest = n - k - nb;
+
+		factorPanel(k, nb);
+
+		// The panel only swapped its own columns, swap the rest of each row too
+		for (unsigned int j = k; j < k + nb; ++j)
+		{
+			if (pivots_[j] != j)
+			{
+				swapRowsOf(j, pivots_[j], 0, k);
+				swapRowsOf(j, pivots_[j], k + nb, n);
+			}
+		}
+
+		if (rest == 0)
+		{
+			break;
+		}
+
+		double* l11 = luData + k + k * ld;
+		double* l21 = l11 + nb;
+		double* u12 = l11 + nb * ld;
+		double* a22 = u12 + nb;
+
+		// U12 = L11^-1 * A12
+		triangularSolve(LOWER_TRIANGLE, true, nb, rest, l11, 1, ld, u12, 1, ld);
+
+		// A22 -= L21 * U12
+		gemm(rest, rest, nb, -1.0, l21, 1, ld, u12, 1, ld, 1.0, a22, 1, ld);
+	}
+	return true;
+}
+
+unsigned int MathLUDecomposition::getPivotedRow(unsigned int i) const
+{
+	if (i >= n_)
+	{
+		return n_;
+	}
+
+	std::vector<unsigned int> rows(n_);
+	for (unsigned int r = 0; r < n_; ++r) rows[r] = r;
+	for (unsigned int j = 0; j < n_; ++j)
+	{
+		unsigned int temp = rows[j]; rows[j] = rows[pivots_[j]]; rows[pivots_[j]] = temp;
+	}
+	return rows[i];
+}
+
+/**
+ * @brief Solves A * X = B for every column of B
+ * @return An empty matrix if nothing is factored, A is singular or B does not have as many
+ *     rows as A
+ */
+MathMatrix MathLUDecomposition::solve(const MathMatrixView& b) const
+{
+	if (!isFactored() || singular_ || b.getNumRows() != n_ || b.getNumCols() == 0)
+	{
+		return MathMatrix();
+	}
+
+	MathMatrix x(b.getNumRows(), b.getNumCols());
+	MathMatrixView xView = x.getView();
+	for (unsigned int c = 0; c < b.getNumCols(); ++c)
+	{
+		for (unsigned int r = 0; r < b.getNumRows(); ++r)
+		{
+			xView.setVal(r, c, b.getVal(r, c));
+		}
+	}
+
+	solveInPlace(xView);
+	return x;
+}
+
+MathVector MathLUDecomposition::solve(const MathVector& b) const
+{
+	if (!isFactored() || singular_ || b.getOperationSize() != n_)
+	{
+		return MathVector();
+	}
+
+	MathVector x(b);
+	solveInPlace(MathMatrixView(x.getData(), n_, 1, 1, n_));
+	return x;
+}
+
+/**
+ * @brief Returns the determinant of A, the product of the diagonal of U with the sign of
+ *     the permutation
+ * @return NAN if nothing is factored
+ */
+double MathLUDecomposition::determinant() const
+{
+	if (!isFactored())
+	{
+		return NAN;
+	}
+	if (singular_)
+	{
+		return 0.0;
+	}
+
+	const double* luData = lu_.getData();
+	size_t ld = lu_.getLeadingDimension();
+
+	double det = 1.0;
+	for (unsigned int i = 0; i < n_; ++i)
+	{
+		det *= luData[i + i * ld];
+		if (pivots_[i] != i) det = -det;
+	}
+	return det;
+}
+
+/**
+ * @brief Returns the inverse of A by solving A * X = I
+ * @return An empty matrix if nothing is factored or A is singular
+ */
+MathMatrix MathLUDecomposition::inverse() const
+{
+	if (!isFactored() || singular_)
+	{
+		return MathMatrix();
+	}
+
+	MathMatrix identity(n_, n_);
+	for (unsigned int i = 0; i < n_; ++i)
+	{
+		identity.setVal(i, i, 1.0);
+	}
+
+	solveInPlace(identity.getView());
+	return identity;
+}
+
+// ==============================================================================
+// Private Member functions
+// ==============================================================================
+
+/**
+ * @brief Factors the nb columns starting at column k, from row k down, one column at a time.
+ *     Rows are only swapped inside the panel.
+ */
+void MathLUDecomposition::factorPanel(unsigned int k, unsigned int nb)
+{
+	double* luData = lu_.getData();
+	size_t ld = lu_.getLeadingDimension();
+
+	for (unsigned int j = k; j < k + nb; ++j)
+	{
+		double* col = luData + j * ld;
+
+		// The pivot is the biggest element on or below the diagonal
+		unsigned int pivot = j;
+		double biggest = std::fabs(col[j]);
+		for (unsigned int i = j + 1; i < n_; ++i)
+		{
+			if (std::fabs(col[i]) > biggest)
+			{
+				biggest = std::fabs(col[i]);
+				pivot = i;
+			}
+		}
+
+		pivots_[j] = pivot;
+		if (pivot != j)
+		{
+			swapRowsOf(j, pivot, k, k + nb);
+		}
+
+		if (col[j] == 0.0)
+		{
+			// Nothing below the diagonal to eliminate with
+			singular_ = true;
+			continue;
+		}
+
+		// Column j of L
+		unsigned int below = n_ - j - 1;
+		simdScale(1.0 / col[j], col + j + 1, below);
+
+		// Rank one update of the rest of the panel
+		for (unsigned int c = j + 1; c < k + nb; ++c)
+		{
+			double* other = luData + c * ld;
+			simdAxpy(-other[j], col + j + 1, other + j + 1, below);
+		}
+	}
+}
+
+void MathLUDecomposition::swapRowsOf(unsigned int row1, unsigned int row2, unsigned int firstCol,
+	unsigned int lastCol)
+{
+	double* luData = lu_.getData();
+	size_t ld = lu_.getLeadingDimension();
+
+	for (unsigned int c = firstCol; c < lastCol; ++c)
+	{
+		double temp = luData[row1 + c * ld];
+		luData[row1 + c * ld] = luData[row2 + c * ld];
+		luData[row2 + c * ld] = temp;
+	}
+}
+
+/**
+ * @brief Overwrites @ref x, which holds B, with the solution of A * X = B
+ */
+bool MathLUDecomposition::solveInPlace(const MathMatrixView& x) const
+{
+	for (unsigned int j = 0; j < n_; ++j)
+	{
+		if (pivots_[j] != j)
+		{
+			x.swapRows(j, pivots_[j]);
+		}
+	}
+
+	const double* luData = lu_.getData();
+	size_t ld = lu_.getLeadingDimension();
+	unsigned int nrhs = x.getNumCols();
+
+	// L * Y = P * B, then U * X = Y
+	triangularSolve(LOWER_TRIANGLE, true, n_, nrhs, luData, 1, ld,
+		x.getData(), x.getRowStride(), x.getColStride());
+	triangularSolve(UPPER_TRIANGLE, false, n_, nrhs, luData, 1, ld,
+		x.getData(), x.getRowStride(), x.getColStride());
+	return true;
+}
+
+// =============================================================================================
+// Outside of class functions
+// =============================================================================================
+
+MathMatrix solve(const MathMatrix& a, const MathMatrix& b)
+{
+	return MathLUDecomposition(a.getView()).solve(b.getView());
+}
+
+MathVector solve(const MathMatrix& a, const MathVector& b)
+{
+	return MathLUDecomposition(a.getView()).solve(b);
+}
+
+double determinant(const MathMatrix& a)
+{
+	return MathLUDecomposition(a.getView()).determinant();
+}
+
+MathMatrix inverse(const MathMatrix& a)
+{
+	return MathLUDecomposition(a.getView()).inverse();
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#ifndef __MATH_LU_DECOMPOSITION_H
+#define __MATH_LU_DECOMPOSITION_H
+
+#include <vector>
+#include "MathMatrix.h"
+#include "MathMatrixView.h"
+#include "MathVector.h"
+
+/**
+ * @brief The LU factorization P * A = L * U of a square matrix A with partial pivoting, where
+ *     P is a permutation, L is lower triangular with ones on its diagonal and U is upper
+ *     triangular.  Once A is factored, systems A * X = B are solved for any number of
+ *     right-hand sides with two triangular solves.
+ * @note The factorization is blocked and right-looking.  A panel of columns is factored with
+ *     row swaps and vector kernels, the rows of U to its right are found with one triangular
+ *     solve and the rest of the matrix is updated with one call to @ref gemm, which is where
+ *     nearly all of the time goes for large matrices.
+ * @note A pivot that is exactly 0 makes the matrix singular.  The factorization still
+ *     finishes, @ref determinant is then 0 and the solves fail.  Matrices that are merely
+ *     close to singular are not detected.
+ */
+class MathLUDecomposition
+{
+public:
+
+	MathLUDecomposition() {}
+	explicit MathLUDecomposition(const MathMatrixView& a) { factor(a); }
+
+	// Factors a copy of @ref a.  Returns false if @ref a is not square or is empty.
+	bool factor(const MathMatrixView& a);
+
+	bool isFactored() const { return n_ != 0; }
+	bool isSingular() const { return singular_; }
+	unsigned int getSize() const { return n_; }
+
+	// L below the diagonal and U on and above it, stored as a COLUMNSPACE matrix
+	const MathMatrix& getLU() const { return lu_; }
+
+	// Row i of P * A is row getPivotedRow(i) of A
+	unsigned int getPivotedRow(unsigned int i) const;
+
+	MathMatrix solve(const MathMatrixView& b) const;
+	MathVector solve(const MathVector& b) const;
+
+	double determinant() const;
+	MathMatrix inverse() const;
+
+private:
+
+	void factorPanel(unsigned int k, unsigned int nb);
+	void swapRowsOf(unsigned int row1, unsigned int row2, unsigned int firstCol, unsigned int lastCol);
+	bool solveInPlace(const MathMatrixView& x) const;
+
+	MathMatrix lu_;
+
+	// Row i was swapped with row pivots_[i] when column i was factored
+	std::vector<unsigned int> pivots_;
+
+	unsigned int n_ = 0;
+	bool singular_ = false;
+};
+
+// Outside of class functions that factor @ref a and throw the factorization away.  On
+//     failure they return an empty matrix or vector and @ref determinant returns NAN.
+MathMatrix solve(const MathMatrix& a, const MathMatrix& b);
+MathVector solve(const MathMatrix& a, const MathVector& b);
+double determinant(const MathMatrix& a);
+MathMatrix inverse(const MathMatrix& a);
+
+#endif // __MATH_LU_DECOMPOSITION_H
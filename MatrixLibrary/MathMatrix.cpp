@@ -1,9 +1,46 @@
 #include "pch.h"
 #include "MathMatrix.h"
+#include "MathMatrixMultiply.h"
 #include <cmath>
 
-MathMatrix::MathMatrix() {};
-MathMatrix::MathMatrix(unsigned int numRows, unsigned int numCols)
+// Leading dimensions that are a multiple of this many cache lines (512 bytes) are padded
+static constexpr unsigned int ALIASING_LINES = 8;
+
+/**
+ * @brief Returns the leading dimension to store vectors of @ref size elements with.  It is
+ *     rounded up to whole cache lines so every vector of the space starts on a line, then
+ *     one more line is added if the distance between two vectors would be a multiple of 512
+ *     bytes.
+ * @note Walking across the vectors of the space (along a row of a column space matrix)
+ *     touches one element per vector.  With a distance of a multiple of 4 KB every one of
+ *     them maps to the same L1 set and only as many as the cache has ways stay cached, and
+ *     stores and loads that far apart falsely look dependent to the CPU.  A multiple of 512
+ *     bytes still only uses an eighth of the sets.  An odd number of lines uses all of them.
+ * @note Vectors shorter than a cache line are not padded so small matrices stay small.
+ */
+template <typename T>
+static unsigned int paddedLeadingDimension(unsigned int size)
+{
+	const unsigned int elementsPerLine = (unsigned int)(MATH_BUFFER_ALIGNMENT / sizeof(T));
+	if (size < elementsPerLine)
+	{
+		return size;
+	}
+
+	size_t lines = ((size_t)size + elementsPerLine - 1) / elementsPerLine;
+	if (lines % ALIASING_LINES == 0)
+	{
+		++lines;
+	}
+
+	size_t padded = lines * elementsPerLine;
+	return (padded > 0xFFFFFFFFu) ? size : (unsigned int)padded;
+}
+
+template <typename T>
+MathMatrixT<T>::MathMatrixT() {};
+template <typename T>
+MathMatrixT<T>::MathMatrixT(unsigned int numRows, unsigned int numCols)
 {
 	numRows_ = numRows;
 	numCols_ = numCols;
@@ -15,27 +52,13 @@ MathMatrix::MathMatrix(unsigned int numRows, unsigned int numCols)
 		//     allocating any memory
 		return;
 	}
-	
-	preAlloc_ = 0x01;
-
-	unsigned int tempNumCols = numCols;
-	while (tempNumCols > 0)
-	{
-		preAlloc_ <<= 1;
-		tempNumCols >>= 1;
-	}
 
-	// Now allocate all the memory
-	vectorSpace_ = new MathVector*[preAlloc_];
-
-
-	for (unsigned int i = 0; i < numCols; ++i)
-	{
-		vectorSpace_[i] = new MathVector(numRows);
-	}
+	// The matrix is a space of column vectors by default
+	allocateStorage(numCols_, numRows_);
 }
 
-MathMatrix::MathMatrix(const MathVector& v, vector_space_t spaceOfVector)
+template <typename T>
+MathMatrixT<T>::MathMatrixT(const MathVectorT<T>& v, vector_space_t spaceOfVector)
 {
 	unsigned int vSize = v.getOperationSize();
 
@@ -46,7 +69,7 @@ MathMatrix::MathMatrix(const MathVector& v, vector_space_t spaceOfVector)
 		numRows_ = numCols_ = 0;
 		return;
 	}
-	
+
 	numRows_ = 1;
 	numCols_ = vSize;
 
@@ -55,14 +78,14 @@ MathMatrix::MathMatrix(const MathVector& v, vector_space_t spaceOfVector)
 		numRows_ = vSize;
 		numCols_ = 1;
 	}
-	
-	// Make it two so we can add another vector easily
-	preAlloc_ = 2;
 
-	vectorSpace_ = new MathVector* [preAlloc_];
+	// The matrix is the one vector of its space
+	allocateStorage(1, vSize);
 
-	// We actually need to construct this and not just use the reference
-	vectorSpace_[0] = new MathVector(v);
+	for (unsigned int i = 0; i < vSize; ++i)
+	{
+		data_[i] = v[i];
+	}
 }
 
 /**
@@ -72,7 +95,8 @@ MathMatrix::MathMatrix(const MathVector& v, vector_space_t spaceOfVector)
  * @param colVector is the column vector to multiply with
  * @param rowVector is the row vector to multiply with
  */
-MathMatrix::MathMatrix(const MathVector& colVector, const MathVector& rowVector)
+template <typename T>
+MathMatrixT<T>::MathMatrixT(const MathVectorT<T>& colVector, const MathVectorT<T>& rowVector)
 {
 	numRows_ = colVector.getOperationSize();
 	numCols_ = rowVector.getOperationSize();
@@ -85,43 +109,58 @@ MathMatrix::MathMatrix(const MathVector& colVector, const MathVector& rowVector)
 
 	// @todo Add a part of this function where a user can choose the space
 	spaceToRepresentMatrixAs_ = COLUMNSPACE;
-	
-	preAlloc_ = pow2Above(numCols_);
 
-	// Allocate the matrix
-	vectorSpace_ = new MathVector * [preAlloc_];
-
-	for (unsigned int i = 0; i < numCols_; ++i)
-	{
-		vectorSpace_[i] = new MathVector(numRows_);
-	}
+	allocateStorage(numCols_, numRows_);
 
 	// Now actually plug in the values
 	for (unsigned int col = 0; col < numCols_; ++col)
 	{
+		T* column = data_ + (size_t)col * leadingDimension_;
 		for (unsigned int row = 0; row < numRows_; ++row)
 		{
-			(*vectorSpace_[col])[row] = colVector[row] * rowVector[col];
+			column[row] = colVector[row] * rowVector[col];
 		}
 	}
 }
 
-MathMatrix::MathMatrix(const MathMatrix& other)
+template <typename T>
+MathMatrixT<T>::MathMatrixT(const MathMatrixT& other)
 {
 	copy(other);
 }
-MathMatrix& MathMatrix::operator=(const MathMatrix& other)
+template <typename T>
+MathMatrixT<T>& MathMatrixT<T>::operator=(const MathMatrixT& other)
 {
-	cleanUpDynamicallyAllocatedMemory();
-	copy(other);
+	if (this != &other)
+	{
+		cleanUpDynamicallyAllocatedMemory();
+		copy(other);
+	}
+	return *this;
+}
+template <typename T>
+MathMatrixT<T>::MathMatrixT(MathMatrixT&& other) noexcept
+{
+	moveFrom(other);
+}
+template <typename T>
+MathMatrixT<T>& MathMatrixT<T>::operator=(MathMatrixT&& other) noexcept
+{
+	if (this != &other)
+	{
+		cleanUpDynamicallyAllocatedMemory();
+		moveFrom(other);
+	}
 	return *this;
 }
 
-MathMatrix::MathMatrix(const std::initializer_list < std::initializer_list<double>> list2d)
+template <typename T>
+MathMatrixT<T>::MathMatrixT(const std::initializer_list < std::initializer_list<T>> list2d)
 {
 	makeMatrixFromInitLists(list2d);
 }
-MathMatrix& MathMatrix::operator=(const std::initializer_list < std::initializer_list<double>> list2d)
+template <typename T>
+MathMatrixT<T>& MathMatrixT<T>::operator=(const std::initializer_list < std::initializer_list<T>> list2d)
 {
 	cleanUpDynamicallyAllocatedMemory();
 	makeMatrixFromInitLists(list2d);
@@ -134,24 +173,17 @@ MathMatrix& MathMatrix::operator=(const std::initializer_list < std::initializer
  * @param other A 2d initializer list representing the matrix to compare with
  * @return true if the rows of the matrix are equal to the initalizer list
  */
-bool MathMatrix::equals(const std::initializer_list<std::initializer_list<double>>& other) const
+template <typename T>
+bool MathMatrixT<T>::equals(const std::initializer_list<std::initializer_list<T>>& other) const
 {
 	if (getNumRowsInOperationSize() != other.size()) return false;
 
 	unsigned int r = 0;
 	unsigned int c = 0;
 
-	unsigned int* firstAccess = &r;
-	unsigned int* secondAccess = &c;
-	if (spaceToRepresentMatrixAs_ == COLUMNSPACE)
-	{
-		firstAccess = &c;
-		secondAccess = &r;
-	}
-
 	unsigned int numColsInOp = getNumColsInOperationSize();
 
-	for (std::initializer_list<std::initializer_list<double>>::const_iterator rowItr = other.begin();
+	for (typename std::initializer_list<std::initializer_list<T>>::const_iterator rowItr = other.begin();
 		rowItr != other.end(); ++rowItr)
 	{
 		if (rowItr->size() != numColsInOp)
@@ -160,10 +192,10 @@ bool MathMatrix::equals(const std::initializer_list<std::initializer_list<double
 		}
 
 		c = 0;
-		std::initializer_list<double>::const_iterator colItrEnd = rowItr->end();
-		for (std::initializer_list<double>::const_iterator indItr = rowItr->begin(); indItr != colItrEnd; ++indItr)
+		typename std::initializer_list<T>::const_iterator colItrEnd = rowItr->end();
+		for (typename std::initializer_list<T>::const_iterator indItr = rowItr->begin(); indItr != colItrEnd; ++indItr)
 		{
-			if (*indItr != (*vectorSpace_[*firstAccess])[*secondAccess])
+			if (*indItr != elementAt(r, c))
 			{
 				return false;
 			}
@@ -176,40 +208,25 @@ bool MathMatrix::equals(const std::initializer_list<std::initializer_list<double
 
 // Programming related helper functions
 
-double MathMatrix::getVal(unsigned int row, unsigned int col) const
+template <typename T>
+T MathMatrixT<T>::getVal(unsigned int row, unsigned int col) const
 {
 	if (row >= numRows_ || col >= numCols_) { return NAN;}
 
-	unsigned int firstAccess = row;
-	unsigned int secondAccess = col;
-
-	if (spaceToRepresentMatrixAs_ == COLUMNSPACE)
-	{
-		firstAccess = col;
-		secondAccess = row;
-	}
-
-	return (*vectorSpace_[firstAccess])[secondAccess];
+	return elementAt(row, col);
 }
-bool MathMatrix::setVal(unsigned int row, unsigned int col, double valueToSetTo) const
+template <typename T>
+bool MathMatrixT<T>::setVal(unsigned int row, unsigned int col, T valueToSetTo) const
 {
 	if (row >= numRows_ || col >= numCols_) { return false; }
 
-	unsigned int firstAccess = row;
-	unsigned int secondAccess = col;
-
-	if (spaceToRepresentMatrixAs_ == COLUMNSPACE)
-	{
-		firstAccess = col;
-		secondAccess = row;
-	}
-
-	(*vectorSpace_[firstAccess])[secondAccess] = valueToSetTo;
+	elementAt(row, col) = valueToSetTo;
 
 	return true;
 }
 
-unsigned int MathMatrix::getNumRowsInOperationSize() const
+template <typename T>
+unsigned int MathMatrixT<T>::getNumRowsInOperationSize() const
 {
 	if (useNonDefaultNumberOfRows_ == true)
 	{
@@ -221,7 +238,8 @@ unsigned int MathMatrix::getNumRowsInOperationSize() const
 	}
 }
 
-unsigned int MathMatrix::getNumColsInOperationSize() const
+template <typename T>
+unsigned int MathMatrixT<T>::getNumColsInOperationSize() const
 {
 	if (useNonDefaultNumberOfCols_ == true)
 	{
@@ -233,222 +251,160 @@ unsigned int MathMatrix::getNumColsInOperationSize() const
 	}
 }
 
-bool MathMatrix::addRow(const MathVector& rowToAdd)
+// Whether there is at least one vector and all of them have the operation size @ref size,
+//     or the same operation size as each other when @ref size is 0
+template <typename T>
+static bool allHaveOperationSize(const std::vector<MathVectorT<T>>& vectors, unsigned int size)
 {
-	bool vectorSuccessfullyAdded = false;
-
-	if (spaceToRepresentMatrixAs_ == ROWSPACE)
+	if (vectors.empty())
 	{
-		vectorSuccessfullyAdded = addMathVectorToSameSpace(rowToAdd, numRows_, numCols_);
+		return false;
 	}
-	else if (spaceToRepresentMatrixAs_ == COLUMNSPACE)
+	if (size == 0)
 	{
-		vectorSuccessfullyAdded = addMathVectorToEndsOfEachVector(rowToAdd, numCols_, numRows_);
+		size = vectors[0].getOperationSize();
 	}
-	else
+	for (const MathVectorT<T>& v : vectors)
 	{
-		// AN UNKNOWN SPACE TYPE IS USED: Return false
-		return vectorSuccessfullyAdded = false;
+		if (v.getOperationSize() != size)
+		{
+			return false;
+		}
 	}
-	return vectorSuccessfullyAdded;
+	return true;
 }
 
-bool MathMatrix::addCol(const MathVector& colToAdd)
+template <typename T>
+bool MathMatrixT<T>::addRow(const MathVectorT<T>& rowToAdd)
 {
-	bool vectorSuccessfullyAdded = false;
-
-	if (spaceToRepresentMatrixAs_ == ROWSPACE)
-	{
-		vectorSuccessfullyAdded = addMathVectorToSameSpace(colToAdd, numRows_, numCols_);
-	}
-	else if (spaceToRepresentMatrixAs_ == COLUMNSPACE)
-	{
-		vectorSuccessfullyAdded = addMathVectorToEndsOfEachVector(colToAdd, numCols_, numRows_);
-	}
-	else
-	{
-		// AN UNKNOWN SPACE TYPE IS USED: Return false
-		return vectorSuccessfullyAdded = false;
-	}
-	return vectorSuccessfullyAdded;
+	return appendVectors(true, 1, rowToAdd.getOperationSize(),
+		[&](unsigned int, unsigned int j) { return rowToAdd[j]; });
 }
 
-//======================================================================
-// Math related operations
-//======================================================================
+template <typename T>
+bool MathMatrixT<T>::addCol(const MathVectorT<T>& colToAdd)
+{
+	return appendVectors(false, 1, colToAdd.getOperationSize(),
+		[&](unsigned int, unsigned int j) { return colToAdd[j]; });
+}
 
-bool MathMatrix::swapRows(unsigned int rowNum1, unsigned int rowNum2)
+/**
+ * @brief Appends every row of @ref block to the bottom of the matrix, growing the buffer at
+ *     most once.  An empty matrix becomes a copy of the block.
+ * @return false and changes nothing if the block is empty or its number of columns is not
+ *     the number of columns of the matrix
+ * @note The block may be a view of this matrix.
+ */
+template <typename T>
+bool MathMatrixT<T>::appendRows(const MathMatrixViewT<T>& block)
 {
-	// Check the bounds first
-	unsigned int rowNumUpperBound = getNumRowsInOperationSize();
-	if ((rowNum1 < 0) || (rowNum2) < 0 || (rowNum1 >= rowNumUpperBound) || 
-		(rowNum2 >= rowNumUpperBound))
+	if (viewsStorage(block))
 	{
-		return false;
+		// Growing would free what the block looks at so append a copy instead
+		MathMatrixT copyOfBlock(block);
+		return appendRows(copyOfBlock.getView());
 	}
 
-	// If we are at this point then we know we are in bounds
-
-	unsigned int col = 0;
-
-	unsigned int* first_access_for_row1 = &rowNum1;
-	unsigned int* second_access_for_row1 = &col;
-
-	unsigned int* first_access_for_row2 = &rowNum1;
-	unsigned int* second_access_for_row2 = &col;
-
-	unsigned int* tempPtr;
-	if (spaceToRepresentMatrixAs_ == COLUMNSPACE)
-	{
-		// Swap the accesses for the first row
-		tempPtr = first_access_for_row1;
-		first_access_for_row1 = second_access_for_row1;
-		second_access_for_row2 = tempPtr;
-
-		// Swap the accesses for the second row
-		tempPtr = first_access_for_row1;
-		first_access_for_row1 = second_access_for_row1;
-		second_access_for_row2 = tempPtr;
-	}
+	const T* data = block.getData();
+	size_t rowStride = block.getRowStride();
+	size_t colStride = block.getColStride();
+	return appendVectors(true, block.getNumRows(), block.getNumCols(),
+		[=](unsigned int i, unsigned int j) { return data[i * rowStride + j * colStride]; });
+}
 
-	// Now swap each of the elements
-	unsigned int numCols = getNumColsInOperationSize();
-	double temp;
-	for (unsigned int c = 0; c < numCols; ++c)
+// Appends every column of @ref block to the right of the matrix like @ref appendRows
+template <typename T>
+bool MathMatrixT<T>::appendCols(const MathMatrixViewT<T>& block)
+{
+	if (viewsStorage(block))
 	{
-		temp = (*vectorSpace_[*first_access_for_row1])[*second_access_for_row1];
-		
-		vectorSpace_[*first_access_for_row1][*second_access_for_row1] = 
-			vectorSpace_[*first_access_for_row2][*second_access_for_row2];
-		
-		(*vectorSpace_[*first_access_for_row2])[*second_access_for_row2] = temp;
+		MathMatrixT copyOfBlock(block);
+		return appendCols(copyOfBlock.getView());
 	}
 
-	// Finally we can return true since the swaps have all been successful
-	return true;
+	const T* data = block.getData();
+	size_t rowStride = block.getRowStride();
+	size_t colStride = block.getColStride();
+	return appendVectors(false, block.getNumCols(), block.getNumRows(),
+		[=](unsigned int i, unsigned int j) { return data[j * rowStride + i * colStride]; });
 }
-bool MathMatrix::swapCols(unsigned int colNum1, unsigned int colNum2)
+
+/**
+ * @brief Appends the operation size of every vector of @ref rows as a row, growing the
+ *     buffer at most once.
+ * @return false and changes nothing if there are no rows or they do not all have the
+ *     number of columns of the matrix
+ */
+template <typename T>
+bool MathMatrixT<T>::appendRows(const std::vector<MathVectorT<T>>& rows)
 {
-	// Check the bounds first
-	unsigned int colNumUpperBound = getNumColsInOperationSize();
-	if ((colNum1 < 0) || (colNum2) < 0 || (colNum1 >= colNumUpperBound) ||
-		(colNum2 >= colNumUpperBound))
+	if (!allHaveOperationSize(rows, (numRows_ == 0 && numCols_ == 0) ? 0 : numCols_))
 	{
 		return false;
 	}
-
-	// If we are at this point then we know we are in bounds
-
-	unsigned int col = 0;
-
-	unsigned int* first_access_for_col1 = &colNum1;
-	unsigned int* second_access_for_col1 = &col;
-
-	unsigned int* first_access_for_col2 = &colNum2;
-	unsigned int* second_access_for_col2 = &col;
-
-	unsigned int* tempPtr;
-	if (spaceToRepresentMatrixAs_ == ROWSPACE)
-	{
-		// Swap the accesses for the first row
-		tempPtr = first_access_for_col1;
-		first_access_for_col1 = second_access_for_col1;
-		second_access_for_col2 = tempPtr;
-
-		// Swap the accesses for the second row
-		tempPtr = first_access_for_col1;
-		first_access_for_col1 = second_access_for_col1;
-		second_access_for_col2 = tempPtr;
-	}
-
-	// Now swap each of the elements
-	unsigned int numRows = getNumRowsInOperationSize();
-	double temp;
-	for (unsigned int c = 0; c < numRows; ++c)
-	{
-		temp = (*vectorSpace_[*first_access_for_col1])[*second_access_for_col1];
-
-		vectorSpace_[*first_access_for_col1][*second_access_for_col1] =
-			vectorSpace_[*first_access_for_col2][*second_access_for_col2];
-
-		(*vectorSpace_[*first_access_for_col2])[*second_access_for_col2] = temp;
-	}
-
-	// Finally we can return true since the swaps have all been successful
-	return true;
+	return appendVectors(true, (unsigned int)rows.size(), rows[0].getOperationSize(),
+		[&](unsigned int i, unsigned int j) { return rows[i][j]; });
 }
 
-bool MathMatrix::addMultipleOfRow(unsigned int rowNumToAddTo, unsigned int rowNumToAdd,
-	double multiple)
+template <typename T>
+bool MathMatrixT<T>::appendCols(const std::vector<MathVectorT<T>>& cols)
 {
-	// Check the bounds first
-	if (!isRowNumInOperationBounds(rowNumToAddTo) ||
-		!isRowNumInOperationBounds(rowNumToAdd))
+	if (!allHaveOperationSize(cols, (numRows_ == 0 && numCols_ == 0) ? 0 : numRows_))
 	{
 		return false;
 	}
-
-	// If we are here then we can add each row to each other
-	unsigned int col = 0;
-
-	unsigned int* first_access_for_row1 = &rowNumToAddTo;
-	unsigned int* second_access_for_row1 = &col;
-
-	unsigned int* first_access_for_row2 = &rowNumToAdd;
-	unsigned int* second_access_for_row2 = &col;
-
-	unsigned int* tempPtr;
-	if (spaceToRepresentMatrixAs_ == COLUMNSPACE)
-	{
-		// Swap the accesses for the first row
-		tempPtr = first_access_for_row1;
-		first_access_for_row1 = second_access_for_row1;
-		second_access_for_row2 = tempPtr;
-
-		// Swap the accesses for the second row
-		tempPtr = first_access_for_row1;
-		first_access_for_row1 = second_access_for_row1;
-		second_access_for_row2 = tempPtr;
-	}
-
-	// Now add the multiple of the row
-	unsigned int numCols = getNumColsInOperationSize();
-	
-	for (unsigned int i = 0; i < numCols; ++i)
-	{
-		(*vectorSpace_[*first_access_for_row1])[*second_access_for_row1] =
-			multiple * (*vectorSpace_[*first_access_for_row2])[*second_access_for_row2];
-	}
-
-	return true;
+	return appendVectors(false, (unsigned int)cols.size(), cols[0].getOperationSize(),
+		[&](unsigned int i, unsigned int j) { return cols[i][j]; });
 }
 
-bool MathMatrix::multiplyRowByConstant(unsigned int row, double constant)
+/**
+ * @brief Makes room for a @ref numRows x @ref numCols matrix so rows and columns can be
+ *     appended up to that size without moving the buffer.  Never shrinks the buffer.
+ * @note Reserving room in an empty matrix keeps the space it is stored in, so a
+ *     @ref COLUMNSPACE matrix that rows are appended to stays one.
+ */
+template <typename T>
+void MathMatrixT<T>::reserve(unsigned int numRows, unsigned int numCols)
 {
-	if (!isRowNumInOperationBounds(row))
+	unsigned int numVectorsInSpace = (spaceToRepresentMatrixAs_ == ROWSPACE) ? numRows : numCols;
+	unsigned int sizeOfVectorsInSpace = (spaceToRepresentMatrixAs_ == ROWSPACE) ? numCols : numRows;
+
+	if (numVectorsInSpace <= preAlloc_ && sizeOfVectorsInSpace <= leadingDimension_)
 	{
-		return false;
+		return;
 	}
+	reallocateStorage((numVectorsInSpace > preAlloc_) ? numVectorsInSpace : preAlloc_,
+		(sizeOfVectorsInSpace > leadingDimension_) ? sizeOfVectorsInSpace : leadingDimension_);
+}
 
-	unsigned int col = 0;
-	
-	unsigned int* first_access = &row;
-	unsigned int* second_access = &col;
+//======================================================================
+// Math related operations
+//======================================================================
 
-	if (spaceToRepresentMatrixAs_ == COLUMNSPACE)
-	{
-		first_access = &col;
-		second_access = &row;
-	}
+// The row operations act on the operation size of the matrix, which is exactly its view
 
-	unsigned int numCols = getNumColsInOperationSize();
+template <typename T>
+bool MathMatrixT<T>::swapRows(unsigned int rowNum1, unsigned int rowNum2)
+{
+	return getView().swapRows(rowNum1, rowNum2);
+}
+template <typename T>
+bool MathMatrixT<T>::swapCols(unsigned int colNum1, unsigned int colNum2)
+{
+	return getView().swapCols(colNum1, colNum2);
+}
 
-	for (unsigned int i = 0; i < numCols; ++i)
-	{
-		vectorSpace_[*first_access][*second_access] *= constant;
-	}
+template <typename T>
+bool MathMatrixT<T>::addMultipleOfRow(unsigned int rowNumToAddTo, unsigned int rowNumToAdd,
+	T multiple)
+{
+	return getView().addMultipleOfRow(rowNumToAddTo, rowNumToAdd, multiple);
+}
 
-	return true;
+template <typename T>
+bool MathMatrixT<T>::multiplyRowByConstant(unsigned int row, T constant)
+{
+	return getView().multiplyRowByConstant(row, constant);
 }
 
 /**
@@ -459,7 +415,8 @@ bool MathMatrix::multiplyRowByConstant(unsigned int row, double constant)
  *     @ref numRowsSeenInOperations_ and @ref numColsSeenInOperations_ when
  *     transposing.
  */
-void MathMatrix::transpose()
+template <typename T>
+void MathMatrixT<T>::transpose()
 {
 	unsigned int unsgined_temp;
 
@@ -475,12 +432,13 @@ void MathMatrix::transpose()
 	useNonDefaultNumberOfRows_ = useNonDefaultNumberOfCols_;
 	useNonDefaultNumberOfCols_ = booltemp;
 
-	// Now swap how the matrix is represented
+	// Now swap how the matrix is represented.  The buffer stays the same, the rows
+	//     of the old matrix are just read as columns.
 	if (spaceToRepresentMatrixAs_ == ROWSPACE)
 	{
 		spaceToRepresentMatrixAs_ = COLUMNSPACE;
 	}
-	else if (spaceToRepresentMatrixAs_ = COLUMNSPACE)
+	else if (spaceToRepresentMatrixAs_ == COLUMNSPACE)
 	{
 		spaceToRepresentMatrixAs_ = ROWSPACE;
 	}
@@ -490,51 +448,78 @@ void MathMatrix::transpose()
 	}
 }
 
-MathMatrixIterator MathMatrix::rowBegin(unsigned int const row) const
+/**
+ * @brief Stores the matrix in @ref space, moving every element to a new buffer if it is
+ *     stored the other way.  The matrix itself does not change, only which of its
+ *     directions is contiguous in memory.
+ * @note The elements are moved with the cache oblivious copy of @ref copyElements.  Calling
+ *     @ref transpose and then storing the matrix in the space it had before is a physical
+ *     transpose.
+ */
+template <typename T>
+void MathMatrixT<T>::setSpaceToRepresentMatrixAs(vector_space_t space)
 {
-	if (spaceToRepresentMatrixAs_ == ROWSPACE)
+	if (space == spaceToRepresentMatrixAs_)
 	{
-		return MathMatrixIterator(vectorSpace_ + row, 0, spaceToRepresentMatrixAs_, ROWSPACE);
+		return;
 	}
-	else
+	if (numRows_ == 0 || numCols_ == 0)
 	{
-		return MathMatrixIterator(vectorSpace_ + 0, row , spaceToRepresentMatrixAs_, ROWSPACE);
+		cleanUpDynamicallyAllocatedMemory();
+		spaceToRepresentMatrixAs_ = space;
+		return;
 	}
+
+	unsigned int numVectorsInSpace = (space == ROWSPACE) ? numRows_ : numCols_;
+	unsigned int leadingDimension = paddedLeadingDimension<T>((space == ROWSPACE) ? numCols_ : numRows_);
+
+	MathArena* newArena;
+	T* newData = allocateElements<T>((size_t)numVectorsInSpace * leadingDimension, newArena);
+
+	MathMatrixViewT<T> from(data_, numRows_, numCols_, getRowStride(), getColStride());
+	MathMatrixViewT<T> to(newData, numRows_, numCols_, (space == ROWSPACE) ? leadingDimension : 1,
+		(space == ROWSPACE) ? 1 : leadingDimension);
+	copyElements(from, to);
+
+	freeElements(data_, arena_);
+	data_ = newData;
+	arena_ = newArena;
+	preAlloc_ = numVectorsInSpace;
+	leadingDimension_ = leadingDimension;
+	spaceToRepresentMatrixAs_ = space;
 }
-MathMatrixIterator MathMatrix::rowEnd(unsigned int const row) const
+
+template <typename T>
+MathMatrixIteratorT<T> MathMatrixT<T>::rowBegin(unsigned int const row) const
 {
-	unsigned int endCol = getNumColsInOperationSize();
-	if (spaceToRepresentMatrixAs_ == ROWSPACE)
-	{
-		return MathMatrixIterator(vectorSpace_ + row, endCol, spaceToRepresentMatrixAs_, ROWSPACE);
-	}
-	else
-	{
-		return MathMatrixIterator(vectorSpace_ + endCol, row, spaceToRepresentMatrixAs_, ROWSPACE);
-	}
+	return getView().rowBegin(row);
 }
-MathMatrixIterator MathMatrix::colBegin(unsigned int const col) const
+template <typename T>
+MathMatrixIteratorT<T> MathMatrixT<T>::rowEnd(unsigned int const row) const
 {
-	if (spaceToRepresentMatrixAs_ == ROWSPACE)
-	{
-		return MathMatrixIterator(vectorSpace_ + 0, col, spaceToRepresentMatrixAs_, COLUMNSPACE);
-	}
-	else
-	{
-		return MathMatrixIterator(vectorSpace_ + col, 0, spaceToRepresentMatrixAs_, COLUMNSPACE);
-	}
+	return getView().rowEnd(row);
 }
-MathMatrixIterator MathMatrix::colEnd(unsigned int const col) const
+template <typename T>
+MathMatrixIteratorT<T> MathMatrixT<T>::colBegin(unsigned int const col) const
 {
-	unsigned int endRow = getNumColsInOperationSize();
-	if (spaceToRepresentMatrixAs_ == ROWSPACE)
-	{
-		return MathMatrixIterator(vectorSpace_ + endRow, col, spaceToRepresentMatrixAs_, COLUMNSPACE);
-	}
-	else
-	{
-		return MathMatrixIterator(vectorSpace_ + col, endRow, spaceToRepresentMatrixAs_, COLUMNSPACE);
-	}
+	return getView().colBegin(col);
+}
+template <typename T>
+MathMatrixIteratorT<T> MathMatrixT<T>::colEnd(unsigned int const col) const
+{
+	return getView().colEnd(col);
+}
+
+/**
+ * @brief Views the numRows x numCols block of the matrix whose top left element is
+ *     (rowOffset, colOffset).
+ * @return An empty view if the block does not fit inside the operation size of the matrix
+ */
+template <typename T>
+MathMatrixViewT<T> MathMatrixT<T>::getView(unsigned int rowOffset, unsigned int colOffset,
+	unsigned int numRows, unsigned int numCols) const
+{
+	return getView().getSubView(rowOffset, colOffset, numRows, numCols);
 }
 
 
@@ -544,165 +529,353 @@ MathMatrixIterator MathMatrix::colEnd(unsigned int const col) const
 
 MathMatrix operator*(const MathMatrix& m1, const MathMatrix& m2)
 {
-	// Make a new matrix with the correct size
+	// The product of the operation sizes of both matrices
+	return m1.getView() * m2.getView();
+}
+
+MathMatrixF operator*(const MathMatrixF& m1, const MathMatrixF& m2)
+{
+	return m1.getView() * m2.getView();
+}
 
-	// However if the m1 is m x n the matrix m2 must have dimension n x p to be
-	//     a legal matrix multiplication
-	if (m1.getNumColsInOperationSize() != m2.getNumRowsInOperationSize())
+template <typename T>
+static bool multiplyVector(MathMatrixViewT<T> a, const MathVectorT<T>& x, MathVectorT<T>& y,
+	T alpha, T beta, bool transposeA)
+{
+	if (transposeA)
 	{
-		return MathMatrix();
+		a.transpose();
 	}
-	else
+	if (x.getOperationSize() != a.getNumCols() || &x == &y)
 	{
-		unsigned int numRowsInNewMatrix = m1.getNumRowsInOperationSize();
-		unsigned int numColsInNewMatrix = m2.getNumColsInOperationSize();
-		MathMatrix result(numRowsInNewMatrix, numColsInNewMatrix);
-
-		// The result of the dot product
-		double dotProdRes;
-		for (unsigned int i = 0; i < numRowsInNewMatrix; ++i)
+		return false;
+	}
+	if (y.getOperationSize() != a.getNumRows())
+	{
+		if (beta != 0)
 		{
-			for (unsigned int j = 0; j < numColsInNewMatrix; ++j)
-			{
-				// M_i,j = row i of m1 * col j of m2
-				dotProdRes = dotProduct(m1.rowBegin(i), m1.rowEnd(i), m2.colBegin(j), m2.colEnd(j));
-				result.setVal(i, j, dotProdRes);
-			}
+			return false;
 		}
-		return result;
+		y = MathVectorT<T>(a.getNumRows());
 	}
+
+	gemv(a.getNumRows(), a.getNumCols(), alpha, a.getData(), a.getRowStride(), a.getColStride(),
+		x.getData(), 1, beta, y.getData(), 1);
+	return true;
+}
+
+bool multiply(const MathMatrixView& a, const MathVector& x, MathVector& y,
+	double alpha, double beta, bool transposeA)
+{
+	return multiplyVector(a, x, y, alpha, beta, transposeA);
+}
+bool multiply(const MathMatrixViewF& a, const MathVectorF& x, MathVectorF& y,
+	float alpha, float beta, bool transposeA)
+{
+	return multiplyVector(a, x, y, alpha, beta, transposeA);
+}
+
+MathVector operator*(const MathMatrix& a, const MathVector& x)
+{
+	MathVector y;
+	multiply(a.getView(), x, y);
+	return y;
+}
+MathVectorF operator*(const MathMatrixF& a, const MathVectorF& x)
+{
+	MathVectorF y;
+	multiply(a.getView(), x, y);
+	return y;
+}
+
+MathVector transposeMultiply(const MathMatrix& a, const MathVector& x)
+{
+	MathVector y;
+	multiply(a.getView(), x, y, 1.0, 0.0, true);
+	return y;
+}
+MathVectorF transposeMultiply(const MathMatrixF& a, const MathVectorF& x)
+{
+	MathVectorF y;
+	multiply(a.getView(), x, y, 1.0f, 0.0f, true);
+	return y;
 }
 
 
 // Private helper functions for the class
 
-void MathMatrix::cleanUpDynamicallyAllocatedMemory()
+/**
+ * @brief Allocates a buffer for the matrix that fits @ref numVectorsInSpace vectors of size
+ *     @ref sizeOfVectorsInSpace, each starting on a cache line when they are at least one
+ *     line long, and sets every element to 0.
+ */
+template <typename T>
+void MathMatrixT<T>::allocateStorage(unsigned int numVectorsInSpace, unsigned int sizeOfVectorsInSpace)
 {
-	unsigned int numToDelete = numCols_;
-	if (spaceToRepresentMatrixAs_ == ROWSPACE)
+	preAlloc_ = numVectorsInSpace;
+	leadingDimension_ = paddedLeadingDimension<T>(sizeOfVectorsInSpace);
+
+	size_t numElements = (size_t)preAlloc_ * leadingDimension_;
+	data_ = allocateElements<T>(numElements, arena_);
+
+	for (size_t i = 0; i < numElements; ++i)
+	{
+		data_[i] = 0;
+	}
+}
+
+/**
+ * @brief Moves the matrix into a bigger buffer that has room for @ref newPreAlloc
+ *     vectors of @ref newLeadingDimension elements each.
+ * @return false if the new buffer is not big enough to hold the current matrix
+ */
+template <typename T>
+bool MathMatrixT<T>::reallocateStorage(unsigned int newPreAlloc, unsigned int newLeadingDimension)
+{
+	unsigned int numVectorsInSpace = (spaceToRepresentMatrixAs_ == ROWSPACE) ? numRows_ : numCols_;
+	unsigned int sizeOfVectorsInSpace = (spaceToRepresentMatrixAs_ == ROWSPACE) ? numCols_ : numRows_;
+
+	if (newPreAlloc < numVectorsInSpace || newLeadingDimension < sizeOfVectorsInSpace)
 	{
-		numToDelete = numRows_;
+		return false;
 	}
+	newLeadingDimension = paddedLeadingDimension<T>(newLeadingDimension);
+
+	MathArena* newArena;
+	T* newData = allocateElements<T>((size_t)newPreAlloc * newLeadingDimension, newArena);
 
-	for (unsigned int i = 0; i < numToDelete; ++i)
+	for (unsigned int v = 0; v < numVectorsInSpace; ++v)
 	{
-		delete vectorSpace_[i];
+		T* to = newData + (size_t)v * newLeadingDimension;
+		const T* from = data_ + (size_t)v * leadingDimension_;
+		for (unsigned int i = 0; i < sizeOfVectorsInSpace; ++i)
+		{
+			to[i] = from[i];
+		}
 	}
-	delete vectorSpace_;
+
+	freeElements(data_, arena_);
+	data_ = newData;
+	arena_ = newArena;
+	preAlloc_ = newPreAlloc;
+	leadingDimension_ = newLeadingDimension;
+
+	return true;
 }
 
-void MathMatrix::copy(const MathMatrix& other)
+template <typename T>
+void MathMatrixT<T>::cleanUpDynamicallyAllocatedMemory()
+{
+	freeElements(data_, arena_);
+	data_ = nullptr;
+	arena_ = nullptr;
+	preAlloc_ = 0;
+	leadingDimension_ = 0;
+}
+
+/**
+ * @brief Takes the buffer of @ref other without copying any elements and leaves
+ *     @ref other as an empty 0 x 0 matrix.
+ */
+template <typename T>
+void MathMatrixT<T>::moveFrom(MathMatrixT& other) noexcept
 {
 	this->spaceToRepresentMatrixAs_ = other.spaceToRepresentMatrixAs_;
 	this->numRows_ = other.numRows_;
 	this->numCols_ = other.numCols_;
 
+	this->numRowsSeenInOperations_ = other.numRowsSeenInOperations_;
+	this->numColsSeenInOperations_ = other.numColsSeenInOperations_;
+	this->useNonDefaultNumberOfRows_ = other.useNonDefaultNumberOfRows_;
+	this->useNonDefaultNumberOfCols_ = other.useNonDefaultNumberOfCols_;
+
+	this->data_ = other.data_;
+	this->arena_ = other.arena_;
+	this->leadingDimension_ = other.leadingDimension_;
 	this->preAlloc_ = other.preAlloc_;
 
+	other.data_ = nullptr;
+	other.arena_ = nullptr;
+	other.leadingDimension_ = 0;
+	other.preAlloc_ = 0;
+	other.numRows_ = other.numCols_ = 0;
+	other.numRowsSeenInOperations_ = other.numColsSeenInOperations_ = 0;
+	other.useNonDefaultNumberOfRows_ = other.useNonDefaultNumberOfCols_ = false;
+}
+
+template <typename T>
+void MathMatrixT<T>::copy(const MathMatrixT& other)
+{
+	this->spaceToRepresentMatrixAs_ = other.spaceToRepresentMatrixAs_;
+	this->numRows_ = other.numRows_;
+	this->numCols_ = other.numCols_;
+
 	this->numRowsSeenInOperations_ = other.numRowsSeenInOperations_;
 	this->numColsSeenInOperations_ = other.numColsSeenInOperations_;
 	this->useNonDefaultNumberOfRows_ = other.useNonDefaultNumberOfRows_;
 	this->useNonDefaultNumberOfCols_ = other.useNonDefaultNumberOfCols_;
 
-	// Now copy the dynamically allocated memory portion
-	vectorSpace_ = new MathVector * [preAlloc_];
-
+	// Now copy the dynamically allocated memory portion.  Only the elements
+	//     actually in the matrix are copied, not the spare room of other.
 	unsigned int numVectorsToCopy = numCols_;
+	unsigned int sizeOfVectorsToCopy = numRows_;
 	if (spaceToRepresentMatrixAs_ == ROWSPACE)
 	{
 		numVectorsToCopy = numRows_;
+		sizeOfVectorsToCopy = numCols_;
 	}
 
-	for (unsigned int i = 0; i < numVectorsToCopy; ++i)
+	if (numVectorsToCopy == 0 || sizeOfVectorsToCopy == 0)
 	{
-		vectorSpace_[i] = new MathVector(*other.vectorSpace_[i]);
+		data_ = nullptr;
+		preAlloc_ = leadingDimension_ = 0;
+		return;
 	}
-	// Set the others to nullptrs
-	for (unsigned int i = numVectorsToCopy; i < preAlloc_; ++i)
+
+	preAlloc_ = numVectorsToCopy;
+	leadingDimension_ = paddedLeadingDimension<T>(sizeOfVectorsToCopy);
+	data_ = allocateElements<T>((size_t)preAlloc_ * leadingDimension_, arena_);
+
+	for (unsigned int v = 0; v < numVectorsToCopy; ++v)
 	{
-		vectorSpace_[i] = nullptr;
+		T* to = data_ + (size_t)v * leadingDimension_;
+		const T* from = other.data_ + (size_t)v * other.leadingDimension_;
+		for (unsigned int i = 0; i < sizeOfVectorsToCopy; ++i)
+		{
+			to[i] = from[i];
+		}
 	}
 }
 
-bool MathMatrix::isRowNumInOperationBounds(unsigned int rowNum)
-{
-	return (rowNum > 0) && (rowNum < getNumRowsInOperationSize());
-}
-bool MathMatrix::isColNumInOperationBounds(unsigned int colNum)
+
+// Returns the capacity to grow to so that @ref needed fits, at least double @ref current
+static unsigned int grownCapacity(unsigned int current, unsigned int needed)
 {
-	return (colNum > 0) && (colNum < getNumColsInOperationSize());
+	if (needed <= current)
+	{
+		return current;
+	}
+	size_t doubled = (current == 0) ? 2 : (size_t)current * 2;
+	if (doubled > 0xFFFFFFFFu)
+	{
+		doubled = 0xFFFFFFFFu;
+	}
+	return (needed > doubled) ? needed : (unsigned int)doubled;
 }
 
 /**
- * @brief Adds each element in v to the end of each vector made up in the space of the matrix
- * @param v is the vector to add.
- * @param innerSpaceSize[in, out] is a reference to the size of 
- * @note This private member function provides no bounds check as it does not care about whether or not
- *     the matrix is represented as a row space or a column space
+ * @brief Moves the matrix into a bigger buffer if it has no room for @ref numRows rows and
+ *     @ref numCols columns.  The capacity at least doubles in whichever direction has to
+ *     grow so appending one vector at a time costs amortized O(1) per element.
  */
-bool MathMatrix::addMathVectorToEndsOfEachVector(const MathVector& v, unsigned int const vectorSpaceSize,
-	unsigned int & numElementsInVectorOfSpace)
+template <typename T>
+bool MathMatrixT<T>::growToFit(unsigned int numRows, unsigned int numCols)
 {
-	unsigned int sizeOfOtherMathVector = v.getOperationSize();
-	
-	// We are trying to add a row/column that is an invalid size
-	if (sizeOfOtherMathVector != vectorSpaceSize)
-	{
-		return false;
-	}
+	unsigned int numVectorsInSpace = (spaceToRepresentMatrixAs_ == ROWSPACE) ? numRows : numCols;
+	unsigned int sizeOfVectorsInSpace = (spaceToRepresentMatrixAs_ == ROWSPACE) ? numCols : numRows;
 
-	for (unsigned int i = 0; i < sizeOfOtherMathVector; ++i)
+	if (numVectorsInSpace <= preAlloc_ && sizeOfVectorsInSpace <= leadingDimension_)
 	{
-		vectorSpace_[i]->push_back(v[i]);
+		return true;
 	}
-	++numElementsInVectorOfSpace;
-	return true;
+	return reallocateStorage(grownCapacity(preAlloc_, numVectorsInSpace),
+		grownCapacity(leadingDimension_, sizeOfVectorsInSpace));
 }
 
 /**
- * @brief Adds a @ref MathVector to the space of the matrix.  This function
- *     DOES NOT UPDATE @ref numRows or @ref numCols
- * @param v is the vector to add to the main space
- * @param mainSpaceSize[in, out] is the size of the main space to which the vector is added.  This variable
- *     will be updated if the size of that space changes
+ * @brief Appends @ref count rows (@ref asRows) or columns of @ref size elements.  Element j
+ *     of new vector i is element(i, j).  The buffer grows at most once and the new elements
+ *     are written in the order they are stored, whichever space the matrix uses.
+ * @return false and changes nothing if there is nothing to add or @ref size does not match
+ *     the matrix
  */
-bool MathMatrix::addMathVectorToSameSpace(const MathVector& v, unsigned int & vectorSpaceSize,
-	unsigned int numElementsInVectorOfSpace)
+template <typename T>
+template <typename ElementSource>
+bool MathMatrixT<T>::appendVectors(bool asRows, unsigned int count, unsigned int size, ElementSource element)
 {
-	if (vectorSpaceSize >= preAlloc_)
+	if (count == 0 || size == 0)
 	{
-		// A fancy way of checking for overflow
-		if (vectorSpaceSize == (0x01 << (sizeof(vectorSpaceSize)-1)) )
-		{
-			return false;
-		}
-		// Now we need to copy everything over
-		preAlloc_ <<= 1;
+		return false;
+	}
 
-		MathVector** newSpace = new MathVector * [preAlloc_];
-		
-		for (unsigned int i = 0; i < vectorSpaceSize; ++i)
+	unsigned int numVectors = asRows ? numRows_ : numCols_;
+
+	if (numRows_ == 0 && numCols_ == 0)
+	{
+		// Without reserved room an empty matrix is stored in the direction of the vectors
+		if (data_ == nullptr)
 		{
-			newSpace[i] = vectorSpace_[i];
+			spaceToRepresentMatrixAs_ = asRows ? ROWSPACE : COLUMNSPACE;
 		}
-		// Dont delete the previous vectors though since only the pointer is copied
-		delete[] vectorSpace_;
-		vectorSpace_ = newSpace;
+	}
+	else if (size != (asRows ? numCols_ : numRows_))
+	{
+		return false;
 	}
 
-	vectorSpace_[vectorSpaceSize++] = new MathVector(v);
+	if (count > 0xFFFFFFFFu - numVectors)
+	{
+		return false;
+	}
+
+	unsigned int newNumRows = asRows ? numVectors + count : size;
+	unsigned int newNumCols = asRows ? size : numVectors + count;
+	if (!growToFit(newNumRows, newNumCols))
+	{
+		return false;
+	}
+	numRows_ = newNumRows;
+	numCols_ = newNumCols;
+
+	// Element j of new vector i, at (numVectors + i, j) for rows and (j, numVectors + i) for columns
+	size_t vectorStride = asRows ? getRowStride() : getColStride();
+	size_t elementStride = asRows ? getColStride() : getRowStride();
+	T* first = data_ + (size_t)numVectors * vectorStride;
 
+	if (elementStride == 1)
+	{
+		for (unsigned int i = 0; i < count; ++i)
+		{
+			T* to = first + (size_t)i * vectorStride;
+			for (unsigned int j = 0; j < size; ++j)
+			{
+				to[j] = element(i, j);
+			}
+		}
+	}
+	else
+	{
+		for (unsigned int j = 0; j < size; ++j)
+		{
+			T* to = first + (size_t)j * elementStride;
+			for (unsigned int i = 0; i < count; ++i)
+			{
+				to[i] = element(i, j);
+			}
+		}
+	}
 	return true;
 }
 
-void MathMatrix::makeMatrixFromInitLists(const std::initializer_list<std::initializer_list<double>>& list2d)
+// Whether @ref view looks at memory inside the buffer of this matrix
+template <typename T>
+bool MathMatrixT<T>::viewsStorage(const MathMatrixViewT<T>& view) const
 {
+	const T* viewed = view.getData();
+	return data_ != nullptr && viewed >= data_ && viewed < data_ + (size_t)preAlloc_ * leadingDimension_;
+}
+
+template <typename T>
+void MathMatrixT<T>::makeMatrixFromInitLists(const std::initializer_list<std::initializer_list<T>>& list2d)
+{
+	numRows_ = numCols_ = 0;
+
 	if (list2d.size() == 0)
 	{
 		return;
 	}
 
-	std::initializer_list<std::initializer_list<double>>::const_iterator itr = list2d.begin();
+	typename std::initializer_list<std::initializer_list<T>>::const_iterator itr = list2d.begin();
 
 	unsigned int numColsInMatrix = (unsigned int) itr->size();
 	++itr;
@@ -715,26 +888,17 @@ void MathMatrix::makeMatrixFromInitLists(const std::initializer_list<std::initia
 		}
 	}
 
-	numRows_ = (unsigned int) list2d.size();
-	numCols_ = numColsInMatrix;
-
-	preAlloc_ = 0x01;
-
-	unsigned int tempNumCols = numCols_;
-	while (tempNumCols > 0)
+	if (numColsInMatrix == 0)
 	{
-		preAlloc_ <<= 1;
-		tempNumCols >>= 1;
+		return;
 	}
 
-	// Now allocate all the memory
-	vectorSpace_ = new MathVector * [preAlloc_];
-
+	numRows_ = (unsigned int) list2d.size();
+	numCols_ = numColsInMatrix;
+	spaceToRepresentMatrixAs_ = COLUMNSPACE;
 
-	for (unsigned int i = 0; i < numCols_; ++i)
-	{
-		vectorSpace_[i] = new MathVector(numRows_);
-	}
+	// Now allocate all the memory
+	allocateStorage(numCols_, numRows_);
 
 	// Fill in the matrix
 
@@ -742,18 +906,19 @@ void MathMatrix::makeMatrixFromInitLists(const std::initializer_list<std::initia
 	unsigned int c = 0;
 
 
-	for (std::initializer_list<std::initializer_list<double>>::iterator rowItr = list2d.begin();
+	for (typename std::initializer_list<std::initializer_list<T>>::iterator rowItr = list2d.begin();
 		rowItr != list2d.end(); ++rowItr)
 	{
-		std::initializer_list<double>::iterator colEndItr = rowItr->end();
+		typename std::initializer_list<T>::iterator colEndItr = rowItr->end();
 		c = 0;
-		for (std::initializer_list<double>::iterator indexItr = rowItr->begin(); indexItr != colEndItr; ++indexItr)
+		for (typename std::initializer_list<T>::iterator indexItr = rowItr->begin(); indexItr != colEndItr; ++indexItr)
 		{
-			(*vectorSpace_[c])[r] = *indexItr;
+			elementAt(r, c) = *indexItr;
 			++c;
 		}
 		++r;
 	}
 }
 
-
+template class MathMatrixT<double>;
+template class MathMatrixT<float>;
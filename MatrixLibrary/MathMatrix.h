@@ -6,6 +6,8 @@
 #include "pch.h"
 #include "MathVector.h"
 #include "MathMatrixIterator.h"
+#include "MathMatrixView.h"
+#include <vector>
 
 /**
  * @brief An enum to define the "dominant space" of the matrix.  This enum being
@@ -25,27 +27,39 @@
 #endif
 
 /**
- * @brief A class used to represent mathematical matrices
+ * @brief A class used to represent mathematical matrices of elements of type T.  Use
+ *     @ref MathMatrix for doubles and @ref MathMatrixF for floats.
+ * @note Products of float matrices run float micro-kernels that do twice the multiply-adds
+ *     per instruction of the double ones and move half the bytes.
  */
-class MathMatrix
+template <typename T>
+class MathMatrixT
 {
 public:
 
-	MathMatrix();
-	MathMatrix(unsigned int numRows, unsigned int numCols);
-	MathMatrix(const MathVector& v, vector_space_t spaceOfVector);
-	MathMatrix(const MathVector& colVector, const MathVector& rowVector);
-	~MathMatrix() { cleanUpDynamicallyAllocatedMemory(); }
-	MathMatrix(const MathMatrix& other);
-	MathMatrix& operator=(const MathMatrix& other);
+	typedef T value_type;
 
-	MathMatrix(const std::initializer_list < std::initializer_list<double>> list2d);
-	MathMatrix& operator=(const std::initializer_list < std::initializer_list<double>> list2d);
+	MathMatrixT();
+	MathMatrixT(unsigned int numRows, unsigned int numCols);
+	MathMatrixT(const MathVectorT<T>& v, vector_space_t spaceOfVector);
+	MathMatrixT(const MathVectorT<T>& colVector, const MathVectorT<T>& rowVector);
+	~MathMatrixT() { cleanUpDynamicallyAllocatedMemory(); }
+	MathMatrixT(const MathMatrixT& other);
+	MathMatrixT& operator=(const MathMatrixT& other);
+	MathMatrixT(MathMatrixT&& other) noexcept;
+	MathMatrixT& operator=(MathMatrixT&& other) noexcept;
+
+	// Copies only the elements the view looks at.  The view may have the other element type.
+	template <typename U>
+	explicit MathMatrixT(const MathMatrixViewT<U>& view);
+
+	MathMatrixT(const std::initializer_list < std::initializer_list<T>> list2d);
+	MathMatrixT& operator=(const std::initializer_list < std::initializer_list<T>> list2d);
 
 	// Programming related helper functions
 
-	double getVal(unsigned int row, unsigned int col) const;
-	bool setVal(unsigned int row, unsigned int col, double valueToSetTo) const;
+	T getVal(unsigned int row, unsigned int col) const;
+	bool setVal(unsigned int row, unsigned int col, T valueToSetTo) const;
 
 	unsigned int getNumRows() const { return numRows_; }
 	unsigned int getNumCols() const { return numCols_; }
@@ -53,10 +67,36 @@ public:
 	unsigned int getNumRowsInOperationSize() const;
 	unsigned int getNumColsInOperationSize() const;
 
-	bool equals(const std::initializer_list<std::initializer_list<double>>& other) const;
+	// Raw access to the storage of the matrix.  Element (row, col) lives at
+	//     getData()[row * getRowStride() + col * getColStride()]
+	T* getData() const { return data_; }
+	unsigned int getLeadingDimension() const { return leadingDimension_; }
+	unsigned int getRowStride() const { return (spaceToRepresentMatrixAs_ == ROWSPACE) ? leadingDimension_ : 1; }
+	unsigned int getColStride() const { return (spaceToRepresentMatrixAs_ == ROWSPACE) ? 1 : leadingDimension_; }
+	vector_space_t getSpaceToRepresentMatrixAs() const { return spaceToRepresentMatrixAs_; }
+	void setSpaceToRepresentMatrixAs(vector_space_t space);
+
+	// A view of the operation size of the matrix and a view of any block of it
+	MathMatrixViewT<T> getView() const { return MathMatrixViewT<T>(*this); }
+	MathMatrixViewT<T> getView(unsigned int rowOffset, unsigned int colOffset,
+		unsigned int numRows, unsigned int numCols) const;
+
+	bool equals(const std::initializer_list<std::initializer_list<T>>& other) const;
+
+	bool addRow(const MathVectorT<T>& rowToAdd);
+	bool addCol(const MathVectorT<T>& rowToCol);
+
+	// Appending many rows or columns at once moves the buffer at most once
+	bool appendRows(const MathMatrixViewT<T>& block);
+	bool appendCols(const MathMatrixViewT<T>& block);
+	bool appendRows(const std::vector<MathVectorT<T>>& rows);
+	bool appendCols(const std::vector<MathVectorT<T>>& cols);
+
+	void reserve(unsigned int numRows, unsigned int numCols);
 
-	bool addRow(const MathVector& rowToAdd);
-	bool addCol(const MathVector& rowToCol);
+	// How many rows and columns fit before appending moves the buffer
+	unsigned int getRowCapacity() const { return (spaceToRepresentMatrixAs_ == ROWSPACE) ? preAlloc_ : leadingDimension_; }
+	unsigned int getColCapacity() const { return (spaceToRepresentMatrixAs_ == ROWSPACE) ? leadingDimension_ : preAlloc_; }
 
 	// Math related operations
 	
@@ -66,38 +106,44 @@ public:
 
 
 	bool addMultipleOfRow(unsigned int rowNumToAddTo, unsigned int rowNumToAdd,
-		double multiple);
+		T multiple);
 
-	bool multiplyRowByConstant(unsigned int row, double constant);
+	bool multiplyRowByConstant(unsigned int row, T constant);
 
 	void transpose();
 
 	// Iterator functions
-	typedef MathMatrixIterator rowIterator;
-	typedef MathMatrixIterator colIterator;
+	typedef MathMatrixIteratorT<T> rowIterator;
+	typedef MathMatrixIteratorT<T> colIterator;
 
-	MathMatrixIterator rowBegin(unsigned int const row) const;
-	MathMatrixIterator rowEnd(unsigned int const row) const;
-	MathMatrixIterator colBegin(unsigned int const col) const;
-	MathMatrixIterator colEnd(unsigned int const col) const;
+	MathMatrixIteratorT<T> rowBegin(unsigned int const row) const;
+	MathMatrixIteratorT<T> rowEnd(unsigned int const row) const;
+	MathMatrixIteratorT<T> colBegin(unsigned int const col) const;
+	MathMatrixIteratorT<T> colEnd(unsigned int const col) const;
 
 
 
 private:
 
-	void makeMatrixFromInitLists(const std::initializer_list<std::initializer_list<double>>& list2d);
+	void makeMatrixFromInitLists(const std::initializer_list<std::initializer_list<T>>& list2d);
 
 	// Dynamically Allocated Memory Helper Functions
+	void allocateStorage(unsigned int numVectorsInSpace, unsigned int sizeOfVectorsInSpace);
 	void cleanUpDynamicallyAllocatedMemory();
-	void copy(const MathMatrix& other);
+	void copy(const MathMatrixT& other);
+	void moveFrom(MathMatrixT& other) noexcept;
+	bool reallocateStorage(unsigned int newPreAlloc, unsigned int newLeadingDimension);
 
-	bool isRowNumInOperationBounds(unsigned int rowNum);
-	bool isColNumInOperationBounds(unsigned int colNum);
+	T& elementAt(unsigned int row, unsigned int col) const
+	{
+		return data_[(size_t)row * getRowStride() + (size_t)col * getColStride()];
+	}
+
+	bool growToFit(unsigned int numRows, unsigned int numCols);
+	template <typename ElementSource>
+	bool appendVectors(bool asRows, unsigned int count, unsigned int size, ElementSource element);
+	bool viewsStorage(const MathMatrixViewT<T>& view) const;
 
-	bool addMathVectorToEndsOfEachVector(const MathVector& v, unsigned int const primarySpaceSize,
-		unsigned int & vectorSpaceSize);
-	bool addMathVectorToSameSpace(const MathVector& v, unsigned int & vectorSpaceSize,
-		unsigned int const numElementsInVectorOfSpace);
 	/**
 	 * @brief The dominant space of the matrix.  By defult the matrix
 	 *     is represented as column vectors.
@@ -112,11 +158,25 @@ private:
 	unsigned int numCols_ = 0;
 
 	/**
-	 * @brief vectorSpace is the space of either row or column
-	 *     vectors that form the matrix.
+	 * @brief data_ is a single contiguous buffer holding the space of either row
+	 *     or column vectors that form the matrix.  Vector i of the space starts at
+	 *     data_ + i * leadingDimension_.
+	 */
+	T* data_ = nullptr;
+
+	// The arena data_ came from, nullptr if it came from the heap
+	MathArena* arena_ = nullptr;
+
+	/**
+	 * @brief The number of elements allocated for each vector of the space.  This is
+	 *     at least the size of the vectors so elements can be appended to each vector
+	 *     without moving the whole buffer every time.
 	 */
-	MathVector** vectorSpace_ = nullptr;
+	unsigned int leadingDimension_ = 0;
 
+	/**
+	 * @brief The number of vectors of the space that data_ has room for
+	 */
 	unsigned int preAlloc_ = 0;
 
 	unsigned int numRowsSeenInOperations_ = 0;
@@ -127,7 +187,85 @@ private:
 
 };
 
+typedef MathMatrixT<double> MathMatrix;
+typedef MathMatrixT<float> MathMatrixF;
+
+extern template class MathMatrixT<double>;
+extern template class MathMatrixT<float>;
+
 MathMatrix operator*(const MathMatrix& m1, const MathMatrix& m2);
+MathMatrixF operator*(const MathMatrixF& m1, const MathMatrixF& m2);
+
+/**
+ * @brief y = alpha * op(a) * x + beta * y written into @ref y, where op(a) is a or, if
+ *     @ref transposeA is set, its transpose.  Nothing is allocated when y already has the
+ *     right size.
+ * @return false and changes nothing if the sizes do not match.  With beta == 0 a y of the
+ *     wrong size is resized instead, and its old elements are never read.
+ * @note Rows of a that are contiguous are dot products with x and contiguous columns are
+ *     added into y one axpy at a time, so neither layout is copied or transposed.
+ * @note @ref x and @ref y must not be the same vector
+ */
+bool multiply(const MathMatrixView& a, const MathVector& x, MathVector& y,
+	double alpha = 1.0, double beta = 0.0, bool transposeA = false);
+bool multiply(const MathMatrixViewF& a, const MathVectorF& x, MathVectorF& y,
+	float alpha = 1.0f, float beta = 0.0f, bool transposeA = false);
+
+// a * x, an empty vector if the sizes do not match
+MathVector operator*(const MathMatrix& a, const MathVector& x);
+MathVectorF operator*(const MathMatrixF& a, const MathVectorF& x);
+
+// a^T * x without transposing @ref a
+MathVector transposeMultiply(const MathMatrix& a, const MathVector& x);
+MathVectorF transposeMultiply(const MathMatrixF& a, const MathVectorF& x);
+
+// =============================================================================================
+// Template member functions
+// =============================================================================================
+
+/**
+ * @brief Makes a matrix holding a copy of the elements @ref view looks at.  Only those
+ *     elements are copied and the new matrix is stored in the direction the view is
+ *     contiguous in so the copy reads memory in order.
+ * @note Copying a view of doubles into a float matrix rounds every element to float, which
+ *     is how a double problem is handed to the faster float kernels.
+ */
+template <typename T>
+template <typename U>
+MathMatrixT<T>::MathMatrixT(const MathMatrixViewT<U>& view)
+{
+	if (view.getNumRows() == 0 || view.getNumCols() == 0)
+	{
+		return;
+	}
+
+	numRows_ = view.getNumRows();
+	numCols_ = view.getNumCols();
+	spaceToRepresentMatrixAs_ = (view.getColStride() < view.getRowStride()) ? ROWSPACE : COLUMNSPACE;
+
+	if (spaceToRepresentMatrixAs_ == ROWSPACE)
+	{
+		allocateStorage(numRows_, numCols_);
+		for (unsigned int r = 0; r < numRows_; ++r)
+		{
+			for (unsigned int c = 0; c < numCols_; ++c)
+			{
+				elementAt(r, c) = (T)view.getVal(r, c);
+			}
+		}
+	}
+	else
+	{
+		allocateStorage(numCols_, numRows_);
+		for (unsigned int c = 0; c < numCols_; ++c)
+		{
+			for (unsigned int r = 0; r < numRows_; ++r)
+			{
+				elementAt(r, c) = (T)view.getVal(r, c);
+			}
+		}
+	}
+}
 
 #endif // __MATH_MATRIX_H
 
@@ -0,0 +1,212 @@
+#pragma once
+
+#ifndef __MATH_MATRIX_BATCH_H
+#define __MATH_MATRIX_BATCH_H
+
+#include <cstddef>
+#include <utility>
+#include "MathArena.h"
+#include "MathFixedMatrix.h"
+#include "MathFixedVector.h"
+#include "MathSimdKernels.h"
+
+/**
+ * @brief Many independent R x C matrices of the same size, stored interleaved so one
+ *     operation is applied to a whole group of them with every SIMD instruction.
+ * @note The matrices are split into groups of @ref LANES.  A group stores element (0, 0) of
+ *     each of its matrices next to each other, then element (0, 1) of each, and so on, so
+ *     element (r, c) of matrix i is
+ *     getData()[(i / LANES) * R * C * LANES + (r * C + c) * LANES + i % LANES].
+ *     The batched kernels apply every operation to a whole group of lanes at once, so they
+ *     run full width SIMD instructions with no shuffles whatever R and C are.
+ * @note The last group is padded with zero matrices, so the number of matrices does not have
+ *     to be a multiple of @ref LANES.
+ * @note Use a batch of R x 1 matrices, @ref MathVectorBatch, for batched matrix vector products.
+ */
+template <unsigned int R, unsigned int C>
+class MathMatrixBatch
+{
+	static_assert(R > 0 && C > 0, "MathMatrixBatch needs at least one row and one column");
+
+public:
+
+	// The matrices in a group.  One element of a whole group is a 64 byte cache line and one
+	//     AVX-512 register, or two AVX2 registers.
+	static constexpr unsigned int LANES = SIMD_BATCH_LANES;
+
+	MathMatrixBatch() {}
+
+	// A batch of @ref size zero matrices
+	explicit MathMatrixBatch(size_t size) { allocate(size); }
+
+	~MathMatrixBatch() { freeElements(data_, arena_); }
+
+	MathMatrixBatch(const MathMatrixBatch& other)
+	{
+		allocate(other.size_);
+		for (size_t i = 0; i < getNumElements(); ++i) data_[i] = other.data_[i];
+	}
+
+	MathMatrixBatch& operator=(const MathMatrixBatch& other)
+	{
+		if (this != &other)
+		{
+			MathMatrixBatch copy(other);
+			swap(copy);
+		}
+		return *this;
+	}
+
+	MathMatrixBatch(MathMatrixBatch&& other) noexcept { swap(other); }
+
+	MathMatrixBatch& operator=(MathMatrixBatch&& other) noexcept
+	{
+		swap(other);
+		return *this;
+	}
+
+	size_t getSize() const { return size_; }
+	size_t getNumGroups() const { return (size_ + LANES - 1) / LANES; }
+
+	static constexpr unsigned int getNumRows() { return R; }
+	static constexpr unsigned int getNumCols() { return C; }
+
+	// Unchecked access to element (row, col) of matrix @ref index
+	double& operator()(size_t index, unsigned int row, unsigned int col)
+	{
+		return data_[(index / LANES) * R * C * LANES + (row * C + col) * LANES + index % LANES];
+	}
+	const double& operator()(size_t index, unsigned int row, unsigned int col) const
+	{
+		return data_[(index / LANES) * R * C * LANES + (row * C + col) * LANES + index % LANES];
+	}
+
+	// Copies matrix @ref index out of or into the batch
+	MathFixedMatrix<R, C> get(size_t index) const
+	{
+		MathFixedMatrix<R, C> m;
+		for (unsigned int r = 0; r < R; ++r)
+		{
+			for (unsigned int c = 0; c < C; ++c) m(r, c) = (*this)(index, r, c);
+		}
+		return m;
+	}
+
+	void set(size_t index, const MathFixedMatrix<R, C>& m)
+	{
+		for (unsigned int r = 0; r < R; ++r)
+		{
+			for (unsigned int c = 0; c < C; ++c) (*this)(index, r, c) = m(r, c);
+		}
+	}
+
+	// The elements of group @ref group start at getData() + group * R * C * LANES
+	double* getData() { return data_; }
+	const double* getData() const { return data_; }
+
+private:
+
+	size_t getNumElements() const { return getNumGroups() * R * C * LANES; }
+
+	void allocate(size_t size)
+	{
+		size_ = size;
+		if (size == 0)
+		{
+			return;
+		}
+
+		data_ = allocateElements<double>(getNumElements(), arena_);
+		for (size_t i = 0; i < getNumElements(); ++i) data_[i] = 0.0;
+	}
+
+	void swap(MathMatrixBatch& other) noexcept
+	{
+		double* data = data_; data_ = other.data_; other.data_ = data;
+		MathArena* arena = arena_; arena_ = other.arena_; other.arena_ = arena;
+		size_t size = size_; size_ = other.size_; other.size_ = size;
+	}
+
+	double* data_ = nullptr;
+
+	// The arena data_ came from, nullptr if it came from the heap
+	MathArena* arena_ = nullptr;
+
+	size_t size_ = 0;
+};
+
+template <unsigned int N>
+using MathVectorBatch = MathMatrixBatch<N, 1>;
+
+// =============================================================================================
+// Outside of class functions
+// =============================================================================================
+
+/**
+ * @brief c = a * b for every matrix of the batches, c[i] = a[i] * b[i].  With b a
+ *     @ref MathVectorBatch this is a batched matrix vector product.
+ * @return false and changes nothing if a and b hold a different number of matrices.
+ *     A c of the wrong size is resized.
+ * @note Each element of a group of products is one chain of K multiply-adds on whole groups,
+ *     run by @ref simdBatchMultiply with the widest instruction set the machine has.
+ */
+template <unsigned int R, unsigned int K, unsigned int C>
+bool multiply(const MathMatrixBatch<R, K>& a, const MathMatrixBatch<K, C>& b, MathMatrixBatch<R, C>& c)
+{
+	if (a.getSize() != b.getSize())
+	{
+		return false;
+	}
+	if (static_cast<const void*>(&c) == &a || static_cast<const void*>(&c) == &b)
+	{
+		MathMatrixBatch<R, C> product;
+		multiply(a, b, product);
+		c = std::move(product);
+		return true;
+	}
+	if (c.getSize() != a.getSize())
+	{
+		c = MathMatrixBatch<R, C>(a.getSize());
+	}
+
+	simdBatchMultiply(R, K, C, a.getData(), b.getData(), c.getData(), a.getNumGroups());
+	return true;
+}
+
+// The batch of products a[i] * b[i], an empty batch if the sizes do not match
+template <unsigned int R, unsigned int K, unsigned int C>
+MathMatrixBatch<R, C> operator*(const MathMatrixBatch<R, K>& a, const MathMatrixBatch<K, C>& b)
+{
+	MathMatrixBatch<R, C> c;
+	multiply(a, b, c);
+	return c;
+}
+
+/**
+ * @brief The inverse of every matrix of the batch by Gauss-Jordan elimination with partial
+ *     pivoting, run on a whole group at once by @ref simdBatchInverse.
+ * @return A batch holding a matrix of NANs for every singular matrix of @ref a, like
+ *     inverse() of a @ref MathFixedMatrix
+ */
+template <unsigned int N>
+MathMatrixBatch<N, N> inverse(const MathMatrixBatch<N, N>& a)
+{
+	const unsigned int lanes = MathMatrixBatch<N, N>::LANES;
+	MathMatrixBatch<N, N> result(a.getSize());
+	if (a.getSize() == 0)
+	{
+		return result;
+	}
+
+	simdBatchInverse(N, a.getData(), result.getData(), a.getNumGroups());
+
+	// The zero matrices padding the last group are singular, set them back to zero
+	double* last = result.getData() + (a.getNumGroups() - 1) * N * N * lanes;
+	for (unsigned int w = (unsigned int)(a.getSize() - (a.getNumGroups() - 1) * lanes); w < lanes; ++w)
+	{
+		for (unsigned int e = 0; e < N * N; ++e) last[e * lanes + w] = 0.0;
+	}
+	return result;
+}
+
+#endif // __MATH_MATRIX_BATCH_H
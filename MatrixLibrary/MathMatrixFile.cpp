@@ -0,0 +1,375 @@
+#include "pch.h"
+#include "MathMatrixFile.h"
+#include "MathArena.h"
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static const char MATRIX_FILE_MAGIC[8] = { 'M', 'A', 'T', 'H', 'M', 'T', 'R', 'X' };
+
+template <typename T> static uint32_t elementTypeOf();
+template <> uint32_t elementTypeOf<double>() { return MATH_MATRIX_FILE_DOUBLE; }
+template <> uint32_t elementTypeOf<float>() { return MATH_MATRIX_FILE_FLOAT; }
+
+// Vectors are padded to whole cache lines so each one starts on a line once mapped
+template <typename T>
+static size_t fileLeadingDimension(unsigned int size)
+{
+	const size_t elementsPerLine = MATH_BUFFER_ALIGNMENT / sizeof(T);
+	return ((size_t)size + elementsPerLine - 1) / elementsPerLine * elementsPerLine;
+}
+
+/**
+ * @brief Checks that a header describes a matrix of T this build can read, and that its
+ *     payload fits in a file of @ref fileSize bytes.
+ */
+template <typename T>
+static bool isValidHeader(const MathMatrixFileHeader& header, uint64_t fileSize)
+{
+	if (std::memcmp(header.magic, MATRIX_FILE_MAGIC, sizeof(MATRIX_FILE_MAGIC)) != 0 ||
+		header.version == 0 || header.version > MATH_MATRIX_FILE_VERSION ||
+		header.endianTag != MATH_MATRIX_FILE_ENDIAN_TAG ||
+		header.elementType != elementTypeOf<T>() || header.elementSize != sizeof(T) ||
+		(header.space != ROWSPACE && header.space != COLUMNSPACE))
+	{
+		return false;
+	}
+
+	uint64_t numVectors = (header.space == ROWSPACE) ? header.numRows : header.numCols;
+	uint64_t vectorSize = (header.space == ROWSPACE) ? header.numCols : header.numRows;
+
+	// A payload of more bytes than a uint64_t holds would wrap around to a small size below
+	if (numVectors != 0 && header.leadingDimension > UINT64_MAX / sizeof(T) / numVectors)
+	{
+		return false;
+	}
+
+	if (header.leadingDimension < vectorSize || header.payloadOffset % MATH_BUFFER_ALIGNMENT != 0 ||
+		header.payloadOffset < sizeof(MathMatrixFileHeader) ||
+		header.payloadSize != numVectors * header.leadingDimension * sizeof(T))
+	{
+		return false;
+	}
+
+	return header.payloadOffset <= fileSize && header.payloadSize <= fileSize - header.payloadOffset;
+}
+
+// =============================================================================================
+// Saving and loading
+// =============================================================================================
+
+bool isSameFile(const char* first, const char* second)
+{
+#ifdef _WIN32
+	// Opened without any access, only to ask which file the path leads to
+	auto identify = [](const char* path, BY_HANDLE_FILE_INFORMATION& information)
+	{
+		HANDLE file = CreateFileA(path, 0, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+			nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (file == INVALID_HANDLE_VALUE)
+		{
+			return false;
+		}
+		bool found = GetFileInformationByHandle(file, &information) != 0;
+		CloseHandle(file);
+		return found;
+	};
+
+	BY_HANDLE_FILE_INFORMATION a, b;
+	return identify(first, a) && identify(second, b) &&
+		a.dwVolumeSerialNumber == b.dwVolumeSerialNumber &&
+		a.nFileIndexHigh == b.nFileIndexHigh && a.nFileIndexLow == b.nFileIndexLow;
+#else
+	struct stat a, b;
+	return stat(first, &a) == 0 && stat(second, &b) == 0 && a.st_dev == b.st_dev && a.st_ino == b.st_ino;
+#endif
+}
+
+template <typename T>
+bool makeMatrixFileHeader(unsigned int numRows, unsigned int numCols, vector_space_t space,
+	MathMatrixFileHeader& header)
+{
+	unsigned int numVectors = (space == ROWSPACE) ? numRows : numCols;
+	size_t leadingDimension = fileLeadingDimension<T>((space == ROWSPACE) ? numCols : numRows);
+	if (leadingDimension > 0xFFFFFFFFu)
+	{
+		return false;
+	}
+
+	header = MathMatrixFileHeader();
+	std::memcpy(header.magic, MATRIX_FILE_MAGIC, sizeof(MATRIX_FILE_MAGIC));
+	header.version = MATH_MATRIX_FILE_VERSION;
+	header.endianTag = MATH_MATRIX_FILE_ENDIAN_TAG;
+	header.elementType = elementTypeOf<T>();
+	header.elementSize = sizeof(T);
+	header.space = space;
+	header.numRows = numRows;
+	header.numCols = numCols;
+	header.leadingDimension = (uint32_t)leadingDimension;
+	header.payloadOffset = sizeof(MathMatrixFileHeader);
+	header.payloadSize = (uint64_t)numVectors * leadingDimension * sizeof(T);
+	return true;
+}
+
+template <typename T>
+bool readMatrixFileHeader(std::istream& file, MathMatrixFileHeader& header)
+{
+	MathMatrixFileHeader read;
+	if (!file.seekg(0, std::ios::end))
+	{
+		return false;
+	}
+
+	uint64_t fileSize = (uint64_t)file.tellg();
+	if (fileSize < sizeof(read) || !file.seekg(0) ||
+		!file.read(reinterpret_cast<char*>(&read), sizeof(read)) || !isValidHeader<T>(read, fileSize))
+	{
+		return false;
+	}
+
+	header = read;
+	return true;
+}
+
+std::string makeTemporaryFilePath(const char* path)
+{
+	static std::atomic<unsigned long long> nextTemporary(0);
+#ifdef _WIN32
+	unsigned long long process = GetCurrentProcessId();
+#else
+	unsigned long long process = (unsigned long long)getpid();
+#endif
+	return std::string(path) + "." + std::to_string(process) + "." + std::to_string(nextTemporary++) + ".tmp";
+}
+
+bool replaceFile(const char* from, const char* to)
+{
+#ifdef _WIN32
+	bool replaced = MoveFileExA(from, to, MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+	bool replaced = std::rename(from, to) == 0;
+#endif
+	if (!replaced)
+	{
+		std::remove(from);
+	}
+	return replaced;
+}
+
+template <typename T>
+bool saveMatrix(const char* path, const MathMatrixViewT<T>& m)
+{
+	vector_space_t space = (m.getColStride() == 1 && m.getRowStride() != 1) ? ROWSPACE : COLUMNSPACE;
+	MathMatrixFileHeader header;
+	if (!makeMatrixFileHeader<T>(m.getNumRows(), m.getNumCols(), space, header))
+	{
+		return false;
+	}
+
+	unsigned int numVectors = (space == ROWSPACE) ? m.getNumRows() : m.getNumCols();
+	unsigned int vectorSize = (space == ROWSPACE) ? m.getNumCols() : m.getNumRows();
+	size_t leadingDimension = header.leadingDimension;
+
+	// Rewriting the file in place would pull the pages out from under whoever has it mapped
+	std::string temporaryPath = makeTemporaryFilePath(path);
+	std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+	file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+	// Each vector is gathered into a zero padded buffer and written with one call
+	size_t along = (space == ROWSPACE) ? m.getColStride() : m.getRowStride();
+	size_t across = (space == ROWSPACE) ? m.getRowStride() : m.getColStride();
+	std::vector<T> vector(leadingDimension, (T)0);
+	for (unsigned int v = 0; v < numVectors && file; ++v)
+	{
+		const T* source = m.getData() + v * across;
+		for (unsigned int i = 0; i < vectorSize; ++i) vector[i] = source[i * along];
+		file.write(reinterpret_cast<const char*>(vector.data()), leadingDimension * sizeof(T));
+	}
+
+	file.close();
+	if (file.fail())
+	{
+		std::remove(temporaryPath.c_str());
+		return false;
+	}
+	return replaceFile(temporaryPath.c_str(), path);
+}
+
+template <typename T>
+bool loadMatrix(const char* path, MathMatrixT<T>& m)
+{
+	std::ifstream file(path, std::ios::binary);
+	MathMatrixFileHeader header;
+	if (!readMatrixFileHeader<T>(file, header))
+	{
+		return false;
+	}
+
+	// A ROWSPACE matrix is the transpose of a new COLUMNSPACE one, which moves no elements
+	vector_space_t space = (vector_space_t)header.space;
+	MathMatrixT<T> loaded(header.numRows, header.numCols);
+	if (space == ROWSPACE)
+	{
+		loaded = MathMatrixT<T>(header.numCols, header.numRows);
+		loaded.transpose();
+	}
+	unsigned int numVectors = (space == ROWSPACE) ? header.numRows : header.numCols;
+	unsigned int vectorSize = (space == ROWSPACE) ? header.numCols : header.numRows;
+
+	// The vectors go straight into the storage of the matrix, whose leading dimension may differ
+	file.seekg((std::streamoff)header.payloadOffset);
+	for (unsigned int v = 0; v < numVectors; ++v)
+	{
+		T* destination = loaded.getData() + (size_t)v * loaded.getLeadingDimension();
+		if (!file.read(reinterpret_cast<char*>(destination), (std::streamsize)vectorSize * sizeof(T)) ||
+			!file.seekg((std::streamoff)(header.leadingDimension - vectorSize) * sizeof(T), std::ios::cur))
+		{
+			return false;
+		}
+	}
+
+	m = std::move(loaded);
+	return true;
+}
+
+template bool makeMatrixFileHeader<double>(unsigned int numRows, unsigned int numCols,
+	vector_space_t space, MathMatrixFileHeader& header);
+template bool makeMatrixFileHeader<float>(unsigned int numRows, unsigned int numCols,
+	vector_space_t space, MathMatrixFileHeader& header);
+template bool readMatrixFileHeader<double>(std::istream& file, MathMatrixFileHeader& header);
+template bool readMatrixFileHeader<float>(std::istream& file, MathMatrixFileHeader& header);
+template bool saveMatrix(const char* path, const MathMatrixViewT<double>& m);
+template bool saveMatrix(const char* path, const MathMatrixViewT<float>& m);
+template bool loadMatrix(const char* path, MathMatrixT<double>& m);
+template bool loadMatrix(const char* path, MathMatrixT<float>& m);
+
+// =============================================================================================
+// Mapped matrices
+// =============================================================================================
+
+template <typename T>
+bool MathMappedMatrixT<T>::open(const char* path)
+{
+	close();
+
+#ifdef _WIN32
+	HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+		FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+
+	LARGE_INTEGER size;
+	HANDLE mappingHandle = nullptr;
+	if (GetFileSizeEx(file, &size) && (uint64_t)size.QuadPart >= sizeof(MathMatrixFileHeader))
+	{
+		mappingHandle = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	}
+
+	// The mapping keeps the file open
+	CloseHandle(file);
+	if (mappingHandle == nullptr)
+	{
+		return false;
+	}
+
+	mapping_ = MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0);
+	if (mapping_ == nullptr)
+	{
+		CloseHandle(mappingHandle);
+		return false;
+	}
+	mappingHandle_ = mappingHandle;
+	mappingSize_ = (size_t)size.QuadPart;
+#else
+	int file = ::open(path, O_RDONLY);
+	if (file < 0)
+	{
+		return false;
+	}
+
+	struct stat status;
+	void* mapping = MAP_FAILED;
+	if (fstat(file, &status) == 0 && (uint64_t)status.st_size >= sizeof(MathMatrixFileHeader))
+	{
+		// Shared, so every process mapping the file reads the same cached pages
+		mapping = mmap(nullptr, (size_t)status.st_size, PROT_READ, MAP_SHARED, file, 0);
+	}
+
+	// The mapping keeps the file open
+	::close(file);
+	if (mapping == MAP_FAILED)
+	{
+		return false;
+	}
+	mapping_ = mapping;
+	mappingSize_ = (size_t)status.st_size;
+#endif
+
+	MathMatrixFileHeader header;
+	std::memcpy(&header, mapping_, sizeof(header));
+	if (!isValidHeader<T>(header, mappingSize_))
+	{
+		close();
+		return false;
+	}
+
+	data_ = reinterpret_cast<const T*>(static_cast<const char*>(mapping_) + header.payloadOffset);
+	numRows_ = header.numRows;
+	numCols_ = header.numCols;
+	leadingDimension_ = header.leadingDimension;
+	space_ = (vector_space_t)header.space;
+	return true;
+}
+
+template <typename T>
+void MathMappedMatrixT<T>::close()
+{
+	if (mapping_ != nullptr)
+	{
+#ifdef _WIN32
+		UnmapViewOfFile(mapping_);
+		CloseHandle(mappingHandle_);
+#else
+		munmap(mapping_, mappingSize_);
+#endif
+	}
+
+	mapping_ = nullptr;
+	mappingHandle_ = nullptr;
+	mappingSize_ = 0;
+	data_ = nullptr;
+	numRows_ = numCols_ = 0;
+	leadingDimension_ = 0;
+	space_ = COLUMNSPACE;
+}
+
+template <typename T>
+void MathMappedMatrixT<T>::swap(MathMappedMatrixT& other) noexcept
+{
+	std::swap(mapping_, other.mapping_);
+	std::swap(mappingSize_, other.mappingSize_);
+	std::swap(mappingHandle_, other.mappingHandle_);
+	std::swap(data_, other.data_);
+	std::swap(numRows_, other.numRows_);
+	std::swap(numCols_, other.numCols_);
+	std::swap(leadingDimension_, other.leadingDimension_);
+	std::swap(space_, other.space_);
+}
+
+template class MathMappedMatrixT<double>;
+template class MathMappedMatrixT<float>;
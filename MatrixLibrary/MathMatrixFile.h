@@ -0,0 +1,186 @@
+#pragma once
+
+#ifndef __MATH_MATRIX_FILE_H
+#define __MATH_MATRIX_FILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <string>
+#include "MathMatrix.h"
+#include "MathMatrixView.h"
+
+/**
+ * @brief The header at the start of a matrix file.  The header and the elements are in the
+ *     byte order of the machine that saved the file, recorded by @ref endianTag, and a
+ *     machine with the other byte order rejects the file.
+ * @note The file is the header followed by the payload: the vectors of the space the matrix
+ *     is stored as (its columns for COLUMNSPACE, its rows for ROWSPACE), vector i starting
+ *     @ref leadingDimension elements after vector i - 1, exactly like @ref MathMatrix keeps
+ *     them in memory.  Every vector is padded with zeros to whole cache lines and the payload
+ *     starts on a cache line, so a file mapped at a page boundary can be used in place.
+ * @note Readers reject files with a newer @ref version.  Fields added later go into
+ *     @ref reserved, which older versions write as zeros.
+ */
+struct MathMatrixFileHeader
+{
+	char magic[8];
+	uint32_t version;
+	// MATH_MATRIX_FILE_ENDIAN_TAG as written by the saving machine
+	uint32_t endianTag;
+	// MATH_MATRIX_FILE_DOUBLE or MATH_MATRIX_FILE_FLOAT, and sizeof of that type
+	uint32_t elementType;
+	uint32_t elementSize;
+	// ROWSPACE or COLUMNSPACE
+	uint32_t space;
+	uint32_t numRows;
+	uint32_t numCols;
+	uint32_t leadingDimension;
+	// Bytes from the start of the file to the first element, and bytes of elements
+	uint64_t payloadOffset;
+	uint64_t payloadSize;
+	uint8_t reserved[8];
+};
+
+static_assert(sizeof(MathMatrixFileHeader) == 64, "The matrix file header is one cache line");
+
+static constexpr uint32_t MATH_MATRIX_FILE_VERSION = 1;
+static constexpr uint32_t MATH_MATRIX_FILE_ENDIAN_TAG = 0x01020304;
+static constexpr uint32_t MATH_MATRIX_FILE_DOUBLE = 0;
+static constexpr uint32_t MATH_MATRIX_FILE_FLOAT = 1;
+
+/**
+ * @brief Fills in the header of a file for a numRows x numCols matrix of T stored as
+ *     @ref space, with the payload right after the header.
+ * @return false if a vector is too long for the format
+ */
+template <typename T>
+bool makeMatrixFileHeader(unsigned int numRows, unsigned int numCols, vector_space_t space,
+	MathMatrixFileHeader& header);
+
+/**
+ * @brief Reads and checks the header of an open matrix file holding elements of type T.
+ * @return false and leaves @ref header unchanged if the file is not one @ref loadMatrix can read
+ */
+template <typename T>
+bool readMatrixFileHeader(std::istream& file, MathMatrixFileHeader& header);
+
+/**
+ * @brief Whether two paths name the same existing file, however each of them is spelled
+ *     (relative or absolute, through links or with "." and ".." in it).
+ * @return false if either file does not exist or cannot be examined
+ */
+bool isSameFile(const char* first, const char* second);
+
+/**
+ * @brief A path next to @ref path that no other call returns, to write a new version of the file
+ *     at before @ref replaceFile moves it into place.
+ */
+std::string makeTemporaryFilePath(const char* path);
+
+/**
+ * @brief Renames the file at @ref from to @ref to in one step, replacing any file there.
+ *     Whoever has the old file open or mapped keeps reading the old contents.
+ * @return false and removes the file at @ref from if it could not be renamed.  On Windows a
+ *     file that is mapped cannot be replaced, so @ref to is then left as it was.
+ */
+bool replaceFile(const char* from, const char* to);
+
+/**
+ * @brief Writes the elements seen by @ref m to a new matrix file at @ref path, replacing any
+ *     file there.  A view with contiguous rows is saved as ROWSPACE, any other as COLUMNSPACE.
+ * @return false if the file could not be written, leaving any file at @ref path as it was
+ * @note The file is written next to @ref path and then renamed over it, so a
+ *     @ref MathMappedMatrixT of the old file, even the one @ref m views, stays valid.
+ */
+template <typename T>
+bool saveMatrix(const char* path, const MathMatrixViewT<T>& m);
+
+/**
+ * @brief Reads a matrix file into @ref m, copying the elements into memory @ref m owns.
+ * @return false and leaves @ref m unchanged if the file cannot be read, is not a matrix file,
+ *     has a newer version or holds the other element type
+ * @note Use @ref MathMappedMatrixT to use a large file without reading it.
+ */
+template <typename T>
+bool loadMatrix(const char* path, MathMatrixT<T>& m);
+
+/**
+ * @brief A matrix file mapped read only into memory.  Opening one reads only the header, so
+ *     it takes the same time for any size of file, and the elements are used in place.
+ * @note The pages of the payload are read from disk the first time they are touched and are
+ *     the operating system's cached pages of the file, so every process that maps the same
+ *     file shares one copy of them.
+ * @note The view from @ref getView points into the read only mapping.  Writing through it
+ *     crashes.  Copy it into a @ref MathMatrix, or use @ref loadMatrix, to change elements.
+ */
+template <typename T>
+class MathMappedMatrixT
+{
+public:
+
+	MathMappedMatrixT() {}
+	~MathMappedMatrixT() { close(); }
+
+	MathMappedMatrixT(const MathMappedMatrixT& other) = delete;
+	MathMappedMatrixT& operator=(const MathMappedMatrixT& other) = delete;
+	MathMappedMatrixT(MathMappedMatrixT&& other) noexcept { swap(other); }
+	MathMappedMatrixT& operator=(MathMappedMatrixT&& other) noexcept
+	{
+		swap(other);
+		return *this;
+	}
+
+	/**
+	 * @brief Maps the matrix file at @ref path, closing whatever was mapped before.
+	 * @return false and leaves nothing mapped for the same reasons @ref loadMatrix fails
+	 */
+	bool open(const char* path);
+	void close();
+	bool isOpen() const { return mapping_ != nullptr; }
+
+	unsigned int getNumRows() const { return numRows_; }
+	unsigned int getNumCols() const { return numCols_; }
+	vector_space_t getSpaceToRepresentMatrixAs() const { return space_; }
+
+	// Element (row, col) is getData()[row * getRowStride() + col * getColStride()]
+	const T* getData() const { return data_; }
+	size_t getRowStride() const { return (space_ == ROWSPACE) ? leadingDimension_ : 1; }
+	size_t getColStride() const { return (space_ == ROWSPACE) ? 1 : leadingDimension_; }
+
+	T getVal(unsigned int row, unsigned int col) const
+	{
+		return data_[row * getRowStride() + col * getColStride()];
+	}
+
+	// A view of the whole matrix for the functions that take views, to be read only
+	MathMatrixViewT<T> getView() const
+	{
+		return MathMatrixViewT<T>(const_cast<T*>(data_), numRows_, numCols_, getRowStride(), getColStride());
+	}
+
+private:
+
+	void swap(MathMappedMatrixT& other) noexcept;
+
+	// The start of the mapped file and its size in bytes
+	void* mapping_ = nullptr;
+	size_t mappingSize_ = 0;
+
+	// The file mapping object, only used on Windows
+	void* mappingHandle_ = nullptr;
+
+	const T* data_ = nullptr;
+	unsigned int numRows_ = 0;
+	unsigned int numCols_ = 0;
+	size_t leadingDimension_ = 0;
+	vector_space_t space_ = COLUMNSPACE;
+};
+
+typedef MathMappedMatrixT<double> MathMappedMatrix;
+typedef MathMappedMatrixT<float> MathMappedMatrixF;
+
+extern template class MathMappedMatrixT<double>;
+extern template class MathMappedMatrixT<float>;
+
+#endif // __MATH_MATRIX_FILE_H
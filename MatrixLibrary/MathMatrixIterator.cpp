@@ -1,90 +1,45 @@
 #include "pch.h"
 #include "MathMatrixIterator.h"
+#include "MathSimdKernels.h"
 #include <cmath>
 
-MathMatrixIterator::MathMatrixIterator(MathVector * const * const matrixSpace, unsigned int const pos,
-	vector_space_t const matrixSpaceType, vector_space_t const toIterate)
-{
-	ptr_ = matrixSpace;
-	posInVec_ = pos;
-
-	if (matrixSpaceType == toIterate)
-	{
-		access_to_increment = SECOND_ACCESS;
-	}
-	else
-	{
-		access_to_increment = FIRST_ACCESS;
-	}
-}
-
-MathMatrixIterator MathMatrixIterator::operator++()
-{
-	increment(1);
-	return *this;
-}
-
-MathMatrixIterator MathMatrixIterator::operator++(int)
-{
-	MathMatrixIterator tmp(*this);
-	increment(1);
-	return tmp;
-}
-
-double& MathMatrixIterator::operator*()
-{
-	return (**ptr_)[posInVec_];
-}
-
-bool MathMatrixIterator::operator==(const MathMatrixIterator& other) const
-{
-	return (this->ptr_ == other.ptr_ && this->posInVec_ == other.posInVec_ &&
-		this->access_to_increment == other.access_to_increment);
-}
-
-unsigned int MathMatrixIterator::operator-(const MathMatrixIterator& other) const
-{
-	// We can add them since only one should be different and the other should be
-	//     0
-	return (unsigned int)((this->ptr_ - other.ptr_) + (this->posInVec_ - other.posInVec_));
-}
-
 // =============================================================================================
 // OUTSIDE OF CLASS ITERATOR
 // =============================================================================================
 
-double dotProduct(MathMatrixIterator beginItr1, const MathMatrixIterator& endItr1,
-	MathMatrixIterator beginItr2, const MathMatrixIterator& endItr2)
+template <typename T>
+static T dotProductOfIterators(MathMatrixIteratorT<T> beginItr1, const MathMatrixIteratorT<T>& endItr1,
+	MathMatrixIteratorT<T> beginItr2, const MathMatrixIteratorT<T>& endItr2)
 {
-	unsigned int len = (endItr1 - beginItr1);
+	std::ptrdiff_t len = (endItr1 - beginItr1);
 
-	if (endItr2 - beginItr2 != len)
+	if (endItr2 - beginItr2 != len || len < 0)
 	{
 		return NAN;
 	}
 
-	double result = 0.0F;
-	for (unsigned int i = 0; i < len; ++i)
+	// Rows of a ROWSPACE matrix and columns of a COLUMNSPACE matrix are contiguous
+	if (beginItr1.isContiguous() && beginItr2.isContiguous())
 	{
-		result += (*beginItr1)*(*beginItr2);
-		++beginItr1; ++beginItr2;
+		return simdDotProduct(beginItr1.getRawPointer(), beginItr2.getRawPointer(), (size_t)len);
+	}
+
+	T result = 0;
+	for (std::ptrdiff_t i = 0; i < len; ++i)
+	{
+		result += beginItr1[i] * beginItr2[i];
 	}
 	return result;
 }
 
+double dotProduct(MathMatrixIterator beginItr1, const MathMatrixIterator& endItr1,
+	MathMatrixIterator beginItr2, const MathMatrixIterator& endItr2)
+{
+	return dotProductOfIterators(beginItr1, endItr1, beginItr2, endItr2);
+}
 
-// ==============================================================================
-// Private Member functions
-// ==============================================================================
-
-void MathMatrixIterator::increment(int amount)
+float dotProduct(MathMatrixIteratorF beginItr1, const MathMatrixIteratorF& endItr1,
+	MathMatrixIteratorF beginItr2, const MathMatrixIteratorF& endItr2)
 {
-	if (access_to_increment == FIRST_ACCESS)
-	{
-		ptr_ += amount;
-	}
-	else
-	{
-		posInVec_ += amount;
-	}
-}
\ No newline at end of file
+	return dotProductOfIterators(beginItr1, endItr1, beginItr2, endItr2);
+}
@@ -1,40 +1,91 @@
 #pragma once
-#include "MathVector.h"
 
-// Predefintion of Mathmatrix
-class MathMatrix;
+#include <cstddef>
+#include <iterator>
 
-#ifndef VECTOR_SPACE_ENUM_DEFINED_
-	typedef enum { ROWSPACE, COLUMNSPACE } vector_space_t;
-#define VECTOR_SPACE_ENUM_DEFINED_
-#endif
-
-class MathMatrixIterator
+/**
+ * @brief Iterates over a single row or column of a @ref MathMatrix.  The matrix
+ *     is stored in one contiguous buffer so walking a row or column is just
+ *     walking that buffer with a constant stride.  The stride is 1 when the
+ *     iterator walks the direction the matrix is stored in and the leading
+ *     dimension of the matrix otherwise.
+ * @note This is a random access iterator so it works with the algorithms of the
+ *     standard library, for example std::sort(m.rowBegin(0), m.rowEnd(0)).
+ *     Everything is inline so loops over it optimize like loops over a pointer.
+ * @note When @ref isContiguous is true the elements from @ref getRawPointer onwards
+ *     are next to each other in memory and can be handed to code expecting a plain
+ *     array of elements.
+ */
+template <typename T>
+class MathMatrixIteratorT
 {
 public:
-	MathMatrixIterator(MathVector * const * const matrixSpace, unsigned int const pos, 
-		vector_space_t const matrixSpaceType, vector_space_t const toIterate);
+	typedef std::random_access_iterator_tag iterator_category;
+	typedef T value_type;
+	typedef std::ptrdiff_t difference_type;
+	typedef T* pointer;
+	typedef T& reference;
+
+	MathMatrixIteratorT() : base_(nullptr), pos_(0), stride_(1) {}
+	MathMatrixIteratorT(T* const base, std::ptrdiff_t const pos, std::ptrdiff_t const stride)
+		: base_(base), pos_(pos), stride_(stride) {}
+
+	T& operator*() const { return base_[pos_ * stride_]; }
+	T* operator->() const { return base_ + pos_ * stride_; }
+	T& operator[](std::ptrdiff_t n) const { return base_[(pos_ + n) * stride_]; }
+
+	MathMatrixIteratorT& operator++() { ++pos_; return *this; }
+	MathMatrixIteratorT operator++(int) { MathMatrixIteratorT tmp(*this); ++pos_; return tmp; }
+	MathMatrixIteratorT& operator--() { --pos_; return *this; }
+	MathMatrixIteratorT operator--(int) { MathMatrixIteratorT tmp(*this); --pos_; return tmp; }
+
+	MathMatrixIteratorT& operator+=(std::ptrdiff_t n) { pos_ += n; return *this; }
+	MathMatrixIteratorT& operator-=(std::ptrdiff_t n) { pos_ -= n; return *this; }
+	MathMatrixIteratorT operator+(std::ptrdiff_t n) const { return MathMatrixIteratorT(base_, pos_ + n, stride_); }
+	MathMatrixIteratorT operator-(std::ptrdiff_t n) const { return MathMatrixIteratorT(base_, pos_ - n, stride_); }
 
-	MathMatrixIterator operator++();
-	MathMatrixIterator operator++(int);
-	double& operator*();
+	// Both iterators have to walk the same row/column so only the positions differ
+	std::ptrdiff_t operator-(const MathMatrixIteratorT& other) const { return pos_ - other.pos_; }
 
-	bool operator==(const MathMatrixIterator& other) const;
+	bool operator==(const MathMatrixIteratorT& other) const
+	{
+		return base_ == other.base_ && pos_ == other.pos_ && stride_ == other.stride_;
+	}
+	bool operator!=(const MathMatrixIteratorT& other) const { return !(*this == other); }
+	bool operator<(const MathMatrixIteratorT& other) const { return pos_ < other.pos_; }
+	bool operator>(const MathMatrixIteratorT& other) const { return pos_ > other.pos_; }
+	bool operator<=(const MathMatrixIteratorT& other) const { return pos_ <= other.pos_; }
+	bool operator>=(const MathMatrixIteratorT& other) const { return pos_ >= other.pos_; }
 
-	unsigned int operator-(const MathMatrixIterator& other) const;
+	// The address of the element the iterator is at
+	T* getRawPointer() const { return base_ + pos_ * stride_; }
+
+	// The distance in memory between two consecutive elements, 1 if the iterator walks contiguous memory
+	std::ptrdiff_t getStride() const { return stride_; }
+	bool isContiguous() const { return stride_ == 1; }
 
 private:
 
-	void increment(int amount);
+	// The first element of the row/column being iterated over
+	T* base_;
 
-	typedef enum { FIRST_ACCESS, SECOND_ACCESS } access_order_t;
-	
-	MathVector* const *  ptr_;
-	unsigned int posInVec_;
+	// The index of the element in the row/column the iterator is at
+	std::ptrdiff_t pos_;
 
-	access_order_t access_to_increment;
+	// The distance in the buffer between two consecutive elements of the row/column
+	std::ptrdiff_t stride_;
 };
 
+template <typename T>
+inline MathMatrixIteratorT<T> operator+(std::ptrdiff_t n, const MathMatrixIteratorT<T>& itr)
+{
+	return itr + n;
+}
+
+typedef MathMatrixIteratorT<double> MathMatrixIterator;
+typedef MathMatrixIteratorT<float> MathMatrixIteratorF;
+
 double dotProduct(MathMatrixIterator beginItr1, const MathMatrixIterator& endItr1,
 	MathMatrixIterator beginItr2, const MathMatrixIterator& endItr2);
-
+float dotProduct(MathMatrixIteratorF beginItr1, const MathMatrixIteratorF& endItr1,
+	MathMatrixIteratorF beginItr2, const MathMatrixIteratorF& endItr2);
@@ -0,0 +1,638 @@
+#include "pch.h"
+#include "MathMatrixMultiply.h"
+#include "MathArena.h"
+#include "MathSimdKernels.h"
+#include "MathThreadPool.h"
+#include <cmath>
+#include <vector>
+
+// =============================================================================================
+// Blocking parameters
+// =============================================================================================
+
+// The size MR x NR of the block of C computed by one call of the micro-kernel depends on
+//     the instruction set it is written for.  See @ref getGemmMicroKernel.
+
+// The packed KC x NR micro-panel of B should stay in the L1 cache, the packed MC x KC
+//     block of A in the L2 cache and the packed KC x NC panel of B in the L3 cache.
+static constexpr unsigned int GEMM_KC = 256;
+static constexpr unsigned int GEMM_MC = 96;
+static constexpr unsigned int GEMM_NC = 4096;
+
+// Products with fewer multiply-adds than this are not worth packing
+static constexpr size_t GEMM_SMALL_PRODUCT_THRESHOLD = 32 * 32 * 32;
+
+// When the product is split between threads each thread gets about this many tiles of C
+//     so threads that finish early can pick up more work
+static constexpr unsigned int GEMM_TILES_PER_THREAD = 4;
+
+// Tiles of C are never made smaller than this in either direction
+static constexpr unsigned int GEMM_MIN_TILE_SIZE = 32;
+
+// Products with fewer multiply-adds than this run on the calling thread only
+static size_t gemmParallelThreshold = 128 * 128 * 128;
+
+// Matrix vector products read every element of A once, so they are split between threads
+//     once A no longer fits in the L2 cache of one core (2 MB of doubles)
+static constexpr size_t GEMV_PARALLEL_THRESHOLD = 256 * 1024;
+
+// The rows of y handed to one task are a multiple of this so no two tasks write to the
+//     same cache line of y
+static constexpr unsigned int GEMV_ROW_BLOCK = 16;
+
+// The micro-kernel of each element type for the instruction set in use
+template <typename T>
+struct GemmKernelOf;
+
+template <>
+struct GemmKernelOf<double>
+{
+	typedef GemmMicroKernel type;
+	static type get() { return getGemmMicroKernel(); }
+};
+
+template <>
+struct GemmKernelOf<float>
+{
+	typedef GemmMicroKernelF type;
+	static type get() { return getGemmMicroKernelF(); }
+};
+
+// =============================================================================================
+// Packing
+// =============================================================================================
+
+/**
+ * @brief Packs the mc x kc block of A starting at @ref a into micro-panels of MR rows.
+ *     Inside each micro-panel the MR elements of one column are next to each other, which
+ *     is the order the micro-kernel reads them in.  Rows past mc are filled with zeros.
+ */
+template <typename T>
+static void packA(unsigned int mc, unsigned int kc, const T* a, size_t rowStride,
+	size_t colStride, unsigned int MR, T* packed)
+{
+	for (unsigned int ir = 0; ir < mc; ir += MR)
+	{
+		unsigned int mr = (mc - ir < MR) ? mc - ir : MR;
+		T* panel = packed + (size_t)ir * kc;
+
+		if (colStride == 1)
+		{
+			// The rows of A are contiguous (ROWSPACE) so walk along each row
+			for (unsigned int i = 0; i < mr; ++i)
+			{
+				const T* row = a + (ir + i) * rowStride;
+				for (unsigned int p = 0; p < kc; ++p)
+				{
+					panel[p * MR + i] = row[p];
+				}
+			}
+		}
+		else
+		{
+			// The columns of A are contiguous (COLUMNSPACE) so walk down each column
+			for (unsigned int p = 0; p < kc; ++p)
+			{
+				const T* col = a + p * colStride + ir * rowStride;
+				for (unsigned int i = 0; i < mr; ++i)
+				{
+					panel[p * MR + i] = col[i * rowStride];
+				}
+			}
+		}
+
+		for (unsigned int i = mr; i < MR; ++i)
+		{
+			for (unsigned int p = 0; p < kc; ++p)
+			{
+				panel[p * MR + i] = 0;
+			}
+		}
+	}
+}
+
+/**
+ * @brief Packs the kc x nc panel of B starting at @ref b into micro-panels of NR
+ *     columns.  Inside each micro-panel the NR elements of one row are next to each other.
+ *     Columns past nc are filled with zeros.
+ */
+template <typename T>
+static void packB(unsigned int kc, unsigned int nc, const T* b, size_t rowStride,
+	size_t colStride, unsigned int NR, T* packed)
+{
+	for (unsigned int jr = 0; jr < nc; jr += NR)
+	{
+		unsigned int nr = (nc - jr < NR) ? nc - jr : NR;
+		T* panel = packed + (size_t)jr * kc;
+
+		if (colStride == 1)
+		{
+			// The rows of B are contiguous (ROWSPACE) so copy a piece of each row
+			for (unsigned int p = 0; p < kc; ++p)
+			{
+				const T* row = b + p * rowStride + jr;
+				for (unsigned int j = 0; j < nr; ++j)
+				{
+					panel[p * NR + j] = row[j];
+				}
+				for (unsigned int j = nr; j < NR; ++j)
+				{
+					panel[p * NR + j] = 0;
+				}
+			}
+		}
+		else
+		{
+			// The columns of B are contiguous (COLUMNSPACE) so walk down each column
+			for (unsigned int j = 0; j < nr; ++j)
+			{
+				const T* col = b + (jr + j) * colStride;
+				for (unsigned int p = 0; p < kc; ++p)
+				{
+					panel[p * NR + j] = col[p * rowStride];
+				}
+			}
+			for (unsigned int j = nr; j < NR; ++j)
+			{
+				for (unsigned int p = 0; p < kc; ++p)
+				{
+					panel[p * NR + j] = 0;
+				}
+			}
+		}
+	}
+}
+
+// =============================================================================================
+// Kernels
+// =============================================================================================
+
+/**
+ * @brief Multiplies a packed mc x kc block of A by a packed kc x nc panel of B into C one
+ *     micro-kernel at a time.  Blocks on the bottom and right edge that are smaller than
+ *     MR x NR are computed into a temporary block and then added to C.
+ */
+template <typename T>
+static void macroKernel(const typename GemmKernelOf<T>::type& microKernel, unsigned int mc, unsigned int nc,
+	unsigned int kc, T alpha, const T* packedA, const T* packedB, T beta,
+	T* c, size_t rowStride, size_t colStride)
+{
+	const unsigned int MR = microKernel.mr;
+	const unsigned int NR = microKernel.nr;
+	T edge[GEMM_MAX_MR * GEMM_MAX_NR];
+
+	for (unsigned int jr = 0; jr < nc; jr += NR)
+	{
+		unsigned int nr = (nc - jr < NR) ? nc - jr : NR;
+
+		for (unsigned int ir = 0; ir < mc; ir += MR)
+		{
+			unsigned int mr = (mc - ir < MR) ? mc - ir : MR;
+			T* cBlock = c + ir * rowStride + jr * colStride;
+
+			if (mr == MR && nr == NR)
+			{
+				microKernel.kernel(kc, alpha, packedA + (size_t)ir * kc, packedB + (size_t)jr * kc,
+					beta, cBlock, rowStride, colStride);
+			}
+			else
+			{
+				microKernel.kernel(kc, alpha, packedA + (size_t)ir * kc, packedB + (size_t)jr * kc,
+					0, edge, NR, 1);
+
+				for (unsigned int i = 0; i < mr; ++i)
+				{
+					for (unsigned int j = 0; j < nr; ++j)
+					{
+						T& cij = cBlock[i * rowStride + j * colStride];
+						cij = (beta == 0) ? edge[i * NR + j] : beta * cij + edge[i * NR + j];
+					}
+				}
+			}
+		}
+	}
+}
+
+/**
+ * @brief The small product for A with contiguous columns.  Each column of C is built as
+ *     beta times itself plus a sum of columns of A scaled by elements of B, one SIMD axpy
+ *     per column of A.  Columns of C that are not contiguous are built in a buffer first.
+ * @note Called with A and B swapped and every stride pair swapped this computes
+ *     C^T = B^T * A^T, which builds the rows of C from contiguous rows of B.
+ */
+template <typename T>
+static void smallGemmByColumns(unsigned int m, unsigned int n, unsigned int k, T alpha,
+	const T* a, size_t aColStride, const T* b, size_t bRowStride, size_t bColStride,
+	T beta, T* c, size_t cRowStride, size_t cColStride)
+{
+	static thread_local std::vector<T, MathAlignedAllocator<T>> buffer;
+	bool direct = (cRowStride == 1);
+	if (!direct && buffer.size() < m)
+	{
+		buffer.resize(m);
+	}
+
+	for (unsigned int j = 0; j < n; ++j)
+	{
+		T* cj = direct ? c + j * cColStride : buffer.data();
+		if (!direct || beta == 0)
+		{
+			for (unsigned int i = 0; i < m; ++i) cj[i] = 0;
+		}
+		else if (beta != 1)
+		{
+			simdScale(beta, cj, m);
+		}
+
+		for (unsigned int p = 0; p < k; ++p)
+		{
+			simdAxpy(alpha * b[p * bRowStride + j * bColStride], a + p * aColStride, cj, m);
+		}
+
+		if (!direct)
+		{
+			for (unsigned int i = 0; i < m; ++i)
+			{
+				T& cij = c[i * cRowStride + j * cColStride];
+				cij = (beta == 0) ? cj[i] : beta * cij + cj[i];
+			}
+		}
+	}
+}
+
+/**
+ * @brief Product used when the operands are too small for packing to pay off.  The loops
+ *     are ordered from the layouts of the operands so the innermost one runs a SIMD kernel
+ *     over contiguous memory whenever A or B allows it.
+ * @note Building columns of C from columns of A or rows of C from rows of B is preferred
+ *     when C is contiguous the same way, then dot products of contiguous rows of A and
+ *     columns of B, then the column or row form through a buffer.  Only operands with no
+ *     contiguous direction at all fall back to scalar loops.
+ */
+template <typename T>
+static void smallGemm(unsigned int m, unsigned int n, unsigned int k, T alpha,
+	const T* a, size_t aRowStride, size_t aColStride,
+	const T* b, size_t bRowStride, size_t bColStride,
+	T beta, T* c, size_t cRowStride, size_t cColStride)
+{
+	bool dotProductsAreContiguous = (aColStride == 1 && bRowStride == 1);
+
+	bool byColumns = (aRowStride == 1 && cRowStride == 1);
+	bool byRows = !byColumns && bColStride == 1 && cColStride == 1;
+	if (!byColumns && !byRows && !dotProductsAreContiguous)
+	{
+		byColumns = (aRowStride == 1);
+		byRows = !byColumns && bColStride == 1;
+	}
+
+	if (byColumns)
+	{
+		smallGemmByColumns(m, n, k, alpha, a, aColStride, b, bRowStride, bColStride,
+			beta, c, cRowStride, cColStride);
+		return;
+	}
+	if (byRows)
+	{
+		smallGemmByColumns(n, m, k, alpha, b, bRowStride, a, aColStride, aRowStride,
+			beta, c, cColStride, cRowStride);
+		return;
+	}
+
+	for (unsigned int j = 0; j < n; ++j)
+	{
+		for (unsigned int i = 0; i < m; ++i)
+		{
+			T sum = 0;
+			if (dotProductsAreContiguous)
+			{
+				sum = simdDotProduct(a + i * aRowStride, b + j * bColStride, k);
+			}
+			else
+			{
+				for (unsigned int p = 0; p < k; ++p)
+				{
+					sum += a[i * aRowStride + p * aColStride] * b[p * bRowStride + j * bColStride];
+				}
+			}
+			T& cij = c[i * cRowStride + j * cColStride];
+			cij = (beta == 0) ? alpha * sum : beta * cij + alpha * sum;
+		}
+	}
+}
+
+/**
+ * @brief Runs the whole blocked product on the calling thread
+ */
+template <typename T>
+static void serialGemm(const typename GemmKernelOf<T>::type& microKernel,
+	unsigned int m, unsigned int n, unsigned int k, T alpha,
+	const T* a, size_t aRowStride, size_t aColStride,
+	const T* b, size_t bRowStride, size_t bColStride,
+	T beta, T* c, size_t cRowStride, size_t cColStride)
+{
+	if (m == 0 || n == 0)
+	{
+		return;
+	}
+
+	if (k == 0 || alpha == 0)
+	{
+		// Nothing to multiply so C just gets scaled
+		for (unsigned int j = 0; j < n; ++j)
+		{
+			for (unsigned int i = 0; i < m; ++i)
+			{
+				T& cij = c[i * cRowStride + j * cColStride];
+				cij = (beta == 0) ? 0 : beta * cij;
+			}
+		}
+		return;
+	}
+
+	if ((size_t)m * n * k <= GEMM_SMALL_PRODUCT_THRESHOLD)
+	{
+		smallGemm(m, n, k, alpha, a, aRowStride, aColStride, b, bRowStride, bColStride,
+			beta, c, cRowStride, cColStride);
+		return;
+	}
+
+	// The packing buffers start on a cache line and are kept around between calls so
+	//     repeated products do not allocate
+	static thread_local std::vector<T, MathAlignedAllocator<T>> packedA;
+	static thread_local std::vector<T, MathAlignedAllocator<T>> packedB;
+
+	const unsigned int MR = microKernel.mr;
+	const unsigned int NR = microKernel.nr;
+
+	unsigned int ncMax = (n < GEMM_NC) ? n : GEMM_NC;
+	unsigned int kcMax = (k < GEMM_KC) ? k : GEMM_KC;
+	unsigned int mcMax = (m < GEMM_MC) ? m : GEMM_MC;
+
+	size_t packedASize = (size_t)((mcMax + MR - 1) / MR) * MR * kcMax;
+	size_t packedBSize = (size_t)((ncMax + NR - 1) / NR) * NR * kcMax;
+	if (packedA.size() < packedASize) packedA.resize(packedASize);
+	if (packedB.size() < packedBSize) packedB.resize(packedBSize);
+
+	for (unsigned int jc = 0; jc < n; jc += GEMM_NC)
+	{
+		unsigned int nc = (n - jc < GEMM_NC) ? n - jc : GEMM_NC;
+
+		for (unsigned int pc = 0; pc < k; pc += GEMM_KC)
+		{
+			unsigned int kc = (k - pc < GEMM_KC) ? k - pc : GEMM_KC;
+
+			// Only the first block along k applies beta, the rest accumulate into C
+			T betaForBlock = (pc == 0) ? beta : 1;
+
+			packB(kc, nc, b + pc * bRowStride + jc * bColStride, bRowStride, bColStride,
+				NR, packedB.data());
+
+			for (unsigned int ic = 0; ic < m; ic += GEMM_MC)
+			{
+				unsigned int mc = (m - ic < GEMM_MC) ? m - ic : GEMM_MC;
+
+				packA(mc, kc, a + ic * aRowStride + pc * aColStride, aRowStride, aColStride,
+					MR, packedA.data());
+
+				macroKernel(microKernel, mc, nc, kc, alpha, packedA.data(), packedB.data(), betaForBlock,
+					c + ic * cRowStride + jc * cColStride, cRowStride, cColStride);
+			}
+		}
+	}
+}
+
+static unsigned int roundUpToMultiple(unsigned int value, unsigned int multiple)
+{
+	return ((value + multiple - 1) / multiple) * multiple;
+}
+
+// =============================================================================================
+// Matrix vector products
+// =============================================================================================
+
+/**
+ * @brief y = alpha * A * x + beta * y for rows first up to last of A and y, with x and y
+ *     contiguous.  Rows of A that are contiguous are dot products with x.  Otherwise the
+ *     columns of A are contiguous and the rows are built as a sum of pieces of the columns
+ *     of A, one axpy per column, which keeps the piece of y in L1 while A streams through.
+ */
+template <typename T>
+static void gemvRows(unsigned int first, unsigned int last, unsigned int n, T alpha,
+	const T* a, size_t aRowStride, size_t aColStride, const T* x, T beta, T* y)
+{
+	if (aColStride == 1)
+	{
+		for (unsigned int i = first; i < last; ++i)
+		{
+			T dot = simdDotProduct(a + i * aRowStride, x, n);
+			y[i] = (beta == 0) ? alpha * dot : alpha * dot + beta * y[i];
+		}
+		return;
+	}
+
+	unsigned int numRows = last - first;
+	if (beta == 0)
+	{
+		for (unsigned int i = first; i < last; ++i) y[i] = 0;
+	}
+	else if (beta != 1)
+	{
+		simdScale(beta, y + first, numRows);
+	}
+	for (unsigned int j = 0; j < n; ++j)
+	{
+		simdAxpy(alpha * x[j], a + j * aColStride + first, y + first, numRows);
+	}
+}
+
+/**
+ * @brief y = alpha * A * x + beta * y for either element type.  A strided x is gathered and
+ *     a strided y computed into contiguous buffers first so the kernels always run on
+ *     contiguous vectors.  Large products split the rows of y between the threads.
+ */
+template <typename T>
+static void gemvT(unsigned int m, unsigned int n, T alpha,
+	const T* a, size_t aRowStride, size_t aColStride, const T* x, size_t xStride,
+	T beta, T* y, size_t yStride)
+{
+	if (m == 0)
+	{
+		return;
+	}
+
+	// Neither direction of A is contiguous, so make the columns contiguous in a copy
+	std::vector<T, MathAlignedAllocator<T>> aCopy;
+	if (aRowStride != 1 && aColStride != 1)
+	{
+		aCopy.resize((size_t)m * n);
+		for (unsigned int j = 0; j < n; ++j)
+		{
+			for (unsigned int i = 0; i < m; ++i) aCopy[(size_t)j * m + i] = a[i * aRowStride + j * aColStride];
+		}
+		a = aCopy.data();
+		aRowStride = 1;
+		aColStride = m;
+	}
+
+	std::vector<T, MathAlignedAllocator<T>> xCopy;
+	if (xStride != 1 && n > 0)
+	{
+		xCopy.resize(n);
+		for (unsigned int j = 0; j < n; ++j) xCopy[j] = x[j * xStride];
+		x = xCopy.data();
+	}
+
+	std::vector<T, MathAlignedAllocator<T>> yCopy;
+	T* yContiguous = y;
+	if (yStride != 1)
+	{
+		yCopy.resize(m);
+		if (beta != 0)
+		{
+			for (unsigned int i = 0; i < m; ++i) yCopy[i] = y[i * yStride];
+		}
+		yContiguous = yCopy.data();
+	}
+
+	MathThreadPool& pool = MathThreadPool::getInstance();
+	unsigned int numThreads = pool.getNumThreads();
+
+	if (numThreads == 1 || (size_t)m * n < GEMV_PARALLEL_THRESHOLD)
+	{
+		gemvRows(0, m, n, alpha, a, aRowStride, aColStride, x, beta, yContiguous);
+	}
+	else
+	{
+		unsigned int numTasks = numThreads * GEMM_TILES_PER_THREAD;
+		unsigned int rowsPerTask = roundUpToMultiple((m + numTasks - 1) / numTasks, GEMV_ROW_BLOCK);
+		numTasks = (m + rowsPerTask - 1) / rowsPerTask;
+
+		pool.parallelFor(numTasks, [&](unsigned int task)
+		{
+			unsigned int first = task * rowsPerTask;
+			unsigned int last = (m - first < rowsPerTask) ? m : first + rowsPerTask;
+			gemvRows(first, last, n, alpha, a, aRowStride, aColStride, x, beta, yContiguous);
+		});
+	}
+
+	if (yStride != 1)
+	{
+		for (unsigned int i = 0; i < m; ++i) y[i * yStride] = yContiguous[i];
+	}
+}
+
+// =============================================================================================
+// Outside of class functions
+// =============================================================================================
+
+/**
+ * @brief The product for either element type.  Only the micro-kernel and the packed buffers
+ *     depend on it, the blocking and the split between threads are the same.
+ */
+template <typename T>
+static void parallelGemm(unsigned int m, unsigned int n, unsigned int k, T alpha,
+	const T* a, size_t aRowStride, size_t aColStride,
+	const T* b, size_t bRowStride, size_t bColStride,
+	T beta, T* c, size_t cRowStride, size_t cColStride)
+{
+	// A product with one column or one row of C is a matrix vector product, which has
+	//     nothing to gain from packing since every element of A is used once
+	if (n == 1 && k > 0)
+	{
+		gemvT(m, k, alpha, a, aRowStride, aColStride, b, bRowStride, beta, c, cRowStride);
+		return;
+	}
+	if (m == 1 && k > 0)
+	{
+		gemvT(n, k, alpha, b, bColStride, bRowStride, a, aColStride, beta, c, cColStride);
+		return;
+	}
+
+	MathThreadPool& pool = MathThreadPool::getInstance();
+	unsigned int numThreads = pool.getNumThreads();
+
+	// Every tile of one product is packed for and computed with the same micro-kernel
+	typename GemmKernelOf<T>::type microKernel = GemmKernelOf<T>::get();
+
+	if (numThreads == 1 || (size_t)m * n * k < gemmParallelThreshold)
+	{
+		serialGemm(microKernel, m, n, k, alpha, a, aRowStride, aColStride, b, bRowStride, bColStride,
+			beta, c, cRowStride, cColStride);
+		return;
+	}
+
+	// Split C into a grid of tiles with about as many tiles down as across relative to the
+	//     shape of C.  Every tile is an independent product of a block of rows of A with a
+	//     block of columns of B so no two threads ever write the same element.
+	unsigned int targetNumTiles = numThreads * GEMM_TILES_PER_THREAD;
+	unsigned int tilesDown = (unsigned int)(std::sqrt((double)targetNumTiles * m / n) + 0.5);
+	if (tilesDown == 0) tilesDown = 1;
+	unsigned int tilesAcross = (targetNumTiles + tilesDown - 1) / tilesDown;
+
+	unsigned int tileRows = roundUpToMultiple((m + tilesDown - 1) / tilesDown, microKernel.mr);
+	unsigned int tileCols = roundUpToMultiple((n + tilesAcross - 1) / tilesAcross, microKernel.nr);
+	if (tileRows < GEMM_MIN_TILE_SIZE) tileRows = GEMM_MIN_TILE_SIZE;
+	if (tileCols < GEMM_MIN_TILE_SIZE) tileCols = GEMM_MIN_TILE_SIZE;
+
+	tilesDown = (m + tileRows - 1) / tileRows;
+	tilesAcross = (n + tileCols - 1) / tileCols;
+
+	pool.parallelFor(tilesDown * tilesAcross, [&](unsigned int tile)
+	{
+		unsigned int i0 = (tile % tilesDown) * tileRows;
+		unsigned int j0 = (tile / tilesDown) * tileCols;
+		unsigned int mt = (m - i0 < tileRows) ? m - i0 : tileRows;
+		unsigned int nt = (n - j0 < tileCols) ? n - j0 : tileCols;
+
+		serialGemm(microKernel, mt, nt, k, alpha, a + i0 * aRowStride, aRowStride, aColStride,
+			b + j0 * bColStride, bRowStride, bColStride,
+			beta, c + i0 * cRowStride + j0 * cColStride, cRowStride, cColStride);
+	});
+}
+
+void gemm(unsigned int m, unsigned int n, unsigned int k, double alpha,
+	const double* a, size_t aRowStride, size_t aColStride,
+	const double* b, size_t bRowStride, size_t bColStride,
+	double beta, double* c, size_t cRowStride, size_t cColStride)
+{
+	parallelGemm(m, n, k, alpha, a, aRowStride, aColStride, b, bRowStride, bColStride,
+		beta, c, cRowStride, cColStride);
+}
+
+void gemm(unsigned int m, unsigned int n, unsigned int k, float alpha,
+	const float* a, size_t aRowStride, size_t aColStride,
+	const float* b, size_t bRowStride, size_t bColStride,
+	float beta, float* c, size_t cRowStride, size_t cColStride)
+{
+	parallelGemm(m, n, k, alpha, a, aRowStride, aColStride, b, bRowStride, bColStride,
+		beta, c, cRowStride, cColStride);
+}
+
+void gemv(unsigned int m, unsigned int n, double alpha,
+	const double* a, size_t aRowStride, size_t aColStride, const double* x, size_t xStride,
+	double beta, double* y, size_t yStride)
+{
+	gemvT(m, n, alpha, a, aRowStride, aColStride, x, xStride, beta, y, yStride);
+}
+
+void gemv(unsigned int m, unsigned int n, float alpha,
+	const float* a, size_t aRowStride, size_t aColStride, const float* x, size_t xStride,
+	float beta, float* y, size_t yStride)
+{
+	gemvT(m, n, alpha, a, aRowStride, aColStride, x, xStride, beta, y, yStride);
+}
+
+/**
+ * @brief Sets the number of multiply-adds (m * n * k) below which @ref gemm runs on the
+ *     calling thread only.  Threads are only worth waking up for products big enough
+ *     to hide the cost of handing out the work.
+ */
+void setGemmParallelThreshold(size_t numMultiplyAdds)
+{
+	gemmParallelThreshold = numMultiplyAdds;
+}
+
+size_t getGemmParallelThreshold()
+{
+	return gemmParallelThreshold;
+}
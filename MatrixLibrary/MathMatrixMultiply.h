@@ -0,0 +1,57 @@
+#pragma once
+
+#ifndef __MATH_MATRIX_MULTIPLY_H
+#define __MATH_MATRIX_MULTIPLY_H
+
+#include <cstddef>
+
+/**
+ * @brief General matrix multiplication, C = alpha * A * B + beta * C, where A is m x k,
+ *     B is k x n and C is m x n.
+ * @note Every operand is given as a pointer to its first element and the distance in
+ *     memory between two consecutive rows and two consecutive columns.  Element (i, j) of
+ *     A is a[i * aRowStride + j * aColStride].  This is exactly how @ref MathMatrix stores
+ *     itself so any combination of ROWSPACE and COLUMNSPACE operands can be passed through
+ *     getData(), getRowStride() and getColStride() without copying.  Passing the strides
+ *     swapped multiplies by the transpose.
+ * @note The product is computed by packing blocks of A and panels of B into contiguous
+ *     buffers sized for the L2 and L1 caches and running a register tiled micro-kernel over
+ *     the packed data.  The packing routine used for each operand depends on which of its
+ *     strides is the contiguous one.
+ * @note If beta is 0 then C is never read, so C may hold uninitialized memory.
+ */
+void gemm(unsigned int m, unsigned int n, unsigned int k, double alpha,
+	const double* a, size_t aRowStride, size_t aColStride,
+	const double* b, size_t bRowStride, size_t bColStride,
+	double beta, double* c, size_t cRowStride, size_t cColStride);
+
+// The same product in single precision, run with the float micro-kernel of the instruction set
+void gemm(unsigned int m, unsigned int n, unsigned int k, float alpha,
+	const float* a, size_t aRowStride, size_t aColStride,
+	const float* b, size_t bRowStride, size_t bColStride,
+	float beta, float* c, size_t cRowStride, size_t cColStride);
+
+/**
+ * @brief Matrix vector multiplication, y = alpha * A * x + beta * y, where A is m x n with
+ *     the same layout rule as @ref gemm and element i of x and y is x[i * xStride] and
+ *     y[i * yStride].
+ * @note A with contiguous rows (ROWSPACE) is multiplied with one SIMD dot product per row
+ *     and A with contiguous columns (COLUMNSPACE) with one SIMD axpy per column.  Large
+ *     products split the rows of y between the threads of @ref MathThreadPool.
+ * @note @ref gemm hands products with a single row or column of C to this function.
+ * @note If beta is 0 then y is never read.  y must not overlap A or x.
+ */
+void gemv(unsigned int m, unsigned int n, double alpha,
+	const double* a, size_t aRowStride, size_t aColStride, const double* x, size_t xStride,
+	double beta, double* y, size_t yStride);
+void gemv(unsigned int m, unsigned int n, float alpha,
+	const float* a, size_t aRowStride, size_t aColStride, const float* x, size_t xStride,
+	float beta, float* y, size_t yStride);
+
+// Products of at least this many multiply-adds are split into tiles of C and computed by
+//     the threads of @ref MathThreadPool.  The number of threads is set through
+//     MathThreadPool::getInstance().setNumThreads().
+void setGemmParallelThreshold(size_t numMultiplyAdds);
+size_t getGemmParallelThreshold();
+
+#endif // __MATH_MATRIX_MULTIPLY_H
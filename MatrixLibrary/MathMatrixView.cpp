@@ -0,0 +1,388 @@
+#include "pch.h"
+#include "MathMatrixView.h"
+#include "MathMatrix.h"
+#include "MathMatrixMultiply.h"
+#include <cmath>
+
+template <typename T>
+MathMatrixViewT<T>::MathMatrixViewT()
+{
+	data_ = nullptr;
+	numRows_ = numCols_ = 0;
+	rowStride_ = colStride_ = 0;
+}
+
+template <typename T>
+MathMatrixViewT<T>::MathMatrixViewT(T* const data, unsigned int const numRows,
+	unsigned int const numCols, size_t const rowStride, size_t const colStride)
+{
+	data_ = data;
+	numRows_ = numRows;
+	numCols_ = numCols;
+	rowStride_ = rowStride;
+	colStride_ = colStride;
+}
+
+template <typename T>
+MathMatrixViewT<T>::MathMatrixViewT(const MathMatrixT<T>& m)
+{
+	data_ = m.getData();
+	numRows_ = m.getNumRowsInOperationSize();
+	numCols_ = m.getNumColsInOperationSize();
+	rowStride_ = m.getRowStride();
+	colStride_ = m.getColStride();
+
+	if (data_ == nullptr)
+	{
+		numRows_ = numCols_ = 0;
+	}
+}
+
+template <typename T>
+T MathMatrixViewT<T>::getVal(unsigned int row, unsigned int col) const
+{
+	if (row >= numRows_ || col >= numCols_) { return NAN; }
+
+	return elementAt(row, col);
+}
+template <typename T>
+bool MathMatrixViewT<T>::setVal(unsigned int row, unsigned int col, T valueToSetTo) const
+{
+	if (row >= numRows_ || col >= numCols_) { return false; }
+
+	elementAt(row, col) = valueToSetTo;
+
+	return true;
+}
+
+/**
+ * @brief Compares the view to 2d initializer lists.  Each inner initialzer list will be
+ *     treated as a row of the view
+ */
+template <typename T>
+bool MathMatrixViewT<T>::equals(const std::initializer_list<std::initializer_list<T>>& other) const
+{
+	if (numRows_ != other.size()) return false;
+
+	unsigned int r = 0;
+	for (const std::initializer_list<T>& row : other)
+	{
+		if (row.size() != numCols_) return false;
+
+		unsigned int c = 0;
+		for (T val : row)
+		{
+			if (val != elementAt(r, c)) return false;
+			++c;
+		}
+		++r;
+	}
+	return true;
+}
+
+/**
+ * @brief Views the numRows x numCols block of this view whose top left element is
+ *     (rowOffset, colOffset).
+ * @return An empty view if the block does not fit inside this view
+ */
+template <typename T>
+MathMatrixViewT<T> MathMatrixViewT<T>::getSubView(unsigned int rowOffset, unsigned int colOffset,
+	unsigned int numRows, unsigned int numCols) const
+{
+	if (rowOffset > numRows_ || numRows > numRows_ - rowOffset ||
+		colOffset > numCols_ || numCols > numCols_ - colOffset)
+	{
+		return MathMatrixViewT();
+	}
+	return MathMatrixViewT(data_ + rowOffset * rowStride_ + colOffset * colStride_,
+		numRows, numCols, rowStride_, colStride_);
+}
+
+template <typename T>
+MathVectorViewT<T> MathMatrixViewT<T>::getRow(unsigned int row) const
+{
+	if (row >= numRows_) return MathVectorViewT<T>();
+
+	return MathVectorViewT<T>(data_ + row * rowStride_, numCols_, (std::ptrdiff_t)colStride_);
+}
+template <typename T>
+MathVectorViewT<T> MathMatrixViewT<T>::getCol(unsigned int col) const
+{
+	if (col >= numCols_) return MathVectorViewT<T>();
+
+	return MathVectorViewT<T>(data_ + col * colStride_, numRows_, (std::ptrdiff_t)rowStride_);
+}
+
+//======================================================================
+// Math related operations
+//======================================================================
+
+template <typename T>
+bool MathMatrixViewT<T>::swapRows(unsigned int rowNum1, unsigned int rowNum2) const
+{
+	// Check the bounds first
+	if (rowNum1 >= numRows_ || rowNum2 >= numRows_)
+	{
+		return false;
+	}
+
+	T* row1 = data_ + rowNum1 * rowStride_;
+	T* row2 = data_ + rowNum2 * rowStride_;
+
+	// Now swap each of the elements
+	T temp;
+	for (unsigned int c = 0; c < numCols_; ++c)
+	{
+		temp = row1[c * colStride_];
+		row1[c * colStride_] = row2[c * colStride_];
+		row2[c * colStride_] = temp;
+	}
+	return true;
+}
+template <typename T>
+bool MathMatrixViewT<T>::swapCols(unsigned int colNum1, unsigned int colNum2) const
+{
+	// Check the bounds first
+	if (colNum1 >= numCols_ || colNum2 >= numCols_)
+	{
+		return false;
+	}
+
+	T* col1 = data_ + colNum1 * colStride_;
+	T* col2 = data_ + colNum2 * colStride_;
+
+	// Now swap each of the elements
+	T temp;
+	for (unsigned int r = 0; r < numRows_; ++r)
+	{
+		temp = col1[r * rowStride_];
+		col1[r * rowStride_] = col2[r * rowStride_];
+		col2[r * rowStride_] = temp;
+	}
+	return true;
+}
+
+template <typename T>
+bool MathMatrixViewT<T>::addMultipleOfRow(unsigned int rowNumToAddTo, unsigned int rowNumToAdd,
+	T multiple) const
+{
+	// Check the bounds first
+	if (rowNumToAddTo >= numRows_ || rowNumToAdd >= numRows_)
+	{
+		return false;
+	}
+
+	T* rowToAddTo = data_ + rowNumToAddTo * rowStride_;
+	const T* rowToAdd = data_ + rowNumToAdd * rowStride_;
+
+	for (unsigned int c = 0; c < numCols_; ++c)
+	{
+		rowToAddTo[c * colStride_] += multiple * rowToAdd[c * colStride_];
+	}
+	return true;
+}
+
+template <typename T>
+bool MathMatrixViewT<T>::multiplyRowByConstant(unsigned int row, T constant) const
+{
+	if (row >= numRows_)
+	{
+		return false;
+	}
+
+	T* rowToMultiply = data_ + row * rowStride_;
+
+	for (unsigned int c = 0; c < numCols_; ++c)
+	{
+		rowToMultiply[c * colStride_] *= constant;
+	}
+	return true;
+}
+
+/**
+ * @brief Transposes the view.  Only the extents and strides of the view are swapped, the
+ *     matrix viewed is not touched.
+ */
+template <typename T>
+void MathMatrixViewT<T>::transpose()
+{
+	unsigned int unsignedTemp = numRows_; numRows_ = numCols_; numCols_ = unsignedTemp;
+	size_t strideTemp = rowStride_; rowStride_ = colStride_; colStride_ = strideTemp;
+}
+
+template <typename T>
+MathMatrixIteratorT<T> MathMatrixViewT<T>::rowBegin(unsigned int const row) const
+{
+	return MathMatrixIteratorT<T>(data_ + row * rowStride_, 0, (std::ptrdiff_t)colStride_);
+}
+template <typename T>
+MathMatrixIteratorT<T> MathMatrixViewT<T>::rowEnd(unsigned int const row) const
+{
+	return MathMatrixIteratorT<T>(data_ + row * rowStride_, numCols_, (std::ptrdiff_t)colStride_);
+}
+template <typename T>
+MathMatrixIteratorT<T> MathMatrixViewT<T>::colBegin(unsigned int const col) const
+{
+	return MathMatrixIteratorT<T>(data_ + col * colStride_, 0, (std::ptrdiff_t)rowStride_);
+}
+template <typename T>
+MathMatrixIteratorT<T> MathMatrixViewT<T>::colEnd(unsigned int const col) const
+{
+	return MathMatrixIteratorT<T>(data_ + col * colStride_, numRows_, (std::ptrdiff_t)rowStride_);
+}
+
+template class MathMatrixViewT<double>;
+template class MathMatrixViewT<float>;
+
+// =============================================================================================
+// Outside of class functions
+// =============================================================================================
+
+// Blocks with no side longer than this are copied with a plain double loop.  Two 16 x 16
+//     blocks of doubles take 4 KB so the source and destination both stay in L1.
+static constexpr unsigned int COPY_BLOCK_SIZE = 16;
+
+/**
+ * @brief Copies a numRows x numCols block by halving its longer side until the block is
+ *     small, which keeps both the source and the destination in cache without knowing how
+ *     big the caches are.  The small blocks are walked along the contiguous direction of the
+ *     destination so every cache line written is written in full.
+ */
+template <typename T>
+static void copyBlock(unsigned int numRows, unsigned int numCols,
+	const T* from, size_t fromRowStride, size_t fromColStride,
+	T* to, size_t toRowStride, size_t toColStride)
+{
+	if (numRows > COPY_BLOCK_SIZE || numCols > COPY_BLOCK_SIZE)
+	{
+		if (numRows >= numCols)
+		{
+			unsigned int half = numRows / 2;
+			copyBlock(half, numCols, from, fromRowStride, fromColStride, to, toRowStride, toColStride);
+			copyBlock(numRows - half, numCols, from + half * fromRowStride, fromRowStride, fromColStride,
+				to + half * toRowStride, toRowStride, toColStride);
+		}
+		else
+		{
+			unsigned int half = numCols / 2;
+			copyBlock(numRows, half, from, fromRowStride, fromColStride, to, toRowStride, toColStride);
+			copyBlock(numRows, numCols - half, from + half * fromColStride, fromRowStride, fromColStride,
+				to + half * toColStride, toRowStride, toColStride);
+		}
+		return;
+	}
+
+	if (toColStride == 1)
+	{
+		for (unsigned int r = 0; r < numRows; ++r)
+		{
+			for (unsigned int c = 0; c < numCols; ++c)
+			{
+				to[r * toRowStride + c] = from[r * fromRowStride + c * fromColStride];
+			}
+		}
+	}
+	else
+	{
+		for (unsigned int c = 0; c < numCols; ++c)
+		{
+			for (unsigned int r = 0; r < numRows; ++r)
+			{
+				to[r * toRowStride + c * toColStride] = from[r * fromRowStride + c * fromColStride];
+			}
+		}
+	}
+}
+
+template <typename T>
+static bool copyViewElements(const MathMatrixViewT<T>& from, const MathMatrixViewT<T>& to)
+{
+	if (from.getNumRows() != to.getNumRows() || from.getNumCols() != to.getNumCols())
+	{
+		return false;
+	}
+
+	copyBlock(from.getNumRows(), from.getNumCols(), from.getData(), from.getRowStride(),
+		from.getColStride(), to.getData(), to.getRowStride(), to.getColStride());
+	return true;
+}
+
+template <typename T>
+static MathMatrixT<T> productOfViews(const MathMatrixViewT<T>& v1, const MathMatrixViewT<T>& v2)
+{
+	// If v1 is m x n then v2 must be n x p to be a legal matrix multiplication
+	if (v1.getNumCols() != v2.getNumRows())
+	{
+		return MathMatrixT<T>();
+	}
+
+	MathMatrixT<T> result(v1.getNumRows(), v2.getNumCols());
+	multiply(v1, v2, result.getView(), 1, 0);
+	return result;
+}
+
+template <typename T>
+static bool multiplyViews(const MathMatrixViewT<T>& a, const MathMatrixViewT<T>& b, const MathMatrixViewT<T>& c,
+	T alpha, T beta)
+{
+	if (a.getNumCols() != b.getNumRows() || a.getNumRows() != c.getNumRows() ||
+		b.getNumCols() != c.getNumCols())
+	{
+		return false;
+	}
+
+	// Hand the buffers of every operand straight to the blocked kernel.  The strides
+	//     tell it how each operand is laid out so no copies are made here.
+	gemm(c.getNumRows(), c.getNumCols(), a.getNumCols(), alpha,
+		a.getData(), a.getRowStride(), a.getColStride(),
+		b.getData(), b.getRowStride(), b.getColStride(),
+		beta, c.getData(), c.getRowStride(), c.getColStride());
+	return true;
+}
+
+template <typename T>
+static MathMatrixT<T> productOfTransposedViews(MathMatrixViewT<T> a, MathMatrixViewT<T> b,
+	bool transposeA, bool transposeB)
+{
+	if (transposeA) a.transpose();
+	if (transposeB) b.transpose();
+	return productOfViews(a, b);
+}
+
+MathMatrix operator*(const MathMatrixView& v1, const MathMatrixView& v2)
+{
+	return productOfViews(v1, v2);
+}
+MathMatrixF operator*(const MathMatrixViewF& v1, const MathMatrixViewF& v2)
+{
+	return productOfViews(v1, v2);
+}
+
+bool multiply(const MathMatrixView& a, const MathMatrixView& b, const MathMatrixView& c,
+	double alpha, double beta)
+{
+	return multiplyViews(a, b, c, alpha, beta);
+}
+bool multiply(const MathMatrixViewF& a, const MathMatrixViewF& b, const MathMatrixViewF& c,
+	float alpha, float beta)
+{
+	return multiplyViews(a, b, c, alpha, beta);
+}
+
+MathMatrix multiply(const MathMatrixView& a, const MathMatrixView& b, bool transposeA, bool transposeB)
+{
+	return productOfTransposedViews(a, b, transposeA, transposeB);
+}
+MathMatrixF multiply(const MathMatrixViewF& a, const MathMatrixViewF& b, bool transposeA, bool transposeB)
+{
+	return productOfTransposedViews(a, b, transposeA, transposeB);
+}
+
+bool copyElements(const MathMatrixView& from, const MathMatrixView& to)
+{
+	return copyViewElements(from, to);
+}
+bool copyElements(const MathMatrixViewF& from, const MathMatrixViewF& to)
+{
+	return copyViewElements(from, to);
+}
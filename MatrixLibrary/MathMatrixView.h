@@ -0,0 +1,136 @@
+#pragma once
+
+#ifndef __MATH_MATRIX_VIEW_H
+#define __MATH_MATRIX_VIEW_H
+
+#include <cstddef>
+#include <initializer_list>
+#include "MathMatrixIterator.h"
+#include "MathVectorView.h"
+
+template <typename T>
+class MathMatrixT;
+
+/**
+ * @brief A non-owning window onto a block of a matrix.  Element (row, col) of the view is
+ *     getData()[row * getRowStride() + col * getColStride()], the same layout rule
+ *     @ref MathMatrix uses for its own buffer, so a view can start at any row and column
+ *     offset of a matrix, cover any number of rows and columns of it, and be transposed,
+ *     without allocating or copying.
+ * @note This generalizes the operation size of a MathMatrix, which can only shrink the
+ *     matrix from the bottom right.  MathMatrix::getView() is exactly the part of the matrix
+ *     its operations see.
+ * @note The view does not keep the matrix alive.  It is invalidated like a pointer when the
+ *     matrix is destroyed or reallocates, for example when a row or column is added.
+ * @note Views are shallow.  The const functions that change elements, like setVal, change
+ *     the elements of the matrix viewed, not the view itself.
+ */
+template <typename T>
+class MathMatrixViewT
+{
+public:
+
+	typedef T value_type;
+
+	MathMatrixViewT();
+	MathMatrixViewT(T* const data, unsigned int const numRows, unsigned int const numCols,
+		size_t const rowStride, size_t const colStride);
+
+	// Views the operation size of @ref m
+	MathMatrixViewT(const MathMatrixT<T>& m);
+
+	T getVal(unsigned int row, unsigned int col) const;
+	bool setVal(unsigned int row, unsigned int col, T valueToSetTo) const;
+
+	unsigned int getNumRows() const { return numRows_; }
+	unsigned int getNumCols() const { return numCols_; }
+
+	T* getData() const { return data_; }
+	size_t getRowStride() const { return rowStride_; }
+	size_t getColStride() const { return colStride_; }
+
+	bool equals(const std::initializer_list<std::initializer_list<T>>& other) const;
+
+	MathMatrixViewT getSubView(unsigned int rowOffset, unsigned int colOffset,
+		unsigned int numRows, unsigned int numCols) const;
+
+	MathVectorViewT<T> getRow(unsigned int row) const;
+	MathVectorViewT<T> getCol(unsigned int col) const;
+
+	// Math related operations
+
+	bool swapRows(unsigned int rowNum1, unsigned int rowNum2) const;
+	bool swapCols(unsigned int colNum1, unsigned int colNum2) const;
+
+	bool addMultipleOfRow(unsigned int rowNumToAddTo, unsigned int rowNumToAdd,
+		T multiple) const;
+
+	bool multiplyRowByConstant(unsigned int row, T constant) const;
+
+	void transpose();
+
+	// Iterator functions
+
+	MathMatrixIteratorT<T> rowBegin(unsigned int const row) const;
+	MathMatrixIteratorT<T> rowEnd(unsigned int const row) const;
+	MathMatrixIteratorT<T> colBegin(unsigned int const col) const;
+	MathMatrixIteratorT<T> colEnd(unsigned int const col) const;
+
+private:
+
+	T& elementAt(unsigned int row, unsigned int col) const
+	{
+		return data_[row * rowStride_ + col * colStride_];
+	}
+
+	// The first element of the view
+	T* data_;
+
+	unsigned int numRows_;
+	unsigned int numCols_;
+
+	// The distance in memory between two consecutive rows and two consecutive columns
+	size_t rowStride_;
+	size_t colStride_;
+};
+
+typedef MathMatrixViewT<double> MathMatrixView;
+typedef MathMatrixViewT<float> MathMatrixViewF;
+
+extern template class MathMatrixViewT<double>;
+extern template class MathMatrixViewT<float>;
+
+MathMatrixT<double> operator*(const MathMatrixView& v1, const MathMatrixView& v2);
+MathMatrixT<float> operator*(const MathMatrixViewF& v1, const MathMatrixViewF& v2);
+
+/**
+ * @brief c = alpha * a * b + beta * c written straight into the elements viewed by @ref c.
+ *     Nothing is allocated, so blocked algorithms can update a block of a matrix in place.
+ * @return false and changes nothing if the sizes do not match
+ * @note @ref c must not overlap @ref a or @ref b
+ */
+bool multiply(const MathMatrixView& a, const MathMatrixView& b, const MathMatrixView& c,
+	double alpha = 1.0, double beta = 0.0);
+bool multiply(const MathMatrixViewF& a, const MathMatrixViewF& b, const MathMatrixViewF& c,
+	float alpha = 1.0f, float beta = 0.0f);
+
+/**
+ * @brief The product op(a) * op(b), where op transposes its operand when the flag for it is
+ *     set.  Transposing only swaps the strides of a view so nothing is copied, and the
+ *     product reads every operand in the direction it is stored in whatever the flags are.
+ * @return an empty matrix if the sizes do not match
+ */
+MathMatrixT<double> multiply(const MathMatrixView& a, const MathMatrixView& b, bool transposeA, bool transposeB);
+MathMatrixT<float> multiply(const MathMatrixViewF& a, const MathMatrixViewF& b, bool transposeA, bool transposeB);
+
+/**
+ * @brief Copies the elements of @ref from into the elements of @ref to with a cache
+ *     oblivious blocked walk.  When the two are laid out differently this is a relayout,
+ *     and copying a transposed view is a physical transpose.
+ * @return false and changes nothing if the sizes do not match
+ * @note @ref from and @ref to must not overlap
+ */
+bool copyElements(const MathMatrixView& from, const MathMatrixView& to);
+bool copyElements(const MathMatrixViewF& from, const MathMatrixViewF& to);
+
+#endif // __MATH_MATRIX_VIEW_H
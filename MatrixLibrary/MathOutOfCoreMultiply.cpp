@@ -0,0 +1,216 @@
+#include "pch.h"
+#include "MathOutOfCoreMultiply.h"
+#include "MathMatrixFile.h"
+#include "MathMatrixMultiply.h"
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <future>
+#include <string>
+
+// Tiles at least this large are a multiple of it, the depth of the blocks @ref gemm packs,
+//     so no tile leaves @ref gemm a short block along the inner dimension
+static constexpr unsigned int OUT_OF_CORE_TILE_MULTIPLE = 256;
+
+// Two buffers each of A, B and C
+static constexpr unsigned int OUT_OF_CORE_NUM_TILE_BUFFERS = 6;
+
+/**
+ * @brief Reads the rows x cols block starting at (row, col) of a matrix file into @ref tile,
+ *     stored the same way as the file: column by column for COLUMNSPACE with a distance of
+ *     @ref rows between columns, row by row for ROWSPACE with a distance of @ref cols.
+ */
+template <typename T>
+static bool readTile(std::istream& file, const MathMatrixFileHeader& header, unsigned int row,
+	unsigned int col, unsigned int rows, unsigned int cols, T* tile)
+{
+	bool byRow = header.space == ROWSPACE;
+	unsigned int firstVector = byRow ? row : col, numVectors = byRow ? rows : cols;
+	unsigned int start = byRow ? col : row, length = byRow ? cols : rows;
+
+	for (unsigned int v = 0; v < numVectors; ++v)
+	{
+		uint64_t offset = header.payloadOffset +
+			((uint64_t)(firstVector + v) * header.leadingDimension + start) * sizeof(T);
+		if (!file.seekg((std::streamoff)offset) ||
+			!file.read(reinterpret_cast<char*>(tile + (size_t)v * length), (std::streamsize)length * sizeof(T)))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+// Writes a tile stored column by column into a COLUMNSPACE matrix file, the inverse of readTile
+template <typename T>
+static bool writeTile(std::ostream& file, const MathMatrixFileHeader& header, unsigned int row,
+	unsigned int col, unsigned int rows, unsigned int cols, const T* tile)
+{
+	for (unsigned int j = 0; j < cols; ++j)
+	{
+		uint64_t offset = header.payloadOffset + ((uint64_t)(col + j) * header.leadingDimension + row) * sizeof(T);
+		if (!file.seekp((std::streamoff)offset) ||
+			!file.write(reinterpret_cast<const char*>(tile + (size_t)j * rows), (std::streamsize)rows * sizeof(T)))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+template <typename T>
+void MathOutOfCoreMultiplyT<T>::setMemoryBudget(size_t bytes)
+{
+	memoryBudget_ = bytes;
+	if (buffer_.size() * sizeof(T) > memoryBudget_)
+	{
+		std::vector<T, MathAlignedAllocator<T>>().swap(buffer_);
+	}
+}
+
+template <typename T>
+unsigned int MathOutOfCoreMultiplyT<T>::getTileSize() const
+{
+	double tile = std::floor(std::sqrt((double)memoryBudget_ / (OUT_OF_CORE_NUM_TILE_BUFFERS * sizeof(T))));
+	if (tile >= 0xFFFFFFFFu)
+	{
+		tile = 0xFFFFFFFFu;
+	}
+
+	unsigned int size = (unsigned int)tile;
+	return (size < OUT_OF_CORE_TILE_MULTIPLE) ? size : size / OUT_OF_CORE_TILE_MULTIPLE * OUT_OF_CORE_TILE_MULTIPLE;
+}
+
+template <typename T>
+bool MathOutOfCoreMultiplyT<T>::multiply(const char* aPath, const char* bPath, const char* cPath)
+{
+	// Compared as files rather than as strings, since one file can be spelled as many paths
+	if (isSameFile(cPath, aPath) || isSameFile(cPath, bPath))
+	{
+		return false;
+	}
+
+	std::ifstream aFile(aPath, std::ios::binary), bFile(bPath, std::ios::binary);
+	MathMatrixFileHeader aHeader, bHeader, cHeader;
+	if (!readMatrixFileHeader<T>(aFile, aHeader) || !readMatrixFileHeader<T>(bFile, bHeader) ||
+		aHeader.numCols != bHeader.numRows ||
+		!makeMatrixFileHeader<T>(aHeader.numRows, bHeader.numCols, COLUMNSPACE, cHeader))
+	{
+		return false;
+	}
+
+	unsigned int m = aHeader.numRows, n = bHeader.numCols, k = aHeader.numCols;
+	unsigned int tile = getTileSize();
+	if (tile == 0)
+	{
+		return false;
+	}
+
+	// C is written next to cPath and renamed over it when it is complete, which leaves any
+	//     mapping of the old file valid.  The new file is all zeros up to its last byte before
+	//     any tile is written.
+	std::string cTemporaryPath = makeTemporaryFilePath(cPath);
+	std::ofstream cFile(cTemporaryPath, std::ios::binary | std::ios::trunc);
+	cFile.write(reinterpret_cast<const char*>(&cHeader), sizeof(cHeader));
+	if (cHeader.payloadSize > 0)
+	{
+		cFile.seekp((std::streamoff)(cHeader.payloadOffset + cHeader.payloadSize - 1));
+		cFile.put(0);
+	}
+	auto finish = [&](bool ok)
+	{
+		cFile.close();
+		if (!ok || cFile.fail())
+		{
+			std::remove(cTemporaryPath.c_str());
+			return false;
+		}
+		return replaceFile(cTemporaryPath.c_str(), cPath);
+	};
+	if (!cFile || m == 0 || n == 0)
+	{
+		return finish((bool)cFile);
+	}
+
+	unsigned int mb = (m < tile) ? m : tile, nb = (n < tile) ? n : tile, kb = (k < tile) ? k : tile;
+	size_t aSize = (size_t)mb * kb, bSize = (size_t)kb * nb, cSize = (size_t)mb * nb;
+	// Buffers kept from a product of another shape are reused if large enough, they are
+	//     within the budget because lowering it frees them
+	if (buffer_.size() < 2 * (aSize + bSize + cSize))
+	{
+		std::vector<T, MathAlignedAllocator<T>>().swap(buffer_);
+		buffer_.resize(2 * (aSize + bSize + cSize));
+	}
+	T* aTiles[2] = { buffer_.data(), buffer_.data() + aSize };
+	T* bTiles[2] = { aTiles[1] + aSize, aTiles[1] + aSize + bSize };
+	T* cTiles[2] = { bTiles[1] + bSize, bTiles[1] + bSize + cSize };
+
+	// Every step multiplies one pair of tiles into a tile of C, the steps of one tile of C
+	//     running over the inner dimension
+	unsigned int tilesDown = (m + mb - 1) / mb, tilesAcross = (n + nb - 1) / nb;
+	unsigned int tilesDeep = (k == 0) ? 1 : (k + kb - 1) / kb;
+	size_t numSteps = (size_t)tilesDown * tilesAcross * tilesDeep;
+
+	struct Step { unsigned int row, col, depth, rows, cols, depths; };
+	auto stepAt = [&](size_t s)
+	{
+		unsigned int p = (unsigned int)(s % tilesDeep);
+		unsigned int ij = (unsigned int)(s / tilesDeep);
+		Step step;
+		step.row = (ij % tilesDown) * mb;
+		step.col = (ij / tilesDown) * nb;
+		step.depth = p * kb;
+		step.rows = (m - step.row < mb) ? m - step.row : mb;
+		step.cols = (n - step.col < nb) ? n - step.col : nb;
+		step.depths = (k - step.depth < kb) ? k - step.depth : kb;
+		return step;
+	};
+	auto load = [&](size_t s, int buffer)
+	{
+		Step step = stepAt(s);
+		return readTile(aFile, aHeader, step.row, step.depth, step.rows, step.depths, aTiles[buffer]) &&
+			readTile(bFile, bHeader, step.depth, step.col, step.depths, step.cols, bTiles[buffer]);
+	};
+
+	// The tile being read and the tile being written are never the ones in use
+	bool ok = load(0, 0);
+	std::future<bool> loading, writing;
+	int cBuffer = 0;
+	for (size_t s = 0; ok && s < numSteps; ++s)
+	{
+		int buffer = (int)(s % 2);
+		if (s + 1 < numSteps)
+		{
+			loading = std::async(std::launch::async, load, s + 1, 1 - buffer);
+		}
+
+		Step step = stepAt(s);
+		size_t aRowStride = (aHeader.space == ROWSPACE) ? step.depths : 1;
+		size_t aColStride = (aHeader.space == ROWSPACE) ? 1 : step.rows;
+		size_t bRowStride = (bHeader.space == ROWSPACE) ? step.cols : 1;
+		size_t bColStride = (bHeader.space == ROWSPACE) ? 1 : step.depths;
+		gemm(step.rows, step.cols, step.depths, (T)1, aTiles[buffer], aRowStride, aColStride,
+			bTiles[buffer], bRowStride, bColStride, (step.depth == 0) ? (T)0 : (T)1,
+			cTiles[cBuffer], 1, step.rows);
+
+		if (step.depth + step.depths >= k)
+		{
+			if (writing.valid()) ok = writing.get() && ok;
+			const T* finished = cTiles[cBuffer];
+			writing = std::async(std::launch::async, [&cFile, &cHeader, step, finished]
+			{
+				return writeTile(cFile, cHeader, step.row, step.col, step.rows, step.cols, finished);
+			});
+			cBuffer = 1 - cBuffer;
+		}
+
+		if (loading.valid()) ok = loading.get() && ok;
+	}
+
+	if (loading.valid()) ok = loading.get() && ok;
+	if (writing.valid()) ok = writing.get() && ok;
+	return finish(ok);
+}
+
+template class MathOutOfCoreMultiplyT<double>;
+template class MathOutOfCoreMultiplyT<float>;
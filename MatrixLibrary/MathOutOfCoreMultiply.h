@@ -0,0 +1,71 @@
+#pragma once
+
+#ifndef __MATH_OUT_OF_CORE_MULTIPLY_H
+#define __MATH_OUT_OF_CORE_MULTIPLY_H
+
+#include <cstddef>
+#include <vector>
+#include "MathArena.h"
+
+/**
+ * @brief Multiplies matrices stored in matrix files (see @ref saveMatrix) that are too large
+ *     to hold in memory, C = A * B, keeping only a few tiles of each in memory at a time.
+ * @note C is computed one tile at a time: each tile of C is the sum over the inner dimension
+ *     of a tile of A times a tile of B, each product run by @ref gemm and its threads.  While
+ *     one pair of tiles is multiplied the next pair is read from the files by another thread,
+ *     and a finished tile of C is written while the next one is computed, so with a fast
+ *     enough disk the product runs at the speed of @ref gemm.
+ * @note The tile buffers, two of each of A, B and C, are the memory used and they stay within
+ *     the memory budget.  Square tiles as large as the budget allows are used, which keeps
+ *     the bytes read per multiply-add lowest.
+ * @note The result agrees with operator* to rounding, not bit for bit.  The products of the
+ *     tiles are summed one after another, and @ref gemm hands a tile with a single row or
+ *     column to @ref gemv, which sums in another order.
+ * @note The buffers are kept by the object for the next product.  Lowering the budget frees
+ *     buffers larger than the new budget, so they never hold more than the budget.
+ */
+template <typename T>
+class MathOutOfCoreMultiplyT
+{
+public:
+
+	// Bytes of tile buffers used by default
+	static constexpr size_t DEFAULT_MEMORY_BUDGET = (size_t)256 << 20;
+
+	explicit MathOutOfCoreMultiplyT(size_t memoryBudget = DEFAULT_MEMORY_BUDGET) : memoryBudget_(memoryBudget) {}
+
+	void setMemoryBudget(size_t bytes);
+	size_t getMemoryBudget() const { return memoryBudget_; }
+
+	// The rows and columns of the square tiles the budget allows, 0 if it is too small
+	unsigned int getTileSize() const;
+
+	/**
+	 * @brief Writes the product of the matrices in the files at @ref aPath and @ref bPath to a
+	 *     new COLUMNSPACE matrix file at @ref cPath, replacing any file there.
+	 * @return false if a file cannot be read or written, the sizes do not match, @ref cPath is
+	 *     one of the operands or the budget is too small for one tile.  Any file at @ref cPath
+	 *     is then left as it was.
+	 * @note C is written next to @ref cPath and renamed over it once complete (see
+	 *     @ref replaceFile), so a mapping of the old file at @ref cPath stays valid.
+	 */
+	bool multiply(const char* aPath, const char* bPath, const char* cPath);
+
+	// The bytes of tile buffers held for the next product
+	size_t getBufferBytes() const { return buffer_.size() * sizeof(T); }
+
+private:
+
+	size_t memoryBudget_;
+
+	// Both buffers of A, then both of B, then both of C
+	std::vector<T, MathAlignedAllocator<T>> buffer_;
+};
+
+typedef MathOutOfCoreMultiplyT<double> MathOutOfCoreMultiply;
+typedef MathOutOfCoreMultiplyT<float> MathOutOfCoreMultiplyF;
+
+extern template class MathOutOfCoreMultiplyT<double>;
+extern template class MathOutOfCoreMultiplyT<float>;
+
+#endif // __MATH_OUT_OF_CORE_MULTIPLY_H
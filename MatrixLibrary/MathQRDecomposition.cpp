@@ -0,0 +1,549 @@
+#include "pch.h"
+#include "MathQRDecomposition.h"
+#include "MathMatrixMultiply.h"
+#include "MathSimdKernels.h"
+#include "MathThreadPool.h"
+#include "MathTriangularSolve.h"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+
+// The number of reflectors merged into one block reflector.  Every block costs an extra
+//     blockSize^2 * m multiply-adds to form T, so this is smaller than the LU block size.
+static constexpr unsigned int QR_BLOCK_SIZE = 64;
+
+// The panel is worked on this many rows at a time so each piece of it stays in the L2 cache
+//     for everything done to it in one pass.  The panel of a tall matrix is far bigger than
+//     the caches and its factorization is bound by memory traffic.
+static constexpr size_t QR_PANEL_ROW_CHUNK = 512;
+
+// Products of the tall part of V with at most this many columns are done a chunk of rows at a
+//     time with the vector kernels instead of @ref gemm.  Packing costs gemm an extra pass over
+//     V, which is most of the time when there are only a few columns to multiply.
+static constexpr unsigned int QR_STREAMING_MAX_COLS = 32;
+
+// Passes over the rows of a tall matrix that touch at least this many elements are split
+//     between the threads of the pool, a range of rows per thread
+static constexpr size_t QR_PARALLEL_THRESHOLD = 256 * 1024;
+
+// =============================================================================================
+// Passes over the rows of the tall part of the matrix
+// =============================================================================================
+
+/**
+ * @brief Calls @ref work on ranges of the rows first to last - 1 that together cover all of
+ *     them, on the threads of @ref MathThreadPool if the pass touches enough elements.
+ *     @ref work adds its part of numSums sums to the array it is handed, which are all added
+ *     into @ref sums at the end.
+ */
+static void forEachRowRange(size_t first, size_t last, size_t elementsPerRow, unsigned int numSums,
+	double* sums, const std::function<void(size_t, size_t, double*)>& work)
+{
+	size_t rows = last - first;
+	MathThreadPool& pool = MathThreadPool::getInstance();
+
+	unsigned int numTasks = 1;
+	if (rows * elementsPerRow >= QR_PARALLEL_THRESHOLD)
+	{
+		size_t numChunks = (rows + QR_PANEL_ROW_CHUNK - 1) / QR_PANEL_ROW_CHUNK;
+		unsigned int numThreads = pool.getNumThreads();
+		numTasks = (numThreads < numChunks) ? numThreads : (unsigned int)numChunks;
+	}
+
+	if (numTasks == 1)
+	{
+		work(first, last, sums);
+		return;
+	}
+
+	std::vector<double> partialSums((size_t)numTasks * numSums, 0.0);
+	pool.parallelFor(numTasks, [&](unsigned int task)
+	{
+		work(first + rows * task / numTasks, first + rows * (task + 1) / numTasks,
+			partialSums.data() + (size_t)task * numSums);
+	});
+
+	for (unsigned int task = 0; task < numTasks; ++task)
+	{
+		for (unsigned int i = 0; i < numSums; ++i)
+		{
+			sums[i] += partialSums[(size_t)task * numSums + i];
+		}
+	}
+}
+
+/**
+ * @brief Adds |x(first:last)|^2 to sums[0] and x(first:last) . other_c(first:last) to
+ *     sums[1 + c] for the numOther columns after x, a chunk of rows at a time
+ */
+static void addColumnSums(const double* x, size_t ld, unsigned int numOther, size_t first,
+	size_t last, double* sums)
+{
+	for (size_t r = first; r < last; r += QR_PANEL_ROW_CHUNK)
+	{
+		size_t rows = (last - r < QR_PANEL_ROW_CHUNK) ? last - r : QR_PANEL_ROW_CHUNK;
+		sums[0] += simdSumOfSquares(x + r, rows);
+		for (unsigned int c = 0; c < numOther; ++c)
+		{
+			sums[1 + c] += simdDotProduct(x + r, x + r + (c + 1) * ld, rows);
+		}
+	}
+}
+
+/**
+ * @brief W += V^T * C where V is rows x nb and C is rows x numCols, both with contiguous columns,
+ *     and W is nb x numCols with leading dimension nb
+ */
+static void addTallTransposeProduct(size_t rows, unsigned int nb, unsigned int numCols,
+	const double* v, size_t vColStride, const double* c, size_t cColStride, double* w)
+{
+	forEachRowRange(0, rows, (size_t)nb + numCols, nb * numCols, w,
+		[&](size_t first, size_t last, double* sums)
+	{
+		for (size_t r = first; r < last; r += QR_PANEL_ROW_CHUNK)
+		{
+			size_t chunk = (last - r < QR_PANEL_ROW_CHUNK) ? last - r : QR_PANEL_ROW_CHUNK;
+			for (unsigned int col = 0; col < numCols; ++col)
+			{
+				for (unsigned int j = 0; j < nb; ++j)
+				{
+					sums[j + col * nb] += simdDotProduct(v + r + j * vColStride, c + r + col * cColStride, chunk);
+				}
+			}
+		}
+	});
+}
+
+/**
+ * @brief C -= V * W where V is rows x nb and C is rows x numCols, both with contiguous columns,
+ *     and W is nb x numCols with leading dimension nb
+ */
+static void subtractTallProduct(size_t rows, unsigned int nb, unsigned int numCols,
+	const double* v, size_t vColStride, const double* w, double* c, size_t cColStride)
+{
+	forEachRowRange(0, rows, (size_t)nb + numCols, 0, nullptr,
+		[&](size_t first, size_t last, double*)
+	{
+		for (size_t r = first; r < last; r += QR_PANEL_ROW_CHUNK)
+		{
+			size_t chunk = (last - r < QR_PANEL_ROW_CHUNK) ? last - r : QR_PANEL_ROW_CHUNK;
+			for (unsigned int col = 0; col < numCols; ++col)
+			{
+				for (unsigned int j = 0; j < nb; ++j)
+				{
+					simdAxpy(-w[j + col * nb], v + r + j * vColStride, c + r + col * cColStride, chunk);
+				}
+			}
+		}
+	});
+}
+
+/**
+ * @brief Factors a copy of @ref a.
+ * @return false and forgets any earlier factorization if @ref a is empty
+ */
+bool MathQRDecomposition::factor(const MathMatrixView& a)
+{
+	numRows_ = 0;
+	numCols_ = 0;
+	rankDeficient_ = false;
+	tau_.clear();
+	t_.clear();
+	v1_.clear();
+	qr_ = MathMatrix();
+
+	unsigned int m = a.getNumRows();
+	unsigned int n = a.getNumCols();
+	if (m == 0 || n == 0)
+	{
+		return false;
+	}
+
+	// By column so every reflector and every column it is applied to is contiguous
+	qr_ = MathMatrix(m, n);
+	double* qrData = qr_.getData();
+	size_t ld = qr_.getLeadingDimension();
+	for (unsigned int c = 0; c < n; ++c)
+	{
+		for (unsigned int r = 0; r < m; ++r)
+		{
+			qrData[r + c * ld] = a.getData()[r * a.getRowStride() + c * a.getColStride()];
+		}
+	}
+
+	numRows_ = m;
+	numCols_ = n;
+
+	unsigned int numReflectors = getNumReflectors();
+	unsigned int numBlocks = (numReflectors + QR_BLOCK_SIZE - 1) / QR_BLOCK_SIZE;
+	tau_.assign(numReflectors, 0.0);
+	t_.assign((size_t)numBlocks * QR_BLOCK_SIZE * QR_BLOCK_SIZE, 0.0);
+	v1_.assign((size_t)numBlocks * QR_BLOCK_SIZE * QR_BLOCK_SIZE, 0.0);
+
+	for (unsigned int k = 0; k < numReflectors; k += QR_BLOCK_SIZE)
+	{
+		unsigned int nb = (numReflectors - k < QR_BLOCK_SIZE) ? numReflectors - k : QR_BLOCK_SIZE;
+
+		size_t blockOffset = (size_t)(k / QR_BLOCK_SIZE) * QR_BLOCK_SIZE * QR_BLOCK_SIZE;
+		double* t = t_.data() + blockOffset;
+		double* v1 = v1_.data() + blockOffset;
+
+		factorPanel(k, nb);
+		formBlockReflector(k, nb, t, v1, QR_BLOCK_SIZE);
+
+		// A(k:m, k+nb:n) = H^T * A(k:m, k+nb:n)
+		if (k + nb < n)
+		{
+			applyBlockReflector(k, nb, t, v1, QR_BLOCK_SIZE, true, n - k - nb,
+				qrData + k + (k + nb) * ld, 1, ld);
+		}
+	}
+
+	for (unsigned int i = 0; i < numReflectors; ++i)
+	{
+		if (qrData[i + i * ld] == 0.0)
+		{
+			rankDeficient_ = true;
+		}
+	}
+	return true;
+}
+
+MathMatrix MathQRDecomposition::getR() const
+{
+	if (!isFactored())
+	{
+		return MathMatrix();
+	}
+
+	unsigned int numReflectors = getNumReflectors();
+	MathMatrix r(numReflectors, numCols_);
+	for (unsigned int c = 0; c < numCols_; ++c)
+	{
+		for (unsigned int row = 0; row <= c && row < numReflectors; ++row)
+		{
+			r.setVal(row, c, qr_.getVal(row, c));
+		}
+	}
+	return r;
+}
+
+/**
+ * @brief Forms Q, or its first min(m, n) columns, by applying it to the columns of the identity
+ * @return An empty matrix if nothing is factored
+ */
+MathMatrix MathQRDecomposition::getQ(bool thin) const
+{
+	if (!isFactored())
+	{
+		return MathMatrix();
+	}
+
+	unsigned int cols = thin ? getNumReflectors() : numRows_;
+	MathMatrix q(numRows_, cols);
+	for (unsigned int i = 0; i < cols; ++i)
+	{
+		q.setVal(i, i, 1.0);
+	}
+
+	applyQ(q.getView());
+	return q;
+}
+
+bool MathQRDecomposition::applyQ(const MathMatrixView& c) const
+{
+	return applyReflectors(c, false);
+}
+
+bool MathQRDecomposition::applyQTranspose(const MathMatrixView& c) const
+{
+	return applyReflectors(c, true);
+}
+
+/**
+ * @brief Returns the x that makes |A * x - b| smallest, found from R * x = (Q^T * b)(0:n)
+ * @return An empty vector if nothing is factored, A has fewer rows than columns, A is rank
+ *     deficient or b does not have m elements
+ */
+MathVector MathQRDecomposition::leastSquares(const MathVector& b) const
+{
+	if (!isFactored() || rankDeficient_ || numRows_ < numCols_ || b.getOperationSize() != numRows_)
+	{
+		return MathVector();
+	}
+
+	MathVector y(b);
+	applyQTranspose(MathMatrixView(y.getData(), numRows_, 1, 1, numRows_));
+	triangularSolve(UPPER_TRIANGLE, false, numCols_, 1, qr_.getData(), 1, qr_.getLeadingDimension(),
+		y.getData(), 1, numRows_);
+
+	MathVector x(numCols_);
+	for (unsigned int i = 0; i < numCols_; ++i)
+	{
+		x[i] = y[i];
+	}
+	return x;
+}
+
+MathMatrix MathQRDecomposition::leastSquares(const MathMatrixView& b) const
+{
+	if (!isFactored() || rankDeficient_ || numRows_ < numCols_ || b.getNumRows() != numRows_ ||
+		b.getNumCols() == 0)
+	{
+		return MathMatrix();
+	}
+
+	MathMatrix y(numRows_, b.getNumCols());
+	MathMatrixView yView = y.getView();
+	for (unsigned int c = 0; c < b.getNumCols(); ++c)
+	{
+		for (unsigned int r = 0; r < numRows_; ++r)
+		{
+			yView.setVal(r, c, b.getVal(r, c));
+		}
+	}
+
+	applyQTranspose(yView);
+	triangularSolve(UPPER_TRIANGLE, false, numCols_, b.getNumCols(), qr_.getData(), 1,
+		qr_.getLeadingDimension(), y.getData(), y.getRowStride(), y.getColStride());
+	return MathMatrix(y.getView(0, 0, numCols_, b.getNumCols()));
+}
+
+// ==============================================================================
+// Private Member functions
+// ==============================================================================
+
+/**
+ * @brief Finds the reflectors of columns k to k + nb - 1 one at a time, applying each one to
+ *     the rest of the panel only.  Reflector j is stored below the diagonal of column j with
+ *     its first element, which is always 1, left out.
+ * @note Each reflector needs the norm of its column below the diagonal and the dot products of
+ *     that part of the column with the rest of the panel.  Those are gathered while the
+ *     previous reflector is applied, so every reflector costs one pass over the panel.
+ */
+void MathQRDecomposition::factorPanel(unsigned int k, unsigned int nb)
+{
+	double* qrData = qr_.getData();
+	size_t ld = qr_.getLeadingDimension();
+
+	// For the next column x, sums[0] = |x(j+1:m)|^2 and sums[1 + c] = x(j+1:m) . other_c(j+1:m)
+	//     for the columns after it
+	std::vector<double> sums(nb + 1, 0.0);
+	forEachRowRange(k + 1, numRows_, nb, nb, sums.data(), [&](size_t first, size_t last, double* part)
+	{
+		addColumnSums(qrData + k * ld, ld, nb - 1, first, last, part);
+	});
+
+	std::vector<double> columnSums(nb + 1);
+	std::vector<double> w(nb);
+	for (unsigned int j = k; j < k + nb; ++j)
+	{
+		double* col = qrData + j * ld;
+		double* next = col + ld;
+		unsigned int numOther = k + nb - j - 1;
+
+		columnSums.swap(sums);
+		std::fill(sums.begin(), sums.end(), 0.0);
+		double belowNormSquared = columnSums[0];
+
+		if (belowNormSquared == 0.0)
+		{
+			// Already zero below the diagonal, H_j = I
+			tau_[j] = 0.0;
+			if (numOther > 0)
+			{
+				forEachRowRange(j + 2, numRows_, numOther, numOther, sums.data(),
+					[&](size_t first, size_t last, double* part)
+				{
+					addColumnSums(next, ld, numOther - 1, first, last, part);
+				});
+			}
+			continue;
+		}
+
+		// H_j * col(j:m) = (beta, 0, ..., 0) with v = col(j+1:m) * scale
+		double alpha = col[j];
+		double beta = -std::copysign(std::hypot(alpha, std::sqrt(belowNormSquared)), alpha);
+		double tau = (beta - alpha) / beta;
+		double scale = 1.0 / (alpha - beta);
+		col[j] = beta;
+		tau_[j] = tau;
+
+		// other(j:m) -= tau * (v^T * other(j:m)) * v, where the dot products were gathered
+		//     before v was scaled
+		for (unsigned int c = 0; c < numOther; ++c)
+		{
+			double* other = col + (c + 1) * ld;
+			w[c] = tau * (other[j] + scale * columnSums[1 + c]);
+			other[j] -= w[c];
+		}
+
+		forEachRowRange(j + 1, numRows_, numOther + 1, numOther, sums.data(),
+			[&](size_t first, size_t last, double* part)
+		{
+			for (size_t r = first; r < last; r += QR_PANEL_ROW_CHUNK)
+			{
+				size_t rows = (last - r < QR_PANEL_ROW_CHUNK) ? last - r : QR_PANEL_ROW_CHUNK;
+				simdScale(scale, col + r, rows);
+				for (unsigned int c = 0; c < numOther; ++c)
+				{
+					simdAxpy(-w[c], col + r, col + r + (c + 1) * ld, rows);
+				}
+
+				// While the chunk is in cache, the sums for the next column, which start a row lower
+				size_t nextFirst = (r < j + 2) ? j + 2 : r;
+				if (numOther > 0 && nextFirst < r + rows)
+				{
+					addColumnSums(next, ld, numOther - 1, nextFirst, r + rows, part);
+				}
+			}
+		});
+	}
+}
+
+/**
+ * @brief Builds T, nb x nb with leading dimension ldT, so that
+ *     H_k * H_k+1 * ... * H_k+nb-1 = I - V * T * V^T, where column i of V is reflector k + i.
+ *     Also copies the top nb x nb triangle of V to v1.  Uses S = V^T * V, computed with
+ *     @ref gemm, and the recurrence T(0:i, i) = -tau_i * T(0:i, 0:i) * S(0:i, i).
+ */
+void MathQRDecomposition::formBlockReflector(unsigned int k, unsigned int nb, double* t, double* v1,
+	size_t ldT) const
+{
+	const double* qrData = qr_.getData();
+	size_t ld = qr_.getLeadingDimension();
+
+	// The top nb x nb of V with the ones on the diagonal and zeros above
+	for (unsigned int j = 0; j < nb; ++j)
+	{
+		v1[j + j * ldT] = 1.0;
+		for (unsigned int i = j + 1; i < nb; ++i)
+		{
+			v1[i + j * ldT] = qrData[(k + i) + (k + j) * ld];
+		}
+	}
+
+	const double* v2 = qrData + (k + nb) + k * ld;
+	unsigned int v2Rows = numRows_ - k - nb;
+
+	std::vector<double> s((size_t)nb * nb);
+	gemm(nb, nb, nb, 1.0, v1, ldT, 1, v1, 1, ldT, 0.0, s.data(), 1, nb);
+	if (nb <= QR_STREAMING_MAX_COLS)
+	{
+		addTallTransposeProduct(v2Rows, nb, nb, v2, ld, v2, ld, s.data());
+	}
+	else
+	{
+		gemm(nb, nb, v2Rows, 1.0, v2, ld, 1, v2, 1, ld, 1.0, s.data(), 1, nb);
+	}
+
+	for (unsigned int i = 0; i < nb; ++i)
+	{
+		double tau = tau_[k + i];
+		t[i + i * ldT] = tau;
+		for (unsigned int r = 0; r < i; ++r)
+		{
+			double sum = 0.0;
+			for (unsigned int q = r; q < i; ++q)
+			{
+				sum += t[r + q * ldT] * s[q + i * nb];
+			}
+			t[r + i * ldT] = -tau * sum;
+		}
+	}
+}
+
+/**
+ * @brief C = (I - V * T * V^T) * C, or with T^T if @ref transpose is set, for the block of
+ *     reflectors starting at k.  C has the m - k rows from row k on and starts at @ref c.
+ *     Done as W = V^T * C, W = T * W, C -= V * W with V split into its triangle and the
+ *     rectangle below it.
+ */
+void MathQRDecomposition::applyBlockReflector(unsigned int k, unsigned int nb, const double* t,
+	const double* v1, size_t ldT, bool transpose, unsigned int numCols, double* c,
+	size_t cRowStride, size_t cColStride) const
+{
+	const double* qrData = qr_.getData();
+	size_t ld = qr_.getLeadingDimension();
+	const double* v2 = qrData + (k + nb) + k * ld;
+	unsigned int v2Rows = numRows_ - k - nb;
+	double* c2 = c + nb * cRowStride;
+
+	std::vector<double> w((size_t)nb * numCols);
+	std::vector<double> tw((size_t)nb * numCols);
+
+	// W = V1^T * C1 + V2^T * C2
+	gemm(nb, numCols, nb, 1.0, v1, ldT, 1, c, cRowStride, cColStride, 0.0, w.data(), 1, nb);
+	bool streaming = (cRowStride == 1 && numCols <= QR_STREAMING_MAX_COLS);
+	if (streaming)
+	{
+		addTallTransposeProduct(v2Rows, nb, numCols, v2, ld, c2, cColStride, w.data());
+	}
+	else
+	{
+		gemm(nb, numCols, v2Rows, 1.0, v2, ld, 1, c2, cRowStride, cColStride, 1.0, w.data(), 1, nb);
+	}
+
+	// TW = T * W or T^T * W
+	size_t tRowStride = transpose ? ldT : 1;
+	size_t tColStride = transpose ? 1 : ldT;
+	gemm(nb, numCols, nb, 1.0, t, tRowStride, tColStride, w.data(), 1, nb, 0.0, tw.data(), 1, nb);
+
+	// C1 -= V1 * TW, C2 -= V2 * TW
+	gemm(nb, numCols, nb, -1.0, v1, 1, ldT, tw.data(), 1, nb, 1.0, c, cRowStride, cColStride);
+	if (streaming)
+	{
+		subtractTallProduct(v2Rows, nb, numCols, v2, ld, tw.data(), c2, cColStride);
+	}
+	else
+	{
+		gemm(v2Rows, numCols, nb, -1.0, v2, 1, ld, tw.data(), 1, nb, 1.0, c2, cRowStride, cColStride);
+	}
+}
+
+/**
+ * @brief Q^T = B_last^T * ... * B_0^T applies the blocks first to last, Q = B_0 * ... * B_last
+ *     applies them last to first
+ */
+bool MathQRDecomposition::applyReflectors(const MathMatrixView& c, bool transpose) const
+{
+	if (!isFactored() || c.getNumRows() != numRows_)
+	{
+		return false;
+	}
+
+	unsigned int numCols = c.getNumCols();
+	if (numCols == 0)
+	{
+		return true;
+	}
+
+	unsigned int numReflectors = getNumReflectors();
+	unsigned int numBlocks = (numReflectors + QR_BLOCK_SIZE - 1) / QR_BLOCK_SIZE;
+	for (unsigned int i = 0; i < numBlocks; ++i)
+	{
+		unsigned int blk = transpose ? i : numBlocks - 1 - i;
+		unsigned int k = blk * QR_BLOCK_SIZE;
+		unsigned int nb = (numReflectors - k < QR_BLOCK_SIZE) ? numReflectors - k : QR_BLOCK_SIZE;
+
+		size_t blockOffset = (size_t)blk * QR_BLOCK_SIZE * QR_BLOCK_SIZE;
+
+		applyBlockReflector(k, nb, t_.data() + blockOffset, v1_.data() + blockOffset, QR_BLOCK_SIZE,
+			transpose, numCols, c.getData() + k * c.getRowStride(), c.getRowStride(), c.getColStride());
+	}
+	return true;
+}
+
+// =============================================================================================
+// Outside of class functions
+// =============================================================================================
+
+MathVector leastSquares(const MathMatrix& a, const MathVector& b)
+{
+	return MathQRDecomposition(a.getView()).leastSquares(b);
+}
+
+MathMatrix leastSquares(const MathMatrix& a, const MathMatrix& b)
+{
+	return MathQRDecomposition(a.getView()).leastSquares(b.getView());
+}
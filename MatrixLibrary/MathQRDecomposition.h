@@ -0,0 +1,96 @@
+#pragma once
+
+#ifndef __MATH_QR_DECOMPOSITION_H
+#define __MATH_QR_DECOMPOSITION_H
+
+#include <vector>
+#include "MathMatrix.h"
+#include "MathMatrixView.h"
+#include "MathVector.h"
+
+/**
+ * @brief The QR factorization A = Q * R of an m x n matrix A by Householder reflections, where
+ *     Q is m x m orthogonal and R is m x n upper triangular.  With m >= n it gives the least
+ *     squares solution of A * x = b, the x that makes |A * x - b| smallest.
+ * @note Q is kept implicitly as the Householder vectors below the diagonal of R.  @ref applyQ
+ *     and @ref applyQTranspose multiply by Q without ever forming it, @ref getQ forms it when
+ *     it is really needed.
+ * @note The factorization is blocked.  The reflectors of a panel of columns are merged into one
+ *     block reflector I - V * T * V^T (the compact WY representation) and applied to the rest
+ *     of the matrix with calls to @ref gemm, so for wide enough matrices most of the work runs
+ *     on the multiplication kernel.  Applying Q works the same way.
+ * @note Tall, narrow matrices have little to gain from @ref gemm and are bound by memory
+ *     traffic instead.  Their panels are factored with one pass over the rows per reflector,
+ *     products with few columns stream the rows through the vector kernels a cache sized chunk
+ *     at a time, and both split the rows between the threads of @ref MathThreadPool.
+ * @note A zero on the diagonal of R makes A rank deficient and the least squares solves fail.
+ *     Matrices that are merely close to rank deficient are not detected.
+ */
+class MathQRDecomposition
+{
+public:
+
+	MathQRDecomposition() {}
+	explicit MathQRDecomposition(const MathMatrixView& a) { factor(a); }
+
+	// Factors a copy of @ref a.  Returns false if @ref a is empty.
+	bool factor(const MathMatrixView& a);
+
+	bool isFactored() const { return numRows_ != 0; }
+	bool isRankDeficient() const { return rankDeficient_; }
+	unsigned int getNumRows() const { return numRows_; }
+	unsigned int getNumCols() const { return numCols_; }
+
+	// R on and above the diagonal and the Householder vectors below it, stored as a
+	//     COLUMNSPACE matrix
+	const MathMatrix& getQR() const { return qr_; }
+
+	// The min(m, n) x n upper triangle R
+	MathMatrix getR() const;
+
+	// The first min(m, n) columns of Q, or all m of them if @ref thin is false
+	MathMatrix getQ(bool thin = true) const;
+
+	// C = Q * C and C = Q^T * C in place.  Return false if C does not have m rows.
+	bool applyQ(const MathMatrixView& c) const;
+	bool applyQTranspose(const MathMatrixView& c) const;
+
+	MathVector leastSquares(const MathVector& b) const;
+	MathMatrix leastSquares(const MathMatrixView& b) const;
+
+private:
+
+	void factorPanel(unsigned int k, unsigned int nb);
+	void formBlockReflector(unsigned int k, unsigned int nb, double* t, double* v1, size_t ldT) const;
+	void applyBlockReflector(unsigned int k, unsigned int nb, const double* t, const double* v1,
+		size_t ldT, bool transpose, unsigned int numCols, double* c, size_t cRowStride,
+		size_t cColStride) const;
+	bool applyReflectors(const MathMatrixView& c, bool transpose) const;
+
+	unsigned int getNumReflectors() const { return (numRows_ < numCols_) ? numRows_ : numCols_; }
+
+	MathMatrix qr_;
+
+	// The scalar of each reflector, H_i = I - tau_[i] * v_i * v_i^T
+	std::vector<double> tau_;
+
+	// The upper triangular T of each block reflector, blockSize x blockSize and by column.
+	//     Block b starts at element b * blockSize * blockSize.
+	std::vector<double> t_;
+
+	// The unit lower triangle of V for each block, stored the same way as t_ so it can be
+	//     passed to @ref gemm without the R above it
+	std::vector<double> v1_;
+
+	unsigned int numRows_ = 0;
+	unsigned int numCols_ = 0;
+	bool rankDeficient_ = false;
+};
+
+// Outside of class functions that factor @ref a and throw the factorization away.  They
+//     return an empty vector or matrix if @ref a has fewer rows than columns, is rank deficient
+//     or does not have as many rows as @ref b.
+MathVector leastSquares(const MathMatrix& a, const MathVector& b);
+MathMatrix leastSquares(const MathMatrix& a, const MathMatrix& b);
+
+#endif // __MATH_QR_DECOMPOSITION_H
@@ -0,0 +1,205 @@
+#include "pch.h"
+#include "MathRowReduction.h"
+#include "MathSimdKernels.h"
+#include "MathThreadPool.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+// Elimination steps that touch at least this many elements are split between the threads of
+//     the pool, a block of rows per task
+static constexpr size_t ROW_REDUCTION_PARALLEL_THRESHOLD = 64 * 1024;
+
+/**
+ * @brief Reduces a copy of @ref a to reduced row echelon form
+ * @return false and forgets any earlier reduction if @ref a is empty
+ */
+bool MathRowReduction::reduce(const MathMatrixView& a, double tolerance)
+{
+	numRows_ = 0;
+	numCols_ = 0;
+	work_.clear();
+	rowOrder_.clear();
+	pivotCols_.clear();
+	tolerance_ = 0.0;
+
+	unsigned int rows = a.getNumRows();
+	unsigned int cols = a.getNumCols();
+	if (rows == 0 || cols == 0)
+	{
+		return false;
+	}
+
+	numRows_ = rows;
+	numCols_ = cols;
+	work_.resize((size_t)rows * cols);
+	rowOrder_.resize(rows);
+
+	double biggest = 0.0;
+	for (unsigned int r = 0; r < rows; ++r)
+	{
+		rowOrder_[r] = r;
+		double* row = work_.data() + (size_t)r * cols;
+		for (unsigned int c = 0; c < cols; ++c)
+		{
+			row[c] = a.getData()[r * a.getRowStride() + c * a.getColStride()];
+			biggest = std::max(biggest, std::fabs(row[c]));
+		}
+	}
+
+	tolerance_ = (tolerance < 0.0) ? std::max(rows, cols) * DBL_EPSILON * biggest : tolerance;
+
+	unsigned int pivotRow = 0;
+	for (unsigned int c = 0; c < cols && pivotRow < rows; ++c)
+	{
+		// The biggest element left in the column is the pivot
+		unsigned int best = pivotRow;
+		double bestVal = std::fabs(rowAt(pivotRow)[c]);
+		for (unsigned int r = pivotRow + 1; r < rows; ++r)
+		{
+			double val = std::fabs(rowAt(r)[c]);
+			if (val > bestVal)
+			{
+				bestVal = val;
+				best = r;
+			}
+		}
+
+		if (bestVal <= tolerance_)
+		{
+			// No pivot, what is left of the column is rounding error
+			for (unsigned int r = pivotRow; r < rows; ++r) rowAt(r)[c] = 0.0;
+			continue;
+		}
+
+		std::swap(rowOrder_[pivotRow], rowOrder_[best]);
+		eliminateColumn(pivotRow, c);
+		pivotCols_.push_back(c);
+		++pivotRow;
+	}
+
+	// Rows without a pivot are rounding error too
+	for (unsigned int r = pivotRow; r < rows; ++r)
+	{
+		std::fill(rowAt(r), rowAt(r) + cols, 0.0);
+	}
+	return true;
+}
+
+/**
+ * @brief Returns R as a ROWSPACE matrix, or an empty matrix if nothing was reduced
+ */
+MathMatrix MathRowReduction::getRREF() const
+{
+	if (!isReduced())
+	{
+		return MathMatrix();
+	}
+
+	MathMatrix r(numCols_, numRows_);
+	r.transpose();
+	for (unsigned int row = 0; row < numRows_; ++row)
+	{
+		std::copy(rowAt(row), rowAt(row) + numCols_, r.getData() + (size_t)row * r.getRowStride());
+	}
+	return r;
+}
+
+/**
+ * @brief Returns the basis of the null space found from R.  Column j sets the j-th column of A
+ *     without a pivot to 1, every other column without a pivot to 0 and solves for the rest.
+ */
+MathMatrix MathRowReduction::getNullSpace() const
+{
+	unsigned int rank = getRank();
+	if (!isReduced() || rank == numCols_)
+	{
+		return MathMatrix();
+	}
+
+	MathMatrix basis(numCols_, numCols_ - rank);
+	double* data = basis.getData();
+	size_t ld = basis.getLeadingDimension();
+
+	unsigned int nextPivot = 0;
+	unsigned int j = 0;
+	for (unsigned int free = 0; free < numCols_; ++free)
+	{
+		if (nextPivot < rank && pivotCols_[nextPivot] == free)
+		{
+			++nextPivot;
+			continue;
+		}
+
+		double* col = data + j * ld;
+		col[free] = 1.0;
+		for (unsigned int k = 0; k < rank; ++k)
+		{
+			col[pivotCols_[k]] = -rowAt(k)[free];
+		}
+		++j;
+	}
+	return basis;
+}
+
+// ==============================================================================
+// Private Member functions
+// ==============================================================================
+
+/**
+ * @brief Scales row @ref pivotRow of R so its pivot in column @ref col is 1 and takes that row
+ *     out of every other row.  Every row is 0 left of @ref col in the columns without a pivot
+ *     so only the columns from @ref col on are touched.
+ */
+void MathRowReduction::eliminateColumn(unsigned int pivotRow, unsigned int col)
+{
+	double* pivot = rowAt(pivotRow) + col;
+	size_t length = numCols_ - col;
+
+	simdScale(1.0 / pivot[0], pivot, length);
+	pivot[0] = 1.0;
+
+	MathThreadPool& pool = MathThreadPool::getInstance();
+	unsigned int numTasks = 1;
+	if ((size_t)numRows_ * length >= ROW_REDUCTION_PARALLEL_THRESHOLD)
+	{
+		numTasks = std::min(pool.getNumThreads() * 4, numRows_);
+	}
+
+	// R -= (column col of R) * (pivot row), one axpy per row
+	pool.parallelFor(numTasks, [&](unsigned int task)
+	{
+		unsigned int first = (unsigned int)((size_t)numRows_ * task / numTasks);
+		unsigned int last = (unsigned int)((size_t)numRows_ * (task + 1) / numTasks);
+
+		for (unsigned int r = first; r < last; ++r)
+		{
+			double* row = rowAt(r) + col;
+			if (r == pivotRow || row[0] == 0.0)
+			{
+				continue;
+			}
+			simdAxpy(-row[0], pivot, row, length);
+			row[0] = 0.0;
+		}
+	});
+}
+
+// =============================================================================================
+// Outside of class functions
+// =============================================================================================
+
+MathMatrix rref(const MathMatrix& a)
+{
+	return MathRowReduction(a.getView()).getRREF();
+}
+
+unsigned int rank(const MathMatrix& a)
+{
+	return MathRowReduction(a.getView()).getRank();
+}
+
+MathMatrix nullSpace(const MathMatrix& a)
+{
+	return MathRowReduction(a.getView()).getNullSpace();
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#ifndef __MATH_ROW_REDUCTION_H
+#define __MATH_ROW_REDUCTION_H
+
+#include <vector>
+#include "MathMatrix.h"
+#include "MathMatrixView.h"
+
+/**
+ * @brief Gauss-Jordan elimination of any matrix A into its reduced row echelon form R, from
+ *     which the rank, the pivot columns and a basis of the null space of A are read.
+ * @note A is copied once into a buffer of contiguous rows.  Swapping two rows only swaps two
+ *     entries of a row order, and every step eliminates the pivot column from all of the other
+ *     rows at once as one rank one update, a SIMD axpy per row that is split between the
+ *     threads of @ref MathThreadPool for big matrices.  Nothing is bounds checked inside the
+ *     loop, unlike calling the row operations of @ref MathMatrix one at a time.
+ * @note Pivots are chosen as the biggest element left in their column.  Elements no bigger
+ *     than the tolerance count as 0.  By default the tolerance is
+ *     max(rows, cols) * DBL_EPSILON * (the biggest element of A).
+ */
+class MathRowReduction
+{
+public:
+
+	MathRowReduction() {}
+	explicit MathRowReduction(const MathMatrixView& a, double tolerance = -1.0) { reduce(a, tolerance); }
+
+	// Reduces a copy of @ref a.  A negative tolerance picks the default.  Returns false if
+	//     @ref a is empty.
+	bool reduce(const MathMatrixView& a, double tolerance = -1.0);
+
+	bool isReduced() const { return numRows_ != 0; }
+	double getTolerance() const { return tolerance_; }
+
+	unsigned int getRank() const { return (unsigned int)pivotCols_.size(); }
+
+	// Column i of A holds the pivot of row i of R, for i less than the rank
+	const std::vector<unsigned int>& getPivotColumns() const { return pivotCols_; }
+
+	// R as a ROWSPACE matrix the size of A
+	MathMatrix getRREF() const;
+
+	// A basis of the null space of A, one column per column of A without a pivot.  Empty if
+	//     A has full column rank.
+	MathMatrix getNullSpace() const;
+
+private:
+
+	void eliminateColumn(unsigned int pivotRow, unsigned int col);
+
+	double* rowAt(unsigned int row) { return work_.data() + (size_t)rowOrder_[row] * numCols_; }
+	const double* rowAt(unsigned int row) const { return work_.data() + (size_t)rowOrder_[row] * numCols_; }
+
+	// The rows of A, one after another.  They never move, row i of R is row rowOrder_[i] of work_
+	std::vector<double> work_;
+	std::vector<unsigned int> rowOrder_;
+
+	std::vector<unsigned int> pivotCols_;
+
+	unsigned int numRows_ = 0;
+	unsigned int numCols_ = 0;
+	double tolerance_ = 0.0;
+};
+
+// Outside of class functions that reduce @ref a with the default tolerance.  They return an
+//     empty matrix, or a rank of 0, if @ref a is empty.
+MathMatrix rref(const MathMatrix& a);
+unsigned int rank(const MathMatrix& a);
+MathMatrix nullSpace(const MathMatrix& a);
+
+#endif // __MATH_ROW_REDUCTION_H
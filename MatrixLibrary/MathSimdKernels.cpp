@@ -0,0 +1,1347 @@
+#include "pch.h"
+#include "MathSimdKernels.h"
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define MATH_SIMD_X86
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+// GCC and Clang only emit instructions of the instruction sets a function is compiled for, so
+//     each kernel is marked with its own.  MSVC emits any intrinsic anywhere.
+#if defined(MATH_SIMD_X86) && (defined(__GNUC__) || defined(__clang__))
+#define MATH_TARGET_SSE2 __attribute__((target("sse2")))
+#define MATH_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#define MATH_TARGET_AVX512 __attribute__((target("avx512f,avx2,fma")))
+#else
+#define MATH_TARGET_SSE2
+#define MATH_TARGET_AVX2
+#define MATH_TARGET_AVX512
+#endif
+
+// =============================================================================================
+// Shared helpers
+// =============================================================================================
+
+/**
+ * @brief Writes the row-major mr x nr block of products @ref ab into C as
+ *     C = alpha * ab + beta * C
+ */
+template <typename T>
+static inline void writeBackGemmBlock(unsigned int mr, unsigned int nr, T alpha, const T* ab,
+	T beta, T* c, size_t rowStride, size_t colStride)
+{
+	for (unsigned int i = 0; i < mr; ++i)
+	{
+		for (unsigned int j = 0; j < nr; ++j)
+		{
+			T& cij = c[i * rowStride + j * colStride];
+			cij = (beta == 0) ? alpha * ab[i * nr + j] : beta * cij + alpha * ab[i * nr + j];
+		}
+	}
+}
+
+// =============================================================================================
+// Scalar kernels
+// =============================================================================================
+
+// The scalar kernels are written once for float and double
+
+template <typename T>
+static T dotProductScalar(const T* x, const T* y, size_t n)
+{
+	T result = 0;
+	for (size_t i = 0; i < n; ++i)
+	{
+		result += x[i] * y[i];
+	}
+	return result;
+}
+
+template <typename T>
+static void axpyScalar(T alpha, const T* x, T* y, size_t n)
+{
+	for (size_t i = 0; i < n; ++i)
+	{
+		y[i] += alpha * x[i];
+	}
+}
+
+template <typename T>
+static void scaleScalar(T alpha, T* x, size_t n)
+{
+	for (size_t i = 0; i < n; ++i)
+	{
+		x[i] *= alpha;
+	}
+}
+
+template <typename T>
+static T sumOfSquaresScalar(const T* x, size_t n)
+{
+	return dotProductScalar(x, x, n);
+}
+
+static constexpr unsigned int SCALAR_MR = 4;
+static constexpr unsigned int SCALAR_NR = 8;
+
+/**
+ * @brief Portable 4 x 8 micro-kernel.  The accumulators are a small fixed size array the
+ *     compiler can keep in registers and vectorize with whatever the target always has.
+ */
+template <typename T>
+static void gemmMicroKernelScalar(unsigned int kc, T alpha, const T* a, const T* b,
+	T beta, T* c, size_t rowStride, size_t colStride)
+{
+	T ab[SCALAR_MR * SCALAR_NR] = { 0 };
+
+	for (unsigned int p = 0; p < kc; ++p)
+	{
+		for (unsigned int i = 0; i < SCALAR_MR; ++i)
+		{
+			T aip = a[i];
+			for (unsigned int j = 0; j < SCALAR_NR; ++j)
+			{
+				ab[i * SCALAR_NR + j] += aip * b[j];
+			}
+		}
+		a += SCALAR_MR;
+		b += SCALAR_NR;
+	}
+
+	writeBackGemmBlock(SCALAR_MR, SCALAR_NR, alpha, ab, beta, c, rowStride, colStride);
+}
+
+/**
+ * @brief Batched products with every loop over the lanes of a group innermost, so the
+ *     compiler can vectorize them with whatever the target always has
+ */
+static void batchMultiplyScalar(unsigned int m, unsigned int k, unsigned int n, const double* a,
+	const double* b, double* product, size_t numGroups)
+{
+	const unsigned int lanes = SIMD_BATCH_LANES;
+	for (size_t g = 0; g < numGroups; ++g)
+	{
+		for (unsigned int i = 0; i < m; ++i)
+		{
+			for (unsigned int j = 0; j < n; ++j)
+			{
+				double sum[lanes] = { 0 };
+				for (unsigned int p = 0; p < k; ++p)
+				{
+					const double* x = a + (i * k + p) * lanes;
+					const double* y = b + (p * n + j) * lanes;
+					for (unsigned int w = 0; w < lanes; ++w) sum[w] += x[w] * y[w];
+				}
+				for (unsigned int w = 0; w < lanes; ++w) product[(i * n + j) * lanes + w] = sum[w];
+			}
+		}
+		a += m * k * lanes;
+		b += k * n * lanes;
+		product += m * n * lanes;
+	}
+}
+
+/**
+ * @brief Batched Gauss-Jordan elimination with partial pivoting.  Each lane picks its own
+ *     pivot by comparing column k of every row below k with row k and swapping when it is
+ *     larger, which leaves the largest one in row k.  The SIMD versions make the same swaps
+ *     with blends so every lane follows the same instructions.
+ */
+static void batchInverseScalar(unsigned int n, const double* a, double* inverse, size_t numGroups)
+{
+	const unsigned int lanes = SIMD_BATCH_LANES;
+	std::vector<double> m(n * n * lanes);
+
+	for (size_t g = 0; g < numGroups; ++g)
+	{
+		double* inv = inverse + g * n * n * lanes;
+		for (unsigned int e = 0; e < n * n; ++e)
+		{
+			for (unsigned int w = 0; w < lanes; ++w)
+			{
+				m[e * lanes + w] = a[(g * n * n + e) * lanes + w];
+				inv[e * lanes + w] = (e / n == e % n) ? 1.0 : 0.0;
+			}
+		}
+
+		bool singular[lanes] = { false };
+		for (unsigned int k = 0; k < n; ++k)
+		{
+			for (unsigned int r = k + 1; r < n; ++r)
+			{
+				for (unsigned int w = 0; w < lanes; ++w)
+				{
+					if (std::fabs(m[(r * n + k) * lanes + w]) <= std::fabs(m[(k * n + k) * lanes + w])) continue;
+					for (unsigned int c = 0; c < n; ++c)
+					{
+						double temp = m[(k * n + c) * lanes + w];
+						m[(k * n + c) * lanes + w] = m[(r * n + c) * lanes + w];
+						m[(r * n + c) * lanes + w] = temp;
+						temp = inv[(k * n + c) * lanes + w];
+						inv[(k * n + c) * lanes + w] = inv[(r * n + c) * lanes + w];
+						inv[(r * n + c) * lanes + w] = temp;
+					}
+				}
+			}
+
+			double scale[lanes];
+			for (unsigned int w = 0; w < lanes; ++w)
+			{
+				singular[w] = singular[w] || m[(k * n + k) * lanes + w] == 0.0;
+				scale[w] = 1.0 / m[(k * n + k) * lanes + w];
+			}
+			for (unsigned int c = 0; c < n; ++c)
+			{
+				for (unsigned int w = 0; w < lanes; ++w)
+				{
+					m[(k * n + c) * lanes + w] *= scale[w];
+					inv[(k * n + c) * lanes + w] *= scale[w];
+				}
+			}
+
+			for (unsigned int r = 0; r < n; ++r)
+			{
+				if (r == k) continue;
+				double factor[lanes];
+				for (unsigned int w = 0; w < lanes; ++w) factor[w] = m[(r * n + k) * lanes + w];
+				for (unsigned int c = 0; c < n; ++c)
+				{
+					for (unsigned int w = 0; w < lanes; ++w)
+					{
+						m[(r * n + c) * lanes + w] -= factor[w] * m[(k * n + c) * lanes + w];
+						inv[(r * n + c) * lanes + w] -= factor[w] * inv[(k * n + c) * lanes + w];
+					}
+				}
+			}
+		}
+
+		for (unsigned int w = 0; w < lanes; ++w)
+		{
+			if (!singular[w]) continue;
+			for (unsigned int e = 0; e < n * n; ++e) inv[e * lanes + w] = std::numeric_limits<double>::quiet_NaN();
+		}
+	}
+}
+
+#ifdef MATH_SIMD_X86
+
+// =============================================================================================
+// SSE2 kernels
+// =============================================================================================
+
+MATH_TARGET_SSE2 static double horizontalSumSse2(__m128d v)
+{
+	__m128d high = _mm_unpackhi_pd(v, v);
+	return _mm_cvtsd_f64(_mm_add_sd(v, high));
+}
+
+MATH_TARGET_SSE2 static double dotProductSse2(const double* x, const double* y, size_t n)
+{
+	__m128d sum0 = _mm_setzero_pd();
+	__m128d sum1 = _mm_setzero_pd();
+
+	size_t i = 0;
+	for (; i + 4 <= n; i += 4)
+	{
+		sum0 = _mm_add_pd(sum0, _mm_mul_pd(_mm_loadu_pd(x + i), _mm_loadu_pd(y + i)));
+		sum1 = _mm_add_pd(sum1, _mm_mul_pd(_mm_loadu_pd(x + i + 2), _mm_loadu_pd(y + i + 2)));
+	}
+
+	double result = horizontalSumSse2(_mm_add_pd(sum0, sum1));
+	for (; i < n; ++i)
+	{
+		result += x[i] * y[i];
+	}
+	return result;
+}
+
+MATH_TARGET_SSE2 static void axpySse2(double alpha, const double* x, double* y, size_t n)
+{
+	__m128d alphaV = _mm_set1_pd(alpha);
+
+	size_t i = 0;
+	for (; i + 2 <= n; i += 2)
+	{
+		_mm_storeu_pd(y + i, _mm_add_pd(_mm_loadu_pd(y + i), _mm_mul_pd(alphaV, _mm_loadu_pd(x + i))));
+	}
+	for (; i < n; ++i)
+	{
+		y[i] += alpha * x[i];
+	}
+}
+
+MATH_TARGET_SSE2 static void scaleSse2(double alpha, double* x, size_t n)
+{
+	__m128d alphaV = _mm_set1_pd(alpha);
+
+	size_t i = 0;
+	for (; i + 2 <= n; i += 2)
+	{
+		_mm_storeu_pd(x + i, _mm_mul_pd(alphaV, _mm_loadu_pd(x + i)));
+	}
+	for (; i < n; ++i)
+	{
+		x[i] *= alpha;
+	}
+}
+
+MATH_TARGET_SSE2 static double sumOfSquaresSse2(const double* x, size_t n)
+{
+	return dotProductSse2(x, x, n);
+}
+
+MATH_TARGET_SSE2 static float horizontalSumSse2(__m128 v)
+{
+	__m128 high = _mm_movehl_ps(v, v);
+	v = _mm_add_ps(v, high);
+	high = _mm_shuffle_ps(v, v, 1);
+	return _mm_cvtss_f32(_mm_add_ss(v, high));
+}
+
+MATH_TARGET_SSE2 static float dotProductSse2(const float* x, const float* y, size_t n)
+{
+	__m128 sum0 = _mm_setzero_ps();
+	__m128 sum1 = _mm_setzero_ps();
+
+	size_t i = 0;
+	for (; i + 8 <= n; i += 8)
+	{
+		sum0 = _mm_add_ps(sum0, _mm_mul_ps(_mm_loadu_ps(x + i), _mm_loadu_ps(y + i)));
+		sum1 = _mm_add_ps(sum1, _mm_mul_ps(_mm_loadu_ps(x + i + 4), _mm_loadu_ps(y + i + 4)));
+	}
+
+	float result = horizontalSumSse2(_mm_add_ps(sum0, sum1));
+	for (; i < n; ++i)
+	{
+		result += x[i] * y[i];
+	}
+	return result;
+}
+
+MATH_TARGET_SSE2 static void axpySse2(float alpha, const float* x, float* y, size_t n)
+{
+	__m128 alphaV = _mm_set1_ps(alpha);
+
+	size_t i = 0;
+	for (; i + 4 <= n; i += 4)
+	{
+		_mm_storeu_ps(y + i, _mm_add_ps(_mm_loadu_ps(y + i), _mm_mul_ps(alphaV, _mm_loadu_ps(x + i))));
+	}
+	for (; i < n; ++i)
+	{
+		y[i] += alpha * x[i];
+	}
+}
+
+MATH_TARGET_SSE2 static void scaleSse2(float alpha, float* x, size_t n)
+{
+	__m128 alphaV = _mm_set1_ps(alpha);
+
+	size_t i = 0;
+	for (; i + 4 <= n; i += 4)
+	{
+		_mm_storeu_ps(x + i, _mm_mul_ps(alphaV, _mm_loadu_ps(x + i)));
+	}
+	for (; i < n; ++i)
+	{
+		x[i] *= alpha;
+	}
+}
+
+MATH_TARGET_SSE2 static float sumOfSquaresSse2(const float* x, size_t n)
+{
+	return dotProductSse2(x, x, n);
+}
+
+// =============================================================================================
+// AVX2 + FMA kernels
+// =============================================================================================
+
+MATH_TARGET_AVX2 static double horizontalSumAvx2(__m256d v)
+{
+	__m128d low = _mm256_castpd256_pd128(v);
+	__m128d high = _mm256_extractf128_pd(v, 1);
+	low = _mm_add_pd(low, high);
+	high = _mm_unpackhi_pd(low, low);
+	return _mm_cvtsd_f64(_mm_add_sd(low, high));
+}
+
+MATH_TARGET_AVX2 static double dotProductAvx2(const double* x, const double* y, size_t n)
+{
+	// Four independent accumulators hide the latency of the fused multiply-add
+	__m256d sum0 = _mm256_setzero_pd();
+	__m256d sum1 = _mm256_setzero_pd();
+	__m256d sum2 = _mm256_setzero_pd();
+	__m256d sum3 = _mm256_setzero_pd();
+
+	size_t i = 0;
+	for (; i + 16 <= n; i += 16)
+	{
+		sum0 = _mm256_fmadd_pd(_mm256_loadu_pd(x + i), _mm256_loadu_pd(y + i), sum0);
+		sum1 = _mm256_fmadd_pd(_mm256_loadu_pd(x + i + 4), _mm256_loadu_pd(y + i + 4), sum1);
+		sum2 = _mm256_fmadd_pd(_mm256_loadu_pd(x + i + 8), _mm256_loadu_pd(y + i + 8), sum2);
+		sum3 = _mm256_fmadd_pd(_mm256_loadu_pd(x + i + 12), _mm256_loadu_pd(y + i + 12), sum3);
+	}
+	for (; i + 4 <= n; i += 4)
+	{
+		sum0 = _mm256_fmadd_pd(_mm256_loadu_pd(x + i), _mm256_loadu_pd(y + i), sum0);
+	}
+
+	double result = horizontalSumAvx2(_mm256_add_pd(_mm256_add_pd(sum0, sum1), _mm256_add_pd(sum2, sum3)));
+	for (; i < n; ++i)
+	{
+		result += x[i] * y[i];
+	}
+	return result;
+}
+
+MATH_TARGET_AVX2 static void axpyAvx2(double alpha, const double* x, double* y, size_t n)
+{
+	__m256d alphaV = _mm256_set1_pd(alpha);
+
+	size_t i = 0;
+	for (; i + 8 <= n; i += 8)
+	{
+		_mm256_storeu_pd(y + i, _mm256_fmadd_pd(alphaV, _mm256_loadu_pd(x + i), _mm256_loadu_pd(y + i)));
+		_mm256_storeu_pd(y + i + 4, _mm256_fmadd_pd(alphaV, _mm256_loadu_pd(x + i + 4), _mm256_loadu_pd(y + i + 4)));
+	}
+	for (; i < n; ++i)
+	{
+		y[i] += alpha * x[i];
+	}
+}
+
+MATH_TARGET_AVX2 static void scaleAvx2(double alpha, double* x, size_t n)
+{
+	__m256d alphaV = _mm256_set1_pd(alpha);
+
+	size_t i = 0;
+	for (; i + 4 <= n; i += 4)
+	{
+		_mm256_storeu_pd(x + i, _mm256_mul_pd(alphaV, _mm256_loadu_pd(x + i)));
+	}
+	for (; i < n; ++i)
+	{
+		x[i] *= alpha;
+	}
+}
+
+MATH_TARGET_AVX2 static double sumOfSquaresAvx2(const double* x, size_t n)
+{
+	return dotProductAvx2(x, x, n);
+}
+
+static constexpr unsigned int AVX2_MR = 6;
+static constexpr unsigned int AVX2_NR = 8;
+
+/**
+ * @brief 6 x 8 micro-kernel.  The twelve accumulators, two rows of B and one broadcast
+ *     element of A use 15 of the 16 ymm registers.
+ */
+MATH_TARGET_AVX2 static void gemmMicroKernelAvx2(unsigned int kc, double alpha, const double* a,
+	const double* b, double beta, double* c, size_t rowStride, size_t colStride)
+{
+	__m256d c00 = _mm256_setzero_pd(), c01 = _mm256_setzero_pd();
+	__m256d c10 = _mm256_setzero_pd(), c11 = _mm256_setzero_pd();
+	__m256d c20 = _mm256_setzero_pd(), c21 = _mm256_setzero_pd();
+	__m256d c30 = _mm256_setzero_pd(), c31 = _mm256_setzero_pd();
+	__m256d c40 = _mm256_setzero_pd(), c41 = _mm256_setzero_pd();
+	__m256d c50 = _mm256_setzero_pd(), c51 = _mm256_setzero_pd();
+
+	for (unsigned int p = 0; p < kc; ++p)
+	{
+		__m256d b0 = _mm256_loadu_pd(b);
+		__m256d b1 = _mm256_loadu_pd(b + 4);
+		__m256d ai;
+
+		ai = _mm256_broadcast_sd(a + 0); c00 = _mm256_fmadd_pd(ai, b0, c00); c01 = _mm256_fmadd_pd(ai, b1, c01);
+		ai = _mm256_broadcast_sd(a + 1); c10 = _mm256_fmadd_pd(ai, b0, c10); c11 = _mm256_fmadd_pd(ai, b1, c11);
+		ai = _mm256_broadcast_sd(a + 2); c20 = _mm256_fmadd_pd(ai, b0, c20); c21 = _mm256_fmadd_pd(ai, b1, c21);
+		ai = _mm256_broadcast_sd(a + 3); c30 = _mm256_fmadd_pd(ai, b0, c30); c31 = _mm256_fmadd_pd(ai, b1, c31);
+		ai = _mm256_broadcast_sd(a + 4); c40 = _mm256_fmadd_pd(ai, b0, c40); c41 = _mm256_fmadd_pd(ai, b1, c41);
+		ai = _mm256_broadcast_sd(a + 5); c50 = _mm256_fmadd_pd(ai, b0, c50); c51 = _mm256_fmadd_pd(ai, b1, c51);
+
+		a += AVX2_MR;
+		b += AVX2_NR;
+	}
+
+	double ab[AVX2_MR * AVX2_NR];
+	_mm256_storeu_pd(ab + 0, c00); _mm256_storeu_pd(ab + 4, c01);
+	_mm256_storeu_pd(ab + 8, c10); _mm256_storeu_pd(ab + 12, c11);
+	_mm256_storeu_pd(ab + 16, c20); _mm256_storeu_pd(ab + 20, c21);
+	_mm256_storeu_pd(ab + 24, c30); _mm256_storeu_pd(ab + 28, c31);
+	_mm256_storeu_pd(ab + 32, c40); _mm256_storeu_pd(ab + 36, c41);
+	_mm256_storeu_pd(ab + 40, c50); _mm256_storeu_pd(ab + 44, c51);
+
+	writeBackGemmBlock(AVX2_MR, AVX2_NR, alpha, ab, beta, c, rowStride, colStride);
+}
+
+MATH_TARGET_AVX2 static float horizontalSumAvx2(__m256 v)
+{
+	__m128 low = _mm256_castps256_ps128(v);
+	__m128 high = _mm256_extractf128_ps(v, 1);
+	low = _mm_add_ps(low, high);
+	high = _mm_movehl_ps(low, low);
+	low = _mm_add_ps(low, high);
+	high = _mm_shuffle_ps(low, low, 1);
+	return _mm_cvtss_f32(_mm_add_ss(low, high));
+}
+
+MATH_TARGET_AVX2 static float dotProductAvx2(const float* x, const float* y, size_t n)
+{
+	__m256 sum0 = _mm256_setzero_ps();
+	__m256 sum1 = _mm256_setzero_ps();
+	__m256 sum2 = _mm256_setzero_ps();
+	__m256 sum3 = _mm256_setzero_ps();
+
+	size_t i = 0;
+	for (; i + 32 <= n; i += 32)
+	{
+		sum0 = _mm256_fmadd_ps(_mm256_loadu_ps(x + i), _mm256_loadu_ps(y + i), sum0);
+		sum1 = _mm256_fmadd_ps(_mm256_loadu_ps(x + i + 8), _mm256_loadu_ps(y + i + 8), sum1);
+		sum2 = _mm256_fmadd_ps(_mm256_loadu_ps(x + i + 16), _mm256_loadu_ps(y + i + 16), sum2);
+		sum3 = _mm256_fmadd_ps(_mm256_loadu_ps(x + i + 24), _mm256_loadu_ps(y + i + 24), sum3);
+	}
+	for (; i + 8 <= n; i += 8)
+	{
+		sum0 = _mm256_fmadd_ps(_mm256_loadu_ps(x + i), _mm256_loadu_ps(y + i), sum0);
+	}
+
+	float result = horizontalSumAvx2(_mm256_add_ps(_mm256_add_ps(sum0, sum1), _mm256_add_ps(sum2, sum3)));
+	for (; i < n; ++i)
+	{
+		result += x[i] * y[i];
+	}
+	return result;
+}
+
+MATH_TARGET_AVX2 static void axpyAvx2(float alpha, const float* x, float* y, size_t n)
+{
+	__m256 alphaV = _mm256_set1_ps(alpha);
+
+	size_t i = 0;
+	for (; i + 16 <= n; i += 16)
+	{
+		_mm256_storeu_ps(y + i, _mm256_fmadd_ps(alphaV, _mm256_loadu_ps(x + i), _mm256_loadu_ps(y + i)));
+		_mm256_storeu_ps(y + i + 8, _mm256_fmadd_ps(alphaV, _mm256_loadu_ps(x + i + 8), _mm256_loadu_ps(y + i + 8)));
+	}
+	for (; i < n; ++i)
+	{
+		y[i] += alpha * x[i];
+	}
+}
+
+MATH_TARGET_AVX2 static void scaleAvx2(float alpha, float* x, size_t n)
+{
+	__m256 alphaV = _mm256_set1_ps(alpha);
+
+	size_t i = 0;
+	for (; i + 8 <= n; i += 8)
+	{
+		_mm256_storeu_ps(x + i, _mm256_mul_ps(alphaV, _mm256_loadu_ps(x + i)));
+	}
+	for (; i < n; ++i)
+	{
+		x[i] *= alpha;
+	}
+}
+
+MATH_TARGET_AVX2 static float sumOfSquaresAvx2(const float* x, size_t n)
+{
+	return dotProductAvx2(x, x, n);
+}
+
+static constexpr unsigned int AVX2_FLOAT_NR = 16;
+
+/**
+ * @brief 6 x 16 float micro-kernel, the same register use as the double one with eight
+ *     elements in every register instead of four
+ */
+MATH_TARGET_AVX2 static void gemmMicroKernelAvx2(unsigned int kc, float alpha, const float* a,
+	const float* b, float beta, float* c, size_t rowStride, size_t colStride)
+{
+	__m256 acc[AVX2_MR][2];
+	for (unsigned int i = 0; i < AVX2_MR; ++i)
+	{
+		acc[i][0] = _mm256_setzero_ps();
+		acc[i][1] = _mm256_setzero_ps();
+	}
+
+	for (unsigned int p = 0; p < kc; ++p)
+	{
+		__m256 b0 = _mm256_loadu_ps(b);
+		__m256 b1 = _mm256_loadu_ps(b + 8);
+
+		for (unsigned int i = 0; i < AVX2_MR; ++i)
+		{
+			__m256 ai = _mm256_broadcast_ss(a + i);
+			acc[i][0] = _mm256_fmadd_ps(ai, b0, acc[i][0]);
+			acc[i][1] = _mm256_fmadd_ps(ai, b1, acc[i][1]);
+		}
+
+		a += AVX2_MR;
+		b += AVX2_FLOAT_NR;
+	}
+
+	float ab[AVX2_MR * AVX2_FLOAT_NR];
+	for (unsigned int i = 0; i < AVX2_MR; ++i)
+	{
+		_mm256_storeu_ps(ab + i * AVX2_FLOAT_NR, acc[i][0]);
+		_mm256_storeu_ps(ab + i * AVX2_FLOAT_NR + 8, acc[i][1]);
+	}
+
+	writeBackGemmBlock(AVX2_MR, AVX2_FLOAT_NR, alpha, ab, beta, c, rowStride, colStride);
+}
+
+/**
+ * @brief The batched products of @ref batchMultiplyAvx512 with each group of lanes in two
+ *     registers, so two columns of the products are accumulated together in four registers
+ */
+MATH_TARGET_AVX2 static void batchMultiplyAvx2(unsigned int m, unsigned int k, unsigned int n,
+	const double* a, const double* b, double* product, size_t numGroups)
+{
+	const unsigned int lanes = SIMD_BATCH_LANES;
+	for (size_t g = 0; g < numGroups; ++g)
+	{
+		for (unsigned int i = 0; i < m; ++i)
+		{
+			const double* aRow = a + i * k * lanes;
+			double* productRow = product + i * n * lanes;
+
+			unsigned int j = 0;
+			for (; j + 2 <= n; j += 2)
+			{
+				__m256d sum0 = _mm256_setzero_pd(), sum1 = _mm256_setzero_pd();
+				__m256d sum2 = _mm256_setzero_pd(), sum3 = _mm256_setzero_pd();
+				for (unsigned int p = 0; p < k; ++p)
+				{
+					__m256d aLow = _mm256_loadu_pd(aRow + p * lanes);
+					__m256d aHigh = _mm256_loadu_pd(aRow + p * lanes + 4);
+					const double* bRow = b + (p * n + j) * lanes;
+					sum0 = _mm256_fmadd_pd(aLow, _mm256_loadu_pd(bRow), sum0);
+					sum1 = _mm256_fmadd_pd(aHigh, _mm256_loadu_pd(bRow + 4), sum1);
+					sum2 = _mm256_fmadd_pd(aLow, _mm256_loadu_pd(bRow + lanes), sum2);
+					sum3 = _mm256_fmadd_pd(aHigh, _mm256_loadu_pd(bRow + lanes + 4), sum3);
+				}
+				_mm256_storeu_pd(productRow + j * lanes, sum0);
+				_mm256_storeu_pd(productRow + j * lanes + 4, sum1);
+				_mm256_storeu_pd(productRow + (j + 1) * lanes, sum2);
+				_mm256_storeu_pd(productRow + (j + 1) * lanes + 4, sum3);
+			}
+			if (j < n)
+			{
+				__m256d sum0 = _mm256_setzero_pd(), sum1 = _mm256_setzero_pd();
+				for (unsigned int p = 0; p < k; ++p)
+				{
+					const double* bRow = b + (p * n + j) * lanes;
+					sum0 = _mm256_fmadd_pd(_mm256_loadu_pd(aRow + p * lanes), _mm256_loadu_pd(bRow), sum0);
+					sum1 = _mm256_fmadd_pd(_mm256_loadu_pd(aRow + p * lanes + 4), _mm256_loadu_pd(bRow + 4), sum1);
+				}
+				_mm256_storeu_pd(productRow + j * lanes, sum0);
+				_mm256_storeu_pd(productRow + j * lanes + 4, sum1);
+			}
+		}
+		a += m * k * lanes;
+		b += k * n * lanes;
+		product += m * n * lanes;
+	}
+}
+
+/**
+ * @brief The Gauss-Jordan elimination of @ref batchInverseScalar on four lanes at a time, with
+ *     the row swaps of the pivot search done by blends under a compare mask
+ */
+MATH_TARGET_AVX2 static void batchInverseAvx2(unsigned int n, const double* a, double* inverse, size_t numGroups)
+{
+	const unsigned int lanes = SIMD_BATCH_LANES;
+	std::vector<double> scratch(n * n * lanes);
+	double* m = scratch.data();
+	const __m256d signBit = _mm256_set1_pd(-0.0);
+	const __m256d zero = _mm256_setzero_pd();
+	const __m256d one = _mm256_set1_pd(1.0);
+
+	for (size_t g = 0; g < numGroups; ++g)
+	{
+		const double* aGroup = a + g * n * n * lanes;
+		double* inv = inverse + g * n * n * lanes;
+
+		for (unsigned int half = 0; half < lanes; half += 4)
+		{
+			for (unsigned int e = 0; e < n * n; ++e)
+			{
+				_mm256_storeu_pd(m + e * lanes + half, _mm256_loadu_pd(aGroup + e * lanes + half));
+				_mm256_storeu_pd(inv + e * lanes + half, (e / n == e % n) ? one : zero);
+			}
+
+			__m256d singular = zero;
+			for (unsigned int k = 0; k < n; ++k)
+			{
+				double* rowK = m + k * n * lanes + half;
+				double* invK = inv + k * n * lanes + half;
+
+				for (unsigned int r = k + 1; r < n; ++r)
+				{
+					double* rowR = m + r * n * lanes + half;
+					double* invR = inv + r * n * lanes + half;
+					__m256d swap = _mm256_cmp_pd(_mm256_andnot_pd(signBit, _mm256_loadu_pd(rowR + k * lanes)),
+						_mm256_andnot_pd(signBit, _mm256_loadu_pd(rowK + k * lanes)), _CMP_GT_OQ);
+					if (_mm256_movemask_pd(swap) == 0) continue;
+
+					for (unsigned int c = 0; c < n; ++c)
+					{
+						__m256d top = _mm256_loadu_pd(rowK + c * lanes);
+						__m256d bottom = _mm256_loadu_pd(rowR + c * lanes);
+						_mm256_storeu_pd(rowK + c * lanes, _mm256_blendv_pd(top, bottom, swap));
+						_mm256_storeu_pd(rowR + c * lanes, _mm256_blendv_pd(bottom, top, swap));
+
+						top = _mm256_loadu_pd(invK + c * lanes);
+						bottom = _mm256_loadu_pd(invR + c * lanes);
+						_mm256_storeu_pd(invK + c * lanes, _mm256_blendv_pd(top, bottom, swap));
+						_mm256_storeu_pd(invR + c * lanes, _mm256_blendv_pd(bottom, top, swap));
+					}
+				}
+
+				__m256d pivot = _mm256_loadu_pd(rowK + k * lanes);
+				singular = _mm256_or_pd(singular, _mm256_cmp_pd(pivot, zero, _CMP_EQ_OQ));
+				__m256d scale = _mm256_div_pd(one, pivot);
+				for (unsigned int c = 0; c < n; ++c)
+				{
+					_mm256_storeu_pd(rowK + c * lanes, _mm256_mul_pd(scale, _mm256_loadu_pd(rowK + c * lanes)));
+					_mm256_storeu_pd(invK + c * lanes, _mm256_mul_pd(scale, _mm256_loadu_pd(invK + c * lanes)));
+				}
+
+				for (unsigned int r = 0; r < n; ++r)
+				{
+					if (r == k) continue;
+					double* rowR = m + r * n * lanes + half;
+					double* invR = inv + r * n * lanes + half;
+					__m256d factor = _mm256_loadu_pd(rowR + k * lanes);
+					for (unsigned int c = 0; c < n; ++c)
+					{
+						_mm256_storeu_pd(rowR + c * lanes, _mm256_fnmadd_pd(factor,
+							_mm256_loadu_pd(rowK + c * lanes), _mm256_loadu_pd(rowR + c * lanes)));
+						_mm256_storeu_pd(invR + c * lanes, _mm256_fnmadd_pd(factor,
+							_mm256_loadu_pd(invK + c * lanes), _mm256_loadu_pd(invR + c * lanes)));
+					}
+				}
+			}
+
+			if (_mm256_movemask_pd(singular) != 0)
+			{
+				__m256d nan = _mm256_set1_pd(std::numeric_limits<double>::quiet_NaN());
+				for (unsigned int e = 0; e < n * n; ++e)
+				{
+					double* element = inv + e * lanes + half;
+					_mm256_storeu_pd(element, _mm256_blendv_pd(_mm256_loadu_pd(element), nan, singular));
+				}
+			}
+		}
+	}
+}
+
+// =============================================================================================
+// AVX-512 kernels
+// =============================================================================================
+
+MATH_TARGET_AVX512 static double dotProductAvx512(const double* x, const double* y, size_t n)
+{
+	__m512d sum0 = _mm512_setzero_pd();
+	__m512d sum1 = _mm512_setzero_pd();
+	__m512d sum2 = _mm512_setzero_pd();
+	__m512d sum3 = _mm512_setzero_pd();
+
+	size_t i = 0;
+	for (; i + 32 <= n; i += 32)
+	{
+		sum0 = _mm512_fmadd_pd(_mm512_loadu_pd(x + i), _mm512_loadu_pd(y + i), sum0);
+		sum1 = _mm512_fmadd_pd(_mm512_loadu_pd(x + i + 8), _mm512_loadu_pd(y + i + 8), sum1);
+		sum2 = _mm512_fmadd_pd(_mm512_loadu_pd(x + i + 16), _mm512_loadu_pd(y + i + 16), sum2);
+		sum3 = _mm512_fmadd_pd(_mm512_loadu_pd(x + i + 24), _mm512_loadu_pd(y + i + 24), sum3);
+	}
+	for (; i + 8 <= n; i += 8)
+	{
+		sum0 = _mm512_fmadd_pd(_mm512_loadu_pd(x + i), _mm512_loadu_pd(y + i), sum0);
+	}
+	if (i < n)
+	{
+		// The last few elements are loaded with a mask so nothing past the end is read
+		__mmask8 tail = (__mmask8)((1u << (n - i)) - 1);
+		sum1 = _mm512_fmadd_pd(_mm512_maskz_loadu_pd(tail, x + i), _mm512_maskz_loadu_pd(tail, y + i), sum1);
+	}
+
+	return _mm512_reduce_add_pd(_mm512_add_pd(_mm512_add_pd(sum0, sum1), _mm512_add_pd(sum2, sum3)));
+}
+
+MATH_TARGET_AVX512 static void axpyAvx512(double alpha, const double* x, double* y, size_t n)
+{
+	__m512d alphaV = _mm512_set1_pd(alpha);
+
+	size_t i = 0;
+	for (; i + 8 <= n; i += 8)
+	{
+		_mm512_storeu_pd(y + i, _mm512_fmadd_pd(alphaV, _mm512_loadu_pd(x + i), _mm512_loadu_pd(y + i)));
+	}
+	if (i < n)
+	{
+		__mmask8 tail = (__mmask8)((1u << (n - i)) - 1);
+		_mm512_mask_storeu_pd(y + i, tail,
+			_mm512_fmadd_pd(alphaV, _mm512_maskz_loadu_pd(tail, x + i), _mm512_maskz_loadu_pd(tail, y + i)));
+	}
+}
+
+MATH_TARGET_AVX512 static void scaleAvx512(double alpha, double* x, size_t n)
+{
+	__m512d alphaV = _mm512_set1_pd(alpha);
+
+	size_t i = 0;
+	for (; i + 8 <= n; i += 8)
+	{
+		_mm512_storeu_pd(x + i, _mm512_mul_pd(alphaV, _mm512_loadu_pd(x + i)));
+	}
+	if (i < n)
+	{
+		__mmask8 tail = (__mmask8)((1u << (n - i)) - 1);
+		_mm512_mask_storeu_pd(x + i, tail, _mm512_mul_pd(alphaV, _mm512_maskz_loadu_pd(tail, x + i)));
+	}
+}
+
+MATH_TARGET_AVX512 static double sumOfSquaresAvx512(const double* x, size_t n)
+{
+	return dotProductAvx512(x, x, n);
+}
+
+static constexpr unsigned int AVX512_MR = 8;
+static constexpr unsigned int AVX512_NR = 16;
+
+/**
+ * @brief 8 x 16 micro-kernel.  Sixteen of the 32 zmm registers hold accumulators which is
+ *     enough independent multiply-adds to keep both FMA units busy.
+ */
+MATH_TARGET_AVX512 static void gemmMicroKernelAvx512(unsigned int kc, double alpha, const double* a,
+	const double* b, double beta, double* c, size_t rowStride, size_t colStride)
+{
+	__m512d acc[AVX512_MR][2];
+	for (unsigned int i = 0; i < AVX512_MR; ++i)
+	{
+		acc[i][0] = _mm512_setzero_pd();
+		acc[i][1] = _mm512_setzero_pd();
+	}
+
+	for (unsigned int p = 0; p < kc; ++p)
+	{
+		__m512d b0 = _mm512_loadu_pd(b);
+		__m512d b1 = _mm512_loadu_pd(b + 8);
+
+		for (unsigned int i = 0; i < AVX512_MR; ++i)
+		{
+			__m512d ai = _mm512_set1_pd(a[i]);
+			acc[i][0] = _mm512_fmadd_pd(ai, b0, acc[i][0]);
+			acc[i][1] = _mm512_fmadd_pd(ai, b1, acc[i][1]);
+		}
+
+		a += AVX512_MR;
+		b += AVX512_NR;
+	}
+
+	double ab[AVX512_MR * AVX512_NR];
+	for (unsigned int i = 0; i < AVX512_MR; ++i)
+	{
+		_mm512_storeu_pd(ab + i * AVX512_NR, acc[i][0]);
+		_mm512_storeu_pd(ab + i * AVX512_NR + 8, acc[i][1]);
+	}
+
+	writeBackGemmBlock(AVX512_MR, AVX512_NR, alpha, ab, beta, c, rowStride, colStride);
+}
+
+MATH_TARGET_AVX512 static float dotProductAvx512(const float* x, const float* y, size_t n)
+{
+	__m512 sum0 = _mm512_setzero_ps();
+	__m512 sum1 = _mm512_setzero_ps();
+	__m512 sum2 = _mm512_setzero_ps();
+	__m512 sum3 = _mm512_setzero_ps();
+
+	size_t i = 0;
+	for (; i + 64 <= n; i += 64)
+	{
+		sum0 = _mm512_fmadd_ps(_mm512_loadu_ps(x + i), _mm512_loadu_ps(y + i), sum0);
+		sum1 = _mm512_fmadd_ps(_mm512_loadu_ps(x + i + 16), _mm512_loadu_ps(y + i + 16), sum1);
+		sum2 = _mm512_fmadd_ps(_mm512_loadu_ps(x + i + 32), _mm512_loadu_ps(y + i + 32), sum2);
+		sum3 = _mm512_fmadd_ps(_mm512_loadu_ps(x + i + 48), _mm512_loadu_ps(y + i + 48), sum3);
+	}
+	for (; i + 16 <= n; i += 16)
+	{
+		sum0 = _mm512_fmadd_ps(_mm512_loadu_ps(x + i), _mm512_loadu_ps(y + i), sum0);
+	}
+	if (i < n)
+	{
+		__mmask16 tail = (__mmask16)((1u << (n - i)) - 1);
+		sum1 = _mm512_fmadd_ps(_mm512_maskz_loadu_ps(tail, x + i), _mm512_maskz_loadu_ps(tail, y + i), sum1);
+	}
+
+	return _mm512_reduce_add_ps(_mm512_add_ps(_mm512_add_ps(sum0, sum1), _mm512_add_ps(sum2, sum3)));
+}
+
+MATH_TARGET_AVX512 static void axpyAvx512(float alpha, const float* x, float* y, size_t n)
+{
+	__m512 alphaV = _mm512_set1_ps(alpha);
+
+	size_t i = 0;
+	for (; i + 16 <= n; i += 16)
+	{
+		_mm512_storeu_ps(y + i, _mm512_fmadd_ps(alphaV, _mm512_loadu_ps(x + i), _mm512_loadu_ps(y + i)));
+	}
+	if (i < n)
+	{
+		__mmask16 tail = (__mmask16)((1u << (n - i)) - 1);
+		_mm512_mask_storeu_ps(y + i, tail,
+			_mm512_fmadd_ps(alphaV, _mm512_maskz_loadu_ps(tail, x + i), _mm512_maskz_loadu_ps(tail, y + i)));
+	}
+}
+
+MATH_TARGET_AVX512 static void scaleAvx512(float alpha, float* x, size_t n)
+{
+	__m512 alphaV = _mm512_set1_ps(alpha);
+
+	size_t i = 0;
+	for (; i + 16 <= n; i += 16)
+	{
+		_mm512_storeu_ps(x + i, _mm512_mul_ps(alphaV, _mm512_loadu_ps(x + i)));
+	}
+	if (i < n)
+	{
+		__mmask16 tail = (__mmask16)((1u << (n - i)) - 1);
+		_mm512_mask_storeu_ps(x + i, tail, _mm512_mul_ps(alphaV, _mm512_maskz_loadu_ps(tail, x + i)));
+	}
+}
+
+MATH_TARGET_AVX512 static float sumOfSquaresAvx512(const float* x, size_t n)
+{
+	return dotProductAvx512(x, x, n);
+}
+
+static constexpr unsigned int AVX512_FLOAT_NR = 32;
+
+/**
+ * @brief 8 x 32 float micro-kernel, sixteen elements in each of the sixteen accumulators
+ */
+MATH_TARGET_AVX512 static void gemmMicroKernelAvx512(unsigned int kc, float alpha, const float* a,
+	const float* b, float beta, float* c, size_t rowStride, size_t colStride)
+{
+	__m512 acc[AVX512_MR][2];
+	for (unsigned int i = 0; i < AVX512_MR; ++i)
+	{
+		acc[i][0] = _mm512_setzero_ps();
+		acc[i][1] = _mm512_setzero_ps();
+	}
+
+	for (unsigned int p = 0; p < kc; ++p)
+	{
+		__m512 b0 = _mm512_loadu_ps(b);
+		__m512 b1 = _mm512_loadu_ps(b + 16);
+
+		for (unsigned int i = 0; i < AVX512_MR; ++i)
+		{
+			__m512 ai = _mm512_set1_ps(a[i]);
+			acc[i][0] = _mm512_fmadd_ps(ai, b0, acc[i][0]);
+			acc[i][1] = _mm512_fmadd_ps(ai, b1, acc[i][1]);
+		}
+
+		a += AVX512_MR;
+		b += AVX512_FLOAT_NR;
+	}
+
+	float ab[AVX512_MR * AVX512_FLOAT_NR];
+	for (unsigned int i = 0; i < AVX512_MR; ++i)
+	{
+		_mm512_storeu_ps(ab + i * AVX512_FLOAT_NR, acc[i][0]);
+		_mm512_storeu_ps(ab + i * AVX512_FLOAT_NR + 16, acc[i][1]);
+	}
+
+	writeBackGemmBlock(AVX512_MR, AVX512_FLOAT_NR, alpha, ab, beta, c, rowStride, colStride);
+}
+
+/**
+ * @brief Batched products with a whole group of lanes in one register.  Four columns of a row
+ *     of the products are accumulated together so each element of a loaded is used four
+ *     times, and the columns left over are done one at a time.
+ */
+MATH_TARGET_AVX512 static void batchMultiplyAvx512(unsigned int m, unsigned int k, unsigned int n,
+	const double* a, const double* b, double* product, size_t numGroups)
+{
+	const unsigned int lanes = SIMD_BATCH_LANES;
+	for (size_t g = 0; g < numGroups; ++g)
+	{
+		for (unsigned int i = 0; i < m; ++i)
+		{
+			const double* aRow = a + i * k * lanes;
+			double* productRow = product + i * n * lanes;
+
+			unsigned int j = 0;
+			for (; j + 4 <= n; j += 4)
+			{
+				__m512d sum0 = _mm512_setzero_pd(), sum1 = _mm512_setzero_pd();
+				__m512d sum2 = _mm512_setzero_pd(), sum3 = _mm512_setzero_pd();
+				for (unsigned int p = 0; p < k; ++p)
+				{
+					__m512d aip = _mm512_loadu_pd(aRow + p * lanes);
+					const double* bRow = b + (p * n + j) * lanes;
+					sum0 = _mm512_fmadd_pd(aip, _mm512_loadu_pd(bRow), sum0);
+					sum1 = _mm512_fmadd_pd(aip, _mm512_loadu_pd(bRow + lanes), sum1);
+					sum2 = _mm512_fmadd_pd(aip, _mm512_loadu_pd(bRow + 2 * lanes), sum2);
+					sum3 = _mm512_fmadd_pd(aip, _mm512_loadu_pd(bRow + 3 * lanes), sum3);
+				}
+				_mm512_storeu_pd(productRow + j * lanes, sum0);
+				_mm512_storeu_pd(productRow + (j + 1) * lanes, sum1);
+				_mm512_storeu_pd(productRow + (j + 2) * lanes, sum2);
+				_mm512_storeu_pd(productRow + (j + 3) * lanes, sum3);
+			}
+			for (; j < n; ++j)
+			{
+				__m512d sum = _mm512_setzero_pd();
+				for (unsigned int p = 0; p < k; ++p)
+				{
+					sum = _mm512_fmadd_pd(_mm512_loadu_pd(aRow + p * lanes),
+						_mm512_loadu_pd(b + (p * n + j) * lanes), sum);
+				}
+				_mm512_storeu_pd(productRow + j * lanes, sum);
+			}
+		}
+		a += m * k * lanes;
+		b += k * n * lanes;
+		product += m * n * lanes;
+	}
+}
+
+// The Gauss-Jordan elimination of @ref batchInverseScalar with the swaps done by mask blends
+MATH_TARGET_AVX512 static void batchInverseAvx512(unsigned int n, const double* a, double* inverse, size_t numGroups)
+{
+	const unsigned int lanes = SIMD_BATCH_LANES;
+	std::vector<double> scratch(n * n * lanes);
+	double* m = scratch.data();
+	const __m512d zero = _mm512_setzero_pd();
+	const __m512d one = _mm512_set1_pd(1.0);
+
+	for (size_t g = 0; g < numGroups; ++g)
+	{
+		const double* aGroup = a + g * n * n * lanes;
+		double* inv = inverse + g * n * n * lanes;
+		for (unsigned int e = 0; e < n * n; ++e)
+		{
+			_mm512_storeu_pd(m + e * lanes, _mm512_loadu_pd(aGroup + e * lanes));
+			_mm512_storeu_pd(inv + e * lanes, (e / n == e % n) ? one : zero);
+		}
+
+		__mmask8 singular = 0;
+		for (unsigned int k = 0; k < n; ++k)
+		{
+			double* rowK = m + k * n * lanes;
+			double* invK = inv + k * n * lanes;
+
+			for (unsigned int r = k + 1; r < n; ++r)
+			{
+				double* rowR = m + r * n * lanes;
+				double* invR = inv + r * n * lanes;
+				__mmask8 swap = _mm512_cmp_pd_mask(_mm512_abs_pd(_mm512_loadu_pd(rowR + k * lanes)),
+					_mm512_abs_pd(_mm512_loadu_pd(rowK + k * lanes)), _CMP_GT_OQ);
+				if (swap == 0) continue;
+
+				for (unsigned int c = 0; c < n; ++c)
+				{
+					__m512d top = _mm512_loadu_pd(rowK + c * lanes);
+					__m512d bottom = _mm512_loadu_pd(rowR + c * lanes);
+					_mm512_storeu_pd(rowK + c * lanes, _mm512_mask_blend_pd(swap, top, bottom));
+					_mm512_storeu_pd(rowR + c * lanes, _mm512_mask_blend_pd(swap, bottom, top));
+
+					top = _mm512_loadu_pd(invK + c * lanes);
+					bottom = _mm512_loadu_pd(invR + c * lanes);
+					_mm512_storeu_pd(invK + c * lanes, _mm512_mask_blend_pd(swap, top, bottom));
+					_mm512_storeu_pd(invR + c * lanes, _mm512_mask_blend_pd(swap, bottom, top));
+				}
+			}
+
+			__m512d pivot = _mm512_loadu_pd(rowK + k * lanes);
+			singular |= _mm512_cmp_pd_mask(pivot, zero, _CMP_EQ_OQ);
+			__m512d scale = _mm512_div_pd(one, pivot);
+			for (unsigned int c = 0; c < n; ++c)
+			{
+				_mm512_storeu_pd(rowK + c * lanes, _mm512_mul_pd(scale, _mm512_loadu_pd(rowK + c * lanes)));
+				_mm512_storeu_pd(invK + c * lanes, _mm512_mul_pd(scale, _mm512_loadu_pd(invK + c * lanes)));
+			}
+
+			for (unsigned int r = 0; r < n; ++r)
+			{
+				if (r == k) continue;
+				double* rowR = m + r * n * lanes;
+				double* invR = inv + r * n * lanes;
+				__m512d factor = _mm512_loadu_pd(rowR + k * lanes);
+				for (unsigned int c = 0; c < n; ++c)
+				{
+					_mm512_storeu_pd(rowR + c * lanes, _mm512_fnmadd_pd(factor,
+						_mm512_loadu_pd(rowK + c * lanes), _mm512_loadu_pd(rowR + c * lanes)));
+					_mm512_storeu_pd(invR + c * lanes, _mm512_fnmadd_pd(factor,
+						_mm512_loadu_pd(invK + c * lanes), _mm512_loadu_pd(invR + c * lanes)));
+				}
+			}
+		}
+
+		if (singular != 0)
+		{
+			__m512d nan = _mm512_set1_pd(std::numeric_limits<double>::quiet_NaN());
+			for (unsigned int e = 0; e < n * n; ++e)
+			{
+				_mm512_storeu_pd(inv + e * lanes, _mm512_mask_blend_pd(singular, _mm512_loadu_pd(inv + e * lanes), nan));
+			}
+		}
+	}
+}
+
+// =============================================================================================
+// CPU detection
+// =============================================================================================
+
+static void cpuid(int leaf, int subleaf, unsigned int registers[4])
+{
+#if defined(_MSC_VER)
+	int info[4];
+	__cpuidex(info, leaf, subleaf);
+	for (int i = 0; i < 4; ++i) registers[i] = (unsigned int)info[i];
+#else
+	__cpuid_count(leaf, subleaf, registers[0], registers[1], registers[2], registers[3]);
+#endif
+}
+
+// Returns the register of the OS telling which vector registers it saves on a context switch
+static unsigned long long readXcr0()
+{
+#if defined(_MSC_VER)
+	return _xgetbv(0);
+#else
+	unsigned int eax, edx;
+	__asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+	return ((unsigned long long)edx << 32) | eax;
+#endif
+}
+
+static simd_instruction_set_t detectSimdInstructionSet()
+{
+	unsigned int registers[4];
+
+	cpuid(0, 0, registers);
+	unsigned int maxLeaf = registers[0];
+
+	cpuid(1, 0, registers);
+	bool hasSse2 = (registers[3] >> 26) & 1;
+	bool hasFma = (registers[2] >> 12) & 1;
+	bool hasOsxsave = (registers[2] >> 27) & 1;
+	bool hasAvx = (registers[2] >> 28) & 1;
+
+	if (!hasSse2)
+	{
+		return SIMD_SCALAR;
+	}
+	if (!hasOsxsave || !hasAvx || !hasFma || maxLeaf < 7)
+	{
+		return SIMD_SSE2;
+	}
+
+	// The OS has to save the ymm (and for AVX-512 the zmm and mask) registers too
+	unsigned long long xcr0 = readXcr0();
+	bool osSavesYmm = (xcr0 & 0x06) == 0x06;
+	bool osSavesZmm = (xcr0 & 0xE6) == 0xE6;
+
+	cpuid(7, 0, registers);
+	bool hasAvx2 = (registers[1] >> 5) & 1;
+	bool hasAvx512f = (registers[1] >> 16) & 1;
+
+	if (hasAvx512f && osSavesZmm)
+	{
+		return SIMD_AVX512;
+	}
+	if (hasAvx2 && osSavesYmm)
+	{
+		return SIMD_AVX2;
+	}
+	return SIMD_SSE2;
+}
+
+#else
+
+static simd_instruction_set_t detectSimdInstructionSet()
+{
+	return SIMD_SCALAR;
+}
+
+#endif // MATH_SIMD_X86
+
+// =============================================================================================
+// Dispatch
+// =============================================================================================
+
+struct SimdKernelTable
+{
+	simd_instruction_set_t instructionSet;
+	double (*dotProduct)(const double*, const double*, size_t);
+	void (*axpy)(double, const double*, double*, size_t);
+	void (*scale)(double, double*, size_t);
+	double (*sumOfSquares)(const double*, size_t);
+	GemmMicroKernel gemm;
+
+	float (*dotProductF)(const float*, const float*, size_t);
+	void (*axpyF)(float, const float*, float*, size_t);
+	void (*scaleF)(float, float*, size_t);
+	float (*sumOfSquaresF)(const float*, size_t);
+	GemmMicroKernelF gemmF;
+
+	void (*batchMultiply)(unsigned int, unsigned int, unsigned int, const double*, const double*, double*, size_t);
+	void (*batchInverse)(unsigned int, const double*, double*, size_t);
+};
+
+static const SimdKernelTable scalarKernels = { SIMD_SCALAR,
+	dotProductScalar<double>, axpyScalar<double>, scaleScalar<double>, sumOfSquaresScalar<double>,
+	{ SCALAR_MR, SCALAR_NR, gemmMicroKernelScalar<double> },
+	dotProductScalar<float>, axpyScalar<float>, scaleScalar<float>, sumOfSquaresScalar<float>,
+	{ SCALAR_MR, SCALAR_NR, gemmMicroKernelScalar<float> },
+	batchMultiplyScalar, batchInverseScalar };
+
+#ifdef MATH_SIMD_X86
+// SSE2 is two lanes wide which the compiler already uses for the portable micro-kernel
+static const SimdKernelTable sse2Kernels = { SIMD_SSE2,
+	dotProductSse2, axpySse2, scaleSse2, sumOfSquaresSse2,
+	{ SCALAR_MR, SCALAR_NR, gemmMicroKernelScalar<double> },
+	dotProductSse2, axpySse2, scaleSse2, sumOfSquaresSse2,
+	{ SCALAR_MR, SCALAR_NR, gemmMicroKernelScalar<float> },
+	batchMultiplyScalar, batchInverseScalar };
+static const SimdKernelTable avx2Kernels = { SIMD_AVX2,
+	dotProductAvx2, axpyAvx2, scaleAvx2, sumOfSquaresAvx2,
+	{ AVX2_MR, AVX2_NR, gemmMicroKernelAvx2 },
+	dotProductAvx2, axpyAvx2, scaleAvx2, sumOfSquaresAvx2,
+	{ AVX2_MR, AVX2_FLOAT_NR, gemmMicroKernelAvx2 },
+	batchMultiplyAvx2, batchInverseAvx2 };
+static const SimdKernelTable avx512Kernels = { SIMD_AVX512,
+	dotProductAvx512, axpyAvx512, scaleAvx512, sumOfSquaresAvx512,
+	{ AVX512_MR, AVX512_NR, gemmMicroKernelAvx512 },
+	dotProductAvx512, axpyAvx512, scaleAvx512, sumOfSquaresAvx512,
+	{ AVX512_MR, AVX512_FLOAT_NR, gemmMicroKernelAvx512 },
+	batchMultiplyAvx512, batchInverseAvx512 };
+#endif
+
+static const SimdKernelTable* kernelTableFor(simd_instruction_set_t instructionSet)
+{
+#ifdef MATH_SIMD_X86
+	switch (instructionSet)
+	{
+	case SIMD_AVX512: return &avx512Kernels;
+	case SIMD_AVX2: return &avx2Kernels;
+	case SIMD_SSE2: return &sse2Kernels;
+	default: break;
+	}
+#endif
+	return &scalarKernels;
+}
+
+static std::atomic<const SimdKernelTable*>& activeKernelTable()
+{
+	// Detected once, the first time any kernel is used
+	static std::atomic<const SimdKernelTable*> table(kernelTableFor(getSupportedSimdInstructionSet()));
+	return table;
+}
+
+static const SimdKernelTable& kernels()
+{
+	return *activeKernelTable().load(std::memory_order_relaxed);
+}
+
+// =============================================================================================
+// Outside of class functions
+// =============================================================================================
+
+simd_instruction_set_t getSupportedSimdInstructionSet()
+{
+	static const simd_instruction_set_t supported = detectSimdInstructionSet();
+	return supported;
+}
+
+simd_instruction_set_t getSimdInstructionSet()
+{
+	return kernels().instructionSet;
+}
+
+bool setSimdInstructionSet(simd_instruction_set_t instructionSet)
+{
+	if (instructionSet > getSupportedSimdInstructionSet())
+	{
+		return false;
+	}
+	activeKernelTable().store(kernelTableFor(instructionSet));
+	return true;
+}
+
+double simdDotProduct(const double* x, const double* y, size_t n)
+{
+	return kernels().dotProduct(x, y, n);
+}
+
+void simdAxpy(double alpha, const double* x, double* y, size_t n)
+{
+	kernels().axpy(alpha, x, y, n);
+}
+
+void simdScale(double alpha, double* x, size_t n)
+{
+	kernels().scale(alpha, x, n);
+}
+
+double simdSumOfSquares(const double* x, size_t n)
+{
+	return kernels().sumOfSquares(x, n);
+}
+
+GemmMicroKernel getGemmMicroKernel()
+{
+	return kernels().gemm;
+}
+
+float simdDotProduct(const float* x, const float* y, size_t n)
+{
+	return kernels().dotProductF(x, y, n);
+}
+
+void simdAxpy(float alpha, const float* x, float* y, size_t n)
+{
+	kernels().axpyF(alpha, x, y, n);
+}
+
+void simdScale(float alpha, float* x, size_t n)
+{
+	kernels().scaleF(alpha, x, n);
+}
+
+float simdSumOfSquares(const float* x, size_t n)
+{
+	return kernels().sumOfSquaresF(x, n);
+}
+
+GemmMicroKernelF getGemmMicroKernelF()
+{
+	return kernels().gemmF;
+}
+
+void simdBatchMultiply(unsigned int m, unsigned int k, unsigned int n, const double* a,
+	const double* b, double* product, size_t numGroups)
+{
+	kernels().batchMultiply(m, k, n, a, b, product, numGroups);
+}
+
+void simdBatchInverse(unsigned int n, const double* a, double* inverse, size_t numGroups)
+{
+	kernels().batchInverse(n, a, inverse, numGroups);
+}
@@ -0,0 +1,103 @@
+#pragma once
+
+#ifndef __MATH_SIMD_KERNELS_H
+#define __MATH_SIMD_KERNELS_H
+
+#include <cstddef>
+
+/**
+ * @brief The instruction sets the kernels of this file are written for, from slowest to
+ *     fastest.  Each one includes the ones before it.
+ */
+typedef enum { SIMD_SCALAR, SIMD_SSE2, SIMD_AVX2, SIMD_AVX512 } simd_instruction_set_t;
+
+/**
+ * @brief The fastest instruction set both the processor and the operating system support.
+ *     This is found with CPUID the first time any kernel runs, so one binary runs at full
+ *     width on every machine.
+ */
+simd_instruction_set_t getSupportedSimdInstructionSet();
+
+/**
+ * @brief The instruction set the kernels currently run with.  This is
+ *     @ref getSupportedSimdInstructionSet unless it was lowered with @ref setSimdInstructionSet.
+ */
+simd_instruction_set_t getSimdInstructionSet();
+
+/**
+ * @brief Makes every kernel run with the given instruction set.  Useful for comparing
+ *     instruction sets on the same machine.
+ * @return false and leaves the kernels alone if the machine does not support it
+ */
+bool setSimdInstructionSet(simd_instruction_set_t instructionSet);
+
+// The kernels all work on n contiguous elements and accept unaligned pointers.  Every kernel
+//     has a float version too, which fits twice as many elements in each vector register.
+
+// Returns x . y
+double simdDotProduct(const double* x, const double* y, size_t n);
+float simdDotProduct(const float* x, const float* y, size_t n);
+
+// y += alpha * x
+void simdAxpy(double alpha, const double* x, double* y, size_t n);
+void simdAxpy(float alpha, const float* x, float* y, size_t n);
+
+// x *= alpha
+void simdScale(double alpha, double* x, size_t n);
+void simdScale(float alpha, float* x, size_t n);
+
+// Returns x . x
+double simdSumOfSquares(const double* x, size_t n);
+float simdSumOfSquares(const float* x, size_t n);
+
+/**
+ * @brief Computes the mr x nr block C = alpha * A * B + beta * C where A is a packed micro-panel
+ *     holding the mr elements of each of its kc columns next to each other and B is a packed
+ *     micro-panel holding the nr elements of each of its kc rows next to each other.  If beta
+ *     is 0 then C is not read.
+ */
+typedef void (*gemm_micro_kernel_t)(unsigned int kc, double alpha, const double* a, const double* b,
+	double beta, double* c, size_t rowStride, size_t colStride);
+typedef void (*gemm_micro_kernel_float_t)(unsigned int kc, float alpha, const float* a, const float* b,
+	float beta, float* c, size_t rowStride, size_t colStride);
+
+/**
+ * @brief A GEMM micro-kernel together with the size of the block of C it computes.  The
+ *     size is picked per instruction set so all the accumulators fit in the vector registers.
+ */
+struct GemmMicroKernel
+{
+	unsigned int mr;
+	unsigned int nr;
+	gemm_micro_kernel_t kernel;
+};
+
+// The float micro-kernels compute blocks twice as wide since a register holds twice the elements
+struct GemmMicroKernelF
+{
+	unsigned int mr;
+	unsigned int nr;
+	gemm_micro_kernel_float_t kernel;
+};
+
+// The largest mr and nr of any micro-kernel
+static constexpr unsigned int GEMM_MAX_MR = 8;
+static constexpr unsigned int GEMM_MAX_NR = 32;
+
+GemmMicroKernel getGemmMicroKernel();
+GemmMicroKernelF getGemmMicroKernelF();
+
+// The batch kernels work on groups of SIMD_BATCH_LANES small matrices of the same size stored
+//     interleaved, so element e of matrix w of a group is group[e * SIMD_BATCH_LANES + w] with
+//     the elements of each matrix numbered by row.  Groups follow each other in memory.  This
+//     is the layout of @ref MathMatrixBatch.
+static constexpr unsigned int SIMD_BATCH_LANES = 8;
+
+// The m x n products of the m x k matrices of @ref a and the k x n matrices of @ref b
+void simdBatchMultiply(unsigned int m, unsigned int k, unsigned int n, const double* a,
+	const double* b, double* product, size_t numGroups);
+
+// The inverses of the n x n matrices of @ref a, with every element NAN for singular ones
+void simdBatchInverse(unsigned int n, const double* a, double* inverse, size_t numGroups);
+
+#endif // __MATH_SIMD_KERNELS_H
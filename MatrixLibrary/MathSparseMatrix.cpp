@@ -0,0 +1,480 @@
+#include "pch.h"
+#include "MathSparseMatrix.h"
+#include "MathSimdKernels.h"
+#include "MathThreadPool.h"
+#include <algorithm>
+#include <cmath>
+
+// Products with fewer nonzeros than this are not worth waking the thread pool for
+static constexpr size_t SPARSE_PARALLEL_THRESHOLD = 32 * 1024;
+
+// Gathering products are split into this many ranges of vectors per thread so a thread that
+//     finishes early can take another range
+static constexpr unsigned int SPARSE_TASKS_PER_THREAD = 4;
+
+MathSparseMatrix::MathSparseMatrix(unsigned int numRows, unsigned int numCols, vector_space_t space)
+	: space_(space), numRows_(numRows), numCols_(numCols)
+{
+	offsets_.assign((size_t)getNumVectorsInSpace() + 1, 0);
+}
+
+/**
+ * @brief Compresses @ref dense, keeping only the elements with |a| > @ref dropTolerance
+ */
+MathSparseMatrix::MathSparseMatrix(const MathMatrixView& dense, vector_space_t space,
+	double dropTolerance)
+	: space_(space), numRows_(dense.getNumRows()), numCols_(dense.getNumCols())
+{
+	unsigned int numVectors = getNumVectorsInSpace();
+	unsigned int vectorSize = getSizeOfVectorsInSpace();
+
+	// Element j of vector i of the space
+	const double* data = dense.getData();
+	size_t vectorStride = (space_ == ROWSPACE) ? dense.getRowStride() : dense.getColStride();
+	size_t elementStride = (space_ == ROWSPACE) ? dense.getColStride() : dense.getRowStride();
+
+	offsets_.assign((size_t)numVectors + 1, 0);
+	for (unsigned int i = 0; i < numVectors; ++i)
+	{
+		size_t count = 0;
+		for (unsigned int j = 0; j < vectorSize; ++j)
+		{
+			count += (std::fabs(data[i * vectorStride + j * elementStride]) > dropTolerance);
+		}
+		offsets_[i + 1] = offsets_[i] + count;
+	}
+
+	indices_.resize(offsets_[numVectors]);
+	values_.resize(offsets_[numVectors]);
+	size_t next = 0;
+	for (unsigned int i = 0; i < numVectors; ++i)
+	{
+		for (unsigned int j = 0; j < vectorSize; ++j)
+		{
+			double value = data[i * vectorStride + j * elementStride];
+			if (std::fabs(value) > dropTolerance)
+			{
+				indices_[next] = j;
+				values_[next] = value;
+				++next;
+			}
+		}
+	}
+}
+
+/**
+ * @brief Takes over compressed arrays.  Vector i of @ref space owns the elements offsets[i]
+ *     up to offsets[i + 1] of @ref indices and @ref values.
+ * @return false and leaves the matrix unchanged if the arrays do not have matching sizes, an
+ *     index is out of range or the indices of a vector are not strictly increasing
+ */
+bool MathSparseMatrix::setCompressed(unsigned int numRows, unsigned int numCols,
+	vector_space_t space, std::vector<size_t> offsets, std::vector<unsigned int> indices,
+	std::vector<double> values)
+{
+	unsigned int numVectors = (space == ROWSPACE) ? numRows : numCols;
+	unsigned int vectorSize = (space == ROWSPACE) ? numCols : numRows;
+
+	if (offsets.size() != (size_t)numVectors + 1 || offsets[0] != 0 ||
+		offsets[numVectors] != indices.size() || indices.size() != values.size())
+	{
+		return false;
+	}
+
+	for (unsigned int i = 0; i < numVectors; ++i)
+	{
+		if (offsets[i + 1] < offsets[i])
+		{
+			return false;
+		}
+		for (size_t p = offsets[i]; p < offsets[i + 1]; ++p)
+		{
+			if (indices[p] >= vectorSize || (p > offsets[i] && indices[p] <= indices[p - 1]))
+			{
+				return false;
+			}
+		}
+	}
+
+	space_ = space;
+	numRows_ = numRows;
+	numCols_ = numCols;
+	offsets_ = std::move(offsets);
+	indices_ = std::move(indices);
+	values_ = std::move(values);
+	return true;
+}
+
+/**
+ * @brief Finds the element by binary search in its vector of the space
+ * @return NAN if the element is out of range, 0 if it is not stored
+ */
+double MathSparseMatrix::getVal(unsigned int row, unsigned int col) const
+{
+	if (row >= numRows_ || col >= numCols_) { return NAN; }
+
+	unsigned int vector = (space_ == ROWSPACE) ? row : col;
+	unsigned int index = (space_ == ROWSPACE) ? col : row;
+
+	auto first = indices_.begin() + offsets_[vector];
+	auto last = indices_.begin() + offsets_[vector + 1];
+	auto found = std::lower_bound(first, last, index);
+	if (found == last || *found != index)
+	{
+		return 0.0;
+	}
+	return values_[found - indices_.begin()];
+}
+
+size_t MathSparseMatrix::getMemoryUsage() const
+{
+	return offsets_.capacity() * sizeof(size_t) + indices_.capacity() * sizeof(unsigned int) +
+		values_.capacity() * sizeof(double);
+}
+
+/**
+ * @brief CSR of A is CSC of A^T, so only the sizes and the space change
+ */
+void MathSparseMatrix::transpose()
+{
+	std::swap(numRows_, numCols_);
+	space_ = (space_ == ROWSPACE) ? COLUMNSPACE : ROWSPACE;
+}
+
+/**
+ * @brief Converts between CSR and CSC with a counting sort of the nonzeros by their index.
+ *     Walking the vectors in order leaves the new indices sorted.
+ */
+MathSparseMatrix MathSparseMatrix::convertTo(vector_space_t space) const
+{
+	if (space == space_)
+	{
+		return *this;
+	}
+
+	unsigned int numVectors = getNumVectorsInSpace();
+	unsigned int vectorSize = getSizeOfVectorsInSpace();
+
+	MathSparseMatrix converted(numRows_, numCols_, space);
+	std::vector<size_t>& offsets = converted.offsets_;
+	for (unsigned int index : indices_)
+	{
+		++offsets[index + 1];
+	}
+	for (unsigned int j = 0; j < vectorSize; ++j)
+	{
+		offsets[j + 1] += offsets[j];
+	}
+
+	converted.indices_.resize(values_.size());
+	converted.values_.resize(values_.size());
+	std::vector<size_t> next(offsets.begin(), offsets.end() - 1);
+	for (unsigned int i = 0; i < numVectors; ++i)
+	{
+		for (size_t p = offsets_[i]; p < offsets_[i + 1]; ++p)
+		{
+			size_t to = next[indices_[p]]++;
+			converted.indices_[to] = i;
+			converted.values_[to] = values_[p];
+		}
+	}
+	return converted;
+}
+
+MathMatrix MathSparseMatrix::toDense() const
+{
+	MathMatrix dense(numRows_, numCols_);
+	unsigned int numVectors = getNumVectorsInSpace();
+	for (unsigned int i = 0; i < numVectors; ++i)
+	{
+		for (size_t p = offsets_[i]; p < offsets_[i + 1]; ++p)
+		{
+			if (space_ == ROWSPACE) dense.setVal(i, indices_[p], values_[p]);
+			else dense.setVal(indices_[p], i, values_[p]);
+		}
+	}
+	return dense;
+}
+
+// =============================================================================================
+// Outside of class functions
+// =============================================================================================
+
+/**
+ * @brief Splits the vectors of the space into @ref numParts ranges of consecutive vectors with
+ *     about the same cost each, where a vector costs one for itself and one per nonzero.
+ *     Range p is boundaries[p] up to boundaries[p + 1].
+ */
+static std::vector<unsigned int> partitionByNonZeros(const std::vector<size_t>& offsets,
+	unsigned int numParts)
+{
+	unsigned int numVectors = (unsigned int)offsets.size() - 1;
+	double total = (double)offsets[numVectors] + numVectors;
+
+	std::vector<unsigned int> boundaries(numParts + 1, numVectors);
+	boundaries[0] = 0;
+	for (unsigned int p = 1; p < numParts; ++p)
+	{
+		double target = total * p / numParts;
+		unsigned int lo = boundaries[p - 1], hi = numVectors;
+		while (lo < hi)
+		{
+			unsigned int mid = lo + (hi - lo) / 2;
+			if ((double)offsets[mid] + mid < target) lo = mid + 1;
+			else hi = mid;
+		}
+		boundaries[p] = lo;
+	}
+	return boundaries;
+}
+
+/**
+ * @brief y[i] = alpha * (vector i of the space) . x + beta * y[i] for vectors first up to last
+ */
+static void gatherRange(const MathSparseMatrix& a, unsigned int first, unsigned int last,
+	const double* x, double* y, double alpha, double beta)
+{
+	const size_t* offsets = a.getOffsets().data();
+	const unsigned int* indices = a.getIndices().data();
+	const double* values = a.getValues().data();
+
+	for (unsigned int i = first; i < last; ++i)
+	{
+		double sum = 0.0;
+		for (size_t p = offsets[i]; p < offsets[i + 1]; ++p)
+		{
+			sum += values[p] * x[indices[p]];
+		}
+		y[i] = (beta == 0.0) ? alpha * sum : alpha * sum + beta * y[i];
+	}
+}
+
+/**
+ * @brief y += alpha * x[i] * (vector i of the space) for vectors first up to last
+ */
+static void scatterRange(const MathSparseMatrix& a, unsigned int first, unsigned int last,
+	const double* x, double* y, double alpha)
+{
+	const size_t* offsets = a.getOffsets().data();
+	const unsigned int* indices = a.getIndices().data();
+	const double* values = a.getValues().data();
+
+	for (unsigned int i = first; i < last; ++i)
+	{
+		double scaled = alpha * x[i];
+		for (size_t p = offsets[i]; p < offsets[i + 1]; ++p)
+		{
+			y[indices[p]] += values[p] * scaled;
+		}
+	}
+}
+
+static void gather(const MathSparseMatrix& a, const double* x, double* y, double alpha, double beta)
+{
+	unsigned int numVectors = (unsigned int)a.getOffsets().size() - 1;
+	MathThreadPool& pool = MathThreadPool::getInstance();
+	unsigned int numThreads = pool.getNumThreads();
+	if (numThreads == 1 || a.getNumNonZeros() < SPARSE_PARALLEL_THRESHOLD)
+	{
+		gatherRange(a, 0, numVectors, x, y, alpha, beta);
+		return;
+	}
+
+	std::vector<unsigned int> boundaries = partitionByNonZeros(a.getOffsets(),
+		numThreads * SPARSE_TASKS_PER_THREAD);
+	pool.parallelFor((unsigned int)boundaries.size() - 1, [&](unsigned int task)
+	{
+		gatherRange(a, boundaries[task], boundaries[task + 1], x, y, alpha, beta);
+	});
+}
+
+/**
+ * @brief y = alpha * sum of x[i] * (vector i of the space) + beta * y.  In parallel every task
+ *     scatters its share of the vectors into a zeroed buffer of its own and the buffers are
+ *     then added into y a range of elements per task.  That costs a buffer the size of y per
+ *     thread, so it is only done when there are more nonzeros than elements of y.
+ */
+static void scatter(const MathSparseMatrix& a, const double* x, double* y, size_t ySize,
+	double alpha, double beta)
+{
+	unsigned int numVectors = (unsigned int)a.getOffsets().size() - 1;
+	MathThreadPool& pool = MathThreadPool::getInstance();
+	unsigned int numThreads = pool.getNumThreads();
+
+	if (numThreads == 1 || a.getNumNonZeros() < SPARSE_PARALLEL_THRESHOLD ||
+		a.getNumNonZeros() < ySize)
+	{
+		if (beta == 0.0) std::fill(y, y + ySize, 0.0);
+		else if (beta != 1.0) simdScale(beta, y, ySize);
+		scatterRange(a, 0, numVectors, x, y, alpha);
+		return;
+	}
+
+	std::vector<unsigned int> boundaries = partitionByNonZeros(a.getOffsets(), numThreads);
+	std::vector<double> buffers(numThreads * ySize, 0.0);
+	pool.parallelFor(numThreads, [&](unsigned int task)
+	{
+		scatterRange(a, boundaries[task], boundaries[task + 1], x, buffers.data() + task * ySize, alpha);
+	});
+
+	size_t chunk = (ySize + numThreads - 1) / numThreads;
+	pool.parallelFor(numThreads, [&](unsigned int task)
+	{
+		size_t first = std::min(ySize, task * chunk);
+		size_t last = std::min(ySize, first + chunk);
+		for (size_t j = first; j < last; ++j)
+		{
+			double sum = (beta == 0.0) ? 0.0 : beta * y[j];
+			for (unsigned int t = 0; t < numThreads; ++t)
+			{
+				sum += buffers[t * ySize + j];
+			}
+			y[j] = sum;
+		}
+	});
+}
+
+bool multiply(const MathSparseMatrix& a, const MathVector& x, MathVector& y,
+	double alpha, double beta, bool transposeA)
+{
+	unsigned int xSize = transposeA ? a.getNumRows() : a.getNumCols();
+	unsigned int ySize = transposeA ? a.getNumCols() : a.getNumRows();
+
+	if (x.getOperationSize() != xSize || &x == &y)
+	{
+		return false;
+	}
+	if (y.getOperationSize() != ySize)
+	{
+		if (beta != 0.0)
+		{
+			return false;
+		}
+		y = MathVector(ySize);
+	}
+	if (ySize == 0)
+	{
+		return true;
+	}
+
+	// A * x reads each row once, which for CSR is gathering along the vectors of the space
+	bool rowsAreVectors = (a.getSpaceToRepresentMatrixAs() == ROWSPACE) != transposeA;
+	if (rowsAreVectors)
+	{
+		gather(a, x.getData(), y.getData(), alpha, beta);
+	}
+	else
+	{
+		scatter(a, x.getData(), y.getData(), ySize, alpha, beta);
+	}
+	return true;
+}
+
+MathVector operator*(const MathSparseMatrix& a, const MathVector& x)
+{
+	MathVector y;
+	multiply(a, x, y);
+	return y;
+}
+
+MathVector transposeMultiply(const MathSparseMatrix& a, const MathVector& x)
+{
+	MathVector y;
+	multiply(a, x, y, 1.0, 0.0, true);
+	return y;
+}
+
+/**
+ * @brief C = A * B for a dense B.  CSR fills C a row at a time from the rows of B, with the
+ *     rows split between the threads by their nonzeros.  CSC fills C a column at a time by
+ *     scattering the columns of A, one column of C per task.
+ */
+MathMatrix operator*(const MathSparseMatrix& a, const MathMatrix& b)
+{
+	MathMatrixView bView = b.getView();
+	unsigned int m = a.getNumRows();
+	unsigned int n = bView.getNumCols();
+	if (bView.getNumRows() != a.getNumCols() || m == 0 || n == 0)
+	{
+		return MathMatrix();
+	}
+
+	const size_t* offsets = a.getOffsets().data();
+	const unsigned int* indices = a.getIndices().data();
+	const double* values = a.getValues().data();
+	const double* bData = bView.getData();
+	size_t bRS = bView.getRowStride();
+	size_t bCS = bView.getColStride();
+
+	MathThreadPool& pool = MathThreadPool::getInstance();
+	unsigned int numThreads = pool.getNumThreads();
+	bool parallel = numThreads > 1 && a.getNumNonZeros() * n >= SPARSE_PARALLEL_THRESHOLD;
+
+	if (a.getSpaceToRepresentMatrixAs() == ROWSPACE)
+	{
+		MathMatrix c(n, m);
+		c.transpose();
+		double* cData = c.getData();
+		size_t ldc = c.getLeadingDimension();
+
+		auto rowRange = [&](unsigned int first, unsigned int last)
+		{
+			for (unsigned int i = first; i < last; ++i)
+			{
+				double* cRow = cData + i * ldc;
+				for (size_t p = offsets[i]; p < offsets[i + 1]; ++p)
+				{
+					const double* bRow = bData + indices[p] * bRS;
+					if (bCS == 1)
+					{
+						simdAxpy(values[p], bRow, cRow, n);
+					}
+					else
+					{
+						for (unsigned int j = 0; j < n; ++j) cRow[j] += values[p] * bRow[j * bCS];
+					}
+				}
+			}
+		};
+
+		if (!parallel)
+		{
+			rowRange(0, m);
+			return c;
+		}
+
+		std::vector<unsigned int> boundaries = partitionByNonZeros(a.getOffsets(),
+			numThreads * SPARSE_TASKS_PER_THREAD);
+		pool.parallelFor((unsigned int)boundaries.size() - 1, [&](unsigned int task)
+		{
+			rowRange(boundaries[task], boundaries[task + 1]);
+		});
+		return c;
+	}
+
+	MathMatrix c(m, n);
+	double* cData = c.getData();
+	size_t ldc = c.getLeadingDimension();
+	unsigned int k = a.getNumCols();
+
+	auto column = [&](unsigned int j)
+	{
+		double* cCol = cData + j * ldc;
+		for (unsigned int col = 0; col < k; ++col)
+		{
+			double scale = bData[col * bRS + j * bCS];
+			for (size_t p = offsets[col]; p < offsets[col + 1]; ++p)
+			{
+				cCol[indices[p]] += values[p] * scale;
+			}
+		}
+	};
+
+	if (!parallel)
+	{
+		for (unsigned int j = 0; j < n; ++j) column(j);
+		return c;
+	}
+	pool.parallelFor(n, column);
+	return c;
+}
@@ -0,0 +1,102 @@
+#pragma once
+
+#ifndef __MATH_SPARSE_MATRIX_H
+#define __MATH_SPARSE_MATRIX_H
+
+#include <cstddef>
+#include <vector>
+#include "MathMatrix.h"
+#include "MathMatrixView.h"
+#include "MathVector.h"
+
+/**
+ * @brief A matrix that stores only its nonzero elements, in compressed sparse row (CSR) or
+ *     compressed sparse column (CSC) form.  Memory grows with the number of nonzeros, not
+ *     with rows * cols.
+ * @note The space works like the space of @ref MathMatrix.  With @ref ROWSPACE the matrix is a
+ *     list of compressed rows (CSR), with @ref COLUMNSPACE a list of compressed columns (CSC).
+ *     Vector i of the space owns the elements getOffsets()[i] up to getOffsets()[i + 1] of
+ *     getIndices() and getValues(), and its indices are strictly increasing.  transpose() only
+ *     swaps the space, and @ref convertTo rebuilds the matrix in the other space.
+ * @note Products that read each vector of the space once and write one element per vector,
+ *     A * x for CSR and A^T * x for CSC, split the vectors between the threads of
+ *     @ref MathThreadPool so every thread gets about the same number of nonzeros.  The other
+ *     products scatter into the result, so each thread adds into its own copy of it first.
+ */
+class MathSparseMatrix
+{
+public:
+
+	MathSparseMatrix() {}
+
+	// A matrix of zeros
+	MathSparseMatrix(unsigned int numRows, unsigned int numCols, vector_space_t space = ROWSPACE);
+
+	// Keeps the elements of @ref dense whose magnitude is above @ref dropTolerance
+	explicit MathSparseMatrix(const MathMatrixView& dense, vector_space_t space = ROWSPACE,
+		double dropTolerance = 0.0);
+
+	// Takes over arrays that are already compressed.  Returns false and leaves the matrix
+	//     unchanged if they do not describe a valid matrix in @ref space.
+	bool setCompressed(unsigned int numRows, unsigned int numCols, vector_space_t space,
+		std::vector<size_t> offsets, std::vector<unsigned int> indices, std::vector<double> values);
+
+	double getVal(unsigned int row, unsigned int col) const;
+
+	unsigned int getNumRows() const { return numRows_; }
+	unsigned int getNumCols() const { return numCols_; }
+	size_t getNumNonZeros() const { return values_.size(); }
+	vector_space_t getSpaceToRepresentMatrixAs() const { return space_; }
+
+	const std::vector<size_t>& getOffsets() const { return offsets_; }
+	const std::vector<unsigned int>& getIndices() const { return indices_; }
+	const std::vector<double>& getValues() const { return values_; }
+
+	// The bytes held by the compressed arrays
+	size_t getMemoryUsage() const;
+
+	void transpose();
+
+	// The same matrix stored in @ref space
+	MathSparseMatrix convertTo(vector_space_t space) const;
+
+	MathMatrix toDense() const;
+
+private:
+
+	unsigned int getNumVectorsInSpace() const { return (space_ == ROWSPACE) ? numRows_ : numCols_; }
+	unsigned int getSizeOfVectorsInSpace() const { return (space_ == ROWSPACE) ? numCols_ : numRows_; }
+
+	vector_space_t space_ = ROWSPACE;
+	unsigned int numRows_ = 0;
+	unsigned int numCols_ = 0;
+
+	// getNumVectorsInSpace() + 1 offsets into indices_ and values_
+	std::vector<size_t> offsets_ = { 0 };
+
+	// The column of each nonzero for CSR, its row for CSC
+	std::vector<unsigned int> indices_;
+	std::vector<double> values_;
+};
+
+// Outside of class functions
+
+/**
+ * @brief y = alpha * op(a) * x + beta * y, where op(a) is a or, if @ref transposeA is set, its
+ *     transpose.  Nothing is allocated when y already has the right size.
+ * @return false and changes nothing if the sizes do not match.  With beta == 0 a y of the
+ *     wrong size is resized instead, and its old elements are never read.
+ * @note @ref x and @ref y must not be the same vector
+ */
+bool multiply(const MathSparseMatrix& a, const MathVector& x, MathVector& y,
+	double alpha = 1.0, double beta = 0.0, bool transposeA = false);
+
+MathVector operator*(const MathSparseMatrix& a, const MathVector& x);
+
+// a^T * x without transposing @ref a
+MathVector transposeMultiply(const MathSparseMatrix& a, const MathVector& x);
+
+// a * b for a dense @ref b, an empty matrix if the sizes do not match
+MathMatrix operator*(const MathSparseMatrix& a, const MathMatrix& b);
+
+#endif // __MATH_SPARSE_MATRIX_H
@@ -0,0 +1,268 @@
+#include "pch.h"
+#include "MathSparseMatrixBuilder.h"
+#include "MathThreadPool.h"
+#include <algorithm>
+#include <atomic>
+
+// Fewer triplets than this are sorted on the calling thread
+static constexpr size_t BUILDER_PARALLEL_THRESHOLD = 64 * 1024;
+
+// Every counting task keeps a counter per vector, so there are only as many of them as leave at
+//     least this many triplets per counter.  The counters then take less memory than the triplets.
+static constexpr size_t BUILDER_TRIPLETS_PER_COUNTER = 2;
+
+// Sorting the vectors of the space is split into this many tasks per thread since their
+//     lengths can vary a lot
+static constexpr unsigned int BUILDER_SORT_TASKS_PER_THREAD = 4;
+
+static std::atomic<unsigned long long> nextBuilderId(1);
+
+MathSparseMatrixBuilder::MathSparseMatrixBuilder(unsigned int numRows, unsigned int numCols)
+	: numRows_(numRows), numCols_(numCols), id_(nextBuilderId++)
+{
+}
+
+bool MathSparseMatrixBuilder::add(unsigned int row, unsigned int col, double value)
+{
+	if (row >= numRows_ || col >= numCols_)
+	{
+		return false;
+	}
+
+	getBufferOfThisThread().triplets.push_back({ row, col, value });
+	return true;
+}
+
+size_t MathSparseMatrixBuilder::getNumTriplets() const
+{
+	size_t total = 0;
+	for (const std::unique_ptr<ThreadBuffer>& buffer : buffers_)
+	{
+		total += buffer->triplets.size();
+	}
+	return total;
+}
+
+void MathSparseMatrixBuilder::clear()
+{
+	for (std::unique_ptr<ThreadBuffer>& buffer : buffers_)
+	{
+		buffer->triplets.clear();
+	}
+}
+
+/**
+ * @brief Sorts the triplets into the vectors of @ref space and adds up duplicates.
+ * @note A counting sort by the vector of each triplet does the bulk of the work.  Every task
+ *     counts its share of the triplets per vector, the counts give each task its own place in
+ *     every vector, and the tasks then copy their triplets there without locking.  After that
+ *     each vector is short enough to sort on its own, and the vectors are split between tasks.
+ * @note Counting takes fewer tasks than the threads when there are few triplets per vector,
+ *     so a tall matrix with few triplets does not get a counter per vector for every thread.
+ */
+MathSparseMatrix MathSparseMatrixBuilder::build(vector_space_t space) const
+{
+	unsigned int numVectors = (space == ROWSPACE) ? numRows_ : numCols_;
+	bool byRow = (space == ROWSPACE);
+
+	// The triplets of all the buffers as one sequence, piece p holds elements
+	//     pieceStarts[p] up to pieceStarts[p + 1]
+	std::vector<const Triplet*> pieces;
+	std::vector<size_t> pieceStarts(1, 0);
+	for (const std::unique_ptr<ThreadBuffer>& buffer : buffers_)
+	{
+		if (!buffer->triplets.empty())
+		{
+			pieces.push_back(buffer->triplets.data());
+			pieceStarts.push_back(pieceStarts.back() + buffer->triplets.size());
+		}
+	}
+	size_t total = pieceStarts.back();
+
+	MathThreadPool& pool = MathThreadPool::getInstance();
+	unsigned int numTasks = (total >= BUILDER_PARALLEL_THRESHOLD) ? pool.getNumThreads() : 1;
+	auto runTasks = [&](unsigned int count, const std::function<void(unsigned int)>& task)
+	{
+		if (numTasks == 1) for (unsigned int t = 0; t < count; ++t) task(t);
+		else pool.parallelFor(count, task);
+	};
+
+	size_t tripletsPerCountTask = std::max<size_t>(numVectors, 1) * BUILDER_TRIPLETS_PER_COUNTER;
+	unsigned int numCountTasks = (unsigned int)std::max<size_t>(1,
+		std::min<size_t>(numTasks, total / tripletsPerCountTask));
+
+	// Calls fn on triplets task * total / numCountTasks up to the start of the next task
+	auto forEachTripletOfTask = [&](unsigned int task, auto&& fn)
+	{
+		size_t first = total * task / numCountTasks;
+		size_t last = total * (task + 1) / numCountTasks;
+		size_t piece = std::upper_bound(pieceStarts.begin(), pieceStarts.end(), first) - pieceStarts.begin() - 1;
+		for (size_t g = first; g < last; ++piece)
+		{
+			size_t end = std::min(last, pieceStarts[piece + 1]);
+			const Triplet* triplets = pieces[piece];
+			for (; g < end; ++g)
+			{
+				fn(triplets[g - pieceStarts[piece]]);
+			}
+		}
+	};
+
+	// slots[v * numCountTasks + t] counts the triplets of task t in vector v, then becomes where
+	//     the next one of them goes
+	std::vector<size_t> slots((size_t)numVectors * numCountTasks, 0);
+	runTasks(numCountTasks, [&](unsigned int task)
+	{
+		forEachTripletOfTask(task, [&](const Triplet& t)
+		{
+			++slots[(size_t)(byRow ? t.row : t.col) * numCountTasks + task];
+		});
+	});
+
+	std::vector<size_t> starts((size_t)numVectors + 1, 0);
+	size_t running = 0;
+	for (unsigned int v = 0; v < numVectors; ++v)
+	{
+		starts[v] = running;
+		for (unsigned int t = 0; t < numCountTasks; ++t)
+		{
+			size_t count = slots[(size_t)v * numCountTasks + t];
+			slots[(size_t)v * numCountTasks + t] = running;
+			running += count;
+		}
+	}
+	starts[numVectors] = running;
+
+	struct Entry
+	{
+		unsigned int index;
+		double value;
+	};
+	std::vector<Entry> staged(total);
+	runTasks(numCountTasks, [&](unsigned int task)
+	{
+		forEachTripletOfTask(task, [&](const Triplet& t)
+		{
+			size_t& slot = slots[(size_t)(byRow ? t.row : t.col) * numCountTasks + task];
+			staged[slot++] = { byRow ? t.col : t.row, t.value };
+		});
+	});
+	std::vector<size_t>().swap(slots);
+
+	// Ranges of vectors with about the same number of triplets for the sorting tasks
+	unsigned int numSortTasks = (numTasks == 1) ? 1 : numTasks * BUILDER_SORT_TASKS_PER_THREAD;
+	std::vector<unsigned int> boundaries(numSortTasks + 1, numVectors);
+	boundaries[0] = 0;
+	for (unsigned int p = 1; p < numSortTasks; ++p)
+	{
+		boundaries[p] = (unsigned int)(std::lower_bound(starts.begin(), starts.end() - 1,
+			total * p / numSortTasks) - starts.begin());
+	}
+
+	// Sorts every vector by index and adds duplicates into the first of them
+	std::vector<size_t> counts(numVectors, 0);
+	runTasks(numSortTasks, [&](unsigned int task)
+	{
+		for (unsigned int v = boundaries[task]; v < boundaries[task + 1]; ++v)
+		{
+			Entry* first = staged.data() + starts[v];
+			Entry* last = staged.data() + starts[v + 1];
+			std::stable_sort(first, last, [](const Entry& a, const Entry& b) { return a.index < b.index; });
+
+			size_t count = 0;
+			for (Entry* e = first; e < last; ++e)
+			{
+				if (count != 0 && first[count - 1].index == e->index) first[count - 1].value += e->value;
+				else first[count++] = *e;
+			}
+			counts[v] = count;
+		}
+	});
+
+	std::vector<size_t> offsets((size_t)numVectors + 1, 0);
+	for (unsigned int v = 0; v < numVectors; ++v)
+	{
+		offsets[v + 1] = offsets[v] + counts[v];
+	}
+
+	std::vector<unsigned int> indices(offsets[numVectors]);
+	std::vector<double> values(offsets[numVectors]);
+	runTasks(numSortTasks, [&](unsigned int task)
+	{
+		for (unsigned int v = boundaries[task]; v < boundaries[task + 1]; ++v)
+		{
+			for (size_t i = 0; i < counts[v]; ++i)
+			{
+				indices[offsets[v] + i] = staged[starts[v] + i].index;
+				values[offsets[v] + i] = staged[starts[v] + i].value;
+			}
+		}
+	});
+
+	MathSparseMatrix result;
+	result.setCompressed(numRows_, numCols_, space, std::move(offsets), std::move(indices), std::move(values));
+	return result;
+}
+
+MathMatrix MathSparseMatrixBuilder::toDense() const
+{
+	MathMatrix dense(numRows_, numCols_);
+	double* data = dense.getData();
+	size_t rowStride = dense.getRowStride();
+	size_t colStride = dense.getColStride();
+
+	for (const std::unique_ptr<ThreadBuffer>& buffer : buffers_)
+	{
+		for (const Triplet& t : buffer->triplets)
+		{
+			data[t.row * rowStride + t.col * colStride] += t.value;
+		}
+	}
+	return dense;
+}
+
+// ==============================================================================
+// Private Member functions
+// ==============================================================================
+
+/**
+ * @brief Every thread remembers the last builder it added to and its buffer there, so @ref add
+ *     takes the lock only when the thread switches to another builder
+ * @note Threads that interleave adds to several builders lock on every switch
+ */
+MathSparseMatrixBuilder::ThreadBuffer& MathSparseMatrixBuilder::getBufferOfThisThread()
+{
+	struct BufferCache
+	{
+		unsigned long long builderId = 0;
+		ThreadBuffer* buffer = nullptr;
+	};
+	static thread_local BufferCache cache;
+
+	if (cache.builderId == id_)
+	{
+		return *cache.buffer;
+	}
+
+	std::lock_guard<std::mutex> lock(buffersMutex_);
+	std::thread::id thisThread = std::this_thread::get_id();
+	ThreadBuffer* found = nullptr;
+	for (std::unique_ptr<ThreadBuffer>& buffer : buffers_)
+	{
+		if (buffer->owner == thisThread)
+		{
+			found = buffer.get();
+			break;
+		}
+	}
+	if (found == nullptr)
+	{
+		buffers_.push_back(std::unique_ptr<ThreadBuffer>(new ThreadBuffer()));
+		found = buffers_.back().get();
+		found->owner = thisThread;
+	}
+
+	cache.builderId = id_;
+	cache.buffer = found;
+	return *found;
+}
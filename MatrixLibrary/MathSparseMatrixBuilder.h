@@ -0,0 +1,81 @@
+#pragma once
+
+#ifndef __MATH_SPARSE_MATRIX_BUILDER_H
+#define __MATH_SPARSE_MATRIX_BUILDER_H
+
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "MathMatrix.h"
+#include "MathSparseMatrix.h"
+
+/**
+ * @brief Collects (row, col, value) triplets, the coordinate (COO) form of a sparse matrix,
+ *     from any number of threads at once and assembles them into a @ref MathSparseMatrix.
+ *     Triplets for the same element are added together, the way the element contributions of a
+ *     finite element mesh are assembled.
+ * @note Every thread that calls @ref add appends to a buffer of its own.  A thread remembers
+ *     only the last builder it added to, so it takes a lock to find its buffer when it adds to
+ *     a builder other than that one.  A thread filling one builder at a time locks once.
+ * @note @ref build sorts the triplets with a parallel counting sort by row (by column for CSC),
+ *     then sorts each row and adds up its duplicates in parallel.  Duplicates are added in the
+ *     order of the buffers, so the result can differ in the last bits between thread counts.
+ * @note @ref add may be called from many threads at the same time, but not at the same time as
+ *     @ref build, @ref toDense or @ref clear.
+ */
+class MathSparseMatrixBuilder
+{
+public:
+
+	MathSparseMatrixBuilder(unsigned int numRows, unsigned int numCols);
+
+	MathSparseMatrixBuilder(const MathSparseMatrixBuilder& other) = delete;
+	MathSparseMatrixBuilder& operator=(const MathSparseMatrixBuilder& other) = delete;
+
+	// Returns false and adds nothing if the element is out of range
+	bool add(unsigned int row, unsigned int col, double value);
+
+	unsigned int getNumRows() const { return numRows_; }
+	unsigned int getNumCols() const { return numCols_; }
+
+	// The number of triplets added so far, duplicates included
+	size_t getNumTriplets() const;
+
+	// Forgets every triplet but keeps the buffers for the next assembly
+	void clear();
+
+	MathSparseMatrix build(vector_space_t space = ROWSPACE) const;
+
+	// Adds every triplet into a dense matrix in one pass
+	MathMatrix toDense() const;
+
+private:
+
+	struct Triplet
+	{
+		unsigned int row;
+		unsigned int col;
+		double value;
+	};
+
+	struct ThreadBuffer
+	{
+		std::thread::id owner;
+		std::vector<Triplet> triplets;
+	};
+
+	ThreadBuffer& getBufferOfThisThread();
+
+	unsigned int numRows_;
+	unsigned int numCols_;
+
+	// Tells the builders apart in the buffer cache of each thread, never reused
+	unsigned long long id_;
+
+	// Owned by the builder, a buffer never moves once it is created
+	std::vector<std::unique_ptr<ThreadBuffer>> buffers_;
+	std::mutex buffersMutex_;
+};
+
+#endif // __MATH_SPARSE_MATRIX_BUILDER_H
@@ -0,0 +1,245 @@
+#include "pch.h"
+#include "MathStrassen.h"
+#include "MathMatrixMultiply.h"
+#include "MathThreadPool.h"
+
+// The crossover is never set below this, smaller blocks are far faster with the classical kernel
+static constexpr unsigned int STRASSEN_MIN_CROSSOVER = 16;
+
+// Block additions of at least this many elements are split between the threads
+static constexpr size_t STRASSEN_PARALLEL_ADD_THRESHOLD = 256 * 256;
+
+// =============================================================================================
+// Block helpers
+// =============================================================================================
+
+/**
+ * @brief out = x + sign * y for m x n blocks with any strides.  out may be x or y.  The inner
+ *     loop runs down the direction out is contiguous in, and when x and y are contiguous in
+ *     it too it is a plain loop over three arrays the compiler vectorizes.
+ */
+template <typename T>
+static void addBlocks(unsigned int m, unsigned int n, const T* x, size_t xRowStride, size_t xColStride,
+	T sign, const T* y, size_t yRowStride, size_t yColStride, T* out, size_t outRowStride, size_t outColStride)
+{
+	// Make the rows the contiguous direction of out by working on the transposes if needed
+	if (outRowStride != 1)
+	{
+		unsigned int temp = m; m = n; n = temp;
+		size_t s = xRowStride; xRowStride = xColStride; xColStride = s;
+		s = yRowStride; yRowStride = yColStride; yColStride = s;
+		s = outRowStride; outRowStride = outColStride; outColStride = s;
+	}
+
+	auto addColumns = [=](unsigned int first, unsigned int last)
+	{
+		for (unsigned int j = first; j < last; ++j)
+		{
+			const T* xj = x + j * xColStride;
+			const T* yj = y + j * yColStride;
+			T* outj = out + j * outColStride;
+			if (xRowStride == 1 && yRowStride == 1 && outRowStride == 1)
+			{
+				for (unsigned int i = 0; i < m; ++i) outj[i] = xj[i] + sign * yj[i];
+			}
+			else
+			{
+				for (unsigned int i = 0; i < m; ++i)
+				{
+					outj[i * outRowStride] = xj[i * xRowStride] + sign * yj[i * yRowStride];
+				}
+			}
+		}
+	};
+
+	MathThreadPool& pool = MathThreadPool::getInstance();
+	unsigned int numThreads = pool.getNumThreads();
+	if (numThreads == 1 || (size_t)m * n < STRASSEN_PARALLEL_ADD_THRESHOLD)
+	{
+		addColumns(0, n);
+		return;
+	}
+
+	unsigned int colsPerTask = (n + numThreads - 1) / numThreads;
+	pool.parallelFor(numThreads, [&](unsigned int task)
+	{
+		unsigned int first = task * colsPerTask;
+		unsigned int last = (n - first < colsPerTask) ? n : first + colsPerTask;
+		if (first < n) addColumns(first, last);
+	});
+}
+
+/**
+ * @brief An m x n block of a matrix described the way @ref gemm takes its operands
+ */
+template <typename T>
+struct StrassenBlock
+{
+	T* data;
+	size_t rowStride;
+	size_t colStride;
+
+	StrassenBlock at(unsigned int row, unsigned int col) const
+	{
+		StrassenBlock block = { data + row * rowStride + col * colStride, rowStride, colStride };
+		return block;
+	}
+};
+
+template <typename T>
+static void addBlocks(unsigned int m, unsigned int n, const StrassenBlock<T>& x, T sign,
+	const StrassenBlock<T>& y, const StrassenBlock<T>& out)
+{
+	addBlocks(m, n, (const T*)x.data, x.rowStride, x.colStride, sign, (const T*)y.data, y.rowStride,
+		y.colStride, out.data, out.rowStride, out.colStride);
+}
+
+// =============================================================================================
+// Recursion
+// =============================================================================================
+
+/**
+ * @brief The workspace a product of this size takes: the two temporaries of this level and
+ *     everything the recursion below it needs, which starts right after them.
+ */
+static size_t workspaceSize(unsigned int m, unsigned int n, unsigned int k, unsigned int crossover)
+{
+	if (m <= crossover || n <= crossover || k <= crossover)
+	{
+		return 0;
+	}
+
+	size_t m2 = m / 2, n2 = n / 2, k2 = k / 2;
+	return m2 * ((k2 > n2) ? k2 : n2) + k2 * n2 + workspaceSize(m / 2, n / 2, k / 2, crossover);
+}
+
+/**
+ * @brief c = a * b for an m x k block a and a k x n block b.
+ * @note The schedule of the 7 products and 15 additions is the one of Boyer, Dumas, Pernet and
+ *     Zhou, "Memory efficient scheduling of Strassen-Winograd's matrix multiplication
+ *     algorithm", which keeps partial results in the blocks of c and needs only two
+ *     temporaries: X, the size of a block of a or of c, and Y, the size of a block of b.
+ */
+template <typename T>
+static void strassenWinograd(unsigned int m, unsigned int n, unsigned int k,
+	const StrassenBlock<T>& a, const StrassenBlock<T>& b, const StrassenBlock<T>& c,
+	T* workspace, unsigned int crossover)
+{
+	if (m <= crossover || n <= crossover || k <= crossover)
+	{
+		gemm(m, n, k, (T)1, a.data, a.rowStride, a.colStride, b.data, b.rowStride, b.colStride,
+			(T)0, c.data, c.rowStride, c.colStride);
+		return;
+	}
+
+	unsigned int m2 = m / 2, n2 = n / 2, k2 = k / 2;
+
+	StrassenBlock<T> a11 = a, a12 = a.at(0, k2), a21 = a.at(m2, 0), a22 = a.at(m2, k2);
+	StrassenBlock<T> b11 = b, b12 = b.at(0, n2), b21 = b.at(k2, 0), b22 = b.at(k2, n2);
+	StrassenBlock<T> c11 = c, c12 = c.at(0, n2), c21 = c.at(m2, 0), c22 = c.at(m2, n2);
+
+	// X holds m2 x k2 sums of blocks of a and later the m2 x n2 product P1, Y holds k2 x n2 sums
+	//     of blocks of b.  Both are stored by column.
+	StrassenBlock<T> x = { workspace, 1, m2 };
+	StrassenBlock<T> y = { workspace + (size_t)m2 * ((k2 > n2) ? k2 : n2), 1, k2 };
+	T* below = y.data + (size_t)k2 * n2;
+
+	addBlocks(m2, k2, a11, (T)-1, a21, x);						// S3 = A11 - A21
+	addBlocks(k2, n2, b22, (T)-1, b12, y);						// T3 = B22 - B12
+	strassenWinograd(m2, n2, k2, x, y, c21, below, crossover);	// P7 = S3 * T3
+	addBlocks(m2, k2, a21, (T)1, a22, x);						// S1 = A21 + A22
+	addBlocks(k2, n2, b12, (T)-1, b11, y);						// T1 = B12 - B11
+	strassenWinograd(m2, n2, k2, x, y, c22, below, crossover);	// P5 = S1 * T1
+	addBlocks(m2, k2, x, (T)-1, a11, x);						// S2 = S1 - A11
+	addBlocks(k2, n2, b22, (T)-1, y, y);						// T2 = B22 - T1
+	strassenWinograd(m2, n2, k2, x, y, c12, below, crossover);	// P6 = S2 * T2
+	addBlocks(m2, k2, a12, (T)-1, x, x);						// S4 = A12 - S2
+	strassenWinograd(m2, n2, k2, x, b22, c11, below, crossover);	// P3 = S4 * B22
+	strassenWinograd(m2, n2, k2, a11, b11, x, below, crossover);	// P1 = A11 * B11
+	addBlocks(m2, n2, x, (T)1, c12, c12);						// U2 = P1 + P6
+	addBlocks(m2, n2, c12, (T)1, c21, c21);						// U3 = U2 + P7
+	addBlocks(m2, n2, c12, (T)1, c22, c12);						// U4 = U2 + P5
+	addBlocks(m2, n2, c21, (T)1, c22, c22);						// U7 = U3 + P5, the block C22
+	addBlocks(m2, n2, c12, (T)1, c11, c12);						// U5 = U4 + P3, the block C12
+	addBlocks(k2, n2, y, (T)-1, b21, y);						// T4 = T2 - B21
+	strassenWinograd(m2, n2, k2, a22, y, c11, below, crossover);	// P4 = A22 * T4
+	addBlocks(m2, n2, c21, (T)-1, c11, c21);					// U6 = U3 - P4, the block C21
+	strassenWinograd(m2, n2, k2, a12, b21, c11, below, crossover);	// P2 = A12 * B21
+	addBlocks(m2, n2, x, (T)1, c11, c11);						// U1 = P1 + P2, the block C11
+
+	// Whatever an odd dimension left out of the even part
+	unsigned int mEven = 2 * m2, nEven = 2 * n2, kEven = 2 * k2;
+	if (k != kEven)
+	{
+		StrassenBlock<T> aCol = a.at(0, kEven), bRow = b.at(kEven, 0);
+		gemm(mEven, nEven, 1, (T)1, aCol.data, aCol.rowStride, aCol.colStride,
+			bRow.data, bRow.rowStride, bRow.colStride, (T)1, c.data, c.rowStride, c.colStride);
+	}
+	if (m != mEven)
+	{
+		StrassenBlock<T> aRow = a.at(mEven, 0), cRow = c.at(mEven, 0);
+		gemm(1, n, k, (T)1, aRow.data, aRow.rowStride, aRow.colStride, b.data, b.rowStride, b.colStride,
+			(T)0, cRow.data, cRow.rowStride, cRow.colStride);
+	}
+	if (n != nEven)
+	{
+		StrassenBlock<T> bCol = b.at(0, nEven), cCol = c.at(0, nEven);
+		gemm(mEven, 1, k, (T)1, a.data, a.rowStride, a.colStride, bCol.data, bCol.rowStride, bCol.colStride,
+			(T)0, cCol.data, cCol.rowStride, cCol.colStride);
+	}
+}
+
+// =============================================================================================
+// Class functions
+// =============================================================================================
+
+template <typename T>
+void MathStrassenT<T>::setCrossover(unsigned int crossover)
+{
+	crossover_ = (crossover < STRASSEN_MIN_CROSSOVER) ? STRASSEN_MIN_CROSSOVER : crossover;
+}
+
+template <typename T>
+size_t MathStrassenT<T>::getWorkspaceSize(unsigned int m, unsigned int n, unsigned int k) const
+{
+	return workspaceSize(m, n, k, crossover_);
+}
+
+template <typename T>
+bool MathStrassenT<T>::multiply(const MathMatrixViewT<T>& a, const MathMatrixViewT<T>& b,
+	const MathMatrixViewT<T>& c)
+{
+	unsigned int m = a.getNumRows(), n = b.getNumCols(), k = a.getNumCols();
+	if (b.getNumRows() != k || c.getNumRows() != m || c.getNumCols() != n)
+	{
+		return false;
+	}
+
+	size_t needed = workspaceSize(m, n, k, crossover_);
+	if (workspace_.size() < needed)
+	{
+		workspace_.resize(needed);
+	}
+
+	StrassenBlock<T> aBlock = { a.getData(), a.getRowStride(), a.getColStride() };
+	StrassenBlock<T> bBlock = { b.getData(), b.getRowStride(), b.getColStride() };
+	StrassenBlock<T> cBlock = { c.getData(), c.getRowStride(), c.getColStride() };
+	strassenWinograd(m, n, k, aBlock, bBlock, cBlock, workspace_.data(), crossover_);
+	return true;
+}
+
+template <typename T>
+MathMatrixT<T> MathStrassenT<T>::multiply(const MathMatrixViewT<T>& a, const MathMatrixViewT<T>& b)
+{
+	if (a.getNumCols() != b.getNumRows())
+	{
+		return MathMatrixT<T>();
+	}
+
+	MathMatrixT<T> c(a.getNumRows(), b.getNumCols());
+	multiply(a, b, c.getView());
+	return c;
+}
+
+template class MathStrassenT<double>;
+template class MathStrassenT<float>;
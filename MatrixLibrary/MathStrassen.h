@@ -0,0 +1,73 @@
+#pragma once
+
+#ifndef __MATH_STRASSEN_H
+#define __MATH_STRASSEN_H
+
+#include <vector>
+#include "MathArena.h"
+#include "MathMatrix.h"
+#include "MathMatrixView.h"
+
+/**
+ * @brief Multiplies large matrices with the Winograd variant of Strassen's algorithm, which
+ *     splits each operand into 2 x 2 blocks and forms the product from 7 block products and
+ *     15 block additions instead of 8 products.  Each level of recursion saves an eighth of
+ *     the multiply-adds, so two levels on top of @ref gemm do about 77% of the classical work.
+ * @note Products whose rows, columns or inner dimension are at most the crossover are handed
+ *     to @ref gemm, which is also where the threads are used.  An odd dimension is split into
+ *     an even part for the recursion and one extra row or column computed by @ref gemm.
+ * @note The temporaries of every level live in one workspace owned by the object.  It grows
+ *     to the largest product multiplied so far and is reused after that, so keep one object
+ *     for a batch of products instead of making one per product.
+ * @note The result is less accurate than the classical product.  With l levels of recursion
+ *     and products of size n0 = n / 2^l at the bottom, every element of the error is at most
+ *     ((n0^2 + 6 n0) 18^l - 6 n) u max|a_ij| max|b_ij| to first order, where u is the unit
+ *     roundoff, against n u max|a_ij| max|b_ij| for the classical product (Higham, Accuracy
+ *     and Stability of Numerical Algorithms, section 23.2.2).  In practice the error is a
+ *     small multiple of the classical one, largest when the rows of A or the columns of B
+ *     differ greatly in size.
+ */
+template <typename T>
+class MathStrassenT
+{
+public:
+
+	// Products of square matrices up to about twice this size are as fast with @ref gemm
+	static constexpr unsigned int DEFAULT_CROSSOVER = 1024;
+
+	explicit MathStrassenT(unsigned int crossover = DEFAULT_CROSSOVER) { setCrossover(crossover); }
+
+	// The recursion stops once a dimension is at most @ref crossover, at least 16
+	void setCrossover(unsigned int crossover);
+	unsigned int getCrossover() const { return crossover_; }
+
+	/**
+	 * @brief c = a * b written into the elements viewed by @ref c.
+	 * @return false and changes nothing if the sizes do not match
+	 * @note @ref c must not overlap @ref a or @ref b
+	 */
+	bool multiply(const MathMatrixViewT<T>& a, const MathMatrixViewT<T>& b, const MathMatrixViewT<T>& c);
+
+	// a * b, an empty matrix if the sizes do not match
+	MathMatrixT<T> multiply(const MathMatrixViewT<T>& a, const MathMatrixViewT<T>& b);
+
+	// The elements of workspace the recursion for an m x k times k x n product needs
+	size_t getWorkspaceSize(unsigned int m, unsigned int n, unsigned int k) const;
+
+	// The elements of workspace held for the next product
+	size_t getWorkspaceCapacity() const { return workspace_.size(); }
+
+private:
+
+	unsigned int crossover_ = DEFAULT_CROSSOVER;
+
+	std::vector<T, MathAlignedAllocator<T>> workspace_;
+};
+
+typedef MathStrassenT<double> MathStrassen;
+typedef MathStrassenT<float> MathStrassenF;
+
+extern template class MathStrassenT<double>;
+extern template class MathStrassenT<float>;
+
+#endif // __MATH_STRASSEN_H
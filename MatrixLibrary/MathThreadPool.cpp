@@ -0,0 +1,169 @@
+#include "pch.h"
+#include "MathThreadPool.h"
+
+// Set while a thread is running tasks of the pool.  A parallelFor called from inside a
+//     task runs on that thread alone instead of waiting on the pool it is part of.
+static thread_local bool isRunningPoolTask = false;
+
+static unsigned int defaultNumThreads()
+{
+	unsigned int hardwareThreads = std::thread::hardware_concurrency();
+	return (hardwareThreads == 0) ? 1 : hardwareThreads;
+}
+
+MathThreadPool& MathThreadPool::getInstance()
+{
+	static MathThreadPool pool;
+	return pool;
+}
+
+MathThreadPool::MathThreadPool() : numThreads_(1), nextTask_(0)
+{
+	startWorkers(defaultNumThreads());
+}
+
+/**
+ * @brief Changes the number of threads work is split between.
+ * @param numThreads is the total number of threads including the calling thread.  0 selects
+ *     one thread per hardware thread and 1 makes every parallel operation run serially.
+ * @note Waits for any parallelFor in progress to finish first.
+ */
+void MathThreadPool::setNumThreads(unsigned int numThreads)
+{
+	if (numThreads == 0)
+	{
+		numThreads = defaultNumThreads();
+	}
+
+	std::lock_guard<std::mutex> jobLock(jobMutex_);
+	if (numThreads == numThreads_.load(std::memory_order_relaxed))
+	{
+		return;
+	}
+	stopWorkers();
+	startWorkers(numThreads);
+}
+
+/**
+ * @brief Calls task(i) once for every i in [0, numTasks) spread over the threads of the pool
+ *     and returns once every call has finished.  The calling thread takes tasks as well.
+ * @note Tasks are handed out in order one at a time so a few more tasks than threads
+ *     balances uneven work well.
+ */
+void MathThreadPool::parallelFor(unsigned int numTasks, const std::function<void(unsigned int)>& task)
+{
+	if (numTasks == 0)
+	{
+		return;
+	}
+
+	if (numTasks == 1 || getNumThreads() == 1 || isRunningPoolTask)
+	{
+		for (unsigned int i = 0; i < numTasks; ++i)
+		{
+			task(i);
+		}
+		return;
+	}
+
+	std::lock_guard<std::mutex> jobLock(jobMutex_);
+
+	{
+		std::lock_guard<std::mutex> stateLock(stateMutex_);
+		task_ = &task;
+		numTasks_ = numTasks;
+		nextTask_.store(0);
+		++jobNumber_;
+	}
+	jobAvailable_.notify_all();
+
+	runTasks();
+
+	// Every task has been taken once runTasks returns, so the job is done when
+	//     no worker is still running one
+	std::unique_lock<std::mutex> stateLock(stateMutex_);
+	jobFinished_.wait(stateLock, [this] { return numWorkersInJob_ == 0; });
+	task_ = nullptr;
+}
+
+// ==============================================================================
+// Private Member functions
+// ==============================================================================
+
+void MathThreadPool::startWorkers(unsigned int numThreads)
+{
+	numThreads_.store(numThreads, std::memory_order_relaxed);
+	stopping_ = false;
+
+	// The thread calling parallelFor is the last thread of the pool
+	for (unsigned int i = 1; i < numThreads; ++i)
+	{
+		workers_.emplace_back(&MathThreadPool::workerLoop, this);
+	}
+}
+
+void MathThreadPool::stopWorkers()
+{
+	{
+		std::lock_guard<std::mutex> stateLock(stateMutex_);
+		stopping_ = true;
+	}
+	jobAvailable_.notify_all();
+
+	for (std::thread& worker : workers_)
+	{
+		worker.join();
+	}
+	workers_.clear();
+}
+
+void MathThreadPool::workerLoop()
+{
+	unsigned long long lastJobNumber;
+	{
+		std::lock_guard<std::mutex> stateLock(stateMutex_);
+		lastJobNumber = jobNumber_;
+	}
+
+	while (true)
+	{
+		{
+			std::unique_lock<std::mutex> stateLock(stateMutex_);
+			jobAvailable_.wait(stateLock, [&] { return stopping_ || jobNumber_ != lastJobNumber; });
+
+			if (stopping_)
+			{
+				return;
+			}
+			lastJobNumber = jobNumber_;
+
+			// The job may already have been finished by the other threads
+			if (task_ == nullptr)
+			{
+				continue;
+			}
+			++numWorkersInJob_;
+		}
+
+		runTasks();
+
+		{
+			std::lock_guard<std::mutex> stateLock(stateMutex_);
+			--numWorkersInJob_;
+		}
+		jobFinished_.notify_all();
+	}
+}
+
+void MathThreadPool::runTasks()
+{
+	bool wasRunningPoolTask = isRunningPoolTask;
+	isRunningPoolTask = true;
+
+	for (unsigned int i = nextTask_.fetch_add(1); i < numTasks_; i = nextTask_.fetch_add(1))
+	{
+		(*task_)(i);
+	}
+
+	isRunningPoolTask = wasRunningPoolTask;
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#ifndef __MATH_THREAD_POOL_H
+#define __MATH_THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief A fixed set of worker threads shared by every parallel operation of the library.
+ *     Work is handed out as a number of independent tasks which the workers and the calling
+ *     thread take one at a time until all of them are done.
+ * @note The pool is created the first time it is used with one thread per hardware thread.
+ *     Use @ref setNumThreads to change that.
+ */
+class MathThreadPool
+{
+public:
+
+	static MathThreadPool& getInstance();
+
+	~MathThreadPool() { stopWorkers(); }
+
+	MathThreadPool(const MathThreadPool& other) = delete;
+	MathThreadPool& operator=(const MathThreadPool& other) = delete;
+
+	void setNumThreads(unsigned int numThreads);
+	unsigned int getNumThreads() const { return numThreads_.load(std::memory_order_relaxed); }
+
+	void parallelFor(unsigned int numTasks, const std::function<void(unsigned int)>& task);
+
+private:
+
+	MathThreadPool();
+
+	void startWorkers(unsigned int numThreads);
+	void stopWorkers();
+	void workerLoop();
+	void runTasks();
+
+	/**
+	 * @brief The number of threads work is split between, including the thread
+	 *     that calls @ref parallelFor
+	 * @note Written under @ref jobMutex_ but read without it by any thread sizing its work,
+	 *     so callers read it once and use that value for the whole operation
+	 */
+	std::atomic<unsigned int> numThreads_;
+
+	std::vector<std::thread> workers_;
+
+	// Only one parallelFor runs at a time
+	std::mutex jobMutex_;
+
+	// Guards the variables used to hand a job to the workers
+	std::mutex stateMutex_;
+	std::condition_variable jobAvailable_;
+	std::condition_variable jobFinished_;
+
+	const std::function<void(unsigned int)>* task_ = nullptr;
+	unsigned int numTasks_ = 0;
+	std::atomic<unsigned int> nextTask_;
+	unsigned int numWorkersInJob_ = 0;
+
+	// Incremented every time a job is posted so workers never run the same job twice
+	unsigned long long jobNumber_ = 0;
+	bool stopping_ = false;
+};
+
+#endif // __MATH_THREAD_POOL_H
@@ -0,0 +1,169 @@
+#include "pch.h"
+#include "MathTriangularSolve.h"
+#include "MathMatrixMultiply.h"
+#include "MathSimdKernels.h"
+#include "MathThreadPool.h"
+#include <vector>
+
+// The number of rows of B solved against each triangle on the diagonal.  The rest of the
+//     work is a product with an inner dimension this big.
+static constexpr unsigned int TRSM_BLOCK_SIZE = 128;
+
+// Diagonal blocks with at least this many multiply-adds split their right-hand sides between
+//     the threads of the pool
+static constexpr size_t TRSM_PARALLEL_THRESHOLD = 64 * 64 * 64;
+
+/**
+ * @brief Solves T * y = x for y in place of one contiguous right-hand side x of n elements.  Uses
+ *     the columns of T when they are contiguous and its rows otherwise so the SIMD kernels
+ *     always read memory in order when they can.
+ */
+static void solveOneRightHandSide(triangle_t triangle, bool unitDiagonal, unsigned int n,
+	const double* t, size_t tRowStride, size_t tColStride, double* x)
+{
+	bool useColumns = (tRowStride == 1);
+
+	if (triangle == LOWER_TRIANGLE)
+	{
+		for (unsigned int i = 0; i < n; ++i)
+		{
+			const double* tRow = t + i * tRowStride;
+			const double* tDiagonal = tRow + i * tColStride;
+
+			if (useColumns)
+			{
+				// x[i] is final, take it out of the rest of x with column i of T
+				if (!unitDiagonal) x[i] /= *tDiagonal;
+				simdAxpy(-x[i], tDiagonal + 1, x + i + 1, n - i - 1);
+			}
+			else
+			{
+				// x[i] -= T(i, 0..i-1) . x(0..i-1)
+				double sum = (tColStride == 1) ? simdDotProduct(tRow, x, i) : 0.0;
+				if (tColStride != 1)
+				{
+					for (unsigned int j = 0; j < i; ++j) sum += tRow[j * tColStride] * x[j];
+				}
+				x[i] -= sum;
+				if (!unitDiagonal) x[i] /= *tDiagonal;
+			}
+		}
+	}
+	else
+	{
+		for (unsigned int i = n; i-- > 0;)
+		{
+			const double* tCol = t + i * tColStride;
+
+			if (useColumns)
+			{
+				if (!unitDiagonal) x[i] /= tCol[i];
+				simdAxpy(-x[i], tCol, x, i);
+			}
+			else
+			{
+				// x[i] -= T(i, i+1..n-1) . x(i+1..n-1)
+				const double* tRow = t + i * tRowStride + (i + 1) * tColStride;
+				double sum = (tColStride == 1) ? simdDotProduct(tRow, x + i + 1, n - i - 1) : 0.0;
+				if (tColStride != 1)
+				{
+					for (unsigned int j = 0; j < n - i - 1; ++j) sum += tRow[j * tColStride] * x[i + 1 + j];
+				}
+				x[i] -= sum;
+				if (!unitDiagonal) x[i] /= tCol[i * tRowStride];
+			}
+		}
+	}
+}
+
+/**
+ * @brief Solves the n x n triangle on the diagonal against every right-hand side, in
+ *     parallel when there are enough of them
+ */
+static void solveDiagonalBlock(triangle_t triangle, bool unitDiagonal, unsigned int n,
+	unsigned int nrhs, const double* t, size_t tRowStride, size_t tColStride,
+	double* b, size_t bRowStride, size_t bColStride)
+{
+	MathThreadPool& pool = MathThreadPool::getInstance();
+	unsigned int numTasks = 1;
+	if ((size_t)n * n * nrhs >= TRSM_PARALLEL_THRESHOLD)
+	{
+		numTasks = pool.getNumThreads() * 4;
+		if (numTasks > nrhs) numTasks = nrhs;
+	}
+
+	pool.parallelFor(numTasks, [&](unsigned int task)
+	{
+		unsigned int first = (unsigned int)((size_t)nrhs * task / numTasks);
+		unsigned int last = (unsigned int)((size_t)nrhs * (task + 1) / numTasks);
+
+		// Right-hand sides that are not contiguous are solved in a copy
+		std::vector<double> copy((bRowStride == 1) ? 0 : n);
+
+		for (unsigned int c = first; c < last; ++c)
+		{
+			double* col = b + c * bColStride;
+			if (bRowStride == 1)
+			{
+				solveOneRightHandSide(triangle, unitDiagonal, n, t, tRowStride, tColStride, col);
+				continue;
+			}
+
+			for (unsigned int i = 0; i < n; ++i) copy[i] = col[i * bRowStride];
+			solveOneRightHandSide(triangle, unitDiagonal, n, t, tRowStride, tColStride, copy.data());
+			for (unsigned int i = 0; i < n; ++i) col[i * bRowStride] = copy[i];
+		}
+	});
+}
+
+void triangularSolve(triangle_t triangle, bool unitDiagonal, unsigned int n, unsigned int nrhs,
+	const double* t, size_t tRowStride, size_t tColStride,
+	double* b, size_t bRowStride, size_t bColStride)
+{
+	if (n == 0 || nrhs == 0)
+	{
+		return;
+	}
+
+	if (triangle == LOWER_TRIANGLE)
+	{
+		// Forward: solve a block of rows, then remove it from every row below
+		for (unsigned int k = 0; k < n; k += TRSM_BLOCK_SIZE)
+		{
+			unsigned int kb = (n - k < TRSM_BLOCK_SIZE) ? n - k : TRSM_BLOCK_SIZE;
+			const double* tBlock = t + k * tRowStride + k * tColStride;
+			double* bBlock = b + k * bRowStride;
+
+			solveDiagonalBlock(triangle, unitDiagonal, kb, nrhs, tBlock, tRowStride, tColStride,
+				bBlock, bRowStride, bColStride);
+
+			unsigned int below = n - k - kb;
+			if (below > 0)
+			{
+				gemm(below, nrhs, kb, -1.0, tBlock + kb * tRowStride, tRowStride, tColStride,
+					bBlock, bRowStride, bColStride, 1.0, bBlock + kb * bRowStride, bRowStride, bColStride);
+			}
+		}
+	}
+	else
+	{
+		// Backward: solve the last block of rows first, then remove it from every row above
+		unsigned int numBlocks = (n + TRSM_BLOCK_SIZE - 1) / TRSM_BLOCK_SIZE;
+		for (unsigned int blk = numBlocks; blk-- > 0;)
+		{
+			unsigned int k = blk * TRSM_BLOCK_SIZE;
+			unsigned int kb = (n - k < TRSM_BLOCK_SIZE) ? n - k : TRSM_BLOCK_SIZE;
+			const double* tBlock = t + k * tRowStride + k * tColStride;
+			double* bBlock = b + k * bRowStride;
+
+			solveDiagonalBlock(triangle, unitDiagonal, kb, nrhs, tBlock, tRowStride, tColStride,
+				bBlock, bRowStride, bColStride);
+
+			if (k > 0)
+			{
+				gemm(k, nrhs, kb, -1.0, t + k * tColStride, tRowStride, tColStride,
+					bBlock, bRowStride, bColStride, 1.0, b, bRowStride, bColStride);
+			}
+		}
+	}
+}
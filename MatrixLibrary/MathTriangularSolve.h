@@ -0,0 +1,31 @@
+#pragma once
+
+#ifndef __MATH_TRIANGULAR_SOLVE_H
+#define __MATH_TRIANGULAR_SOLVE_H
+
+#include <cstddef>
+
+/**
+ * @brief Which triangle of a square matrix holds a triangular matrix
+ */
+typedef enum { LOWER_TRIANGLE, UPPER_TRIANGLE } triangle_t;
+
+/**
+ * @brief Solves T * X = B for X, where T is the n x n lower or upper triangle of t and B is
+ *     n x nrhs.  X is written over B.
+ * @note The operands are given the same way as to @ref gemm, a pointer to the first element
+ *     and the distance in memory between two consecutive rows and two consecutive columns.
+ *     Passing the strides of t swapped solves with the transpose of T.
+ * @note Only the triangle of t is read so the other triangle may hold anything, for example
+ *     the other factor of an LU decomposition.  If unitDiagonal is true the diagonal is not
+ *     read either and is taken to be all ones.
+ * @note The solve is blocked.  Each block of rows of B is solved against the small triangle on
+ *     the diagonal and the rest of B is then updated with one call to @ref gemm, so nearly all
+ *     of the work for many right-hand sides runs on the multiplication kernel.
+ * @note Nothing is checked, a zero on the diagonal gives infinities or NANs in X.
+ */
+void triangularSolve(triangle_t triangle, bool unitDiagonal, unsigned int n, unsigned int nrhs,
+	const double* t, size_t tRowStride, size_t tColStride,
+	double* b, size_t bRowStride, size_t bColStride);
+
+#endif // __MATH_TRIANGULAR_SOLVE_H
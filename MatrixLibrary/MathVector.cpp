@@ -2,6 +2,7 @@
 #include "pch.cpp"
 #include <math.h>
 #include "MathVector.h"
+#include "MathSimdKernels.h"
 
 static constexpr double ALPHA = 0.001;
 
@@ -21,7 +22,8 @@ unsigned int pow2Above(unsigned int n)
 	return ret;
 }
 
-MathVector::MathVector()
+template <typename T>
+MathVectorT<T>::MathVectorT()
 {
 	size_ = 0;
 	useSizeFromOperations_ = 0;
@@ -30,12 +32,14 @@ MathVector::MathVector()
 	data_ = nullptr;
 }
 
-MathVector::MathVector(unsigned int size)
+template <typename T>
+MathVectorT<T>::MathVectorT(unsigned int size)
 {
 	if (size == 0)
 	{
 		size_ = 0;
 		preAlloc_ = 0;
+		data_ = nullptr;
 	}
 	else
 	{
@@ -48,16 +52,17 @@ MathVector::MathVector(unsigned int size)
 			// Multiply it by 2
 			preAlloc_ <<= 1;
 		}
-		data_ = new double[preAlloc_];
+		data_ = allocateElements<T>(preAlloc_, arena_);
 
 		for (unsigned int i = 0; i < size; ++i)
 		{
-			data_[i] = 0.0F;
+			data_[i] = 0;
 		}
 	}
 }
 
-MathVector::MathVector(const std::initializer_list<double> arr)
+template <typename T>
+MathVectorT<T>::MathVectorT(const std::initializer_list<T> arr)
 {
 	size_ = (unsigned int) arr.size();
 	preAlloc_ = 2;
@@ -66,9 +71,9 @@ MathVector::MathVector(const std::initializer_list<double> arr)
 	{
 		preAlloc_ <<= 1;
 	}
-	data_ = new double[preAlloc_];
+	data_ = allocateElements<T>(preAlloc_, arena_);
 
-	std::initializer_list<double>::iterator itr = arr.begin();
+	typename std::initializer_list<T>::iterator itr = arr.begin();
 
 	for (unsigned int i = 0; i < size_; ++i)
 	{
@@ -77,7 +82,8 @@ MathVector::MathVector(const std::initializer_list<double> arr)
 	}
 }
 
-MathVector& MathVector::operator=(const std::initializer_list<double> arr)
+template <typename T>
+MathVectorT<T>& MathVectorT<T>::operator=(const std::initializer_list<T> arr)
 {
 	deleteAllocatedMemory();
 
@@ -88,9 +94,9 @@ MathVector& MathVector::operator=(const std::initializer_list<double> arr)
 	{
 		preAlloc_ <<= 1;
 	}
-	data_ = new double[preAlloc_];
+	data_ = allocateElements<T>(preAlloc_, arena_);
 
-	std::initializer_list<double>::iterator itr = arr.begin();
+	typename std::initializer_list<T>::iterator itr = arr.begin();
 
 	for (unsigned int i = 0; i < size_; ++i)
 	{
@@ -109,38 +115,72 @@ MathVector& MathVector::operator=(const std::initializer_list<double> arr)
  * @param copyTo is the vector where the contents of @ref copyFrom will be
  *     placed
  * @note copyVector does not use the operationSize assigned to the vector
+ * @note Only the @ref size_ elements of the vector are copied.  The copy gets
+ *     no spare room beyond them, it grows again through @ref push_back if needed.
  */
-void MathVector::copyVector(const MathVector& copyFrom)
+template <typename T>
+void MathVectorT<T>::copyVector(const MathVectorT& copyFrom)
 {
 	// Copy all of the non-dynamically allocated memory over
 	this->size_ = copyFrom.size_;
 	this->sizeSeenInOperations_ = copyFrom.sizeSeenInOperations_;
 	this->useSizeFromOperations_ = copyFrom.useSizeFromOperations_;
-	this->preAlloc_ = copyFrom.preAlloc_;
+	this->preAlloc_ = copyFrom.size_;
+
+	if (size_ == 0)
+	{
+		this->data_ = nullptr;
+		return;
+	}
 
 	// Now make a copy of the dynamically allocated memory
-	this->data_ = new double[preAlloc_];
-	for (unsigned int i = 0; i < preAlloc_; ++i)
+	this->data_ = allocateElements<T>(preAlloc_, arena_);
+	for (unsigned int i = 0; i < size_; ++i)
 	{
 		this->data_[i] = copyFrom.data_[i];
 	}
 }
 
-void MathVector::deleteAllocatedMemory()
+/**
+ * @brief Takes the buffer of @ref moveFrom without copying any elements and leaves
+ *     @ref moveFrom as an empty vector that can still be used or assigned to.
+ */
+template <typename T>
+void MathVectorT<T>::moveVector(MathVectorT& moveFrom) noexcept
+{
+	this->size_ = moveFrom.size_;
+	this->sizeSeenInOperations_ = moveFrom.sizeSeenInOperations_;
+	this->useSizeFromOperations_ = moveFrom.useSizeFromOperations_;
+	this->preAlloc_ = moveFrom.preAlloc_;
+	this->data_ = moveFrom.data_;
+	this->arena_ = moveFrom.arena_;
+
+	moveFrom.size_ = 0;
+	moveFrom.sizeSeenInOperations_ = 0;
+	moveFrom.useSizeFromOperations_ = false;
+	moveFrom.preAlloc_ = 0;
+	moveFrom.data_ = nullptr;
+	moveFrom.arena_ = nullptr;
+}
+
+template <typename T>
+void MathVectorT<T>::deleteAllocatedMemory()
 {
-	if (size_ != 0)
-	{
-		delete[] data_;
-	}
+	freeElements(data_, arena_);
+	data_ = nullptr;
+	arena_ = nullptr;
+	size_ = 0;
+	preAlloc_ = 0;
 }
 
-bool MathVector::isZeroVector() const
+template <typename T>
+bool MathVectorT<T>::isZeroVector() const
 {
 	unsigned int operationSize = getOperationSize();
 
 	for (unsigned int i = 0; i < operationSize; ++i)
 	{
-		if (!approxEqual(data_[i], 0.0F)) return false;
+		if (!approxEqual(data_[i], 0)) return false;
 	}
 	return true;
 }
@@ -152,21 +192,18 @@ bool MathVector::isZeroVector() const
  *     otherwise.
  * @note To get the square of the magnitude just call "v1.dotProduct(v1)".
  */
-double MathVector::getMagnitude() const
+template <typename T>
+T MathVectorT<T>::getMagnitude() const
 {
-	double mag = 0.0;
 	unsigned int opsize = getOperationSize();
 
 	if (opsize == 0) return NAN;
 
-	for (unsigned int i = 0; i < opsize; ++i)
-	{
-		mag += data_[i] * data_[i];
-	}
-	return sqrt(mag);
+	return sqrt(simdSumOfSquares(data_, opsize));
 }
 
-bool MathVector::isEqualTo(const MathVector& other) const
+template <typename T>
+bool MathVectorT<T>::isEqualTo(const MathVectorT& other) const
 {
 	if (other.size_ != this->size_) return false;
 
@@ -179,12 +216,13 @@ bool MathVector::isEqualTo(const MathVector& other) const
 	}
 	return true;
 }
-bool MathVector::isEqualTo(const std::initializer_list<double> arr) const
+template <typename T>
+bool MathVectorT<T>::isEqualTo(const std::initializer_list<T> arr) const
 {
 	unsigned int opSize = this->getOperationSize();
 	if (opSize != arr.size()) return false;
 
-	std::initializer_list<double>::iterator itr = arr.begin();
+	typename std::initializer_list<T>::iterator itr = arr.begin();
 	for (unsigned int i = 0; i < opSize; ++i)
 	{
 		if (data_[i] != *itr) return false;
@@ -193,17 +231,19 @@ bool MathVector::isEqualTo(const std::initializer_list<double> arr) const
 	return true;
 }
 
-bool MathVector::isNotEqualTo(const MathVector& other) const
+template <typename T>
+bool MathVectorT<T>::isNotEqualTo(const MathVectorT& other) const
 {
 
 	return !isEqualTo(other);
 }
-bool MathVector::isNotEqualTo(const std::initializer_list<double> arr) const
+template <typename T>
+bool MathVectorT<T>::isNotEqualTo(const std::initializer_list<T> arr) const
 {
 	unsigned int opSize = this->getOperationSize();
 	if (opSize != arr.size()) return true;
 
-	std::initializer_list<double>::iterator itr = arr.begin();
+	typename std::initializer_list<T>::iterator itr = arr.begin();
 	for (unsigned int i = 0; i < opSize; ++i)
 	{
 		if (data_[i] != *itr) return true;
@@ -212,7 +252,8 @@ bool MathVector::isNotEqualTo(const std::initializer_list<double> arr) const
 	return false;
 }
 
-unsigned int MathVector::getOperationSize() const
+template <typename T>
+unsigned int MathVectorT<T>::getOperationSize() const
 {
 	if (useSizeFromOperations_ == true)
 	{
@@ -242,7 +283,8 @@ Operations we can perform on the vectors
  * @return true if the vectors could be successfully added and false if the vectors
  *     do not have the same size or the operation size of either vector is equal to 0
  */
-bool MathVector::operator+=(const MathVector& mv2)
+template <typename T>
+bool MathVectorT<T>::operator+=(const MathVectorT& mv2)
 {
 	if (mv2.getOperationSize() != this->getOperationSize()
 || mv2.getOperationSize() == 0)
@@ -250,10 +292,7 @@ bool MathVector::operator+=(const MathVector& mv2)
 		// Vector addition is not defined
 		return false;
 	}
-	for (unsigned int i = 0; i < mv2.getOperationSize(); ++i)
-	{
-		data_[i] += mv2[i];
-	}
+	simdAxpy(1.0, mv2.data_, data_, mv2.getOperationSize());
 	return true;
 }
 
@@ -262,36 +301,33 @@ bool MathVector::operator+=(const MathVector& mv2)
 * Operator overload for subtraction of two vectors,
 
 @Returns whether or not the second vector was successfully 
-*     added to this vector
+*     subtracted from this vector
 */
-bool MathVector::operator-=(const MathVector& mv2)
+template <typename T>
+bool MathVectorT<T>::operator-=(const MathVectorT& mv2)
 {
 	if (mv2.getOperationSize() != this->getOperationSize()
 		|| mv2.getOperationSize() == 0)
 	{
-		// Vector addition is not defined
+		// Vector subtraction is not defined
 		return false;
 	}
-	for (unsigned int i = 0; i < mv2.getOperationSize(); ++i)
-	{
-		data_[i] += mv2[i];
-	}
+	simdAxpy(-1.0, mv2.data_, data_, mv2.getOperationSize());
 	return true;
 }
 
 /*
 * Scalar Multiplication for vectors
 */
-bool MathVector::operator*=(double alpha)
+template <typename T>
+bool MathVectorT<T>::operator*=(T alpha)
 {
-	if (getOperationSize() == 0)
+	unsigned int opSize = getOperationSize();
+	if (opSize == 0)
 	{
 		return false;
 	}
-	for (unsigned int i = 0; i < getOperationSize(); ++i)
-	{
-		data_[i] *= alpha;
-	}
+	simdScale(alpha, data_, opSize);
 	return true;
 }
 
@@ -302,20 +338,15 @@ bool MathVector::operator*=(double alpha)
  * @return NAN if the dot product is not defined between the two vectors
  *    and the dot product if it is defined
  */
-double MathVector::dotProduct(const MathVector& other) const
+template <typename T>
+T MathVectorT<T>::dotProduct(const MathVectorT& other) const
 {
 	if (this->getOperationSize() == 0 || this->getOperationSize() != other.getOperationSize())
 	{
 		return NAN;
 	}
 
-	double result = 0.0;
-	for (unsigned int i = 0; i < getOperationSize(); ++i)
-	{
-		result += data_[i] * other.data_[i];
-	}
-	return result;
-
+	return simdDotProduct(data_, other.data_, getOperationSize());
 }
 
 
@@ -325,15 +356,16 @@ double MathVector::dotProduct(const MathVector& other) const
 *     @ref size_ > sizeSeenInOperations_ it will still be placed
 *     after the last element in the vector
 */
-bool MathVector::push_back(const double& element)
+template <typename T>
+bool MathVectorT<T>::push_back(const T& element)
 {
 
 	// Case where we havent allocated anything yet
-	if (size_ == 0)
+	if (preAlloc_ == 0)
 	{
 		size_ = 1;
 		preAlloc_ = 2;
-		data_ = new double[preAlloc_];
+		data_ = allocateElements<T>(preAlloc_, arena_);
 		data_[0] = element;
 		return true; // <----- Return
 	}
@@ -349,13 +381,15 @@ bool MathVector::push_back(const double& element)
 	if (size_ == preAlloc_)
 	{
 		// Make a new array to store all the data
-		double* newData = new double[preAlloc_ << 1];
+		MathArena* newArena;
+		T* newData = allocateElements<T>(preAlloc_ << 1, newArena);
 		for (unsigned int i = 0; i < size_; ++i)
 		{
 			newData[i] = data_[i];
 		}
-		delete data_;
+		freeElements(data_, arena_);
 		data_ = newData;
+		arena_ = newArena;
 
 		preAlloc_ <<= 1;
 	}
@@ -367,6 +401,9 @@ bool MathVector::push_back(const double& element)
 }
 
 
+template class MathVectorT<double>;
+template class MathVectorT<float>;
+
 //////////////////////////////////////////////////////////////////////////
 // Outside of class functions that generate new vectors when used
 /////////////////////////////////////////////////////////////////////////
@@ -396,17 +433,18 @@ bool operator!=(const MathVector& v1, std::initializer_list<double> arr)
 	return v1.isNotEqualTo(arr);
 }
 
-MathVector add(const MathVector& v1, const MathVector& v2)
+bool operator==(const MathVectorF& v1, const MathVectorF& v2)
 {
-	MathVector newVec(v1);
-	newVec += v2;
-
-	return newVec;
+	return v1.isEqualTo(v2);
 }
-MathVector operator+(const MathVector& v1, const MathVector& v2)
+
+bool operator==(const MathVectorF& v1, std::initializer_list<float> arr)
 {
-	if (v1.getSize() != v2.getSize()) return MathVector();
+	return v1.isEqualTo(arr);
+}
 
+MathVector add(const MathVector& v1, const MathVector& v2)
+{
 	MathVector newVec(v1);
 	newVec += v2;
 
@@ -420,16 +458,18 @@ MathVector scalarMult(const MathVector& vec, double alpha)
 
 	return newVec;
 }
-MathVector operator*(const MathVector& vec, double alpha)
+
+MathVectorF add(const MathVectorF& v1, const MathVectorF& v2)
 {
-	MathVector newVec(vec);
-	newVec *= alpha;
+	MathVectorF newVec(v1);
+	newVec += v2;
 
 	return newVec;
 }
-MathVector operator*(double alpha, const MathVector& vec)
+
+MathVectorF scalarMult(const MathVectorF& vec, float alpha)
 {
-	MathVector newVec(vec);
+	MathVectorF newVec(vec);
 	newVec *= alpha;
 
 	return newVec;
@@ -450,6 +490,14 @@ double operator*(const MathVector& v1, const MathVector& v2)
 {
 	return v1.dotProduct(v2);
 }
+float dotProduct(const MathVectorF& v1, const MathVectorF& v2)
+{
+	return v1.dotProduct(v2);
+}
+float operator*(const MathVectorF& v1, const MathVectorF& v2)
+{
+	return v1.dotProduct(v2);
+}
 
 /**
  * @brief Returns the projection of vector @ref b onto vector @ref a
@@ -469,4 +517,9 @@ MathVector findProjection(const MathVector& b, const MathVector& a)
 	//     (b.a)/(a.a)*a
 	double scalar = (b.dotProduct(a)) / (a.dotProduct(a));
 	return a * scalar;
+}
+MathVectorF findProjection(const MathVectorF& b, const MathVectorF& a)
+{
+	float scalar = (b.dotProduct(a)) / (a.dotProduct(a));
+	return a * scalar;
 }
\ No newline at end of file
@@ -0,0 +1,131 @@
+#pragma once
+
+#ifndef __MATH_VECTOR_EXPRESSION_H
+#define __MATH_VECTOR_EXPRESSION_H
+
+template <typename T>
+class MathVectorT;
+
+/**
+ * @brief The base of everything that can appear in an arithmetic expression of vectors,
+ *     @ref MathVector itself and the lazy nodes below.
+ * @note Adding or scaling vectors does not compute anything.  It builds a small object
+ *     that remembers its operands, and the whole expression is evaluated element by element
+ *     in a single loop once it is assigned to a @ref MathVector.  So
+ *     "v = a + 2.0 * b + c * alpha" makes no temporary vectors and, if v already has the
+ *     right size, does not allocate at all.
+ * @note Every E has getOperationSize() and an operator[] returning element i by value.
+ *     The size of a node is 0 if the sizes of its operands do not match, and evaluating an
+ *     expression of size 0 gives an empty vector, just like adding two vectors of different
+ *     sizes always has.
+ * @note Every E also has a value_type, the element type of the vectors it is built from.
+ *     Scaling a vector of floats by a double still gives floats.
+ */
+template <typename E>
+class MathVectorExpression
+{
+public:
+	const E& derived() const { return static_cast<const E&>(*this); }
+};
+
+/**
+ * @brief How a node holds an operand.  Vectors are held by reference so nothing is copied.
+ *     Nodes are tiny and held by value so an expression never refers to a node that was a
+ *     temporary of the statement it was built in.
+ */
+template <typename E>
+struct MathVectorOperand
+{
+	typedef const E type;
+};
+
+template <typename T>
+struct MathVectorOperand<MathVectorT<T>>
+{
+	typedef const MathVectorT<T>& type;
+};
+
+// lhs + rhs
+template <typename L, typename R>
+class MathVectorSum : public MathVectorExpression<MathVectorSum<L, R>>
+{
+public:
+	typedef typename L::value_type value_type;
+
+	MathVectorSum(const L& lhs, const R& rhs) : lhs_(lhs), rhs_(rhs) {}
+
+	unsigned int getOperationSize() const
+	{
+		unsigned int size = lhs_.getOperationSize();
+		return (size == rhs_.getOperationSize()) ? size : 0;
+	}
+	value_type operator[](unsigned int i) const { return lhs_[i] + rhs_[i]; }
+
+private:
+	typename MathVectorOperand<L>::type lhs_;
+	typename MathVectorOperand<R>::type rhs_;
+};
+
+// lhs - rhs
+template <typename L, typename R>
+class MathVectorDifference : public MathVectorExpression<MathVectorDifference<L, R>>
+{
+public:
+	typedef typename L::value_type value_type;
+
+	MathVectorDifference(const L& lhs, const R& rhs) : lhs_(lhs), rhs_(rhs) {}
+
+	unsigned int getOperationSize() const
+	{
+		unsigned int size = lhs_.getOperationSize();
+		return (size == rhs_.getOperationSize()) ? size : 0;
+	}
+	value_type operator[](unsigned int i) const { return lhs_[i] - rhs_[i]; }
+
+private:
+	typename MathVectorOperand<L>::type lhs_;
+	typename MathVectorOperand<R>::type rhs_;
+};
+
+// alpha * vec
+template <typename E>
+class MathVectorScaled : public MathVectorExpression<MathVectorScaled<E>>
+{
+public:
+	typedef typename E::value_type value_type;
+
+	MathVectorScaled(double alpha, const E& vec) : alpha_((value_type)alpha), vec_(vec) {}
+
+	unsigned int getOperationSize() const { return vec_.getOperationSize(); }
+	value_type operator[](unsigned int i) const { return alpha_ * vec_[i]; }
+
+private:
+	value_type alpha_;
+	typename MathVectorOperand<E>::type vec_;
+};
+
+template <typename L, typename R>
+MathVectorSum<L, R> operator+(const MathVectorExpression<L>& lhs, const MathVectorExpression<R>& rhs)
+{
+	return MathVectorSum<L, R>(lhs.derived(), rhs.derived());
+}
+
+template <typename L, typename R>
+MathVectorDifference<L, R> operator-(const MathVectorExpression<L>& lhs, const MathVectorExpression<R>& rhs)
+{
+	return MathVectorDifference<L, R>(lhs.derived(), rhs.derived());
+}
+
+template <typename E>
+MathVectorScaled<E> operator*(const MathVectorExpression<E>& vec, double alpha)
+{
+	return MathVectorScaled<E>(alpha, vec.derived());
+}
+
+template <typename E>
+MathVectorScaled<E> operator*(double alpha, const MathVectorExpression<E>& vec)
+{
+	return MathVectorScaled<E>(alpha, vec.derived());
+}
+
+#endif // __MATH_VECTOR_EXPRESSION_H
@@ -0,0 +1,65 @@
+#include "pch.h"
+#include "MathVectorView.h"
+#include "MathVector.h"
+#include "MathSimdKernels.h"
+#include <cmath>
+
+template <typename T>
+MathVectorViewT<T>::MathVectorViewT(const MathVectorT<T>& v)
+{
+	data_ = v.getData();
+	size_ = (data_ == nullptr) ? 0 : v.getOperationSize();
+	stride_ = 1;
+}
+
+template <typename T>
+MathVectorViewT<T> MathVectorViewT<T>::getSubView(unsigned int offset, unsigned int size) const
+{
+	if (offset > size_ || size > size_ - offset)
+	{
+		return MathVectorViewT();
+	}
+	return MathVectorViewT(data_ + (std::ptrdiff_t)offset * stride_, size, stride_);
+}
+
+/**
+ * @brief Returns the dot product of the two views
+ * @return NAN if the views are empty or do not have the same size
+ */
+template <typename T>
+T MathVectorViewT<T>::dotProduct(const MathVectorViewT& other) const
+{
+	if (size_ == 0 || size_ != other.size_)
+	{
+		return NAN;
+	}
+
+	if (isContiguous() && other.isContiguous())
+	{
+		return simdDotProduct(data_, other.data_, size_);
+	}
+
+	T result = 0;
+	for (unsigned int i = 0; i < size_; ++i)
+	{
+		result += (*this)[i] * other[i];
+	}
+	return result;
+}
+
+template class MathVectorViewT<double>;
+template class MathVectorViewT<float>;
+
+// =============================================================================================
+// Outside of class functions
+// =============================================================================================
+
+double dotProduct(const MathVectorView& v1, const MathVectorView& v2)
+{
+	return v1.dotProduct(v2);
+}
+
+float dotProduct(const MathVectorViewF& v1, const MathVectorViewF& v2)
+{
+	return v1.dotProduct(v2);
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+#ifndef __MATH_VECTOR_VIEW_H
+#define __MATH_VECTOR_VIEW_H
+
+#include <cstddef>
+#include "MathVectorExpression.h"
+#include "MathMatrixIterator.h"
+
+/**
+ * @brief A non-owning window onto elements that are a constant stride apart, for example
+ *     part of a @ref MathVector or one row or column of a @ref MathMatrixView.  Making one
+ *     never allocates or copies, and writing through it writes to what it looks at.
+ * @note A view can be used in vector expressions like a MathVector, so
+ *     "MathVector v = m.getView().getRow(0) + 2.0 * w" works without copying the row.
+ * @note The view does not keep what it looks at alive.  It is invalidated like a pointer
+ *     when the vector or matrix is destroyed or reallocates, for example when it grows.
+ * @note Views are shallow.  A const view can still change the elements it looks at, just
+ *     as MathMatrix::setVal is a const function.
+ */
+template <typename T>
+class MathVectorViewT : public MathVectorExpression<MathVectorViewT<T>>
+{
+public:
+	typedef T value_type;
+
+	MathVectorViewT() : data_(nullptr), size_(0), stride_(1) {}
+	MathVectorViewT(T* const data, unsigned int const size, std::ptrdiff_t const stride = 1)
+		: data_(data), size_(size), stride_(stride) {}
+
+	// Views the elements of @ref v in its operation size
+	explicit MathVectorViewT(const MathVectorT<T>& v);
+
+	unsigned int getSize() const { return size_; }
+	unsigned int getOperationSize() const { return size_; }
+
+	T& operator[](unsigned int index) const { return data_[(std::ptrdiff_t)index * stride_]; }
+
+	T* getData() const { return data_; }
+	std::ptrdiff_t getStride() const { return stride_; }
+	bool isContiguous() const { return stride_ == 1; }
+
+	MathMatrixIteratorT<T> begin() const { return MathMatrixIteratorT<T>(data_, 0, stride_); }
+	MathMatrixIteratorT<T> end() const { return MathMatrixIteratorT<T>(data_, size_, stride_); }
+
+	// Views @ref size elements starting at @ref offset.  Returns an empty view if they do not fit.
+	MathVectorViewT getSubView(unsigned int offset, unsigned int size) const;
+
+	template <typename E>
+	bool assign(const MathVectorExpression<E>& expression) const;
+
+	T dotProduct(const MathVectorViewT& other) const;
+
+private:
+
+	T* data_;
+	unsigned int size_;
+
+	// The distance in memory between two consecutive elements
+	std::ptrdiff_t stride_;
+};
+
+/**
+ * @brief Evaluates @ref expression into the elements the view looks at.
+ * @return false and changes nothing if the expression does not have the size of the view
+ * @note The view may appear in the expression, but if another operand overlaps it at a
+ *     different position (a row and a column of the same matrix, say) the result is undefined.
+ */
+template <typename T>
+template <typename E>
+bool MathVectorViewT<T>::assign(const MathVectorExpression<E>& expression) const
+{
+	const E& expr = expression.derived();
+	if (expr.getOperationSize() != size_)
+	{
+		return false;
+	}
+
+	for (unsigned int i = 0; i < size_; ++i)
+	{
+		(*this)[i] = expr[i];
+	}
+	return true;
+}
+
+typedef MathVectorViewT<double> MathVectorView;
+typedef MathVectorViewT<float> MathVectorViewF;
+
+extern template class MathVectorViewT<double>;
+extern template class MathVectorViewT<float>;
+
+double dotProduct(const MathVectorView& v1, const MathVectorView& v2);
+float dotProduct(const MathVectorViewF& v1, const MathVectorViewF& v2);
+
+#endif // __MATH_VECTOR_VIEW_H
@@ -0,0 +1,931 @@
+// MatrixLibraryBenchmark.cpp : Times the hot paths of the library.
+//
+// Run the Release build.  Every benchmark prints one table; times are the best of a few
+//     repetitions so a single slow run caused by the rest of the system is ignored.
+
+#include "../MatrixLibrary/MathArena.h"
+#include "../MatrixLibrary/MathCholeskyDecomposition.h"
+#include "../MatrixLibrary/MathFixedMatrix.h"
+#include "../MatrixLibrary/MathLUDecomposition.h"
+#include "../MatrixLibrary/MathMatrix.h"
+#include "../MatrixLibrary/MathMatrixBatch.h"
+#include "../MatrixLibrary/MathMatrixFile.h"
+#include "../MatrixLibrary/MathMatrixMultiply.h"
+#include "../MatrixLibrary/MathOutOfCoreMultiply.h"
+#include "../MatrixLibrary/MathQRDecomposition.h"
+#include "../MatrixLibrary/MathSimdKernels.h"
+#include "../MatrixLibrary/MathSparseMatrix.h"
+#include "../MatrixLibrary/MathSparseMatrixBuilder.h"
+#include "../MatrixLibrary/MathStrassen.h"
+#include "../MatrixLibrary/MathThreadPool.h"
+#include "../MatrixLibrary/MathVector.h"
+
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <thread>
+#include <vector>
+
+// =============================================================================================
+// Helpers
+// =============================================================================================
+
+/**
+ * @brief Returns the fastest of @ref repetitions runs of @ref work in seconds
+ */
+static double bestTimeInSeconds(unsigned int repetitions, const std::function<void()>& work)
+{
+	double best = 1e300;
+	for (unsigned int i = 0; i < repetitions; ++i)
+	{
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		work();
+		std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+		double seconds = std::chrono::duration<double>(end - start).count();
+		if (seconds < best) best = seconds;
+	}
+	return best;
+}
+
+static MathMatrix makeBenchmarkMatrix(unsigned int rows, unsigned int cols, vector_space_t space)
+{
+	MathMatrix m(rows, cols);
+	if (space == ROWSPACE)
+	{
+		m = MathMatrix(cols, rows);
+		m.transpose();
+	}
+	for (unsigned int r = 0; r < rows; ++r)
+	{
+		for (unsigned int c = 0; c < cols; ++c)
+		{
+			m.setVal(r, c, (double)((r * 7 + c * 13) % 17) - 8.0);
+		}
+	}
+	return m;
+}
+
+// =============================================================================================
+// Benchmarks
+// =============================================================================================
+
+static void benchmarkMultiply()
+{
+	std::printf("\nMatrix multiplication, square, COLUMNSPACE * ROWSPACE, all threads\n");
+	std::printf("%8s %12s %12s\n", "n", "seconds", "GFLOP/s");
+
+	for (unsigned int n : { 64u, 128u, 256u, 512u, 1024u, 2048u })
+	{
+		MathMatrix a = makeBenchmarkMatrix(n, n, COLUMNSPACE);
+		MathMatrix b = makeBenchmarkMatrix(n, n, ROWSPACE);
+
+		double seconds = bestTimeInSeconds(3, [&] { MathMatrix c = a * b; });
+		std::printf("%8u %12.5f %12.2f\n", n, seconds, 2.0 * n * n * n / seconds * 1e-9);
+	}
+}
+
+static void benchmarkMultiplyScaling()
+{
+	MathThreadPool& pool = MathThreadPool::getInstance();
+	unsigned int threadsBefore = pool.getNumThreads();
+	unsigned int hardwareThreads = std::thread::hardware_concurrency();
+	if (hardwareThreads == 0) hardwareThreads = 1;
+
+	for (unsigned int n : { 1024u, 2048u })
+	{
+		std::printf("\nMatrix multiplication thread scaling, n = %u\n", n);
+		std::printf("%8s %12s %12s %10s %12s\n", "threads", "seconds", "GFLOP/s", "speedup", "efficiency");
+
+		MathMatrix a = makeBenchmarkMatrix(n, n, COLUMNSPACE);
+		MathMatrix b = makeBenchmarkMatrix(n, n, COLUMNSPACE);
+
+		double serialSeconds = 0.0;
+		std::vector<unsigned int> threadCounts;
+		for (unsigned int t = 1; t < hardwareThreads; t <<= 1) threadCounts.push_back(t);
+		threadCounts.push_back(hardwareThreads);
+
+		for (unsigned int threads : threadCounts)
+		{
+			pool.setNumThreads(threads);
+			double seconds = bestTimeInSeconds(3, [&] { MathMatrix c = a * b; });
+			if (threads == 1) serialSeconds = seconds;
+
+			double speedup = serialSeconds / seconds;
+			std::printf("%8u %12.5f %12.2f %10.2f %11.0f%%\n", threads, seconds,
+				2.0 * n * n * n / seconds * 1e-9, speedup, 100.0 * speedup / threads);
+		}
+	}
+
+	pool.setNumThreads(threadsBefore);
+}
+
+static const char* instructionSetName(simd_instruction_set_t instructionSet)
+{
+	switch (instructionSet)
+	{
+	case SIMD_SSE2: return "SSE2";
+	case SIMD_AVX2: return "AVX2";
+	case SIMD_AVX512: return "AVX-512";
+	default: return "scalar";
+	}
+}
+
+static void benchmarkInstructionSets()
+{
+	simd_instruction_set_t before = getSimdInstructionSet();
+	const unsigned int vectorSize = 4096;
+	const unsigned int repeats = 1000;
+	const unsigned int n = 512;
+
+	std::printf("\nVector kernels (size %u) and multiplication (n = %u) per instruction set, one thread\n",
+		vectorSize, n);
+	std::printf("%8s %14s %14s %14s\n", "set", "dot GFLOP/s", "+= GFLOP/s", "mul GFLOP/s");
+
+	MathThreadPool& pool = MathThreadPool::getInstance();
+	unsigned int threadsBefore = pool.getNumThreads();
+	pool.setNumThreads(1);
+
+	MathVector x(vectorSize), y(vectorSize);
+	for (unsigned int i = 0; i < vectorSize; ++i)
+	{
+		x[i] = (double)(i % 17) - 8.0;
+		y[i] = (double)(i % 13) - 6.0;
+	}
+	MathMatrix a = makeBenchmarkMatrix(n, n, COLUMNSPACE);
+	MathMatrix b = makeBenchmarkMatrix(n, n, ROWSPACE);
+
+	for (int set = SIMD_SCALAR; set <= getSupportedSimdInstructionSet(); ++set)
+	{
+		setSimdInstructionSet((simd_instruction_set_t)set);
+
+		volatile double sink = 0.0;
+		double dotSeconds = bestTimeInSeconds(3, [&] {
+			for (unsigned int i = 0; i < repeats; ++i) sink = sink + x.dotProduct(y);
+		});
+		double addSeconds = bestTimeInSeconds(3, [&] {
+			for (unsigned int i = 0; i < repeats; ++i) { y += x; y -= x; }
+		});
+		double mulSeconds = bestTimeInSeconds(3, [&] { MathMatrix c = a * b; });
+
+		std::printf("%8s %14.2f %14.2f %14.2f\n", instructionSetName((simd_instruction_set_t)set),
+			2.0 * vectorSize * repeats / dotSeconds * 1e-9,
+			2.0 * vectorSize * repeats / addSeconds * 1e-9,
+			2.0 * n * n * n / mulSeconds * 1e-9);
+	}
+
+	setSimdInstructionSet(before);
+	pool.setNumThreads(threadsBefore);
+}
+
+static void benchmarkVectorExpression()
+{
+	const unsigned int repeats = 1000;
+	const double alpha = -0.5;
+
+	std::printf("\nv = a + 2.0 * b + c * alpha, fused expression vs one temporary per operation\n");
+	std::printf("%8s %14s %14s %10s\n", "size", "fused ns", "eager ns", "speedup");
+
+	for (unsigned int size : { 16u, 256u, 4096u, 65536u })
+	{
+		MathVector a(size), b(size), c(size), v(size);
+		for (unsigned int i = 0; i < size; ++i)
+		{
+			a[i] = (double)(i % 17);
+			b[i] = (double)(i % 13);
+			c[i] = (double)(i % 11);
+		}
+
+		double fusedSeconds = bestTimeInSeconds(3, [&] {
+			for (unsigned int i = 0; i < repeats; ++i) v = a + 2.0 * b + c * alpha;
+		});
+		double eagerSeconds = bestTimeInSeconds(3, [&] {
+			for (unsigned int i = 0; i < repeats; ++i) v = add(add(a, scalarMult(b, 2.0)), scalarMult(c, alpha));
+		});
+
+		std::printf("%8u %14.1f %14.1f %10.2f\n", size, fusedSeconds / repeats * 1e9,
+			eagerSeconds / repeats * 1e9, eagerSeconds / fusedSeconds);
+	}
+}
+
+static void benchmarkLUSolve()
+{
+	std::printf("\nSolve A * x = b, blocked LU vs Gaussian elimination with row operations\n");
+	std::printf("%8s %12s %12s %14s %10s\n", "n", "LU seconds", "LU GFLOP/s", "row ops sec", "speedup");
+
+	for (unsigned int n : { 64u, 128u, 256u, 512u, 1024u })
+	{
+		MathMatrix a = makeBenchmarkMatrix(n, n, ROWSPACE);
+		for (unsigned int i = 0; i < n; ++i) a.setVal(i, i, a.getVal(i, i) + 4.0 * n);
+		MathVector b(n);
+		for (unsigned int i = 0; i < n; ++i) b[i] = (double)(i % 5);
+
+		double luSeconds = bestTimeInSeconds(3, [&] { MathVector x = solve(a, b); });
+
+		// Elimination without pivoting is enough for a diagonally dominant matrix
+		double rowOpSeconds = (n > 512) ? 0.0 : bestTimeInSeconds(1, [&] {
+			MathMatrix work = a;
+			MathVector x = b;
+			for (unsigned int k = 0; k < n; ++k)
+			{
+				for (unsigned int r = k + 1; r < n; ++r)
+				{
+					double factor = -work.getVal(r, k) / work.getVal(k, k);
+					work.addMultipleOfRow(r, k, factor);
+					x[r] += factor * x[k];
+				}
+			}
+			for (unsigned int k = n; k-- > 0;)
+			{
+				for (unsigned int c = k + 1; c < n; ++c) x[k] -= work.getVal(k, c) * x[c];
+				x[k] /= work.getVal(k, k);
+			}
+		});
+
+		std::printf("%8u %12.5f %12.2f", n, luSeconds, 2.0 / 3.0 * n * n * n / luSeconds * 1e-9);
+		if (rowOpSeconds > 0.0) std::printf(" %14.5f %10.1f\n", rowOpSeconds, rowOpSeconds / luSeconds);
+		else std::printf(" %14s %10s\n", "-", "-");
+	}
+}
+
+static void benchmarkCholeskySolve()
+{
+	std::printf("\nSymmetric positive definite A, Cholesky vs LU, factor once and solve 100 vectors\n");
+	std::printf("%8s %14s %14s %14s %14s\n", "n", "chol factor", "LU factor", "chol 100 solves", "LU 100 solves");
+
+	for (unsigned int n : { 128u, 256u, 512u, 1024u, 2048u })
+	{
+		// A = B^T * B + n * I
+		MathMatrix b = makeBenchmarkMatrix(n, n, COLUMNSPACE);
+		MathMatrix bT = b;
+		bT.transpose();
+		MathMatrix a = bT * b;
+		for (unsigned int i = 0; i < n; ++i) a.setVal(i, i, a.getVal(i, i) + n);
+		MathVector rhs(n);
+		for (unsigned int i = 0; i < n; ++i) rhs[i] = (double)(i % 5);
+
+		MathCholeskyDecomposition chol;
+		MathLUDecomposition lu;
+		double cholSeconds = bestTimeInSeconds(3, [&] { chol.factor(a.getView()); });
+		double luSeconds = bestTimeInSeconds(3, [&] { lu.factor(a.getView()); });
+		double cholSolveSeconds = bestTimeInSeconds(3, [&] {
+			for (int i = 0; i < 100; ++i) { MathVector x = chol.solve(rhs); }
+		});
+		double luSolveSeconds = bestTimeInSeconds(3, [&] {
+			for (int i = 0; i < 100; ++i) { MathVector x = lu.solve(rhs); }
+		});
+
+		std::printf("%8u %14.5f %14.5f %14.5f %14.5f\n", n, cholSeconds, luSeconds, cholSolveSeconds, luSolveSeconds);
+	}
+}
+
+static void benchmarkLeastSquares()
+{
+	std::printf("\nLeast squares by blocked Householder QR, m x n, one right-hand side, all threads\n");
+	std::printf("%10s %6s %12s %12s\n", "m", "n", "seconds", "GFLOP/s");
+
+	const unsigned int sizes[][2] = { { 10000, 10 }, { 100000, 50 }, { 1000000, 20 }, { 20000, 500 }, { 2000, 2000 } };
+	for (const unsigned int* size : sizes)
+	{
+		unsigned int m = size[0], n = size[1];
+		MathMatrix a = makeBenchmarkMatrix(m, n, COLUMNSPACE);
+		for (unsigned int i = 0; i < n; ++i) a.setVal(i, i, a.getVal(i, i) + 100.0);
+		MathVector b(m);
+		for (unsigned int i = 0; i < m; ++i) b[i] = (double)(i % 5);
+
+		double seconds = bestTimeInSeconds(2, [&] { MathVector x = leastSquares(a, b); });
+		double flops = 2.0 * m * n * n - 2.0 / 3.0 * n * n * n;
+		std::printf("%10u %6u %12.5f %12.2f\n", m, n, seconds, flops / seconds * 1e-9);
+	}
+}
+
+static void benchmarkSparseMultiply()
+{
+	std::printf("\nSparse matrix times vector, n x n with nnz per row, all threads\n");
+	std::printf("%10s %6s %10s %12s %12s %12s %14s\n", "n", "nnz/r", "space", "seconds", "GFLOP/s", "GB/s", "MB (dense GB)");
+
+	const unsigned int sizes[][2] = { { 100000, 10 }, { 1000000, 10 }, { 1000000, 50 } };
+	for (const unsigned int* size : sizes)
+	{
+		unsigned int n = size[0], perRow = size[1];
+		std::vector<size_t> offsets(1, 0);
+		std::vector<unsigned int> indices;
+		std::vector<double> values;
+		offsets.reserve((size_t)n + 1);
+		indices.reserve((size_t)n * perRow);
+		values.reserve((size_t)n * perRow);
+
+		unsigned long long state = 1;
+		for (unsigned int r = 0; r < n; ++r)
+		{
+			// Distinct random columns in increasing order, one per stripe of the row
+			for (unsigned int k = 0; k < perRow; ++k)
+			{
+				state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+				unsigned int stripe = n / perRow;
+				indices.push_back(k * stripe + (unsigned int)((state >> 33) % stripe));
+				values.push_back(1.0);
+			}
+			offsets.push_back(indices.size());
+		}
+
+		MathSparseMatrix csr;
+		csr.setCompressed(n, n, ROWSPACE, std::move(offsets), std::move(indices), std::move(values));
+		MathVector x(n);
+		for (unsigned int i = 0; i < n; ++i) x[i] = (double)(i % 5);
+		MathVector y(n);
+
+		for (vector_space_t space : { ROWSPACE, COLUMNSPACE })
+		{
+			MathSparseMatrix a = csr.convertTo(space);
+			double seconds = bestTimeInSeconds(5, [&] { multiply(a, x, y); });
+			double nnz = (double)a.getNumNonZeros();
+			double bytes = nnz * (sizeof(double) + sizeof(unsigned int)) + 3.0 * n * sizeof(double);
+			std::printf("%10u %6u %10s %12.5f %12.2f %12.2f %7.0f (%5.0f)\n", n, perRow,
+				(space == ROWSPACE) ? "CSR" : "CSC", seconds, 2.0 * nnz / seconds * 1e-9,
+				bytes / seconds * 1e-9, a.getMemoryUsage() / 1e6, (double)n * n * sizeof(double) / 1e9);
+		}
+	}
+}
+
+static void benchmarkSparseAssembly()
+{
+	std::printf("\nAssembling a 2D grid of 4 node elements from triplets, all threads\n");
+	std::printf("%10s %12s %12s %12s %14s\n", "elements", "triplets", "add sec", "build sec", "Mtriplets/s");
+
+	MathThreadPool& pool = MathThreadPool::getInstance();
+	for (unsigned int side : { 300u, 1000u })
+	{
+		unsigned int nodes = (side + 1) * (side + 1);
+		MathSparseMatrixBuilder builder(nodes, nodes);
+		MathSparseMatrix a;
+
+		// Every element adds a 4 x 4 block over its corners, shared with up to three neighbours
+		double addSeconds = bestTimeInSeconds(3, [&] {
+			builder.clear();
+			pool.parallelFor(side, [&](unsigned int row)
+			{
+				for (unsigned int col = 0; col < side; ++col)
+				{
+					unsigned int corners[4] = { row * (side + 1) + col, row * (side + 1) + col + 1,
+						(row + 1) * (side + 1) + col, (row + 1) * (side + 1) + col + 1 };
+					for (unsigned int i = 0; i < 4; ++i)
+						for (unsigned int j = 0; j < 4; ++j)
+							builder.add(corners[i], corners[j], (i == j) ? 2.0 / 3.0 : -1.0 / 6.0);
+				}
+			});
+		});
+		double buildSeconds = bestTimeInSeconds(3, [&] { a = builder.build(); });
+
+		double triplets = (double)builder.getNumTriplets();
+		std::printf("%10u %12.0f %12.5f %12.5f %14.1f\n", side * side, triplets, addSeconds,
+			buildSeconds, triplets / (addSeconds + buildSeconds) * 1e-6);
+	}
+}
+
+static void benchmarkFixedMatrix()
+{
+	std::printf("\n4 x 4 transforms, nanoseconds per operation\n");
+	std::printf("%22s %14s %14s\n", "", "MathFixedMatrix", "MathMatrix");
+
+	const int count = 200000;
+	MathFixedMatrix4 fixed = { {2, 1, 0, 1}, {0, 3, 1, 0}, {1, 0, 2, 1}, {0, 1, 0, 4} };
+	MathFixedVector<4> fixedPoint = { 1, 2, 3, 1 };
+	MathMatrix dynamic = fixed.toMathMatrix();
+	MathMatrix dynamicPoint(fixedPoint.toMathVector(), COLUMNSPACE);
+
+	// The sums keep the compiler from dropping the loops
+	double sink = 0.0;
+	double fixedMultiply = bestTimeInSeconds(3, [&] {
+		MathFixedMatrix4 product = fixed;
+		for (int i = 0; i < count; ++i) { product = product * fixed; product *= 0.25; }
+		sink += product(0, 0);
+	});
+	double dynamicMultiply = bestTimeInSeconds(3, [&] {
+		MathMatrix product = dynamic;
+		for (int i = 0; i < count; ++i) { product = product * dynamic; product.multiplyRowByConstant(0, 0.25); }
+		sink += product.getVal(0, 0);
+	});
+	double fixedInverse = bestTimeInSeconds(3, [&] {
+		for (int i = 0; i < count; ++i) { fixed(0, 0) += 1e-9; sink += inverse(fixed)(1, 1); }
+	});
+	double dynamicInverse = bestTimeInSeconds(3, [&] {
+		for (int i = 0; i < count; ++i) { dynamic.setVal(0, 0, dynamic.getVal(0, 0) + 1e-9); sink += inverse(dynamic).getVal(1, 1); }
+	});
+	double fixedApply = bestTimeInSeconds(3, [&] {
+		for (int i = 0; i < count; ++i) { fixedPoint[0] += 1e-9; sink += (fixed * fixedPoint)[3]; }
+	});
+	double dynamicApply = bestTimeInSeconds(3, [&] {
+		for (int i = 0; i < count; ++i) { dynamicPoint.setVal(0, 0, dynamicPoint.getVal(0, 0) + 1e-9); sink += (dynamic * dynamicPoint).getVal(3, 0); }
+	});
+
+	std::printf("%22s %14.1f %14.1f\n", "multiply", fixedMultiply / count * 1e9, dynamicMultiply / count * 1e9);
+	std::printf("%22s %14.1f %14.1f\n", "inverse", fixedInverse / count * 1e9, dynamicInverse / count * 1e9);
+	std::printf("%22s %14.1f %14.1f\n", "transform a point", fixedApply / count * 1e9, dynamicApply / count * 1e9);
+	if (sink == 1.0) std::printf("\n");
+}
+
+static void benchmarkFloatPrecision()
+{
+	simd_instruction_set_t before = getSimdInstructionSet();
+	const unsigned int vectorSize = 4096;
+	const unsigned int repeats = 1000;
+	const unsigned int n = 512;
+
+	std::printf("\nDouble against float, vector size %u and multiplication n = %u, one thread\n",
+		vectorSize, n);
+	std::printf("%8s %14s %14s %14s %14s\n", "set", "dot f64 GF/s", "dot f32 GF/s", "mul f64 GF/s", "mul f32 GF/s");
+
+	MathThreadPool& pool = MathThreadPool::getInstance();
+	unsigned int threadsBefore = pool.getNumThreads();
+	pool.setNumThreads(1);
+
+	MathVector x(vectorSize), y(vectorSize);
+	MathVectorF xF(vectorSize), yF(vectorSize);
+	for (unsigned int i = 0; i < vectorSize; ++i)
+	{
+		xF[i] = (float)(x[i] = (double)(i % 17) - 8.0);
+		yF[i] = (float)(y[i] = (double)(i % 13) - 6.0);
+	}
+	MathMatrix a = makeBenchmarkMatrix(n, n, COLUMNSPACE);
+	MathMatrix b = makeBenchmarkMatrix(n, n, ROWSPACE);
+	MathMatrixF aF(a.getView());
+	MathMatrixF bF(b.getView());
+
+	for (int set = SIMD_SCALAR; set <= getSupportedSimdInstructionSet(); ++set)
+	{
+		setSimdInstructionSet((simd_instruction_set_t)set);
+
+		volatile double sink = 0.0;
+		double dotSeconds = bestTimeInSeconds(3, [&] {
+			for (unsigned int i = 0; i < repeats; ++i) sink = sink + x.dotProduct(y);
+		});
+		double dotFloatSeconds = bestTimeInSeconds(3, [&] {
+			for (unsigned int i = 0; i < repeats; ++i) sink = sink + xF.dotProduct(yF);
+		});
+		double mulSeconds = bestTimeInSeconds(3, [&] { MathMatrix c = a * b; });
+		double mulFloatSeconds = bestTimeInSeconds(3, [&] { MathMatrixF c = aF * bF; });
+
+		std::printf("%8s %14.2f %14.2f %14.2f %14.2f\n", instructionSetName((simd_instruction_set_t)set),
+			2.0 * vectorSize * repeats / dotSeconds * 1e-9,
+			2.0 * vectorSize * repeats / dotFloatSeconds * 1e-9,
+			2.0 * n * n * n / mulSeconds * 1e-9,
+			2.0 * n * n * n / mulFloatSeconds * 1e-9);
+	}
+	setSimdInstructionSet(before);
+
+	// Too big for any cache, so the dot product only runs as fast as memory delivers elements
+	const unsigned int bigSize = 8 * 1024 * 1024;
+	MathVector big(bigSize);
+	MathVectorF bigF(bigSize);
+	volatile double sink = 0.0;
+	double bigSeconds = bestTimeInSeconds(5, [&] { sink = sink + big.dotProduct(big); });
+	double bigFloatSeconds = bestTimeInSeconds(5, [&] { sink = sink + bigF.dotProduct(bigF); });
+	std::printf("dot of %u elements from memory: f64 %.2f GB/s, f32 %.2f GB/s, f32 is %.2fx faster\n",
+		bigSize, 8.0 * bigSize / bigSeconds * 1e-9, 4.0 * bigSize / bigFloatSeconds * 1e-9,
+		bigSeconds / bigFloatSeconds);
+
+	pool.setNumThreads(threadsBefore);
+}
+
+static void benchmarkArenaAllocation()
+{
+	std::printf("\nA request that builds and discards small matrices, microseconds per request\n");
+	std::printf("%22s %14s %14s\n", "", "heap", "MathArena");
+
+	const int numRequests = 2000;
+	const unsigned int matricesPerRequest = 200;
+
+	// Copies, growth and small products, the allocations a request loop is made of
+	double sink = 0.0;
+	auto request = [&](unsigned int seed) {
+		for (unsigned int i = 0; i < matricesPerRequest; ++i)
+		{
+			MathMatrix a(6, 6);
+			a.setVal(i % 6, (i + seed) % 6, 1.0 + i);
+			MathMatrix b = a;
+			b.addRow(MathVector(6));
+			MathVector v;
+			for (unsigned int j = 0; j < 12; ++j) v.push_back((double)j);
+			sink += b.getVal(i % 6, (i + seed) % 6) + v[11];
+		}
+	};
+
+	double heap = bestTimeInSeconds(3, [&] {
+		for (int r = 0; r < numRequests; ++r) request(r);
+	});
+
+	MathArena arena;
+	double pooled = bestTimeInSeconds(3, [&] {
+		for (int r = 0; r < numRequests; ++r)
+		{
+			{
+				MathArenaScope scope(arena);
+				request(r);
+			}
+			arena.reset();
+		}
+	});
+
+	std::printf("%22s %14.2f %14.2f\n", "per request", heap / numRequests * 1e6, pooled / numRequests * 1e6);
+	std::printf("%22s %14s %13.2fx\n", "speedup", "", heap / pooled);
+	if (sink == 1.0) std::printf("\n");
+}
+
+static void benchmarkPaddedLeadingDimension()
+{
+	std::printf("\nWalking every row of a column space matrix, GB/s\n");
+	std::printf("%22s %14s %14s\n", "rows x cols", "unpadded", "padded");
+
+	for (unsigned int n : { 512u, 1024u, 2048u })
+	{
+		// The padded matrix next to a view of the same elements with the leading dimension n
+		MathMatrix padded = makeBenchmarkMatrix(n, n, COLUMNSPACE);
+		std::vector<double> buffer((size_t)n * n);
+		MathMatrixView unpadded(buffer.data(), n, n, 1, n);
+		for (unsigned int c = 0; c < n; ++c)
+		{
+			for (unsigned int r = 0; r < n; ++r) unpadded.setVal(r, c, padded.getVal(r, c));
+		}
+
+		// Rows are strided, one element per column, so every step lands a leading dimension away
+		double sink = 0.0;
+		auto walkRows = [&](const MathMatrixView& m) {
+			for (unsigned int r = 0; r < n; ++r) sink += dotProduct(m.getRow(r), m.getRow(r));
+		};
+		double unpaddedTime = bestTimeInSeconds(3, [&] { walkRows(unpadded); });
+		double paddedTime = bestTimeInSeconds(3, [&] { walkRows(padded.getView()); });
+
+		double bytes = (double)n * n * sizeof(double);
+		char size[32];
+		std::snprintf(size, sizeof(size), "%u x %u", n, n);
+		std::printf("%22s %14.2f %14.2f\n", size, bytes / unpaddedTime * 1e-9, bytes / paddedTime * 1e-9);
+		if (sink == 1.0) std::printf("\n");
+	}
+}
+
+static void benchmarkAppendRows()
+{
+	std::printf("\nStreaming records of 16 values into a column space matrix, million elements per second\n");
+	std::printf("%22s %14s %14s %14s\n", "records", "addRow", "reserve", "appendRows");
+
+	const unsigned int recordSize = 16;
+	const unsigned int batchSize = 256;
+	MathVector record(recordSize);
+	std::vector<MathVector> batch(batchSize, record);
+
+	for (unsigned int numRecords : { 10000u, 200000u })
+	{
+		double sink = 0.0;
+		double oneAtATime = bestTimeInSeconds(3, [&] {
+			MathMatrix m;
+			m.reserve(0, recordSize);
+			for (unsigned int i = 0; i < numRecords; ++i) { record[0] = i; m.addRow(record); }
+			sink += m.getVal(numRecords - 1, 0);
+		});
+		double reserved = bestTimeInSeconds(3, [&] {
+			MathMatrix m;
+			m.reserve(numRecords, recordSize);
+			for (unsigned int i = 0; i < numRecords; ++i) { record[0] = i; m.addRow(record); }
+			sink += m.getVal(numRecords - 1, 0);
+		});
+		double batched = bestTimeInSeconds(3, [&] {
+			MathMatrix m;
+			m.reserve(0, recordSize);
+			for (unsigned int i = 0; i < numRecords; i += batchSize)
+			{
+				for (unsigned int b = 0; b < batchSize; ++b) batch[b][0] = i + b;
+				m.appendRows(batch);
+			}
+			sink += m.getVal(numRecords - 1, 0);
+		});
+
+		double elements = (double)numRecords * recordSize;
+		std::printf("%22u %14.1f %14.1f %14.1f\n", numRecords, elements / oneAtATime * 1e-6,
+			elements / reserved * 1e-6, elements / batched * 1e-6);
+		if (sink == 1.0) std::printf("\n");
+	}
+}
+
+static void benchmarkLayouts()
+{
+	std::printf("\n24 x 24 products by layout of A and B, GFLOP/s\n");
+	std::printf("%22s %14s %14s\n", "A \\ B", "ROWSPACE", "COLUMNSPACE");
+
+	const unsigned int n = 24;
+	const int count = 20000;
+	vector_space_t spaces[] = { ROWSPACE, COLUMNSPACE };
+	const char* names[] = { "ROWSPACE", "COLUMNSPACE" };
+	double sink = 0.0;
+
+	for (int i = 0; i < 2; ++i)
+	{
+		double gflops[2];
+		for (int j = 0; j < 2; ++j)
+		{
+			MathMatrix a = makeBenchmarkMatrix(n, n, spaces[i]);
+			MathMatrix b = makeBenchmarkMatrix(n, n, spaces[j]);
+			MathMatrix c(n, n);
+			double seconds = bestTimeInSeconds(3, [&] {
+				for (int r = 0; r < count; ++r) multiply(a.getView(), b.getView(), c.getView(), 1.0, 0.5);
+				sink += c.getVal(0, 0);
+			});
+			gflops[j] = 2.0 * n * n * n * count / seconds * 1e-9;
+		}
+		std::printf("%22s %14.2f %14.2f\n", names[i], gflops[0], gflops[1]);
+	}
+
+	std::printf("\nPhysical transpose of a column space matrix, GB/s\n");
+	std::printf("%22s %14s %14s\n", "rows x cols", "element loop", "copyElements");
+
+	for (unsigned int size : { 256u, 1024u, 4096u })
+	{
+		MathMatrix from = makeBenchmarkMatrix(size, size, COLUMNSPACE);
+		MathMatrix to(size, size);
+		MathMatrixView transposed = from.getView();
+		transposed.transpose();
+
+		double loop = bestTimeInSeconds(3, [&] {
+			for (unsigned int c = 0; c < size; ++c)
+			{
+				for (unsigned int r = 0; r < size; ++r) to.setVal(r, c, from.getVal(c, r));
+			}
+		});
+		double blocked = bestTimeInSeconds(3, [&] { copyElements(transposed, to.getView()); });
+		sink += to.getVal(1, 0);
+
+		// Every element is read once and written once
+		double bytes = 2.0 * size * size * sizeof(double);
+		char name[32];
+		std::snprintf(name, sizeof(name), "%u x %u", size, size);
+		std::printf("%22s %14.2f %14.2f\n", name, bytes / loop * 1e-9, bytes / blocked * 1e-9);
+	}
+	if (sink == 1.0) std::printf("\n");
+}
+
+static void benchmarkGemv()
+{
+	std::printf("\nMatrix vector product y = A * x, GB/s of A read\n");
+	std::printf("%22s %14s %14s %14s\n", "n x n, space of A", "element loop", "1 thread", "all threads");
+
+	MathThreadPool& pool = MathThreadPool::getInstance();
+	unsigned int threadsBefore = pool.getNumThreads();
+	unsigned int hardwareThreads = std::thread::hardware_concurrency();
+	if (hardwareThreads == 0) hardwareThreads = 1;
+
+	vector_space_t spaces[] = { ROWSPACE, COLUMNSPACE };
+	const char* names[] = { "ROWSPACE", "COLUMNSPACE" };
+	double sink = 0.0;
+
+	for (unsigned int n : { 1024u, 4096u })
+	{
+		for (int i = 0; i < 2; ++i)
+		{
+			MathMatrix a = makeBenchmarkMatrix(n, n, spaces[i]);
+			MathVector x(n);
+			for (unsigned int j = 0; j < n; ++j) x[j] = 1.0 / (j + 1);
+			MathVector y(n);
+
+			double loop = bestTimeInSeconds(3, [&] {
+				for (unsigned int r = 0; r < n; ++r)
+				{
+					double sum = 0.0;
+					for (unsigned int c = 0; c < n; ++c) sum += a.getVal(r, c) * x[c];
+					y[r] = sum;
+				}
+			});
+
+			pool.setNumThreads(1);
+			double serial = bestTimeInSeconds(5, [&] { multiply(a.getView(), x, y); });
+			pool.setNumThreads(hardwareThreads);
+			double parallel = bestTimeInSeconds(5, [&] { multiply(a.getView(), x, y); });
+			sink += y[n - 1];
+
+			double bytes = (double)n * n * sizeof(double);
+			char name[32];
+			std::snprintf(name, sizeof(name), "%u %s", n, names[i]);
+			std::printf("%22s %14.2f %14.2f %14.2f\n", name, bytes / loop * 1e-9,
+				bytes / serial * 1e-9, bytes / parallel * 1e-9);
+		}
+	}
+
+	pool.setNumThreads(threadsBefore);
+	if (sink == 1.0) std::printf("\n");
+}
+
+// Times one batch of N x N matrices against the same work done one MathFixedMatrix and
+//     one MathMatrix at a time, in nanoseconds per matrix
+template <unsigned int N>
+static void benchmarkBatchOfSize(size_t count, int repeats)
+{
+	MathMatrixBatch<N, N> a(count), b(count);
+	MathVectorBatch<N> x(count);
+	std::vector<MathFixedMatrix<N, N>> fixedA(count), fixedB(count);
+	std::vector<MathFixedMatrix<N, 1>> fixedX(count);
+	std::vector<MathMatrix> dynamicA, dynamicB;
+	for (size_t i = 0; i < count; ++i)
+	{
+		for (unsigned int r = 0; r < N; ++r)
+		{
+			for (unsigned int c = 0; c < N; ++c)
+			{
+				fixedA[i](r, c) = (double)((r * 7 + c * 3 + i) % 13) + ((r == c) ? 4.0 * N : 0.0);
+				fixedB[i](r, c) = (double)((r * 5 + c * 11 + i) % 17);
+			}
+			fixedX[i](r, 0) = 1.0 + r;
+		}
+		a.set(i, fixedA[i]);
+		b.set(i, fixedB[i]);
+		x.set(i, fixedX[i]);
+		dynamicA.push_back(fixedA[i].toMathMatrix());
+		dynamicB.push_back(fixedB[i].toMathMatrix());
+	}
+
+	double sink = 0.0;
+	MathMatrixBatch<N, N> product;
+	MathVectorBatch<N> ax;
+	double batchMultiply = bestTimeInSeconds(3, [&] {
+		for (int rep = 0; rep < repeats; ++rep) multiply(a, b, product);
+		sink += product(0, 0, 0);
+	});
+	double batchInverse = bestTimeInSeconds(3, [&] {
+		for (int rep = 0; rep < repeats; ++rep) sink += inverse(a)(count - 1, 0, 0);
+	});
+	double batchApply = bestTimeInSeconds(3, [&] {
+		for (int rep = 0; rep < repeats; ++rep) multiply(a, x, ax);
+		sink += ax(0, 0, 0);
+	});
+
+	std::vector<MathFixedMatrix<N, N>> fixedProduct(count);
+	std::vector<MathFixedMatrix<N, 1>> fixedAx(count);
+	double fixedMultiply = bestTimeInSeconds(3, [&] {
+		for (int rep = 0; rep < repeats; ++rep)
+		{
+			for (size_t i = 0; i < count; ++i) fixedProduct[i] = fixedA[i] * fixedB[i];
+		}
+		sink += fixedProduct[0](0, 0);
+	});
+	double fixedInverse = bestTimeInSeconds(3, [&] {
+		for (int rep = 0; rep < repeats; ++rep)
+		{
+			for (size_t i = 0; i < count; ++i) fixedProduct[i] = inverse(fixedA[i]);
+		}
+		sink += fixedProduct[count - 1](0, 0);
+	});
+	double fixedApply = bestTimeInSeconds(3, [&] {
+		for (int rep = 0; rep < repeats; ++rep)
+		{
+			for (size_t i = 0; i < count; ++i) fixedAx[i] = fixedA[i] * fixedX[i];
+		}
+		sink += fixedAx[0](0, 0);
+	});
+	double dynamicMultiply = bestTimeInSeconds(1, [&] {
+		for (size_t i = 0; i < count; ++i) sink += (dynamicA[i] * dynamicB[i]).getVal(0, 0);
+	});
+
+	double perMatrix = 1e9 / ((double)count * repeats);
+	char name[32];
+	std::snprintf(name, sizeof(name), "%u x %u multiply", N, N);
+	std::printf("%22s %16.2f %16.2f %14.2f\n", name, batchMultiply * perMatrix,
+		fixedMultiply * perMatrix, dynamicMultiply / count * 1e9);
+	std::snprintf(name, sizeof(name), "%u x %u inverse", N, N);
+	std::printf("%22s %16.2f %16.2f\n", name, batchInverse * perMatrix, fixedInverse * perMatrix);
+	std::snprintf(name, sizeof(name), "%u x %u times vector", N, N);
+	std::printf("%22s %16.2f %16.2f\n", name, batchApply * perMatrix, fixedApply * perMatrix);
+	if (sink == 1.0) std::printf("\n");
+}
+
+static void benchmarkMatrixBatch()
+{
+	// Batches that stay in the L2 cache, worked on over and over
+	const size_t count = 1024;
+	const int repeats = 200;
+	std::printf("\nBatches of %u small matrices, nanoseconds per matrix\n", (unsigned int)count);
+	std::printf("%22s %16s %16s %14s\n", "", "MathMatrixBatch", "MathFixedMatrix", "MathMatrix");
+
+	benchmarkBatchOfSize<3>(count, repeats);
+	benchmarkBatchOfSize<4>(count, repeats);
+	benchmarkBatchOfSize<6>(count, repeats);
+}
+
+static void benchmarkStrassen()
+{
+	std::printf("\nStrassen-Winograd against operator*, milliseconds, all threads\n");
+	std::printf("%10s %14s %14s %14s %14s\n", "n x n", "operator*", "crossover 256", "crossover 512",
+		"crossover 1024");
+
+	double sink = 0.0;
+	for (unsigned int n : { 1024u, 2048u, 4096u })
+	{
+		MathMatrix a = makeBenchmarkMatrix(n, n, COLUMNSPACE);
+		MathMatrix b = makeBenchmarkMatrix(n, n, COLUMNSPACE);
+		MathMatrix c(n, n);
+
+		double classical = bestTimeInSeconds(2, [&] { c = a * b; });
+		sink += c.getVal(n - 1, n - 1);
+		std::printf("%10u %14.1f", n, classical * 1e3);
+
+		// One object per crossover, so the workspace is allocated by the first repetition only
+		for (unsigned int crossover : { 256u, 512u, 1024u })
+		{
+			MathStrassen strassen(crossover);
+			double winograd = bestTimeInSeconds(2, [&] { strassen.multiply(a, b, c); });
+			sink += c.getVal(n - 1, n - 1);
+			std::printf(" %14.1f", winograd * 1e3);
+		}
+		std::printf("\n");
+	}
+
+	if (sink == 1.0) std::printf("\n");
+}
+
+static void benchmarkMatrixFile()
+{
+	std::printf("\nMatrix files, milliseconds\n");
+	std::printf("%10s %10s %14s %14s %14s %16s\n", "n x n", "MB", "save", "loadMatrix", "open mapped",
+		"first A * x");
+
+	const char* path = "MatrixLibraryBenchmark_matrixFile.mat";
+	double sink = 0.0;
+	for (unsigned int n : { 1024u, 4096u })
+	{
+		MathMatrix a = makeBenchmarkMatrix(n, n, COLUMNSPACE);
+		MathVector x(n), y(n);
+		for (unsigned int j = 0; j < n; ++j) x[j] = 1.0 / (j + 1);
+
+		double save = bestTimeInSeconds(1, [&] { saveMatrix(path, a.getView()); });
+		MathMatrix loaded;
+		double load = bestTimeInSeconds(3, [&] { loadMatrix(path, loaded); });
+
+		// Opening reads only the header, the product then touches every page of the payload
+		MathMappedMatrix mapped;
+		double open = bestTimeInSeconds(3, [&] { mapped.open(path); });
+		double firstUse = bestTimeInSeconds(1, [&] { multiply(mapped.getView(), x, y); });
+		sink += y[n - 1] + loaded.getVal(n - 1, n - 1);
+
+		std::printf("%10u %10.1f %14.2f %14.2f %14.4f %16.2f\n", n, (double)n * n * sizeof(double) / 1e6,
+			save * 1e3, load * 1e3, open * 1e3, firstUse * 1e3);
+	}
+
+	std::remove(path);
+	if (sink == 1.0) std::printf("\n");
+}
+
+static void benchmarkOutOfCoreMultiply()
+{
+	std::printf("\nOut of core product of 2048 x 2048 matrix files, GFLOP/s\n");
+	std::printf("%22s %12s %14s\n", "memory budget", "tile size", "GFLOP/s");
+
+	const unsigned int n = 2048;
+	const char* aPath = "MatrixLibraryBenchmark_a.mat";
+	const char* bPath = "MatrixLibraryBenchmark_b.mat";
+	const char* cPath = "MatrixLibraryBenchmark_c.mat";
+	MathMatrix a = makeBenchmarkMatrix(n, n, COLUMNSPACE);
+	MathMatrix b = makeBenchmarkMatrix(n, n, ROWSPACE);
+	saveMatrix(aPath, a.getView());
+	saveMatrix(bPath, b.getView());
+	double flops = 2.0 * n * n * n;
+
+	MathMatrix c;
+	double inMemory = bestTimeInSeconds(2, [&] { c = a * b; });
+	std::printf("%22s %12s %14.2f\n", "all in memory", "", flops / inMemory * 1e-9);
+
+	// The three operands are 100 MB together
+	for (size_t megabytes : { 6u, 24u, 96u })
+	{
+		MathOutOfCoreMultiply outOfCore(megabytes << 20);
+		double seconds = bestTimeInSeconds(2, [&] { outOfCore.multiply(aPath, bPath, cPath); });
+		char name[32];
+		std::snprintf(name, sizeof(name), "%u MB", (unsigned int)megabytes);
+		std::printf("%22s %12u %14.2f\n", name, outOfCore.getTileSize(), flops / seconds * 1e-9);
+	}
+
+	std::remove(aPath);
+	std::remove(bPath);
+	std::remove(cPath);
+}
+
+int main()
+{
+	benchmarkVectorExpression();
+	benchmarkInstructionSets();
+	benchmarkMultiply();
+	benchmarkMultiplyScaling();
+	benchmarkLUSolve();
+	benchmarkCholeskySolve();
+	benchmarkLeastSquares();
+	benchmarkSparseMultiply();
+	benchmarkSparseAssembly();
+	benchmarkFixedMatrix();
+	benchmarkFloatPrecision();
+	benchmarkArenaAllocation();
+	benchmarkPaddedLeadingDimension();
+	benchmarkAppendRows();
+	benchmarkLayouts();
+	benchmarkGemv();
+	benchmarkMatrixBatch();
+	benchmarkStrassen();
+	benchmarkMatrixFile();
+	benchmarkOutOfCoreMultiply();
+	return 0;
+}
@@ -0,0 +1,120 @@
+#include "pch.h"
+
+#include "../MatrixLibrary/MathArena.h"
+#include "../MatrixLibrary/MathMatrix.h"
+#include "../MatrixLibrary/MathVector.h"
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace MATH_ARENA_TESTS {
+
+	TEST(ArenaTests, ALLOCATIONS_ARE_ALIGNED_AND_DO_NOT_OVERLAP)
+	{
+		// A small first block so the allocations spread over several blocks
+		MathArena arena(256);
+
+		std::vector<std::pair<char*, size_t>> allocations;
+		for (size_t size : { 1u, 3u, 8u, 100u, 200u, 1000u, 5u })
+		{
+			char* p = static_cast<char*>(arena.allocate(size, 16));
+			EXPECT_EQ((uintptr_t)p % 16, 0u);
+			for (const std::pair<char*, size_t>& other : allocations)
+			{
+				EXPECT_TRUE(p + size <= other.first || other.first + other.second <= p);
+			}
+			allocations.push_back(std::make_pair(p, size));
+		}
+		EXPECT_EQ(arena.getBytesUsed(), 1317u);
+		EXPECT_GE(arena.getCapacity(), 1317u);
+	}
+
+	TEST(ArenaTests, RESET_KEEPS_ONE_BLOCK_BIG_ENOUGH_FOR_THE_NEXT_PASS)
+	{
+		MathArena arena(128);
+		for (int i = 0; i < 50; ++i)
+		{
+			arena.allocateElements<double>(10);
+		}
+		size_t capacity = arena.getCapacity();
+
+		arena.reset();
+		EXPECT_EQ(arena.getBytesUsed(), 0u);
+		EXPECT_EQ(arena.getCapacity(), capacity);
+
+		// The second pass fits in the block left by reset
+		for (int i = 0; i < 50; ++i)
+		{
+			arena.allocateElements<double>(10);
+		}
+		EXPECT_EQ(arena.getCapacity(), capacity);
+	}
+
+	TEST(ArenaTests, SCOPES_NEST_AND_RESTORE_THE_HEAP)
+	{
+		MathArena outer, inner;
+		EXPECT_EQ(MathArena::getCurrent(), nullptr);
+		{
+			MathArenaScope outerScope(outer);
+			EXPECT_EQ(MathArena::getCurrent(), &outer);
+			{
+				MathArenaScope innerScope(inner);
+				EXPECT_EQ(MathArena::getCurrent(), &inner);
+			}
+			EXPECT_EQ(MathArena::getCurrent(), &outer);
+		}
+		EXPECT_EQ(MathArena::getCurrent(), nullptr);
+	}
+
+	TEST(ArenaTests, VECTORS_AND_MATRICES_IN_A_SCOPE_USE_THE_ARENA)
+	{
+		MathArena arena;
+		MathMatrix kept;
+		MathVector keptVector;
+		{
+			MathArenaScope scope(arena);
+
+			MathMatrix a = { {1, 2}, {3, 4} };
+			MathMatrix b = a * a;
+			MathVector v = { 1, 2, 3 };
+			for (int i = 0; i < 20; ++i)
+			{
+				v.push_back(i);
+			}
+			EXPECT_TRUE(b.addRow({ 5, 6 }));
+			EXPECT_GT(arena.getBytesUsed(), 0u);
+
+			size_t used = arena.getBytesUsed();
+			{
+				// Copies and products made in the scope come from the arena too
+				MathMatrix c = b;
+				EXPECT_GT(arena.getBytesUsed(), used);
+			}
+
+			kept = b;
+			keptVector = v;
+		}
+		size_t used = arena.getBytesUsed();
+
+		// Copying assigns a buffer from where the copy is made, and kept was assigned in the scope
+		MathMatrix heapCopy = kept;
+		MathVector heapVector = keptVector;
+		EXPECT_EQ(arena.getBytesUsed(), used);
+
+		EXPECT_TRUE(heapCopy.equals({ {7, 10}, {15, 22}, {5, 6} }));
+		EXPECT_EQ(heapVector.getSize(), 23u);
+		EXPECT_DOUBLE_EQ(heapVector[22], 19.0);
+
+		// Growing an arena matrix after the scope closes moves it to the heap
+		EXPECT_TRUE(kept.addCol({ 0, 0, 0 }));
+		EXPECT_EQ(arena.getBytesUsed(), used);
+		EXPECT_DOUBLE_EQ(kept.getVal(2, 1), 6.0);
+
+		kept = MathMatrix();
+		keptVector = MathVector();
+		arena.reset();
+
+		// Everything left is on the heap and still valid after the reset
+		EXPECT_DOUBLE_EQ(heapCopy.getVal(1, 1), 22.0);
+	}
+}
@@ -0,0 +1,155 @@
+#include "pch.h"
+
+#include "../MatrixLibrary/MathMatrix.h"
+#include "../MatrixLibrary/MathCholeskyDecomposition.h"
+#include "../MatrixLibrary/MathLUDecomposition.h"
+#include "../MatrixLibrary/MathThreadPool.h"
+#include "TestHelpers.h"
+#include <cmath>
+#include <ostream>
+
+namespace CHOLESKY_DECOMPOSITION_TESTS {
+
+	// B * B^T + n * I for a pseudo random B, which is symmetric positive definite
+	static MathMatrix makeSpdMatrix(unsigned int n, vector_space_t space, unsigned int seed)
+	{
+		MathMatrix b = makeRandomMatrix(n, n, COLUMNSPACE, seed);
+		MathMatrix bT = b;
+		bT.transpose();
+		MathMatrix product = b * bT;
+
+		return makeMatrix(n, n, space, [&](unsigned int r, unsigned int c)
+		{
+			return product.getVal(r, c) + ((r == c) ? n : 0.0);
+		});
+	}
+
+	TEST(CholeskyDecompositionTests, SMALL_MATRIX_HAS_THE_KNOWN_FACTOR)
+	{
+		// L = [2 0 0; 6 1 0; -8 5 3]
+		MathMatrix a = { {4, 12, -16}, {12, 37, -43}, {-16, -43, 98} };
+		MathCholeskyDecomposition chol(a.getView());
+
+		ASSERT_TRUE(chol.isFactored());
+		EXPECT_EQ(chol.getFailedColumn(), -1);
+
+		MathMatrix expected = { {2, 0, 0}, {6, 1, 0}, {-8, 5, 3} };
+		EXPECT_LT(maxDifference(chol.getL(), expected), 1e-14);
+		EXPECT_NEAR(chol.logDeterminant(), std::log(36.0), 1e-12);
+
+		MathVector x = chol.solve(MathVector({ 1, 2, 3 }));
+		MathVector xLU = solve(a, MathVector({ 1, 2, 3 }));
+		ASSERT_EQ(x.getSize(), 3);
+		for (unsigned int i = 0; i < 3; ++i) EXPECT_NEAR(x[i], xLU[i], 1e-10);
+	}
+
+	TEST(CholeskyDecompositionTests, MANY_BLOCKS_IN_EITHER_SPACE)
+	{
+		const unsigned int n = 301;
+		for (vector_space_t space : { ROWSPACE, COLUMNSPACE })
+		{
+			MathMatrix a = makeSpdMatrix(n, space, 1);
+			MathCholeskyDecomposition chol(a.getView());
+			ASSERT_TRUE(chol.isFactored());
+
+			MathMatrix l = chol.getL();
+			MathMatrix lT = l;
+			lT.transpose();
+			EXPECT_LT(maxDifference(l * lT, a), 1e-10);
+			EXPECT_EQ(l.getVal(0, n - 1), 0);
+		}
+	}
+
+	TEST(CholeskyDecompositionTests, FACTOR_ONCE_SOLVE_MANY)
+	{
+		const unsigned int n = 200, nrhs = 7;
+		MathMatrix a = makeSpdMatrix(n, COLUMNSPACE, 2);
+		MathCholeskyDecomposition chol(a.getView());
+
+		MathMatrix b(nrhs, n);
+		b.transpose();
+		for (unsigned int r = 0; r < n; ++r)
+			for (unsigned int c = 0; c < nrhs; ++c)
+				b.setVal(r, c, (double)((r * 7 + c * 3) % 11) - 5.0);
+
+		MathMatrix x = chol.solve(b.getView());
+		ASSERT_EQ(x.getNumRows(), n);
+		ASSERT_EQ(x.getNumCols(), nrhs);
+		EXPECT_LT(maxDifference(a * x, b), 1e-10);
+
+		// Every column on its own gives the same answer
+		for (unsigned int c = 0; c < nrhs; ++c)
+		{
+			MathVector bc(n);
+			for (unsigned int r = 0; r < n; ++r) bc[r] = b.getVal(r, c);
+			MathVector xc = chol.solve(bc);
+			for (unsigned int r = 0; r < n; ++r) EXPECT_NEAR(xc[r], x.getVal(r, c), 1e-12);
+		}
+
+		MathMatrix identity(n, n);
+		for (unsigned int i = 0; i < n; ++i) identity.setVal(i, i, 1.0);
+		EXPECT_LT(maxDifference(a * chol.inverse(), identity), 1e-12);
+	}
+
+	TEST(CholeskyDecompositionTests, ONLY_THE_LOWER_TRIANGLE_IS_READ)
+	{
+		MathMatrix a = { {4, 999, 999}, {12, 37, 999}, {-16, -43, 98} };
+		MathCholeskyDecomposition chol(a.getView());
+
+		ASSERT_TRUE(chol.isFactored());
+		EXPECT_NEAR(chol.getL().getVal(2, 2), 3, 1e-14);
+	}
+
+	TEST(CholeskyDecompositionTests, NOT_POSITIVE_DEFINITE_FAILS_CLEANLY)
+	{
+		// Symmetric but indefinite, the second pivot is 1 - 4 = -3
+		MathMatrix indefinite = { {1, 2}, {2, 1} };
+		MathCholeskyDecomposition chol;
+		EXPECT_FALSE(chol.factor(indefinite.getView()));
+		EXPECT_FALSE(chol.isFactored());
+		EXPECT_EQ(chol.getFailedColumn(), 1);
+		EXPECT_EQ(chol.solve(MathVector({ 1, 1 })).getSize(), 0);
+		EXPECT_TRUE(std::isnan(chol.logDeterminant()));
+		EXPECT_EQ(choleskySolve(indefinite, MathVector({ 1, 1 })).getSize(), 0);
+
+		// A failure in a later block, past the first CHOLESKY_BLOCK_SIZE columns
+		const unsigned int n = 300;
+		MathMatrix a = makeSpdMatrix(n, COLUMNSPACE, 3);
+		a.setVal(250, 250, -1.0);
+		EXPECT_FALSE(chol.factor(a.getView()));
+		EXPECT_EQ(chol.getFailedColumn(), 250);
+
+		// Refactoring something valid clears the failure
+		EXPECT_TRUE(chol.factor(makeSpdMatrix(4, ROWSPACE, 4).getView()));
+		EXPECT_EQ(chol.getFailedColumn(), -1);
+
+		EXPECT_FALSE(chol.factor(MathMatrix(2, 3).getView()));
+		EXPECT_FALSE(chol.factor(MathMatrix().getView()));
+		EXPECT_EQ(chol.getFailedColumn(), -1);
+	}
+
+	TEST(CholeskyDecompositionTests, PARALLEL_FACTOR_MATCHES_SERIAL)
+	{
+		const unsigned int n = 520;
+		MathMatrix a = makeSpdMatrix(n, ROWSPACE, 5);
+		MathVector b(n);
+		for (unsigned int i = 0; i < n; ++i) b[i] = (double)(i % 9) - 4.0;
+
+		MathVector serial = choleskySolve(a, b);
+
+		MathThreadPool& pool = MathThreadPool::getInstance();
+		unsigned int threadsBefore = pool.getNumThreads();
+		pool.setNumThreads(4);
+		MathCholeskyDecomposition chol(a.getView());
+		MathVector parallel = chol.solve(b);
+		pool.setNumThreads(threadsBefore);
+
+		ASSERT_EQ(parallel.getSize(), n);
+		for (unsigned int i = 0; i < n; ++i) EXPECT_NEAR(parallel[i], serial[i], 1e-12);
+
+		MathMatrix l = chol.getL();
+		MathMatrix lT = l;
+		lT.transpose();
+		EXPECT_LT(maxDifference(l * lT, a), 1e-10);
+	}
+}
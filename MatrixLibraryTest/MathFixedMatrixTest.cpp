@@ -0,0 +1,126 @@
+#include "pch.h"
+
+#include "../MatrixLibrary/MathFixedMatrix.h"
+#include "../MatrixLibrary/MathLUDecomposition.h"
+#include "../MatrixLibrary/MathMatrix.h"
+#include "TestHelpers.h"
+#include <cmath>
+#include <ostream>
+
+namespace FIXED_MATRIX_TESTS {
+
+	// Pseudo random elements in [-1, 1) plus a diagonal that keeps the matrix well conditioned
+	template <unsigned int N>
+	static MathFixedMatrix<N, N> makeMatrix(unsigned int seed)
+	{
+		MathFixedMatrix<N, N> m;
+		unsigned long long state = seed;
+		for (unsigned int r = 0; r < N; ++r)
+		{
+			for (unsigned int c = 0; c < N; ++c)
+			{
+				m(r, c) = nextRandom(state) + ((r == c) ? 2.0 : 0.0);
+			}
+		}
+		return m;
+	}
+
+	template <unsigned int N>
+	static void expectInverseAndDeterminantMatchLU(unsigned int seed)
+	{
+		MathFixedMatrix<N, N> a = makeMatrix<N>(seed);
+		MathMatrix dynamic = a.toMathMatrix();
+
+		EXPECT_NEAR(determinant(a), determinant(dynamic), 1e-12 * std::fabs(determinant(dynamic)));
+		EXPECT_LT(maxDifference(a * inverse(a), MathFixedMatrix<N, N>::identity()), 1e-13);
+		EXPECT_LT(maxDifference(inverse(a), MathFixedMatrix<N, N>(inverse(dynamic).getView())), 1e-13);
+	}
+
+	TEST(FixedMatrixTests, EVALUATES_AT_COMPILE_TIME)
+	{
+		constexpr MathFixedMatrix2 rotate = { {0, -1}, {1, 0} };
+		constexpr MathFixedVector<2> x = { 1, 2 };
+		constexpr MathFixedVector<2> rotated = rotate * x;
+		static_assert(rotated[0] == -2 && rotated[1] == 1, "rotation by 90 degrees");
+
+		constexpr MathFixedMatrix3 a = { {1, 2, 3}, {0, 1, 4}, {5, 6, 0} };
+		static_assert(determinant(a) == 1, "3 x 3 determinant");
+		static_assert(inverse(a) * a == MathFixedMatrix3::identity(), "exact 3 x 3 inverse");
+		static_assert(determinant(MathFixedMatrix<5, 5>::identity() * 2.0) == 32, "5 x 5 determinant");
+		static_assert(crossProduct({ 1, 0, 0 }, { 0, 1, 0 }) == MathFixedVector<3>({ 0, 0, 1 }), "cross product");
+
+		EXPECT_EQ(rotated[0], -2);
+	}
+
+	TEST(FixedMatrixTests, PRODUCTS_MATCH_MATH_MATRIX)
+	{
+		MathFixedMatrix<3, 4> a = { {1, 2, 3, 4}, {5, 6, 7, 8}, {9, 10, 11, 12} };
+		MathFixedMatrix<4, 2> b = { {1, -1}, {2, 0}, {0, 3}, {-2, 1} };
+
+		MathFixedMatrix<3, 2> product = a * b;
+		MathMatrix expected = a.toMathMatrix() * b.toMathMatrix();
+		EXPECT_LT(maxDifference(product, MathFixedMatrix<3, 2>(expected.getView())), 1e-15);
+
+		MathFixedVector<4> v = { 1, 0, -1, 2 };
+		MathFixedVector<3> av = a * v;
+		EXPECT_EQ(av, MathFixedVector<3>({ 6, 14, 22 }));
+
+		MathFixedMatrix<4, 3> aT = transpose(a);
+		EXPECT_EQ(aT(3, 1), 8);
+		EXPECT_EQ(a + a, 2.0 * a);
+		EXPECT_EQ(a - a, (MathFixedMatrix<3, 4>()));
+	}
+
+	TEST(FixedMatrixTests, INVERSE_AND_DETERMINANT_OF_EVERY_SIZE)
+	{
+		expectInverseAndDeterminantMatchLU<2>(1);
+		expectInverseAndDeterminantMatchLU<3>(2);
+		expectInverseAndDeterminantMatchLU<4>(3);
+		expectInverseAndDeterminantMatchLU<5>(4);
+		expectInverseAndDeterminantMatchLU<7>(5);
+
+		// A 4 x 4 that needs pivoting and has a known determinant
+		MathFixedMatrix4 p = { {0, 1, 0, 0}, {0, 0, 0, 2}, {3, 0, 0, 0}, {0, 0, 4, 0} };
+		EXPECT_EQ(determinant(p), determinant(p.toMathMatrix()));
+		EXPECT_LT(maxDifference(inverse(p) * p, MathFixedMatrix4::identity()), 1e-15);
+	}
+
+	TEST(FixedMatrixTests, SINGULAR_MATRICES_GIVE_NAN_INVERSES)
+	{
+		MathFixedMatrix2 s2 = { {1, 2}, {2, 4} };
+		MathFixedMatrix3 s3 = { {1, 2, 3}, {4, 5, 6}, {7, 8, 9} };
+		MathFixedMatrix4 s4 = { {1, 2, 3, 4}, {2, 4, 6, 8}, {0, 1, 0, 1}, {1, 0, 1, 0} };
+		MathFixedMatrix<5, 5> s5;
+
+		EXPECT_EQ(determinant(s2), 0);
+		EXPECT_TRUE(std::isnan(inverse(s2)(0, 0)));
+		EXPECT_TRUE(std::isnan(inverse(s4)(3, 3)));
+		EXPECT_EQ(determinant(s5), 0);
+		EXPECT_TRUE(std::isnan(inverse(s5)(2, 1)));
+
+		// Singular in exact arithmetic, but rounding may leave a tiny determinant
+		EXPECT_NEAR(determinant(s3), 0, 1e-12);
+	}
+
+	TEST(FixedMatrixTests, CONVERSIONS_AND_VIEWS)
+	{
+		MathMatrix dynamic = { {1, 2, 3}, {4, 5, 6} };
+		MathFixedMatrix<2, 2> topLeft(dynamic.getView());
+		EXPECT_EQ(topLeft, MathFixedMatrix2({ {1, 2}, {4, 5} }));
+
+		MathFixedMatrix<3, 3> padded(dynamic.getView());
+		EXPECT_EQ(padded(2, 2), 0);
+		EXPECT_EQ(padded(1, 2), 6);
+		EXPECT_TRUE(padded.toMathMatrix().getView().getSubView(0, 0, 2, 3).equals({ {1, 2, 3}, {4, 5, 6} }));
+
+		// Library functions that take views work on the fixed matrix in place
+		MathFixedMatrix3 m = { {1, 2, 3}, {4, 5, 6}, {7, 8, 10} };
+		EXPECT_TRUE(m.getView().swapRows(0, 2));
+		EXPECT_EQ(m(0, 2), 10);
+
+		MathFixedVector<3> v(MathVector({ 1, 2 }));
+		EXPECT_EQ(v, MathFixedVector<3>({ 1, 2, 0 }));
+		EXPECT_TRUE(v.toMathVector().isEqualTo({ 1, 2, 0 }));
+		EXPECT_DOUBLE_EQ(MathFixedVector<2>({ 3, 4 }).getMagnitude(), 5);
+	}
+}
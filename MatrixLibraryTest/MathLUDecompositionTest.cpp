@@ -0,0 +1,224 @@
+#include "pch.h"
+
+#include "../MatrixLibrary/MathLUDecomposition.h"
+#include "../MatrixLibrary/MathMatrix.h"
+#include "../MatrixLibrary/MathTriangularSolve.h"
+#include "TestHelpers.h"
+#include <cmath>
+#include <ostream>
+
+namespace LU_DECOMPOSITION_TESTS {
+
+	// A matrix with pseudo random entries and a heavy diagonal so it is well conditioned
+	static MathMatrix makeWellConditionedMatrix(unsigned int rows, unsigned int cols, vector_space_t space,
+		unsigned int seed)
+	{
+		return makeMatrix(rows, cols, space, [seed](unsigned int r, unsigned int c)
+		{
+			return (double)((r * 37 + c * 61 + seed * 11) % 101) / 50.0 - 1.0 + ((r == c) ? 4.0 : 0.0);
+		});
+	}
+
+	// The largest |A * X - B| over every element
+	static double maxResidual(const MathMatrix& a, const MathMatrix& x, const MathMatrix& b)
+	{
+		MathMatrix ax = a * x;
+		double worst = 0.0;
+		for (unsigned int r = 0; r < b.getNumRows(); ++r)
+		{
+			for (unsigned int c = 0; c < b.getNumCols(); ++c)
+			{
+				worst = std::fmax(worst, std::fabs(ax.getVal(r, c) - b.getVal(r, c)));
+			}
+		}
+		return worst;
+	}
+
+	TEST(TriangularSolveTests, LOWER_AND_UPPER_SOLVES_IN_EITHER_LAYOUT)
+	{
+		// The lower triangle is L, the upper triangle is U and the diagonal belongs to both
+		MathMatrix t = { {2, 4, 7}, {1, 5, 8}, {3, 6, 9} };
+		for (vector_space_t space : { ROWSPACE, COLUMNSPACE })
+		{
+			MathMatrix tCopy = t;
+			if (space == ROWSPACE)
+			{
+				tCopy = { {2, 1, 3}, {4, 5, 6}, {7, 8, 9} };
+				tCopy.transpose();
+			}
+
+			// L = [2 0 0; 1 5 0; 3 6 9], L * [1 2 3]^T = [2 11 42]^T
+			MathVector x = { 2, 11, 42 };
+			triangularSolve(LOWER_TRIANGLE, false, 3, 1, tCopy.getData(), tCopy.getRowStride(),
+				tCopy.getColStride(), x.getData(), 1, 3);
+			EXPECT_TRUE(x.isEqualTo({ 1, 2, 3 }));
+
+			// U = [2 4 7; 0 5 8; 0 0 9], U * [1 2 3]^T = [31 34 27]^T
+			x = { 31, 34, 27 };
+			triangularSolve(UPPER_TRIANGLE, false, 3, 1, tCopy.getData(), tCopy.getRowStride(),
+				tCopy.getColStride(), x.getData(), 1, 3);
+			EXPECT_TRUE(x.isEqualTo({ 1, 2, 3 }));
+
+			// Unit diagonal, [1 0 0; 1 1 0; 3 6 1] * [1 2 3]^T = [1 3 18]^T
+			x = { 1, 3, 18 };
+			triangularSolve(LOWER_TRIANGLE, true, 3, 1, tCopy.getData(), tCopy.getRowStride(),
+				tCopy.getColStride(), x.getData(), 1, 3);
+			EXPECT_TRUE(x.isEqualTo({ 1, 2, 3 }));
+		}
+	}
+
+	TEST(TriangularSolveTests, BLOCKED_SOLVE_WITH_MANY_RIGHT_HAND_SIDES)
+	{
+		const unsigned int n = 300, nrhs = 37;
+		for (vector_space_t space : { ROWSPACE, COLUMNSPACE })
+		{
+			MathMatrix t = makeWellConditionedMatrix(n, n, COLUMNSPACE, 1);
+			MathMatrix b = makeWellConditionedMatrix(n, nrhs, space, 2);
+
+			for (triangle_t triangle : { LOWER_TRIANGLE, UPPER_TRIANGLE })
+			{
+				// The triangle on its own, to check the solve against
+				MathMatrix tri(n, n);
+				for (unsigned int r = 0; r < n; ++r)
+				{
+					for (unsigned int c = 0; c < n; ++c)
+					{
+						bool inside = (triangle == LOWER_TRIANGLE) ? (c <= r) : (c >= r);
+						if (inside) tri.setVal(r, c, t.getVal(r, c));
+					}
+				}
+
+				MathMatrix x = b;
+				triangularSolve(triangle, false, n, nrhs, t.getData(), t.getRowStride(),
+					t.getColStride(), x.getData(), x.getRowStride(), x.getColStride());
+				EXPECT_LT(maxResidual(tri, x, b), 1e-10);
+			}
+		}
+	}
+
+	TEST(LUDecompositionTests, SOLVES_A_SMALL_SYSTEM)
+	{
+		// 2x + y - z = 8, -3x - y + 2z = -11, -2x + y + 2z = -3 has the solution (2, 3, -1)
+		MathMatrix a = { {2, 1, -1}, {-3, -1, 2}, {-2, 1, 2} };
+		MathLUDecomposition lu(a);
+
+		ASSERT_TRUE(lu.isFactored());
+		EXPECT_FALSE(lu.isSingular());
+		EXPECT_EQ(lu.getSize(), 3);
+
+		MathVector x = lu.solve(MathVector({ 8, -11, -3 }));
+		ASSERT_EQ(x.getSize(), 3);
+		EXPECT_NEAR(x[0], 2, 1e-12);
+		EXPECT_NEAR(x[1], 3, 1e-12);
+		EXPECT_NEAR(x[2], -1, 1e-12);
+
+		EXPECT_NEAR(lu.determinant(), -1, 1e-12);
+	}
+
+	TEST(LUDecompositionTests, ZERO_ON_THE_DIAGONAL_NEEDS_A_ROW_SWAP)
+	{
+		MathMatrix a = { {0, 1}, {1, 0} };
+		MathLUDecomposition lu(a);
+
+		ASSERT_FALSE(lu.isSingular());
+		EXPECT_EQ(lu.getPivotedRow(0), 1);
+		EXPECT_EQ(lu.getPivotedRow(1), 0);
+		EXPECT_EQ(lu.getPivotedRow(2), 2);
+		EXPECT_EQ(lu.determinant(), -1);
+		EXPECT_TRUE(solve(a, MathVector({ 3, 4 })).isEqualTo({ 4, 3 }));
+	}
+
+	TEST(LUDecompositionTests, FACTORS_RECOMBINE_TO_THE_PERMUTED_MATRIX)
+	{
+		const unsigned int n = 150;
+		MathMatrix a = makeWellConditionedMatrix(n, n, ROWSPACE, 3);
+		MathLUDecomposition lu(a);
+		const MathMatrix& factors = lu.getLU();
+
+		MathMatrix l(n, n), u(n, n);
+		for (unsigned int r = 0; r < n; ++r)
+		{
+			for (unsigned int c = 0; c < n; ++c)
+			{
+				if (c < r) l.setVal(r, c, factors.getVal(r, c));
+				else u.setVal(r, c, factors.getVal(r, c));
+			}
+			l.setVal(r, r, 1.0);
+		}
+
+		MathMatrix product = l * u;
+		double worst = 0.0;
+		for (unsigned int r = 0; r < n; ++r)
+		{
+			for (unsigned int c = 0; c < n; ++c)
+			{
+				// Partial pivoting keeps every multiplier at most 1
+				EXPECT_LE(std::fabs(l.getVal(r, c)), 1.0);
+				worst = std::fmax(worst, std::fabs(product.getVal(r, c) - a.getVal(lu.getPivotedRow(r), c)));
+			}
+		}
+		EXPECT_LT(worst, 1e-10);
+	}
+
+	TEST(LUDecompositionTests, BLOCKED_SOLVE_WITH_MANY_RIGHT_HAND_SIDES_IN_EITHER_SPACE)
+	{
+		const unsigned int n = 301, nrhs = 20;
+		for (vector_space_t aSpace : { ROWSPACE, COLUMNSPACE })
+		{
+			for (vector_space_t bSpace : { ROWSPACE, COLUMNSPACE })
+			{
+				MathMatrix a = makeWellConditionedMatrix(n, n, aSpace, 4);
+				MathMatrix b = makeWellConditionedMatrix(n, nrhs, bSpace, 5);
+
+				MathMatrix x = solve(a, b);
+				ASSERT_EQ(x.getNumRows(), n);
+				ASSERT_EQ(x.getNumCols(), nrhs);
+				EXPECT_LT(maxResidual(a, x, b), 1e-10);
+			}
+		}
+	}
+
+	TEST(LUDecompositionTests, INVERSE_AND_DETERMINANT)
+	{
+		MathMatrix a = { {4, 7}, {2, 6} };
+		EXPECT_NEAR(determinant(a), 10, 1e-12);
+
+		MathMatrix inv = inverse(a);
+		EXPECT_NEAR(inv.getVal(0, 0), 0.6, 1e-12);
+		EXPECT_NEAR(inv.getVal(0, 1), -0.7, 1e-12);
+		EXPECT_NEAR(inv.getVal(1, 0), -0.2, 1e-12);
+		EXPECT_NEAR(inv.getVal(1, 1), 0.4, 1e-12);
+
+		const unsigned int n = 200;
+		MathMatrix big = makeWellConditionedMatrix(n, n, COLUMNSPACE, 6);
+		MathMatrix identity(n, n);
+		for (unsigned int i = 0; i < n; ++i) identity.setVal(i, i, 1.0);
+		EXPECT_LT(maxResidual(big, inverse(big), identity), 1e-10);
+
+		// Swapping two rows flips the sign of the determinant
+		MathMatrix swapped = big;
+		swapped.swapRows(0, n - 1);
+		EXPECT_NEAR(determinant(swapped) / determinant(big), -1.0, 1e-10);
+	}
+
+	TEST(LUDecompositionTests, SINGULAR_AND_BAD_INPUT_FAIL_CLEANLY)
+	{
+		MathMatrix singular = { {1, 2, 3}, {2, 4, 6}, {1, 0, 1} };
+		MathLUDecomposition lu(singular);
+		EXPECT_TRUE(lu.isFactored());
+		EXPECT_TRUE(lu.isSingular());
+		EXPECT_EQ(lu.determinant(), 0);
+		EXPECT_EQ(lu.solve(MathVector({ 1, 2, 3 })).getSize(), 0);
+		EXPECT_EQ(lu.inverse().getNumRows(), 0);
+
+		MathMatrix notSquare = { {1, 2, 3}, {4, 5, 6} };
+		EXPECT_FALSE(lu.factor(notSquare));
+		EXPECT_FALSE(lu.isFactored());
+		EXPECT_TRUE(std::isnan(determinant(notSquare)));
+		EXPECT_FALSE(MathLUDecomposition().factor(MathMatrix()));
+
+		MathMatrix a = { {2, 1}, {1, 3} };
+		EXPECT_EQ(solve(a, MathVector({ 1, 2, 3 })).getSize(), 0);
+		EXPECT_EQ(solve(a, MathMatrix(3, 1)).getNumRows(), 0);
+	}
+}
@@ -0,0 +1,126 @@
+#include "pch.h"
+
+#include "../MatrixLibrary/MathMatrixBatch.h"
+#include "TestHelpers.h"
+#include <cmath>
+
+namespace MATRIX_BATCH_TESTS {
+
+	// A well conditioned matrix that is different for every seed
+	template <unsigned int R, unsigned int C>
+	static MathFixedMatrix<R, C> makeFixedMatrix(unsigned int seed)
+	{
+		MathFixedMatrix<R, C> m;
+		for (unsigned int r = 0; r < R; ++r)
+		{
+			for (unsigned int c = 0; c < C; ++c)
+			{
+				m(r, c) = (double)((r * 7 + c * 3 + seed * 11) % 13) / 13.0 + ((r == c) ? R : 0.0);
+			}
+		}
+		return m;
+	}
+
+	template <unsigned int N>
+	static void expectBatchMatchesFixedMatrices(size_t size)
+	{
+		MathMatrixBatch<N, N> a(size), b(size);
+		MathVectorBatch<N> x(size);
+		for (size_t i = 0; i < size; ++i)
+		{
+			a.set(i, makeFixedMatrix<N, N>((unsigned int)i));
+			b.set(i, makeFixedMatrix<N, N>((unsigned int)i + 100));
+			x.set(i, makeFixedMatrix<N, 1>((unsigned int)i + 200));
+		}
+
+		MathMatrixBatch<N, N> product = a * b;
+		MathVectorBatch<N> ax = a * x;
+		MathMatrixBatch<N, N> inv = inverse(a);
+		ASSERT_EQ(product.getSize(), size);
+		ASSERT_EQ(inv.getSize(), size);
+
+		for (size_t i = 0; i < size; ++i)
+		{
+			EXPECT_LT(maxDifference(product.get(i), a.get(i) * b.get(i)), 1e-13);
+			EXPECT_LT(maxDifference(ax.get(i), a.get(i) * x.get(i)), 1e-13);
+			EXPECT_LT(maxDifference(inv.get(i), inverse(a.get(i))), 1e-13);
+		}
+	}
+
+	TEST(MatrixBatchTests, PRODUCTS_AND_INVERSES_MATCH_FIXED_MATRICES)
+	{
+		forEachSupportedInstructionSet([] {
+			// Sizes that leave the last group partly full
+			expectBatchMatchesFixedMatrices<2>(5);
+			expectBatchMatchesFixedMatrices<3>(21);
+			expectBatchMatchesFixedMatrices<4>(16);
+			expectBatchMatchesFixedMatrices<6>(43);
+		});
+	}
+
+	TEST(MatrixBatchTests, ELEMENTS_ARE_INTERLEAVED_ACROSS_THE_BATCH)
+	{
+		MathMatrixBatch<2, 3> batch(10);
+		EXPECT_EQ(batch.getNumGroups(), 2u);
+		batch(9, 1, 2) = 5.0;
+		batch(2, 0, 1) = 7.0;
+
+		const unsigned int lanes = MathMatrixBatch<2, 3>::LANES;
+		EXPECT_EQ(batch.getData()[1 * 2 * 3 * lanes + (1 * 3 + 2) * lanes + 1], 5.0);
+		EXPECT_EQ(batch.getData()[1 * lanes + 2], 7.0);
+		EXPECT_EQ(batch.get(9)(1, 2), 5.0);
+		EXPECT_EQ(batch.get(8)(1, 2), 0.0);
+	}
+
+	TEST(MatrixBatchTests, SINGULAR_MATRICES_ONLY_SPOIL_THEIR_OWN_INVERSE)
+	{
+		MathMatrixBatch<3, 3> a(11);
+		for (size_t i = 0; i < a.getSize(); ++i)
+		{
+			a.set(i, makeFixedMatrix<3, 3>((unsigned int)i));
+		}
+		a.set(4, { {1, 2, 3}, {2, 4, 6}, {0, 1, 0} });
+
+		// Needs a row swap in the first column
+		MathFixedMatrix3 pivoted = { {0, 1, 0}, {0, 0, 2}, {3, 0, 0} };
+		a.set(5, pivoted);
+
+		forEachSupportedInstructionSet([&] {
+			MathMatrixBatch<3, 3> inv = inverse(a);
+			EXPECT_TRUE(std::isnan(inv(4, 0, 0)));
+			EXPECT_TRUE(std::isnan(inv(4, 2, 2)));
+			EXPECT_LT(maxDifference(inv.get(5) * pivoted, MathFixedMatrix3::identity()), 1e-15);
+			for (size_t i : { 0u, 3u, 6u, 10u })
+			{
+				EXPECT_LT(maxDifference(inv.get(i), inverse(a.get(i))), 1e-13);
+			}
+
+			// The padding of the last group is still zero
+			const unsigned int lanes = MathMatrixBatch<3, 3>::LANES;
+			EXPECT_EQ(inv.getData()[inv.getNumGroups() * 9 * lanes - 1], 0.0);
+		});
+	}
+
+	TEST(MatrixBatchTests, SIZE_MISMATCH_AND_ALIASING)
+	{
+		MathMatrixBatch<2, 2> a(3), b(4);
+		for (size_t i = 0; i < 3; ++i)
+		{
+			a.set(i, { {1, 1}, {0, 1} });
+		}
+
+		MathMatrixBatch<2, 2> c(7);
+		EXPECT_FALSE(multiply(a, b, c));
+		EXPECT_EQ(c.getSize(), 7u);
+		EXPECT_EQ((a * b).getSize(), 0u);
+
+		// c may be one of the operands
+		EXPECT_TRUE(multiply(a, a, a));
+		EXPECT_EQ(a.get(2), MathFixedMatrix2({ {1, 2}, {0, 1} }));
+
+		MathMatrixBatch<2, 2> copy = a;
+		MathMatrixBatch<2, 2> moved = std::move(copy);
+		EXPECT_EQ(moved.get(1), a.get(1));
+		EXPECT_EQ(copy.getSize(), 0u);
+	}
+}
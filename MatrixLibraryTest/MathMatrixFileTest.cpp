@@ -0,0 +1,216 @@
+#include "pch.h"
+
+#include "../MatrixLibrary/MathMatrixFile.h"
+#include "TestHelpers.h"
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+namespace MATRIX_FILE_TESTS {
+
+	// Removes the file when the test ends, however it ends
+	struct TemporaryFile
+	{
+		explicit TemporaryFile(const char* name) : path(name) {}
+		~TemporaryFile() { std::remove(path); }
+		const char* path;
+	};
+
+	template <typename T, typename Matrix>
+	static bool sameElements(const MathMatrixT<T>& expected, const Matrix& actual)
+	{
+		if (expected.getNumRows() != actual.getNumRows() || expected.getNumCols() != actual.getNumCols())
+		{
+			return false;
+		}
+		for (unsigned int r = 0; r < expected.getNumRows(); ++r)
+		{
+			for (unsigned int c = 0; c < expected.getNumCols(); ++c)
+			{
+				if (expected.getVal(r, c) != actual.getVal(r, c)) return false;
+			}
+		}
+		return true;
+	}
+
+	template <typename T>
+	static void expectRoundTrip(vector_space_t space, const char* path)
+	{
+		MathMatrixT<T> m = makeRandomMatrix<T>(37, 21, space, 1);
+		ASSERT_TRUE(saveMatrix(path, m.getView()));
+
+		MathMatrixT<T> loaded;
+		ASSERT_TRUE(loadMatrix(path, loaded));
+		EXPECT_TRUE(sameElements(m, loaded));
+		EXPECT_EQ(loaded.getSpaceToRepresentMatrixAs(), space);
+
+		MathMappedMatrixT<T> mapped;
+		ASSERT_TRUE(mapped.open(path));
+		EXPECT_TRUE(sameElements(m, mapped));
+		EXPECT_TRUE(sameElements(m, mapped.getView()));
+		EXPECT_EQ(mapped.getSpaceToRepresentMatrixAs(), space);
+
+		// Every vector of the payload starts on a cache line
+		size_t leadingDimension = (space == ROWSPACE) ? mapped.getRowStride() : mapped.getColStride();
+		EXPECT_EQ(reinterpret_cast<uintptr_t>(mapped.getData()) % MATH_BUFFER_ALIGNMENT, 0u);
+		EXPECT_EQ(leadingDimension * sizeof(T) % MATH_BUFFER_ALIGNMENT, 0u);
+	}
+
+	TEST(MatrixFileTests, ROUND_TRIPS_BOTH_SPACES_AND_ELEMENT_TYPES)
+	{
+		TemporaryFile file("MathMatrixFileTest_roundTrip.mat");
+		expectRoundTrip<double>(COLUMNSPACE, file.path);
+		expectRoundTrip<double>(ROWSPACE, file.path);
+		expectRoundTrip<float>(COLUMNSPACE, file.path);
+		expectRoundTrip<float>(ROWSPACE, file.path);
+	}
+
+	TEST(MatrixFileTests, SAVES_ONLY_THE_ELEMENTS_OF_A_VIEW)
+	{
+		TemporaryFile file("MathMatrixFileTest_view.mat");
+		MathMatrix m = makeRandomMatrix<double>(30, 40, ROWSPACE, 2);
+		MathMatrixView block = m.getView(3, 5, 10, 12);
+		block.transpose();
+		ASSERT_TRUE(saveMatrix(file.path, block));
+
+		MathMappedMatrix mapped;
+		ASSERT_TRUE(mapped.open(file.path));
+		ASSERT_EQ(mapped.getNumRows(), 12u);
+		ASSERT_EQ(mapped.getNumCols(), 10u);
+		EXPECT_EQ(mapped.getSpaceToRepresentMatrixAs(), COLUMNSPACE);
+		EXPECT_EQ(mapped.getVal(0, 0), m.getVal(3, 5));
+		EXPECT_EQ(mapped.getVal(11, 9), m.getVal(12, 16));
+
+		// An empty matrix is a valid file too
+		ASSERT_TRUE(saveMatrix(file.path, MathMatrix().getView()));
+		MathMatrix loaded = makeRandomMatrix<double>(2, 2, COLUMNSPACE, 3);
+		EXPECT_TRUE(loadMatrix(file.path, loaded));
+		EXPECT_EQ(loaded.getNumRows(), 0u);
+	}
+
+	TEST(MatrixFileTests, SAVING_OVER_A_MAPPED_FILE_KEEPS_THE_MAPPING)
+	{
+		TemporaryFile file("MathMatrixFileTest_remap.mat");
+		MathMatrix m = makeRandomMatrix<double>(50, 30, COLUMNSPACE, 9);
+		ASSERT_TRUE(saveMatrix(file.path, m.getView()));
+
+		MathMappedMatrix mapped;
+		ASSERT_TRUE(mapped.open(file.path));
+#ifdef _WIN32
+		// Windows does not replace a mapped file, the save fails and the file is unchanged
+		EXPECT_FALSE(saveMatrix(file.path, makeRandomMatrix<double>(5, 5, ROWSPACE, 10).getView()));
+		EXPECT_TRUE(sameElements(m, mapped));
+#else
+		// The mapping still reads the old file while its own elements are saved over it
+		ASSERT_TRUE(saveMatrix(file.path, mapped.getView()));
+		EXPECT_TRUE(sameElements(m, mapped));
+
+		MathMatrix other = makeRandomMatrix<double>(5, 5, ROWSPACE, 10);
+		ASSERT_TRUE(saveMatrix(file.path, other.getView()));
+		EXPECT_TRUE(sameElements(m, mapped));
+
+		MathMappedMatrix remapped;
+		ASSERT_TRUE(remapped.open(file.path));
+		EXPECT_TRUE(sameElements(other, remapped));
+#endif
+	}
+
+	TEST(MatrixFileTests, REJECTS_FILES_IT_CANNOT_READ)
+	{
+		TemporaryFile file("MathMatrixFileTest_reject.mat");
+		MathMatrix unchanged = makeRandomMatrix<double>(2, 3, COLUMNSPACE, 4);
+		MathMatrix m = unchanged;
+		MathMappedMatrix mapped;
+
+		EXPECT_FALSE(loadMatrix("MathMatrixFileTest_missing.mat", m));
+		EXPECT_FALSE(mapped.open("MathMatrixFileTest_missing.mat"));
+
+		// The other element type
+		ASSERT_TRUE(saveMatrix(file.path, makeRandomMatrix<float>(4, 4, COLUMNSPACE, 5).getView()));
+		EXPECT_FALSE(loadMatrix(file.path, m));
+		EXPECT_FALSE(mapped.open(file.path));
+		MathMappedMatrixF mappedFloat;
+		EXPECT_TRUE(mappedFloat.open(file.path));
+
+		// A newer version
+		ASSERT_TRUE(saveMatrix(file.path, makeRandomMatrix<double>(4, 4, COLUMNSPACE, 6).getView()));
+		{
+			std::fstream stream(file.path, std::ios::binary | std::ios::in | std::ios::out);
+			uint32_t version = MATH_MATRIX_FILE_VERSION + 1;
+			stream.seekp(8);
+			stream.write(reinterpret_cast<const char*>(&version), sizeof(version));
+		}
+		EXPECT_FALSE(loadMatrix(file.path, m));
+		EXPECT_FALSE(mapped.open(file.path));
+
+		// A payload cut short
+		ASSERT_TRUE(saveMatrix(file.path, makeRandomMatrix<double>(40, 4, COLUMNSPACE, 7).getView()));
+		std::vector<char> bytes;
+		{
+			std::ifstream stream(file.path, std::ios::binary);
+			bytes.assign(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+		}
+		{
+			std::ofstream stream(file.path, std::ios::binary | std::ios::trunc);
+			stream.write(bytes.data(), bytes.size() - 8);
+		}
+		EXPECT_FALSE(loadMatrix(file.path, m));
+		EXPECT_FALSE(mapped.open(file.path));
+		EXPECT_FALSE(mapped.isOpen());
+
+		EXPECT_TRUE(sameElements(unchanged, m));
+	}
+
+	TEST(MatrixFileTests, REJECTS_HEADERS_WHOSE_PAYLOAD_SIZE_OVERFLOWS)
+	{
+		// 2^30 columns of 2^31 doubles are 2^64 bytes, which wraps around to a payload of 0
+		TemporaryFile file("MathMatrixFileTest_overflow.mat");
+		MathMatrixFileHeader header;
+		ASSERT_TRUE(makeMatrixFileHeader<double>(0, 0, COLUMNSPACE, header));
+		header.numRows = 1u << 31;
+		header.numCols = 1u << 30;
+		header.leadingDimension = 1u << 31;
+		header.payloadSize = 0;
+		{
+			std::ofstream stream(file.path, std::ios::binary | std::ios::trunc);
+			stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		}
+
+		{
+			std::ifstream stream(file.path, std::ios::binary);
+			MathMatrixFileHeader read;
+			EXPECT_FALSE(readMatrixFileHeader<double>(stream, read));
+		}
+		MathMatrix m;
+		EXPECT_FALSE(loadMatrix(file.path, m));
+		MathMappedMatrix mapped;
+		EXPECT_FALSE(mapped.open(file.path));
+		EXPECT_FALSE(mapped.isOpen());
+	}
+
+	TEST(MatrixFileTests, MAPPED_MATRICES_MOVE_AND_CLOSE)
+	{
+		TemporaryFile file("MathMatrixFileTest_move.mat");
+		MathMatrix m = makeRandomMatrix<double>(5, 6, COLUMNSPACE, 8);
+		ASSERT_TRUE(saveMatrix(file.path, m.getView()));
+
+		MathMappedMatrix first;
+		ASSERT_TRUE(first.open(file.path));
+		MathMappedMatrix second = std::move(first);
+		EXPECT_FALSE(first.isOpen());
+		ASSERT_TRUE(second.isOpen());
+		EXPECT_TRUE(sameElements(m, second));
+
+		// The mapped matrix is an operand like any other view
+		MathMatrix copy(second.getView());
+		EXPECT_TRUE(sameElements(m, copy));
+
+		second.close();
+		EXPECT_FALSE(second.isOpen());
+		EXPECT_EQ(second.getNumRows(), 0u);
+		EXPECT_EQ(second.getData(), nullptr);
+	}
+}
@@ -0,0 +1,433 @@
+#include "pch.h"
+
+#include "../MatrixLibrary/MathMatrix.h"
+#include "../MatrixLibrary/MathMatrixMultiply.h"
+#include "../MatrixLibrary/MathThreadPool.h"
+#include "TestHelpers.h"
+#include <cmath>
+#include <ostream>
+
+namespace MATRIX_MULTIPLY_TESTS {
+
+	// Small integers, so products are exact enough to compare
+	static MathMatrix makeIntegerMatrix(unsigned int rows, unsigned int cols, vector_space_t space,
+		unsigned int seed)
+	{
+		return makeMatrix(rows, cols, space, [seed](unsigned int r, unsigned int c)
+		{
+			return (double)((r * 7 + c * 13 + seed * 31) % 17) - 8.0;
+		});
+	}
+
+	static double referenceProductVal(const MathMatrix& a, const MathMatrix& b, unsigned int r,
+		unsigned int c)
+	{
+		double sum = 0.0;
+		for (unsigned int p = 0; p < a.getNumCols(); ++p)
+		{
+			sum += a.getVal(r, p) * b.getVal(p, c);
+		}
+		return sum;
+	}
+
+	TEST(GemmTests, OPERATOR_STAR_MATCHES_REFERENCE_FOR_EVERY_COMBINATION_OF_SPACES)
+	{
+		// Sizes that are not multiples of any blocking parameter and larger than one block
+		const unsigned int m = 131, n = 70, k = 301;
+		vector_space_t spaces[] = { ROWSPACE, COLUMNSPACE };
+
+		for (vector_space_t aSpace : spaces)
+		{
+			for (vector_space_t bSpace : spaces)
+			{
+				MathMatrix a = makeIntegerMatrix(m, k, aSpace, 1);
+				MathMatrix b = makeIntegerMatrix(k, n, bSpace, 2);
+
+				MathMatrix c = a * b;
+				ASSERT_EQ(c.getNumRows(), m);
+				ASSERT_EQ(c.getNumCols(), n);
+
+				for (unsigned int r = 0; r < m; ++r)
+				{
+					for (unsigned int col = 0; col < n; ++col)
+					{
+						ASSERT_DOUBLE_EQ(c.getVal(r, col), referenceProductVal(a, b, r, col));
+					}
+				}
+			}
+		}
+	}
+
+	TEST(GemmTests, TRANSPOSED_PRODUCTS_MATCH_REFERENCE_FOR_EVERY_LAYOUT)
+	{
+		// The first sizes run the small product, the last the blocked one
+		const unsigned int sizes[][3] = { { 7, 5, 9 }, { 31, 17, 23 }, { 97, 66, 130 } };
+		vector_space_t spaces[] = { ROWSPACE, COLUMNSPACE };
+
+		for (const unsigned int* size : sizes)
+		{
+			unsigned int m = size[0], n = size[1], k = size[2];
+			for (int flags = 0; flags < 4; ++flags)
+			{
+				bool transposeA = (flags & 1) != 0;
+				bool transposeB = (flags & 2) != 0;
+
+				for (vector_space_t aSpace : spaces)
+				{
+					for (vector_space_t bSpace : spaces)
+					{
+						MathMatrix a = transposeA ? makeIntegerMatrix(k, m, aSpace, 1) : makeIntegerMatrix(m, k, aSpace, 1);
+						MathMatrix b = transposeB ? makeIntegerMatrix(n, k, bSpace, 2) : makeIntegerMatrix(k, n, bSpace, 2);
+
+						MathMatrix c = multiply(a, b, transposeA, transposeB);
+						ASSERT_EQ(c.getNumRows(), m);
+						ASSERT_EQ(c.getNumCols(), n);
+
+						for (unsigned int r = 0; r < m; ++r)
+						{
+							for (unsigned int col = 0; col < n; ++col)
+							{
+								double expected = 0.0;
+								for (unsigned int p = 0; p < k; ++p)
+								{
+									expected += (transposeA ? a.getVal(p, r) : a.getVal(r, p)) *
+										(transposeB ? b.getVal(col, p) : b.getVal(p, col));
+								}
+								ASSERT_DOUBLE_EQ(c.getVal(r, col), expected);
+							}
+						}
+					}
+				}
+			}
+		}
+
+		// The inner sizes must still match after transposing
+		EXPECT_EQ(multiply(makeIntegerMatrix(3, 4, ROWSPACE, 1), makeIntegerMatrix(3, 4, ROWSPACE, 1), false, false).getNumRows(), 0u);
+		EXPECT_EQ(multiply(makeIntegerMatrix(3, 4, ROWSPACE, 1), makeIntegerMatrix(3, 4, ROWSPACE, 1), true, false).getNumRows(), 4u);
+	}
+
+	TEST(GemmTests, SMALL_PRODUCTS_APPLY_ALPHA_AND_BETA_INTO_EVERY_LAYOUT_OF_C)
+	{
+		const unsigned int m = 13, n = 11, k = 9;
+		vector_space_t spaces[] = { ROWSPACE, COLUMNSPACE };
+
+		for (vector_space_t aSpace : spaces)
+		{
+			for (vector_space_t bSpace : spaces)
+			{
+				for (vector_space_t cSpace : spaces)
+				{
+					MathMatrix a = makeIntegerMatrix(m, k, aSpace, 3);
+					MathMatrix b = makeIntegerMatrix(k, n, bSpace, 4);
+					MathMatrix c = makeIntegerMatrix(m, n, cSpace, 5);
+					MathMatrix cBefore = c;
+
+					ASSERT_TRUE(multiply(a.getView(), b.getView(), c.getView(), 0.5, -2.0));
+					for (unsigned int r = 0; r < m; ++r)
+					{
+						for (unsigned int col = 0; col < n; ++col)
+						{
+							ASSERT_DOUBLE_EQ(c.getVal(r, col),
+								0.5 * referenceProductVal(a, b, r, col) - 2.0 * cBefore.getVal(r, col));
+						}
+					}
+				}
+			}
+		}
+	}
+
+	TEST(GemmTests, GEMM_APPLIES_ALPHA_AND_BETA)
+	{
+		const unsigned int m = 45, n = 38, k = 60;
+		MathMatrix a = makeIntegerMatrix(m, k, COLUMNSPACE, 3);
+		MathMatrix b = makeIntegerMatrix(k, n, ROWSPACE, 4);
+		MathMatrix c = makeIntegerMatrix(m, n, ROWSPACE, 5);
+		MathMatrix cBefore = c;
+
+		gemm(m, n, k, 2.0, a.getData(), a.getRowStride(), a.getColStride(),
+			b.getData(), b.getRowStride(), b.getColStride(),
+			-1.0, c.getData(), c.getRowStride(), c.getColStride());
+
+		for (unsigned int r = 0; r < m; ++r)
+		{
+			for (unsigned int col = 0; col < n; ++col)
+			{
+				ASSERT_DOUBLE_EQ(c.getVal(r, col),
+					2.0 * referenceProductVal(a, b, r, col) - cBefore.getVal(r, col));
+			}
+		}
+	}
+
+	TEST(GemmTests, SWAPPED_STRIDES_MULTIPLY_BY_THE_TRANSPOSE)
+	{
+		MathMatrix a = { {1, 2}, {3, 4}, {5, 6} };
+		MathMatrix b = { {1, 0, 2}, {0, 1, 3}, {1, 1, 1} };
+		MathMatrix c(2, 3);
+
+		// c = a^T * b
+		gemm(2, 3, 3, 1.0, a.getData(), a.getColStride(), a.getRowStride(),
+			b.getData(), b.getRowStride(), b.getColStride(),
+			0.0, c.getData(), c.getRowStride(), c.getColStride());
+
+		EXPECT_TRUE(c.equals({ {6, 8, 16}, {8, 10, 22} }));
+	}
+
+	TEST(GemmTests, PARALLEL_GEMM_MATCHES_REFERENCE)
+	{
+		MathThreadPool& pool = MathThreadPool::getInstance();
+		unsigned int threadsBefore = pool.getNumThreads();
+		size_t thresholdBefore = getGemmParallelThreshold();
+
+		pool.setNumThreads(4);
+		setGemmParallelThreshold(0);
+
+		const unsigned int m = 157, n = 203, k = 97;
+		MathMatrix a = makeIntegerMatrix(m, k, ROWSPACE, 6);
+		MathMatrix b = makeIntegerMatrix(k, n, COLUMNSPACE, 7);
+		MathMatrix c = a * b;
+
+		pool.setNumThreads(threadsBefore);
+		setGemmParallelThreshold(thresholdBefore);
+
+		for (unsigned int r = 0; r < m; ++r)
+		{
+			for (unsigned int col = 0; col < n; ++col)
+			{
+				ASSERT_DOUBLE_EQ(c.getVal(r, col), referenceProductVal(a, b, r, col));
+			}
+		}
+	}
+
+	TEST(GemmTests, FLOAT_PRODUCT_MATCHES_DOUBLE_PRODUCT)
+	{
+		MathThreadPool& pool = MathThreadPool::getInstance();
+		unsigned int threadsBefore = pool.getNumThreads();
+		size_t thresholdBefore = getGemmParallelThreshold();
+
+		pool.setNumThreads(4);
+		setGemmParallelThreshold(0);
+
+		// The elements and every partial sum are small integers so float is exact too
+		const unsigned int m = 131, n = 70, k = 301;
+		vector_space_t spaces[] = { ROWSPACE, COLUMNSPACE };
+
+		for (vector_space_t aSpace : spaces)
+		{
+			for (vector_space_t bSpace : spaces)
+			{
+				MathMatrix a = makeIntegerMatrix(m, k, aSpace, 8);
+				MathMatrix b = makeIntegerMatrix(k, n, bSpace, 9);
+				MathMatrixF aF(a.getView());
+				MathMatrixF bF(b.getView());
+				ASSERT_EQ(aF.getSpaceToRepresentMatrixAs(), aSpace);
+
+				MathMatrix c = a * b;
+				MathMatrixF cF = aF * bF;
+				ASSERT_EQ(cF.getNumRows(), m);
+				ASSERT_EQ(cF.getNumCols(), n);
+
+				for (unsigned int r = 0; r < m; ++r)
+				{
+					for (unsigned int col = 0; col < n; ++col)
+					{
+						ASSERT_EQ(cF.getVal(r, col), (float)c.getVal(r, col));
+					}
+				}
+			}
+		}
+
+		pool.setNumThreads(threadsBefore);
+		setGemmParallelThreshold(thresholdBefore);
+	}
+
+	TEST(GemmTests, FLOAT_MATRICES_SUPPORT_THE_DOUBLE_INTERFACE)
+	{
+		MathMatrixF a = { {1, 2}, {3, 4}, {5, 6} };
+		MathMatrixF b = { {1, 0, -1}, {0.5f, 2, 1} };
+
+		MathMatrixF c = a * b;
+		EXPECT_TRUE(c.equals({ {2, 4, 1}, {5, 8, 1}, {8, 12, 1} }));
+
+		// Views, row operations and iterators all work on floats
+		EXPECT_TRUE(multiply(a.getView(), b.getView(), c.getView(), 2.0f, -1.0f));
+		EXPECT_TRUE(c.equals({ {2, 4, 1}, {5, 8, 1}, {8, 12, 1} }));
+		EXPECT_TRUE(c.addMultipleOfRow(0, 1, -2));
+		EXPECT_TRUE(c.equals({ {-8, -12, -1}, {5, 8, 1}, {8, 12, 1} }));
+		EXPECT_EQ(dotProduct(c.rowBegin(1), c.rowEnd(1), c.rowBegin(2), c.rowEnd(2)), 137.0f);
+		EXPECT_EQ(c.getView().getCol(2).dotProduct(c.getView().getCol(0)), 21.0f);
+		EXPECT_TRUE(c.addRow(MathVectorF({ 1, 1, 1 })));
+		EXPECT_EQ(c.getNumRows(), 4);
+		EXPECT_TRUE(std::isnan(c.getVal(4, 0)));
+
+		// Converting back to double is exact
+		MathMatrix d(c.getView());
+		EXPECT_TRUE(d.equals({ {-8, -12, -1}, {5, 8, 1}, {8, 12, 1}, {1, 1, 1} }));
+	}
+
+	static MathVector makeVector(unsigned int size, unsigned int seed)
+	{
+		MathVector v(size);
+		for (unsigned int i = 0; i < size; ++i)
+		{
+			v[i] = (double)((i * 5 + seed * 11) % 13) - 6.0;
+		}
+		return v;
+	}
+
+	// Checks y = alpha * op(a) * x + beta * yBefore element by element
+	static void expectGemvMatchesReference(const MathMatrix& a, bool transposeA, const MathVector& x,
+		double alpha, double beta, const MathVector& yBefore, const MathVector& y)
+	{
+		unsigned int rows = transposeA ? a.getNumCols() : a.getNumRows();
+		ASSERT_EQ(y.getSize(), rows);
+		for (unsigned int i = 0; i < rows; ++i)
+		{
+			double sum = 0.0;
+			for (unsigned int j = 0; j < x.getSize(); ++j)
+			{
+				sum += (transposeA ? a.getVal(j, i) : a.getVal(i, j)) * x[j];
+			}
+			double expected = alpha * sum + ((beta == 0.0) ? 0.0 : beta * yBefore[i]);
+			ASSERT_DOUBLE_EQ(y[i], expected);
+		}
+	}
+
+	TEST(GemvTests, GEMV_MATCHES_REFERENCE_FOR_BOTH_SPACES_AND_TRANSPOSE)
+	{
+		const unsigned int m = 67, n = 45;
+		vector_space_t spaces[] = { ROWSPACE, COLUMNSPACE };
+
+		for (vector_space_t space : spaces)
+		{
+			MathMatrix a = makeIntegerMatrix(m, n, space, 10);
+			for (bool transposeA : { false, true })
+			{
+				MathVector x = makeVector(transposeA ? m : n, 1);
+				MathVector yBefore = makeVector(transposeA ? n : m, 2);
+
+				MathVector y = yBefore;
+				ASSERT_TRUE(multiply(a.getView(), x, y, 2.0, -0.5, transposeA));
+				expectGemvMatchesReference(a, transposeA, x, 2.0, -0.5, yBefore, y);
+
+				y = yBefore;
+				ASSERT_TRUE(multiply(a.getView(), x, y, 1.0, 1.0, transposeA));
+				expectGemvMatchesReference(a, transposeA, x, 1.0, 1.0, yBefore, y);
+
+				MathVector product = transposeA ? transposeMultiply(a, x) : a * x;
+				expectGemvMatchesReference(a, transposeA, x, 1.0, 0.0, yBefore, product);
+			}
+		}
+
+		// A block of a matrix is neither contiguous nor starts at the beginning of the buffer
+		MathMatrix big = makeIntegerMatrix(m, n, COLUMNSPACE, 11);
+		MathMatrixView block = big.getView(3, 5, 20, 30);
+		MathMatrix blockCopy(block);
+		MathVector x = makeVector(30, 3);
+		MathVector y;
+		ASSERT_TRUE(multiply(block, x, y));
+		expectGemvMatchesReference(blockCopy, false, x, 1.0, 0.0, y, y);
+	}
+
+	TEST(GemvTests, GEMV_RESIZES_Y_ONLY_WHEN_BETA_IS_ZERO)
+	{
+		MathMatrix a = { {1, 2, 3}, {4, 5, 6} };
+		MathVector x = { 1, 1, 1 };
+
+		MathVector y = { 100, 100, 100, 100 };
+		EXPECT_FALSE(multiply(a.getView(), x, y, 1.0, 1.0));
+		EXPECT_EQ(y.getSize(), 4u);
+		EXPECT_DOUBLE_EQ(y[0], 100.0);
+
+		EXPECT_TRUE(multiply(a.getView(), x, y));
+		ASSERT_EQ(y.getSize(), 2u);
+		EXPECT_DOUBLE_EQ(y[0], 6.0);
+		EXPECT_DOUBLE_EQ(y[1], 15.0);
+
+		// x of the wrong size, or y being x, changes nothing
+		MathVector shortX = { 1, 1 };
+		EXPECT_FALSE(multiply(a.getView(), shortX, y));
+		EXPECT_FALSE(multiply(a.getView(), shortX, shortX, 1.0, 0.0, true));
+		EXPECT_DOUBLE_EQ(y[1], 15.0);
+		EXPECT_EQ((a * shortX).getSize(), 0u);
+
+		MathVector t = transposeMultiply(a, shortX);
+		ASSERT_EQ(t.getSize(), 3u);
+		EXPECT_DOUBLE_EQ(t[2], 9.0);
+
+		MathMatrixF aF = { {1, 2}, {3, 4} };
+		MathVectorF xF = { 1, -1 };
+		MathVectorF yF = aF * xF;
+		ASSERT_EQ(yF.getSize(), 2u);
+		EXPECT_EQ(yF[0], -1.0f);
+		EXPECT_EQ(yF[1], -1.0f);
+	}
+
+	TEST(GemvTests, PARALLEL_GEMV_MATCHES_REFERENCE)
+	{
+		MathThreadPool& pool = MathThreadPool::getInstance();
+		unsigned int threadsBefore = pool.getNumThreads();
+		pool.setNumThreads(4);
+
+		// Big enough to be split between the threads, with rows left over for the last task
+		const unsigned int m = 1003, n = 517;
+		vector_space_t spaces[] = { ROWSPACE, COLUMNSPACE };
+
+		for (vector_space_t space : spaces)
+		{
+			MathMatrix a = makeIntegerMatrix(m, n, space, 12);
+			MathVector x = makeVector(n, 4);
+			MathVector yBefore = makeVector(m, 5);
+			MathVector y = yBefore;
+			ASSERT_TRUE(multiply(a.getView(), x, y, 3.0, 2.0));
+			expectGemvMatchesReference(a, false, x, 3.0, 2.0, yBefore, y);
+		}
+
+		pool.setNumThreads(threadsBefore);
+	}
+
+	TEST(GemvTests, GEMM_WITH_ONE_ROW_OR_COLUMN_OF_C_MATCHES_REFERENCE)
+	{
+		const unsigned int size = 83, k = 59;
+		vector_space_t spaces[] = { ROWSPACE, COLUMNSPACE };
+
+		for (vector_space_t aSpace : spaces)
+		{
+			for (vector_space_t bSpace : spaces)
+			{
+				// One column of C, then one row of C
+				MathMatrix a = makeIntegerMatrix(size, k, aSpace, 13);
+				MathMatrix b = makeIntegerMatrix(k, 1, bSpace, 14);
+				MathMatrix c = a * b;
+				for (unsigned int r = 0; r < size; ++r)
+				{
+					ASSERT_DOUBLE_EQ(c.getVal(r, 0), referenceProductVal(a, b, r, 0));
+				}
+
+				MathMatrix rowA = makeIntegerMatrix(1, k, aSpace, 15);
+				MathMatrix rowB = makeIntegerMatrix(k, size, bSpace, 16);
+				MathMatrix rowC = rowA * rowB;
+				for (unsigned int col = 0; col < size; ++col)
+				{
+					ASSERT_DOUBLE_EQ(rowC.getVal(0, col), referenceProductVal(rowA, rowB, 0, col));
+				}
+			}
+		}
+
+		// A strided x and y, taken from a row of a COLUMNSPACE matrix, with alpha and beta
+		MathMatrix a = makeIntegerMatrix(4, 3, ROWSPACE, 17);
+		MathMatrix x = makeIntegerMatrix(3, 1, COLUMNSPACE, 18);
+		MathMatrix c = makeIntegerMatrix(2, 4, COLUMNSPACE, 19);
+		MathMatrix cBefore = c;
+		x.transpose();
+		MathMatrixView aTransposed = a.getView();
+		aTransposed.transpose();
+		ASSERT_TRUE(multiply(x.getView(), aTransposed, c.getView(1, 0, 1, 4), 2.0, 1.0));
+		for (unsigned int col = 0; col < 4; ++col)
+		{
+			double sum = 0.0;
+			for (unsigned int p = 0; p < 3; ++p) sum += x.getVal(0, p) * a.getVal(col, p);
+			ASSERT_DOUBLE_EQ(c.getVal(1, col), 2.0 * sum + cBefore.getVal(1, col));
+			ASSERT_DOUBLE_EQ(c.getVal(0, col), cBefore.getVal(0, col));
+		}
+	}
+}
@@ -1,7 +1,13 @@
 #include "pch.h"
 
 #include "../MatrixLibrary/MathMatrix.h"
+#include <cstdint>
 #include <ostream>
+#include <algorithm>
+#include <numeric>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 namespace MATRIX_LIBRARY_TESTS {
 	;
@@ -33,6 +39,69 @@ namespace MATRIX_LIBRARY_TESTS {
 
 	}
 
+	TEST(AddingRowColumnsTest, SUCCESSFULLY_ADDS_ROWS_AND_COLUMNS_IN_BOTH_SPACES)
+	{
+		MathMatrix colSpace = { {1, 2}, {3, 4} };
+		MathMatrix rowSpace = { {1, 3}, {2, 4} };
+		rowSpace.transpose();
+
+		for (int i = 0; i < 5; ++i)
+		{
+			EXPECT_TRUE(colSpace.addRow({ 5.0 + i, 6.0 + i }));
+			EXPECT_TRUE(rowSpace.addRow({ 5.0 + i, 6.0 + i }));
+		}
+		EXPECT_TRUE(colSpace.addCol({ 9, 9, 9, 9, 9, 9, 9 }));
+		EXPECT_TRUE(rowSpace.addCol({ 9, 9, 9, 9, 9, 9, 9 }));
+		EXPECT_FALSE(colSpace.addCol({ 1, 2 }));
+		EXPECT_FALSE(rowSpace.addRow({ 1, 2 }));
+
+		EXPECT_TRUE(colSpace.equals({ {1, 2, 9}, {3, 4, 9}, {5, 6, 9}, {6, 7, 9}, {7, 8, 9}, {8, 9, 9}, {9, 10, 9} }));
+		EXPECT_TRUE(rowSpace.equals({ {1, 2, 9}, {3, 4, 9}, {5, 6, 9}, {6, 7, 9}, {7, 8, 9}, {8, 9, 9}, {9, 10, 9} }));
+
+		MathMatrix empty;
+		EXPECT_TRUE(empty.addRow({ 1, 2, 3 }));
+		EXPECT_TRUE(empty.addRow({ 4, 5, 6 }));
+		EXPECT_TRUE(empty.equals({ {1, 2, 3}, {4, 5, 6} }));
+	}
+
+	TEST(TransposeTests, TRANSPOSE_KEEPS_ELEMENTS_AND_SWAPS_INDICES)
+	{
+		MathMatrix m = { {1, 2, 3}, {4, 5, 6} };
+		m.transpose();
+
+		EXPECT_EQ(m.getNumRows(), 3);
+		EXPECT_EQ(m.getNumCols(), 2);
+		EXPECT_TRUE(m.equals({ {1, 4}, {2, 5}, {3, 6} }));
+		EXPECT_EQ(m.getRowStride(), m.getLeadingDimension());
+		EXPECT_EQ(m.getColStride(), 1);
+	}
+
+	TEST(RowOperationTests, ROW_OPERATIONS_WORK_IN_BOTH_SPACES)
+	{
+		MathMatrix colSpace = { {1, 2}, {3, 4}, {5, 6} };
+		MathMatrix rowSpace = { {1, 3, 5}, {2, 4, 6} };
+		rowSpace.transpose();
+
+		MathMatrix* matrices[] = { &colSpace, &rowSpace };
+		for (MathMatrix* m : matrices)
+		{
+			EXPECT_TRUE(m->swapRows(0, 2));
+			EXPECT_TRUE(m->equals({ {5, 6}, {3, 4}, {1, 2} }));
+
+			EXPECT_TRUE(m->addMultipleOfRow(1, 2, -3));
+			EXPECT_TRUE(m->equals({ {5, 6}, {0, -2}, {1, 2} }));
+
+			EXPECT_TRUE(m->multiplyRowByConstant(0, 2));
+			EXPECT_TRUE(m->equals({ {10, 12}, {0, -2}, {1, 2} }));
+
+			EXPECT_TRUE(m->swapCols(0, 1));
+			EXPECT_TRUE(m->equals({ {12, 10}, {-2, 0}, {2, 1} }));
+
+			EXPECT_FALSE(m->swapRows(0, 3));
+			EXPECT_FALSE(m->swapCols(2, 0));
+		}
+	}
+
 	TEST(MathMatrixIteratorTests, SUBTRACTION_ON_ITERATORS_WORKS_CORRECTLY)
 	{
 		MathMatrix m(4, 4);
@@ -43,6 +112,60 @@ namespace MATRIX_LIBRARY_TESTS {
 		EXPECT_EQ(endItr - startItr, 4);
 	}
 
+	TEST(MathMatrixIteratorTests, ITERATOR_IS_RANDOM_ACCESS)
+	{
+		static_assert(std::is_same<std::iterator_traits<MathMatrixIterator>::iterator_category,
+			std::random_access_iterator_tag>::value, "");
+
+		MathMatrix m = { {1, 2, 3, 4}, {5, 6, 7, 8}, {9, 10, 11, 12} };
+
+		MathMatrix::colIterator itr = m.colBegin(2);
+		EXPECT_EQ(itr[2], 11);
+		EXPECT_EQ(*(itr + 1), 7);
+		EXPECT_EQ(*(1 + itr), 7);
+
+		itr += 2;
+		EXPECT_EQ(*itr, 11);
+		itr -= 1;
+		EXPECT_EQ(*itr--, 7);
+		EXPECT_EQ(*itr, 3);
+
+		EXPECT_TRUE(m.colBegin(2) < m.colEnd(2));
+		EXPECT_TRUE(m.colEnd(2) >= m.colBegin(2));
+		EXPECT_TRUE(m.colBegin(2) + 3 == m.colEnd(2));
+		EXPECT_TRUE(m.colBegin(2) != m.colBegin(1));
+		EXPECT_EQ(m.colBegin(2) - m.colEnd(2), -3);
+
+		itr[1] = 100;
+		EXPECT_EQ(m.getVal(1, 2), 100);
+	}
+
+	TEST(MathMatrixIteratorTests, STANDARD_ALGORITHMS_WORK_ON_ROWS_AND_COLUMNS_IN_BOTH_SPACES)
+	{
+		MathMatrix m = { {4, 1, 3}, {9, 7, 8}, {2, 6, 5} };
+
+		for (int i = 0; i < 2; ++i)
+		{
+			// One of these walks contiguous memory and the other is strided
+			EXPECT_EQ(m.rowBegin(0).isContiguous(), m.getSpaceToRepresentMatrixAs() == ROWSPACE);
+			EXPECT_EQ(m.colBegin(0).isContiguous(), m.getSpaceToRepresentMatrixAs() == COLUMNSPACE);
+
+			MathMatrix sortedRow = m;
+			MathMatrix sortedCol = m;
+			std::sort(sortedRow.rowBegin(0), sortedRow.rowEnd(0));
+			std::sort(sortedCol.colBegin(2), sortedCol.colEnd(2), [](double a, double b) { return a > b; });
+
+			EXPECT_EQ(std::accumulate(m.rowBegin(1), m.rowEnd(1), 0.0), m.getVal(1, 0) + m.getVal(1, 1) + m.getVal(1, 2));
+			EXPECT_EQ(*std::max_element(m.colBegin(1), m.colEnd(1)),
+				std::max(m.getVal(0, 1), std::max(m.getVal(1, 1), m.getVal(2, 1))));
+			EXPECT_TRUE(std::is_sorted(sortedRow.rowBegin(0), sortedRow.rowEnd(0)));
+			EXPECT_TRUE(std::is_sorted(sortedCol.colBegin(2), sortedCol.colEnd(2), [](double a, double b) { return a > b; }));
+			EXPECT_EQ(sortedCol.getVal(1, 0), m.getVal(1, 0));
+
+			m.transpose();
+		}
+	}
+
 	TEST(ComparisonOperatorTests, OPERATOR_COMPARISON_WORKS_AS_INTENDED)
 	{
 		MathMatrix m({ {4, 5, 7}, { 3, 7, 2 }, { 9, 3, 1 }});
@@ -83,4 +206,223 @@ namespace MATRIX_LIBRARY_TESTS {
 		EXPECT_EQ(m3.getVal(1, 1), 0);
 	}
 
+	TEST(MatrixMultiplicationTest, MATRIX_MULTIPLICATION_WORKS_FOR_EVERY_COMBINATION_OF_SPACES)
+	{
+		MathMatrix a = { {1, 2, 3}, {4, 5, 6} };
+		MathMatrix b = { {7, 8}, {9, 10}, {11, 12} };
+
+		MathMatrix aRowSpace = { {1, 4}, {2, 5}, {3, 6} };
+		aRowSpace.transpose();
+		MathMatrix bRowSpace = { {7, 9, 11}, {8, 10, 12} };
+		bRowSpace.transpose();
+
+		EXPECT_TRUE((a * b).equals({ {58, 64}, {139, 154} }));
+		EXPECT_TRUE((aRowSpace * b).equals({ {58, 64}, {139, 154} }));
+		EXPECT_TRUE((a * bRowSpace).equals({ {58, 64}, {139, 154} }));
+		EXPECT_TRUE((aRowSpace * bRowSpace).equals({ {58, 64}, {139, 154} }));
+
+		EXPECT_EQ((a * a).getNumRows(), 0);
+	}
+
+	TEST(MoveTests, MOVING_A_MATRIX_TAKES_ITS_BUFFER_AND_LEAVES_IT_EMPTY)
+	{
+		static_assert(std::is_nothrow_move_constructible<MathMatrix>::value, "");
+		static_assert(std::is_nothrow_move_assignable<MathMatrix>::value, "");
+
+		MathMatrix m1 = { {1, 2, 3}, {4, 5, 6} };
+		m1.transpose();
+		double* buffer = m1.getData();
+
+		MathMatrix m2(std::move(m1));
+		EXPECT_EQ(m2.getData(), buffer);
+		EXPECT_TRUE(m2.equals({ {1, 4}, {2, 5}, {3, 6} }));
+		EXPECT_EQ(m1.getNumRows(), 0);
+		EXPECT_EQ(m1.getNumCols(), 0);
+		EXPECT_EQ(m1.getData(), nullptr);
+
+		MathMatrix m3 = { {9} };
+		m3 = std::move(m2);
+		EXPECT_EQ(m3.getData(), buffer);
+		EXPECT_TRUE(m3.equals({ {1, 4}, {2, 5}, {3, 6} }));
+
+		// A moved from matrix can be used again
+		m2 = { {7, 8} };
+		EXPECT_TRUE(m2.equals({ {7, 8} }));
+		EXPECT_TRUE(m1.addRow({ 1, 2 }));
+		EXPECT_TRUE(m1.equals({ {1, 2} }));
+	}
+
+	TEST(MoveTests, STD_VECTOR_OF_MATRICES_DOES_NOT_COPY_ON_REALLOCATION)
+	{
+		std::vector<MathMatrix> matrices;
+		matrices.push_back(MathMatrix(3, 4));
+		double* buffer = matrices[0].getData();
+
+		for (unsigned int i = 0; i < 100; ++i)
+		{
+			matrices.push_back(MathMatrix(2, 2));
+		}
+		EXPECT_EQ(matrices[0].getData(), buffer);
+	}
+
+
+	TEST(StorageTests, BUFFERS_START_ON_A_CACHE_LINE_AND_AVOID_ALIASED_LEADING_DIMENSIONS)
+	{
+		MathVector v(3);
+		v.push_back(1.0);
+		EXPECT_EQ((uintptr_t)v.getData() % 64, 0u);
+
+		// Vectors shorter than a line are not padded
+		MathMatrix small(3, 3);
+		EXPECT_EQ(small.getLeadingDimension(), 3u);
+		EXPECT_EQ((uintptr_t)small.getData() % 64, 0u);
+
+		for (unsigned int rows : { 8u, 13u, 64u, 512u, 1000u, 1024u })
+		{
+			MathMatrix m(rows, 5);
+			MathMatrixF f(rows, 5);
+			unsigned int ld = m.getLeadingDimension();
+
+			EXPECT_EQ((uintptr_t)m.getData() % 64, 0u);
+			EXPECT_EQ((uintptr_t)f.getData() % 64, 0u);
+			EXPECT_GE(ld, rows);
+			EXPECT_EQ(ld % 8, 0u);
+			EXPECT_NE((ld * sizeof(double)) % 512, 0u);
+			EXPECT_NE((f.getLeadingDimension() * sizeof(float)) % 512, 0u);
+
+			// Copies and grown matrices are padded the same way and keep their elements
+			m.setVal(rows - 1, 4, 2.5);
+			MathMatrix copy = m;
+			EXPECT_NE((copy.getLeadingDimension() * sizeof(double)) % 512, 0u);
+			for (unsigned int i = 0; i < 70; ++i)
+			{
+				EXPECT_TRUE(copy.addRow(MathVector(5)));
+			}
+			EXPECT_NE((copy.getLeadingDimension() * sizeof(double)) % 512, 0u);
+			EXPECT_DOUBLE_EQ(copy.getVal(rows - 1, 4), 2.5);
+		}
+	}
+
+
+	TEST(AppendTests, APPENDING_ONE_ROW_AT_A_TIME_MOVES_THE_BUFFER_A_LOGARITHMIC_NUMBER_OF_TIMES)
+	{
+		for (vector_space_t space : { ROWSPACE, COLUMNSPACE })
+		{
+			MathMatrix m(1, 3);
+			if (space == ROWSPACE)
+			{
+				m = MathMatrix(3, 1);
+				m.transpose();
+			}
+
+			int moves = 0;
+			for (unsigned int r = 1; r < 5000; ++r)
+			{
+				double* before = m.getData();
+				ASSERT_TRUE(m.addRow({ (double)r, 2.0 * r, 3.0 * r }));
+				if (m.getData() != before) ++moves;
+			}
+			EXPECT_EQ(m.getSpaceToRepresentMatrixAs(), space);
+			EXPECT_LE(moves, 16);
+			EXPECT_EQ(m.getNumRows(), 5000u);
+			EXPECT_DOUBLE_EQ(m.getVal(4321, 2), 3.0 * 4321);
+		}
+	}
+
+	TEST(AppendTests, APPENDING_INTO_RESERVED_ROOM_NEVER_MOVES_THE_BUFFER)
+	{
+		MathMatrix m;
+		m.reserve(100, 4);
+		EXPECT_GE(m.getRowCapacity(), 100u);
+		EXPECT_GE(m.getColCapacity(), 4u);
+		double* buffer = m.getData();
+
+		std::vector<MathVector> rows;
+		for (unsigned int r = 0; r < 10; ++r)
+		{
+			rows.push_back({ (double)r, 1, 2, 3 });
+		}
+		for (int i = 0; i < 10; ++i)
+		{
+			ASSERT_TRUE(m.appendRows(rows));
+		}
+
+		// The reserved matrix stays a space of columns even though rows were appended
+		EXPECT_EQ(m.getData(), buffer);
+		EXPECT_EQ(m.getSpaceToRepresentMatrixAs(), COLUMNSPACE);
+		EXPECT_EQ(m.getNumRows(), 100u);
+		EXPECT_EQ(m.getNumCols(), 4u);
+		EXPECT_DOUBLE_EQ(m.getVal(57, 0), 7.0);
+		EXPECT_DOUBLE_EQ(m.getVal(99, 3), 3.0);
+
+		// Reserving less than the matrix already holds changes nothing
+		m.reserve(10, 2);
+		EXPECT_EQ(m.getData(), buffer);
+	}
+
+	TEST(AppendTests, APPENDED_BLOCKS_MATCH_IN_EVERY_SPACE)
+	{
+		MathMatrix block = { {1, 2, 3}, {4, 5, 6} };
+		MathMatrix blockTransposed = { {1, 4}, {2, 5}, {3, 6} };
+
+		for (vector_space_t space : { ROWSPACE, COLUMNSPACE })
+		{
+			MathMatrix m = { {0, 0, 0} };
+			if (space == ROWSPACE)
+			{
+				m = MathMatrix(3, 1);
+				m.transpose();
+			}
+
+			EXPECT_TRUE(m.appendRows(block.getView()));
+			MathMatrixView transposed = blockTransposed.getView();
+			transposed.transpose();
+			EXPECT_TRUE(m.appendRows(transposed));
+			EXPECT_TRUE(m.equals({ {0, 0, 0}, {1, 2, 3}, {4, 5, 6}, {1, 2, 3}, {4, 5, 6} }));
+
+			EXPECT_TRUE(m.appendCols(m.getView(0, 1, 5, 2)));
+			EXPECT_TRUE(m.equals({ {0, 0, 0, 0, 0}, {1, 2, 3, 2, 3}, {4, 5, 6, 5, 6},
+				{1, 2, 3, 2, 3}, {4, 5, 6, 5, 6} }));
+
+			// A block of the wrong size or an empty one changes nothing
+			EXPECT_FALSE(m.appendRows(block.getView()));
+			EXPECT_FALSE(m.appendCols(block.getView()));
+			EXPECT_FALSE(m.appendRows(std::vector<MathVector>()));
+			EXPECT_FALSE(m.appendCols(std::vector<MathVector>{ MathVector{ 1, 2, 3, 4, 5 }, MathVector{ 1 } }));
+			EXPECT_EQ(m.getNumRows(), 5u);
+			EXPECT_EQ(m.getNumCols(), 5u);
+		}
+
+		// An empty matrix becomes the block
+		MathMatrix empty;
+		EXPECT_TRUE(empty.appendCols(block.getView()));
+		EXPECT_TRUE(empty.equals({ {1, 2, 3}, {4, 5, 6} }));
+	}
+
+
+	TEST(StorageTests, CHANGING_THE_SPACE_MOVES_THE_ELEMENTS_BUT_KEEPS_THE_MATRIX)
+	{
+		MathMatrix m(40, 27);
+		for (unsigned int r = 0; r < 40; ++r)
+		{
+			for (unsigned int c = 0; c < 27; ++c) m.setVal(r, c, r - 2.0 * c);
+		}
+
+		m.setSpaceToRepresentMatrixAs(ROWSPACE);
+		EXPECT_EQ(m.getSpaceToRepresentMatrixAs(), ROWSPACE);
+		EXPECT_EQ(m.getColStride(), 1u);
+		EXPECT_DOUBLE_EQ(m.getVal(39, 26), 39 - 52.0);
+
+		// Transposing and then going back to the old space is a physical transpose
+		m.transpose();
+		m.setSpaceToRepresentMatrixAs(ROWSPACE);
+		EXPECT_EQ(m.getNumRows(), 27u);
+		EXPECT_EQ(m.getColStride(), 1u);
+		for (unsigned int r = 0; r < 27; ++r)
+		{
+			for (unsigned int c = 0; c < 40; ++c) ASSERT_DOUBLE_EQ(m.getVal(r, c), c - 2.0 * r);
+		}
+		EXPECT_TRUE(m.addRow(MathVector(40)));
+	}
+
 }
\ No newline at end of file
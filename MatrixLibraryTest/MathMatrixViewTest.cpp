@@ -0,0 +1,212 @@
+#include "pch.h"
+
+#include "../MatrixLibrary/MathMatrix.h"
+#include "../MatrixLibrary/MathMatrixView.h"
+#include "../MatrixLibrary/MathVectorView.h"
+#include "TestHelpers.h"
+#include <algorithm>
+#include <cmath>
+#include <ostream>
+
+namespace MATRIX_VIEW_TESTS {
+
+	// [ 1  2  3  4 ]
+	// [ 5  6  7  8 ]
+	// [ 9 10 11 12 ]
+	static MathMatrix makeMatrix(vector_space_t space)
+	{
+		return ::makeMatrix(3, 4, space, [](unsigned int r, unsigned int c) { return (double)(r * 4 + c + 1); });
+	}
+
+	TEST(MatrixViewTests, SUB_VIEW_SEES_THE_BLOCK_AT_ITS_OFFSETS_IN_EITHER_SPACE)
+	{
+		for (vector_space_t space : { ROWSPACE, COLUMNSPACE })
+		{
+			MathMatrix m = makeMatrix(space);
+			MathMatrixView block = m.getView(1, 1, 2, 3);
+
+			EXPECT_EQ(block.getNumRows(), 2);
+			EXPECT_EQ(block.getNumCols(), 3);
+			EXPECT_TRUE(block.equals({ {6, 7, 8}, {10, 11, 12} }));
+			EXPECT_TRUE(block.getSubView(1, 1, 1, 2).equals({ {11, 12} }));
+
+			// Writing through the view writes to the matrix
+			EXPECT_TRUE(block.setVal(0, 0, -6));
+			EXPECT_EQ(m.getVal(1, 1), -6);
+
+			EXPECT_FALSE(block.setVal(2, 0, 1));
+			EXPECT_TRUE(std::isnan(block.getVal(0, 3)));
+		}
+	}
+
+	TEST(MatrixViewTests, BLOCKS_THAT_DO_NOT_FIT_GIVE_AN_EMPTY_VIEW)
+	{
+		MathMatrix m = makeMatrix(COLUMNSPACE);
+
+		EXPECT_EQ(m.getView(2, 0, 2, 1).getNumRows(), 0);
+		EXPECT_EQ(m.getView(0, 3, 1, 2).getNumCols(), 0);
+		EXPECT_EQ(m.getView(4, 0, 0, 0).getData(), nullptr);
+		EXPECT_EQ(MathMatrix().getView().getNumRows(), 0);
+		EXPECT_EQ(m.getView(3, 4, 0, 0).getNumRows(), 0);
+	}
+
+	TEST(MatrixViewTests, TRANSPOSE_SWAPS_THE_VIEW_ONLY)
+	{
+		MathMatrix m = makeMatrix(ROWSPACE);
+		MathMatrixView view = m.getView(0, 1, 2, 2);
+		view.transpose();
+
+		EXPECT_TRUE(view.equals({ {2, 6}, {3, 7} }));
+		EXPECT_TRUE(m.equals({ {1, 2, 3, 4}, {5, 6, 7, 8}, {9, 10, 11, 12} }));
+	}
+
+	TEST(MatrixViewTests, ROW_OPERATIONS_STAY_INSIDE_THE_VIEW)
+	{
+		for (vector_space_t space : { ROWSPACE, COLUMNSPACE })
+		{
+			MathMatrix m = makeMatrix(space);
+			MathMatrixView block = m.getView(1, 1, 2, 2);
+
+			EXPECT_TRUE(block.swapRows(0, 1));
+			EXPECT_TRUE(block.addMultipleOfRow(0, 1, 2));
+			EXPECT_TRUE(block.multiplyRowByConstant(1, -1));
+			EXPECT_TRUE(block.swapCols(0, 1));
+			EXPECT_FALSE(block.swapRows(0, 2));
+
+			EXPECT_TRUE(m.equals({ {1, 2, 3, 4}, {5, 25, 22, 8}, {9, -7, -6, 12} }));
+		}
+	}
+
+	TEST(MatrixViewTests, ITERATORS_WALK_THE_VIEW)
+	{
+		MathMatrix m = makeMatrix(COLUMNSPACE);
+		MathMatrixView block = m.getView(0, 1, 3, 2);
+
+		EXPECT_EQ(block.rowEnd(2) - block.rowBegin(2), 2);
+		EXPECT_EQ(*block.rowBegin(2), 10);
+		EXPECT_EQ(block.colBegin(1)[2], 11);
+
+		std::sort(block.rowBegin(0), block.rowEnd(0), [](double a, double b) { return a > b; });
+		EXPECT_TRUE(m.equals({ {1, 3, 2, 4}, {5, 6, 7, 8}, {9, 10, 11, 12} }));
+	}
+
+	TEST(MatrixViewTests, MULTIPLY_VIEWS_AND_WRITE_INTO_A_BLOCK)
+	{
+		MathMatrix a = makeMatrix(ROWSPACE);
+		MathMatrix b = makeMatrix(COLUMNSPACE);
+
+		// [ 6 7 ] * [ 2 3 ]^T   = [ 6*2+7*3  6*6+7*7 ]
+		// [10 11]   [ 6 7 ]       [10*2+11*3 10*6+11*7]
+		MathMatrixView aBlock = a.getView(1, 1, 2, 2);
+		MathMatrixView bBlock = b.getView(0, 1, 2, 2);
+		bBlock.transpose();
+
+		EXPECT_TRUE((aBlock * bBlock).equals({ {33, 85}, {53, 137} }));
+
+		// c = 2 * aBlock * bBlock + 1 * c in the middle of a bigger matrix
+		MathMatrix c(4, 4);
+		MathMatrixView cBlock = c.getView(1, 1, 2, 2);
+		cBlock.setVal(0, 0, 1);
+		EXPECT_TRUE(multiply(aBlock, bBlock, cBlock, 2.0, 1.0));
+		EXPECT_TRUE(c.equals({ {0, 0, 0, 0}, {0, 67, 170, 0}, {0, 106, 274, 0}, {0, 0, 0, 0} }));
+
+		EXPECT_FALSE(multiply(aBlock, a.getView(), cBlock));
+		EXPECT_EQ((aBlock * a.getView()).getNumRows(), 0);
+	}
+
+	TEST(MatrixViewTests, MATRIX_FROM_A_VIEW_COPIES_ONLY_THE_BLOCK)
+	{
+		for (vector_space_t space : { ROWSPACE, COLUMNSPACE })
+		{
+			MathMatrix m = makeMatrix(space);
+			MathMatrix copy(m.getView(1, 2, 2, 2));
+
+			EXPECT_TRUE(copy.equals({ {7, 8}, {11, 12} }));
+			EXPECT_EQ(copy.getSpaceToRepresentMatrixAs(), space);
+			EXPECT_EQ(copy.getLeadingDimension(), 2);
+
+			copy.setVal(0, 0, 0);
+			EXPECT_EQ(m.getVal(1, 2), 7);
+		}
+	}
+
+	TEST(MatrixViewTests, COPY_ELEMENTS_RELAYOUTS_AND_TRANSPOSES_IN_ANY_SPACE)
+	{
+		// Bigger than one copy block in both directions and not a multiple of it
+		const unsigned int rows = 45, cols = 70;
+		for (vector_space_t fromSpace : { ROWSPACE, COLUMNSPACE })
+		{
+			for (vector_space_t toSpace : { ROWSPACE, COLUMNSPACE })
+			{
+				MathMatrix from(rows, cols);
+				if (fromSpace == ROWSPACE)
+				{
+					from = MathMatrix(cols, rows);
+					from.transpose();
+				}
+				for (unsigned int r = 0; r < rows; ++r)
+				{
+					for (unsigned int c = 0; c < cols; ++c) from.setVal(r, c, r * 1000.0 + c);
+				}
+
+				MathMatrix to(cols, rows);
+				if (toSpace == ROWSPACE)
+				{
+					to = MathMatrix(rows, cols);
+					to.transpose();
+				}
+
+				MathMatrixView transposed = from.getView();
+				transposed.transpose();
+				EXPECT_FALSE(copyElements(from.getView(), to.getView()));
+				ASSERT_TRUE(copyElements(transposed, to.getView()));
+
+				for (unsigned int r = 0; r < rows; ++r)
+				{
+					for (unsigned int c = 0; c < cols; ++c)
+					{
+						ASSERT_EQ(to.getVal(c, r), r * 1000.0 + c);
+					}
+				}
+			}
+		}
+	}
+
+	TEST(VectorViewTests, ROWS_AND_COLUMNS_ARE_VECTOR_VIEWS)
+	{
+		MathMatrix m = makeMatrix(COLUMNSPACE);
+		MathVectorView row = m.getView().getRow(1);
+		MathVectorView col = m.getView().getCol(2);
+
+		EXPECT_EQ(row.getSize(), 4);
+		EXPECT_FALSE(row.isContiguous());
+		EXPECT_TRUE(col.isContiguous());
+		EXPECT_EQ(row[3], 8);
+		EXPECT_EQ(col[2], 11);
+
+		EXPECT_EQ(dotProduct(row, m.getView().getRow(0)), 5 + 12 + 21 + 32);
+		EXPECT_EQ(dotProduct(col, m.getView().getCol(0)), 3 + 35 + 99);
+		EXPECT_TRUE(std::isnan(dotProduct(row, col)));
+
+		EXPECT_TRUE(row.getSubView(0, 2).assign(2.0 * row.getSubView(2, 2)));
+		EXPECT_TRUE(m.equals({ {1, 2, 3, 4}, {14, 16, 7, 8}, {9, 10, 11, 12} }));
+		EXPECT_FALSE(row.assign(col));
+		EXPECT_EQ(row.getSubView(3, 2).getSize(), 0);
+	}
+
+	TEST(VectorViewTests, VIEWS_TAKE_PART_IN_VECTOR_EXPRESSIONS)
+	{
+		MathMatrix m = makeMatrix(ROWSPACE);
+		MathVector v = { 1, 1, 1 };
+
+		MathVector sum = m.getView().getCol(0) + 2.0 * m.getView().getCol(3) - v;
+		EXPECT_TRUE(sum.isEqualTo({ 8, 20, 32 }));
+
+		MathVectorView vView(v);
+		EXPECT_TRUE(vView.assign(m.getView().getCol(1) * 0.5));
+		EXPECT_TRUE(v.isEqualTo({ 1, 3, 5 }));
+
+		EXPECT_TRUE(v += m.getView().getCol(2));
+		EXPECT_TRUE(v.isEqualTo({ 4, 10, 16 }));
+	}
+}
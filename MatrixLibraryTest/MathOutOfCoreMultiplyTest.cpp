@@ -0,0 +1,146 @@
+#include "pch.h"
+
+#include "../MatrixLibrary/MathOutOfCoreMultiply.h"
+#include "../MatrixLibrary/MathMatrixFile.h"
+#include "TestHelpers.h"
+#include <cstdio>
+#include <string>
+
+namespace OUT_OF_CORE_MULTIPLY_TESTS {
+
+	// Removes the files when the test ends, however it ends
+	struct TemporaryFiles
+	{
+		~TemporaryFiles()
+		{
+			std::remove(a);
+			std::remove(b);
+			std::remove(c);
+		}
+		const char* a = "MathOutOfCoreMultiplyTest_a.mat";
+		const char* b = "MathOutOfCoreMultiplyTest_b.mat";
+		const char* c = "MathOutOfCoreMultiplyTest_c.mat";
+	};
+
+	TEST(OutOfCoreMultiplyTests, MATCHES_OPERATOR_STAR_WITHIN_THE_BUDGET)
+	{
+		TemporaryFiles files;
+		MathMatrix a = makeRandomMatrix<double>(300, 600, ROWSPACE, 1);
+		MathMatrix b = makeRandomMatrix<double>(600, 200, COLUMNSPACE, 2);
+		ASSERT_TRUE(saveMatrix(files.a, a.getView()));
+		ASSERT_TRUE(saveMatrix(files.b, b.getView()));
+
+		// Room for 256 x 256 tiles, so every dimension takes several of them
+		const size_t budget = 6 * 256 * 256 * sizeof(double) + 1000;
+		MathOutOfCoreMultiply outOfCore(budget);
+		EXPECT_EQ(outOfCore.getTileSize(), 256u);
+		ASSERT_TRUE(outOfCore.multiply(files.a, files.b, files.c));
+		EXPECT_LE(outOfCore.getBufferBytes(), budget);
+
+		MathMatrix c;
+		ASSERT_TRUE(loadMatrix(files.c, c));
+		ASSERT_EQ(c.getNumRows(), 300u);
+		ASSERT_EQ(c.getNumCols(), 200u);
+		EXPECT_EQ(c.getSpaceToRepresentMatrixAs(), COLUMNSPACE);
+
+		EXPECT_LT(maxDifference(c, a * b), 1e-12);
+	}
+
+	TEST(OutOfCoreMultiplyTests, EDGE_TILES_OF_ONE_ROW_OR_ONE_COLUMN)
+	{
+		// 257 rows and 257 columns leave tiles of C that gemm hands to gemv
+		TemporaryFiles files;
+		MathOutOfCoreMultiply outOfCore(6 * 256 * 256 * sizeof(double));
+		struct { unsigned int m, n, k; } sizes[] = { {257, 200, 600}, {300, 257, 600}, {257, 257, 257} };
+		for (const auto& size : sizes)
+		{
+			MathMatrix a = makeRandomMatrix<double>(size.m, size.k, COLUMNSPACE, 7);
+			MathMatrix b = makeRandomMatrix<double>(size.k, size.n, ROWSPACE, 8);
+			ASSERT_TRUE(saveMatrix(files.a, a.getView()));
+			ASSERT_TRUE(saveMatrix(files.b, b.getView()));
+			ASSERT_TRUE(outOfCore.multiply(files.a, files.b, files.c));
+
+			MathMatrix c;
+			ASSERT_TRUE(loadMatrix(files.c, c));
+			ASSERT_EQ(c.getNumRows(), size.m);
+			ASSERT_EQ(c.getNumCols(), size.n);
+			EXPECT_LT(maxDifference(c, a * b), 1e-12);
+		}
+	}
+
+	TEST(OutOfCoreMultiplyTests, SMALL_TILES_AND_FLOATS)
+	{
+		TemporaryFiles files;
+		MathMatrixF a = makeRandomMatrix<float>(131, 77, COLUMNSPACE, 3);
+		MathMatrixF b = makeRandomMatrix<float>(77, 95, ROWSPACE, 4);
+		ASSERT_TRUE(saveMatrix(files.a, a.getView()));
+		ASSERT_TRUE(saveMatrix(files.b, b.getView()));
+
+		// 30 x 30 tiles, none of the dimensions a multiple of it
+		MathOutOfCoreMultiplyF outOfCore(6 * 30 * 30 * sizeof(float));
+		EXPECT_EQ(outOfCore.getTileSize(), 30u);
+		ASSERT_TRUE(outOfCore.multiply(files.a, files.b, files.c));
+
+		MathMappedMatrixF c;
+		ASSERT_TRUE(c.open(files.c));
+		EXPECT_LT(maxDifference(MathMatrixF(c.getView()), a * b), 1e-4);
+
+		// The buffers are kept for the next product
+		size_t bytes = outOfCore.getBufferBytes();
+#ifndef _WIN32
+		// The mapping of the old product still reads it while the new one replaces the file
+		MathMatrixF previous(c.getView());
+		ASSERT_TRUE(outOfCore.multiply(files.a, files.b, files.c));
+		EXPECT_EQ(maxDifference(MathMatrixF(c.getView()), previous), 0.0);
+#endif
+		c.close();
+		ASSERT_TRUE(outOfCore.multiply(files.a, files.b, files.c));
+		EXPECT_EQ(outOfCore.getBufferBytes(), bytes);
+
+		// A lower budget gives smaller buffers, never the ones of the larger budget
+		const size_t lowerBudget = 6 * 10 * 10 * sizeof(float);
+		outOfCore.setMemoryBudget(lowerBudget);
+		EXPECT_LE(outOfCore.getBufferBytes(), lowerBudget);
+		ASSERT_TRUE(outOfCore.multiply(files.a, files.b, files.c));
+		EXPECT_GT(outOfCore.getBufferBytes(), 0u);
+		EXPECT_LE(outOfCore.getBufferBytes(), lowerBudget);
+		ASSERT_TRUE(c.open(files.c));
+		EXPECT_LT(maxDifference(MathMatrixF(c.getView()), a * b), 1e-4);
+	}
+
+	TEST(OutOfCoreMultiplyTests, FAILS_ON_FILES_IT_CANNOT_MULTIPLY)
+	{
+		TemporaryFiles files;
+		ASSERT_TRUE(saveMatrix(files.a, makeRandomMatrix<double>(10, 20, COLUMNSPACE, 5).getView()));
+		ASSERT_TRUE(saveMatrix(files.b, makeRandomMatrix<double>(21, 5, COLUMNSPACE, 6).getView()));
+
+		MathOutOfCoreMultiply outOfCore;
+		EXPECT_FALSE(outOfCore.multiply(files.a, files.b, files.c));
+		EXPECT_FALSE(outOfCore.multiply(files.a, "MathOutOfCoreMultiplyTest_missing.mat", files.c));
+		EXPECT_FALSE(outOfCore.multiply(files.a, files.a, files.a));
+
+		// The product would overwrite an operand spelled as another path
+		MathMatrix a;
+		ASSERT_TRUE(loadMatrix(files.a, a));
+		ASSERT_TRUE(saveMatrix(files.b, makeRandomMatrix<double>(20, 5, COLUMNSPACE, 6).getView()));
+		std::string sameAsA = std::string("./") + files.a;
+		EXPECT_FALSE(outOfCore.multiply(files.a, files.b, sameAsA.c_str()));
+		MathMatrix reloaded;
+		ASSERT_TRUE(loadMatrix(files.a, reloaded));
+		EXPECT_EQ(maxDifference(reloaded, a), 0.0);
+		EXPECT_TRUE(outOfCore.multiply(files.a, files.b, files.c));
+		ASSERT_TRUE(saveMatrix(files.b, makeRandomMatrix<double>(21, 5, COLUMNSPACE, 6).getView()));
+
+		// Files of the other element type
+		MathOutOfCoreMultiplyF floats;
+		EXPECT_FALSE(floats.multiply(files.a, files.a, files.c));
+
+		// Too small a budget for one element of each tile
+		ASSERT_TRUE(saveMatrix(files.b, makeRandomMatrix<double>(20, 5, COLUMNSPACE, 6).getView()));
+		outOfCore.setMemoryBudget(10);
+		EXPECT_EQ(outOfCore.getTileSize(), 0u);
+		EXPECT_FALSE(outOfCore.multiply(files.a, files.b, files.c));
+		outOfCore.setMemoryBudget(6 * sizeof(double));
+		EXPECT_TRUE(outOfCore.multiply(files.a, files.b, files.c));
+	}
+}
@@ -0,0 +1,174 @@
+#include "pch.h"
+
+#include "../MatrixLibrary/MathMatrix.h"
+#include "../MatrixLibrary/MathQRDecomposition.h"
+#include "../MatrixLibrary/MathThreadPool.h"
+#include "TestHelpers.h"
+#include <cmath>
+#include <ostream>
+
+namespace QR_DECOMPOSITION_TESTS {
+
+	static MathMatrix identity(unsigned int n)
+	{
+		MathMatrix i(n, n);
+		for (unsigned int d = 0; d < n; ++d) i.setVal(d, d, 1.0);
+		return i;
+	}
+
+	TEST(QRDecompositionTests, SMALL_MATRIX_HAS_THE_KNOWN_FACTORS)
+	{
+		// The classic example, R = [-14 -21 14; 0 -175 70; 0 0 -35] up to the signs of its rows
+		MathMatrix a = { {12, -51, 4}, {6, 167, -68}, {-4, 24, -41} };
+		MathQRDecomposition qr(a.getView());
+
+		ASSERT_TRUE(qr.isFactored());
+		EXPECT_FALSE(qr.isRankDeficient());
+
+		MathMatrix r = qr.getR();
+		EXPECT_NEAR(std::fabs(r.getVal(0, 0)), 14, 1e-12);
+		EXPECT_NEAR(std::fabs(r.getVal(1, 1)), 175, 1e-12);
+		EXPECT_NEAR(std::fabs(r.getVal(2, 2)), 35, 1e-12);
+		EXPECT_EQ(r.getVal(2, 0), 0);
+
+		MathMatrix q = qr.getQ();
+		EXPECT_LT(maxDifference(q * r, a), 1e-12);
+	}
+
+	TEST(QRDecompositionTests, TALL_MATRIX_WITH_MANY_BLOCKS_IN_EITHER_SPACE)
+	{
+		const unsigned int m = 403, n = 97;
+		for (vector_space_t space : { ROWSPACE, COLUMNSPACE })
+		{
+			MathMatrix a = makeRandomMatrix(m, n, space, 1);
+			MathQRDecomposition qr(a.getView());
+
+			MathMatrix q = qr.getQ();
+			MathMatrix r = qr.getR();
+			ASSERT_EQ(q.getNumRows(), m);
+			ASSERT_EQ(q.getNumCols(), n);
+			ASSERT_EQ(r.getNumRows(), n);
+
+			EXPECT_LT(maxDifference(q * r, a), 1e-12);
+
+			MathMatrix qT = q;
+			qT.transpose();
+			EXPECT_LT(maxDifference(qT * q, identity(n)), 1e-12);
+		}
+	}
+
+	TEST(QRDecompositionTests, FULL_Q_IS_ORTHOGONAL_AND_APPLY_Q_MATCHES_IT)
+	{
+		const unsigned int m = 90, n = 40;
+		MathMatrix a = makeRandomMatrix(m, n, COLUMNSPACE, 2);
+		MathQRDecomposition qr(a.getView());
+
+		MathMatrix q = qr.getQ(false);
+		ASSERT_EQ(q.getNumCols(), m);
+		MathMatrix qT = q;
+		qT.transpose();
+		EXPECT_LT(maxDifference(qT * q, identity(m)), 1e-12);
+
+		// Applying Q and Q^T without forming Q, to a ROWSPACE block
+		MathMatrix c = makeRandomMatrix(m, 5, ROWSPACE, 3);
+		MathMatrix qc = c;
+		EXPECT_TRUE(qr.applyQ(qc.getView()));
+		EXPECT_LT(maxDifference(qc, q * c), 1e-12);
+
+		EXPECT_TRUE(qr.applyQTranspose(qc.getView()));
+		EXPECT_LT(maxDifference(qc, c), 1e-12);
+
+		EXPECT_FALSE(qr.applyQ(MathMatrix(m - 1, 2).getView()));
+	}
+
+	TEST(QRDecompositionTests, LEAST_SQUARES_FITS_A_LINE)
+	{
+		// The best line through (0, 6), (1, 0), (2, 0) is y = 5 - 3x
+		MathMatrix a = { {1, 0}, {1, 1}, {1, 2} };
+		MathVector x = leastSquares(a, MathVector({ 6, 0, 0 }));
+
+		ASSERT_EQ(x.getSize(), 2);
+		EXPECT_NEAR(x[0], 5, 1e-12);
+		EXPECT_NEAR(x[1], -3, 1e-12);
+	}
+
+	TEST(QRDecompositionTests, LEAST_SQUARES_RESIDUAL_IS_ORTHOGONAL_TO_THE_COLUMNS)
+	{
+		const unsigned int m = 1000, n = 50, nrhs = 3;
+		MathMatrix a = makeRandomMatrix(m, n, ROWSPACE, 4);
+		MathMatrix b = makeRandomMatrix(m, nrhs, COLUMNSPACE, 5);
+
+		MathMatrix x = leastSquares(a, b);
+		ASSERT_EQ(x.getNumRows(), n);
+		ASSERT_EQ(x.getNumCols(), nrhs);
+
+		// The normal equations, A^T * (A * x - b) = 0
+		MathMatrix residual = a * x;
+		for (unsigned int r = 0; r < m; ++r)
+			for (unsigned int c = 0; c < nrhs; ++c)
+				residual.setVal(r, c, residual.getVal(r, c) - b.getVal(r, c));
+		MathMatrix aT = a;
+		aT.transpose();
+		EXPECT_LT(maxDifference(aT * residual, MathMatrix(n, nrhs)), 1e-10);
+
+		// One column on its own gives the same answer
+		MathVector b0(m);
+		for (unsigned int r = 0; r < m; ++r) b0[r] = b.getVal(r, 0);
+		MathVector x0 = leastSquares(a, b0);
+		ASSERT_EQ(x0.getSize(), n);
+		for (unsigned int r = 0; r < n; ++r) EXPECT_NEAR(x0[r], x.getVal(r, 0), 1e-12);
+	}
+
+	TEST(QRDecompositionTests, COLUMN_ALREADY_ZERO_BELOW_THE_DIAGONAL_IS_SKIPPED)
+	{
+		MathMatrix a = { {3, 2, 1}, {0, 3, 5}, {0, 4, 2}, {0, 0, 7} };
+		MathQRDecomposition qr(a.getView());
+
+		EXPECT_FALSE(qr.isRankDeficient());
+		EXPECT_EQ(qr.getR().getVal(0, 0), 3);
+		EXPECT_NEAR(std::fabs(qr.getR().getVal(1, 1)), 5, 1e-12);
+		EXPECT_LT(maxDifference(qr.getQ() * qr.getR(), a), 1e-12);
+	}
+
+	TEST(QRDecompositionTests, TALL_SKINNY_MATRIX_ON_SEVERAL_THREADS)
+	{
+		const unsigned int m = 30000, n = 20;
+		MathMatrix a = makeRandomMatrix(m, n, COLUMNSPACE, 7);
+		MathMatrix b = makeRandomMatrix(m, 1, COLUMNSPACE, 8);
+		MathVector bVec(m);
+		for (unsigned int r = 0; r < m; ++r) bVec[r] = b.getVal(r, 0);
+
+		MathVector serial = leastSquares(a, bVec);
+
+		MathThreadPool& pool = MathThreadPool::getInstance();
+		unsigned int threadsBefore = pool.getNumThreads();
+		pool.setNumThreads(4);
+		MathQRDecomposition qr(a.getView());
+		MathVector parallel = qr.leastSquares(bVec);
+		MathMatrix q = qr.getQ();
+		pool.setNumThreads(threadsBefore);
+
+		ASSERT_EQ(parallel.getSize(), n);
+		for (unsigned int i = 0; i < n; ++i) EXPECT_NEAR(parallel[i], serial[i], 1e-12);
+		EXPECT_LT(maxDifference(q * qr.getR(), a), 1e-12);
+	}
+
+	TEST(QRDecompositionTests, WIDE_AND_RANK_DEFICIENT_MATRICES)
+	{
+		// Wide matrices factor but have no unique least squares solution
+		MathMatrix wide = makeRandomMatrix(5, 8, COLUMNSPACE, 6);
+		MathQRDecomposition qr(wide.getView());
+		EXPECT_EQ(qr.getQ().getNumCols(), 5);
+		EXPECT_LT(maxDifference(qr.getQ() * qr.getR(), wide), 1e-12);
+		EXPECT_EQ(qr.leastSquares(MathVector(5)).getSize(), 0);
+
+		MathMatrix zeroColumn = { {1, 0}, {2, 0}, {3, 0} };
+		EXPECT_TRUE(MathQRDecomposition(zeroColumn.getView()).isRankDeficient());
+		EXPECT_EQ(leastSquares(zeroColumn, MathVector({ 1, 2, 3 })).getSize(), 0);
+
+		MathMatrix a = { {1, 0}, {0, 1}, {1, 1} };
+		EXPECT_EQ(leastSquares(a, MathVector({ 1, 2 })).getSize(), 0);
+		EXPECT_FALSE(MathQRDecomposition().factor(MathMatrix().getView()));
+		EXPECT_EQ(MathQRDecomposition().getQ().getNumRows(), 0);
+	}
+}
@@ -0,0 +1,124 @@
+#include "pch.h"
+
+#include "../MatrixLibrary/MathMatrix.h"
+#include "../MatrixLibrary/MathRowReduction.h"
+#include "../MatrixLibrary/MathThreadPool.h"
+#include "TestHelpers.h"
+#include <cmath>
+#include <ostream>
+
+namespace ROW_REDUCTION_TESTS {
+
+	static bool isNear(const MathMatrix& m, const std::initializer_list<std::initializer_list<double>>& expected)
+	{
+		unsigned int r = 0;
+		for (const std::initializer_list<double>& row : expected)
+		{
+			unsigned int c = 0;
+			for (double val : row)
+			{
+				if (std::fabs(m.getVal(r, c) - val) > 1e-12) return false;
+				++c;
+			}
+			if (c != m.getNumCols()) return false;
+			++r;
+		}
+		return r == m.getNumRows();
+	}
+
+	TEST(RowReductionTests, RREF_OF_A_SMALL_MATRIX_IN_EITHER_SPACE)
+	{
+		for (vector_space_t space : { ROWSPACE, COLUMNSPACE })
+		{
+			MathMatrix a = { {1, 2, -1, -4}, {2, 3, -1, -11}, {-2, 0, -3, 22} };
+			if (space == ROWSPACE)
+			{
+				a = { {1, 2, -2}, {2, 3, 0}, {-1, -1, -3}, {-4, -11, 22} };
+				a.transpose();
+			}
+
+			MathRowReduction reduction(a.getView());
+			EXPECT_TRUE(reduction.isReduced());
+			EXPECT_EQ(reduction.getRank(), 3);
+			EXPECT_TRUE(isNear(reduction.getRREF(), { {1, 0, 0, -8}, {0, 1, 0, 1}, {0, 0, 1, -2} }));
+			EXPECT_EQ(reduction.getRREF().getSpaceToRepresentMatrixAs(), ROWSPACE);
+		}
+	}
+
+	TEST(RowReductionTests, RANK_DEFICIENT_MATRIX_HAS_FREE_COLUMNS)
+	{
+		// The second row is twice the first and the third column is the first plus the second
+		MathMatrix a = { {1, 2, 3, 1}, {2, 4, 6, 2}, {1, 0, 1, 3} };
+
+		EXPECT_EQ(rank(a), 2);
+		EXPECT_TRUE(isNear(rref(a), { {1, 0, 1, 3}, {0, 1, 1, -1}, {0, 0, 0, 0} }));
+
+		MathRowReduction reduction(a.getView());
+		ASSERT_EQ(reduction.getPivotColumns().size(), 2);
+		EXPECT_EQ(reduction.getPivotColumns()[0], 0);
+		EXPECT_EQ(reduction.getPivotColumns()[1], 1);
+
+		MathMatrix basis = nullSpace(a);
+		ASSERT_EQ(basis.getNumRows(), 4);
+		ASSERT_EQ(basis.getNumCols(), 2);
+		EXPECT_TRUE(isNear(basis, { {-1, -3}, {-1, 1}, {1, 0}, {0, 1} }));
+
+		MathMatrix product = a * basis;
+		for (unsigned int r = 0; r < product.getNumRows(); ++r)
+		{
+			for (unsigned int c = 0; c < product.getNumCols(); ++c)
+			{
+				EXPECT_NEAR(product.getVal(r, c), 0, 1e-12);
+			}
+		}
+	}
+
+	TEST(RowReductionTests, BIG_LOW_RANK_PRODUCT_HAS_THE_RIGHT_RANK_AND_NULL_SPACE)
+	{
+		// A 300 x 200 product of 300 x 37 and 37 x 200 factors, big enough to run in parallel
+		const unsigned int rows = 300, cols = 200, inner = 37;
+		MathMatrix left = makeRandomMatrix(rows, inner, COLUMNSPACE, 1);
+		MathMatrix right = makeRandomMatrix(inner, cols, COLUMNSPACE, 2);
+		MathMatrix a = left * right;
+
+		MathThreadPool& pool = MathThreadPool::getInstance();
+		unsigned int threadsBefore = pool.getNumThreads();
+		pool.setNumThreads(4);
+		MathRowReduction reduction(a.getView());
+		pool.setNumThreads(threadsBefore);
+
+		EXPECT_EQ(reduction.getRank(), inner);
+
+		MathMatrix basis = reduction.getNullSpace();
+		ASSERT_EQ(basis.getNumCols(), cols - inner);
+
+		MathMatrix product = a * basis;
+		double worst = 0.0;
+		for (unsigned int r = 0; r < product.getNumRows(); ++r)
+			for (unsigned int c = 0; c < product.getNumCols(); ++c)
+				worst = std::fmax(worst, std::fabs(product.getVal(r, c)));
+		EXPECT_LT(worst, 1e-8);
+	}
+
+	TEST(RowReductionTests, TOLERANCE_DECIDES_WHAT_COUNTS_AS_ZERO)
+	{
+		MathMatrix a = { {1, 0}, {0, 1e-9} };
+
+		EXPECT_EQ(MathRowReduction(a.getView()).getRank(), 2);
+		EXPECT_EQ(MathRowReduction(a.getView(), 1e-6).getRank(), 1);
+		EXPECT_EQ(MathRowReduction(a.getView(), 1e-6).getTolerance(), 1e-6);
+	}
+
+	TEST(RowReductionTests, FULL_COLUMN_RANK_AND_EMPTY_INPUT)
+	{
+		MathMatrix a = { {1, 2}, {3, 4}, {5, 7} };
+		EXPECT_EQ(rank(a), 2);
+		EXPECT_EQ(nullSpace(a).getNumRows(), 0);
+
+		MathRowReduction reduction;
+		EXPECT_FALSE(reduction.reduce(MathMatrix().getView()));
+		EXPECT_FALSE(reduction.isReduced());
+		EXPECT_EQ(rank(MathMatrix()), 0);
+		EXPECT_EQ(rref(MathMatrix()).getNumRows(), 0);
+	}
+}
@@ -0,0 +1,210 @@
+#include "pch.h"
+
+#include "../MatrixLibrary/MathMatrix.h"
+#include "../MatrixLibrary/MathMatrixMultiply.h"
+#include "../MatrixLibrary/MathSimdKernels.h"
+#include "../MatrixLibrary/MathVector.h"
+#include "TestHelpers.h"
+#include <vector>
+
+namespace MATH_SIMD_KERNELS_TESTS {
+
+	// Lengths around every vector width and unroll factor so the tails are exercised
+	static const size_t LENGTHS[] = { 0, 1, 2, 3, 4, 5, 7, 8, 9, 15, 16, 17, 31, 33, 63, 64, 65, 1001 };
+
+	static std::vector<double> makeData(size_t n, unsigned int seed)
+	{
+		std::vector<double> data(n);
+		for (size_t i = 0; i < n; ++i)
+		{
+			data[i] = (double)((i * 7 + seed * 31) % 19) * 0.25 - 2.0;
+		}
+		return data;
+	}
+
+	TEST(SimdKernelTests, UNSUPPORTED_INSTRUCTION_SET_IS_REJECTED)
+	{
+		simd_instruction_set_t before = getSimdInstructionSet();
+
+		if (getSupportedSimdInstructionSet() != SIMD_AVX512)
+		{
+			EXPECT_FALSE(setSimdInstructionSet(SIMD_AVX512));
+		}
+		EXPECT_EQ(getSimdInstructionSet(), before);
+	}
+
+	TEST(SimdKernelTests, VECTOR_KERNELS_MATCH_REFERENCE_FOR_EVERY_LENGTH)
+	{
+		forEachSupportedInstructionSet([]()
+		{
+			for (size_t n : LENGTHS)
+			{
+				std::vector<double> x = makeData(n, 1);
+				std::vector<double> y = makeData(n, 2);
+
+				double dot = 0.0, squares = 0.0;
+				for (size_t i = 0; i < n; ++i)
+				{
+					dot += x[i] * y[i];
+					squares += x[i] * x[i];
+				}
+				EXPECT_NEAR(simdDotProduct(x.data(), y.data(), n), dot, 1e-9);
+				EXPECT_NEAR(simdSumOfSquares(x.data(), n), squares, 1e-9);
+
+				std::vector<double> axpy = y;
+				simdAxpy(-1.5, x.data(), axpy.data(), n);
+				std::vector<double> scaled = x;
+				simdScale(3.0, scaled.data(), n);
+
+				for (size_t i = 0; i < n; ++i)
+				{
+					ASSERT_DOUBLE_EQ(axpy[i], y[i] - 1.5 * x[i]);
+					ASSERT_DOUBLE_EQ(scaled[i], 3.0 * x[i]);
+				}
+			}
+		});
+	}
+
+	TEST(SimdKernelTests, KERNELS_ACCEPT_UNALIGNED_POINTERS)
+	{
+		forEachSupportedInstructionSet([]()
+		{
+			std::vector<double> x = makeData(40, 3);
+			std::vector<double> y = makeData(40, 4);
+
+			double dot = 0.0;
+			for (size_t i = 1; i < 38; ++i)
+			{
+				dot += x[i] * y[i + 1];
+			}
+			EXPECT_NEAR(simdDotProduct(x.data() + 1, y.data() + 2, 37), dot, 1e-9);
+		});
+	}
+
+	TEST(SimdKernelTests, GEMM_MATCHES_REFERENCE_WITH_EVERY_MICRO_KERNEL)
+	{
+		forEachSupportedInstructionSet([]()
+		{
+			GemmMicroKernel microKernel = getGemmMicroKernel();
+			ASSERT_LE(microKernel.mr, GEMM_MAX_MR);
+			ASSERT_LE(microKernel.nr, GEMM_MAX_NR);
+
+			const unsigned int m = 53, n = 41, k = 67;
+			std::vector<double> a = makeData((size_t)m * k, 5);
+			std::vector<double> b = makeData((size_t)k * n, 6);
+			std::vector<double> c = makeData((size_t)m * n, 7);
+			std::vector<double> cBefore = c;
+
+			// A row major, B column major, C row major
+			gemm(m, n, k, 0.5, a.data(), k, 1, b.data(), 1, k, 2.0, c.data(), n, 1);
+
+			for (unsigned int i = 0; i < m; ++i)
+			{
+				for (unsigned int j = 0; j < n; ++j)
+				{
+					double sum = 0.0;
+					for (unsigned int p = 0; p < k; ++p)
+					{
+						sum += a[i * k + p] * b[j * k + p];
+					}
+					ASSERT_NEAR(c[i * n + j], 0.5 * sum + 2.0 * cBefore[i * n + j], 1e-9);
+				}
+			}
+		});
+	}
+
+	TEST(SimdKernelTests, FLOAT_KERNELS_MATCH_REFERENCE_FOR_EVERY_LENGTH)
+	{
+		forEachSupportedInstructionSet([]()
+		{
+			for (size_t n : LENGTHS)
+			{
+				// Quarters are exact in float so every result can be compared exactly
+				std::vector<double> xd = makeData(n, 1);
+				std::vector<double> yd = makeData(n, 2);
+				std::vector<float> x(xd.begin(), xd.end());
+				std::vector<float> y(yd.begin(), yd.end());
+
+				double dot = 0.0, squares = 0.0;
+				for (size_t i = 0; i < n; ++i)
+				{
+					dot += xd[i] * yd[i];
+					squares += xd[i] * xd[i];
+				}
+				EXPECT_EQ(simdDotProduct(x.data(), y.data(), n), (float)dot);
+				EXPECT_EQ(simdSumOfSquares(x.data(), n), (float)squares);
+
+				std::vector<float> axpy = y;
+				simdAxpy(-1.5f, x.data(), axpy.data(), n);
+				std::vector<float> scaled = x;
+				simdScale(3.0f, scaled.data(), n);
+
+				for (size_t i = 0; i < n; ++i)
+				{
+					ASSERT_EQ(axpy[i], (float)(yd[i] - 1.5 * xd[i]));
+					ASSERT_EQ(scaled[i], (float)(3.0 * xd[i]));
+				}
+			}
+		});
+	}
+
+	TEST(SimdKernelTests, FLOAT_GEMM_MATCHES_REFERENCE_WITH_EVERY_MICRO_KERNEL)
+	{
+		forEachSupportedInstructionSet([]()
+		{
+			GemmMicroKernelF microKernel = getGemmMicroKernelF();
+			ASSERT_LE(microKernel.mr, GEMM_MAX_MR);
+			ASSERT_LE(microKernel.nr, GEMM_MAX_NR);
+			ASSERT_GE(microKernel.nr, getGemmMicroKernel().nr);
+
+			// n is past two of the widest float micro-panels so the right edge is a partial one
+			const unsigned int m = 53, n = 71, k = 67;
+			std::vector<double> ad = makeData((size_t)m * k, 5);
+			std::vector<double> bd = makeData((size_t)k * n, 6);
+			std::vector<double> cd = makeData((size_t)m * n, 7);
+			std::vector<float> a(ad.begin(), ad.end());
+			std::vector<float> b(bd.begin(), bd.end());
+			std::vector<float> c(cd.begin(), cd.end());
+
+			// A column major, B row major, C column major
+			gemm(m, n, k, 0.5f, a.data(), 1, m, b.data(), n, 1, 2.0f, c.data(), 1, m);
+
+			for (unsigned int i = 0; i < m; ++i)
+			{
+				for (unsigned int j = 0; j < n; ++j)
+				{
+					double sum = 0.0;
+					for (unsigned int p = 0; p < k; ++p)
+					{
+						sum += ad[i + p * m] * bd[p * n + j];
+					}
+					ASSERT_EQ(c[i + j * m], (float)(0.5 * sum + 2.0 * cd[i + j * m]));
+				}
+			}
+		});
+	}
+
+	TEST(SimdKernelTests, ITERATOR_DOT_PRODUCT_MATCHES_FOR_CONTIGUOUS_AND_STRIDED_WALKS)
+	{
+		MathMatrix m(9, 11);
+		for (unsigned int r = 0; r < 9; ++r)
+		{
+			for (unsigned int c = 0; c < 11; ++c)
+			{
+				m.setVal(r, c, (double)(r * 3 + c) - 7.0);
+			}
+		}
+
+		// Rows are contiguous and columns strided, then the other way around after transposing
+		for (int i = 0; i < 2; ++i)
+		{
+			double rowDot = 0.0, colDot = 0.0;
+			for (unsigned int c = 0; c < m.getNumCols(); ++c) rowDot += m.getVal(2, c) * m.getVal(5, c);
+			for (unsigned int r = 0; r < m.getNumRows(); ++r) colDot += m.getVal(r, 1) * m.getVal(r, 7);
+
+			EXPECT_DOUBLE_EQ(dotProduct(m.rowBegin(2), m.rowEnd(2), m.rowBegin(5), m.rowEnd(5)), rowDot);
+			EXPECT_DOUBLE_EQ(dotProduct(m.colBegin(1), m.colEnd(1), m.colBegin(7), m.colEnd(7)), colDot);
+			m.transpose();
+		}
+	}
+}
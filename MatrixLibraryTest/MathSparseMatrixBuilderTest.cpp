@@ -0,0 +1,144 @@
+#include "pch.h"
+
+#include "../MatrixLibrary/MathMatrix.h"
+#include "../MatrixLibrary/MathSparseMatrixBuilder.h"
+#include "../MatrixLibrary/MathThreadPool.h"
+#include "TestHelpers.h"
+#include <cmath>
+#include <ostream>
+
+namespace SPARSE_MATRIX_BUILDER_TESTS {
+
+	// The stiffness matrix of a chain of springs, every element adds a 2 x 2 block that
+	//     overlaps the blocks of its neighbours on the diagonal
+	static void addSpringElement(MathSparseMatrixBuilder& builder, unsigned int element)
+	{
+		builder.add(element, element, 1.0);
+		builder.add(element, element + 1, -1.0);
+		builder.add(element + 1, element, -1.0);
+		builder.add(element + 1, element + 1, 1.0);
+	}
+
+	TEST(SparseMatrixBuilderTests, DUPLICATES_ARE_ADDED)
+	{
+		MathSparseMatrixBuilder builder(3, 4);
+		EXPECT_TRUE(builder.add(2, 1, 1.5));
+		EXPECT_TRUE(builder.add(0, 3, 2.0));
+		EXPECT_TRUE(builder.add(2, 1, 2.5));
+		EXPECT_TRUE(builder.add(0, 0, -1.0));
+		EXPECT_FALSE(builder.add(3, 0, 1.0));
+		EXPECT_FALSE(builder.add(0, 4, 1.0));
+		EXPECT_EQ(builder.getNumTriplets(), 4);
+
+		MathSparseMatrix csr = builder.build();
+		EXPECT_EQ(csr.getNumNonZeros(), 3);
+		EXPECT_EQ(csr.getOffsets(), std::vector<size_t>({ 0, 2, 2, 3 }));
+		EXPECT_EQ(csr.getIndices(), std::vector<unsigned int>({ 0, 3, 1 }));
+		EXPECT_EQ(csr.getValues(), std::vector<double>({ -1, 2, 4 }));
+
+		MathSparseMatrix csc = builder.build(COLUMNSPACE);
+		EXPECT_EQ(csc.getOffsets(), std::vector<size_t>({ 0, 1, 2, 2, 3 }));
+		EXPECT_EQ(csc.getVal(2, 1), 4);
+
+		MathMatrix expected = { {-1, 0, 0, 2}, {0, 0, 0, 0}, {0, 4, 0, 0} };
+		EXPECT_LT(maxDifference(builder.toDense(), expected), 1e-15);
+		EXPECT_LT(maxDifference(csr.toDense(), expected), 1e-15);
+
+		builder.clear();
+		EXPECT_EQ(builder.getNumTriplets(), 0);
+		EXPECT_EQ(builder.build().getNumNonZeros(), 0);
+		EXPECT_EQ(builder.build().getNumRows(), 3);
+	}
+
+	TEST(SparseMatrixBuilderTests, MANY_THREADS_ASSEMBLE_THE_SAME_MATRIX)
+	{
+		const unsigned int numElements = 50000;
+
+		MathSparseMatrixBuilder serial(numElements + 1, numElements + 1);
+		for (unsigned int e = 0; e < numElements; ++e) addSpringElement(serial, e);
+		MathSparseMatrix expected = serial.build();
+
+		MathThreadPool& pool = MathThreadPool::getInstance();
+		unsigned int threadsBefore = pool.getNumThreads();
+		pool.setNumThreads(4);
+
+		MathSparseMatrixBuilder builder(numElements + 1, numElements + 1);
+		const unsigned int numTasks = 64;
+		pool.parallelFor(numTasks, [&](unsigned int task)
+		{
+			// Interleaved so neighbouring elements come from different threads
+			for (unsigned int e = task; e < numElements; e += numTasks) addSpringElement(builder, e);
+		});
+		MathSparseMatrix csr = builder.build();
+		MathSparseMatrix csc = builder.build(COLUMNSPACE);
+		pool.setNumThreads(threadsBefore);
+
+		EXPECT_EQ(builder.getNumTriplets(), 4 * numElements);
+		EXPECT_EQ(csr.getNumNonZeros(), 3 * numElements + 1);
+		EXPECT_EQ(csr.getOffsets(), expected.getOffsets());
+		EXPECT_EQ(csr.getIndices(), expected.getIndices());
+		EXPECT_EQ(csr.getValues(), expected.getValues());
+
+		EXPECT_EQ(csr.getVal(0, 0), 1);
+		EXPECT_EQ(csr.getVal(7, 7), 2);
+		EXPECT_EQ(csr.getVal(7, 8), -1);
+		EXPECT_EQ(csr.getVal(numElements, numElements), 1);
+
+		// The stiffness matrix is symmetric, so its CSC arrays are its CSR arrays
+		EXPECT_EQ(csc.getOffsets(), csr.getOffsets());
+		EXPECT_EQ(csc.getIndices(), csr.getIndices());
+	}
+
+	TEST(SparseMatrixBuilderTests, MANY_TRIPLETS_PER_VECTOR_SPLIT_THE_COUNTING)
+	{
+		// Thousands of triplets per row, so every thread counts a share of them
+		const unsigned int size = 64;
+		const unsigned int numTriplets = 400000;
+		MathSparseMatrixBuilder serial(size, size);
+		for (unsigned int i = 0; i < numTriplets; ++i) serial.add(i % size, (i / size) % size, (double)(i % 5));
+		MathSparseMatrix expected = serial.build();
+		MathSparseMatrix expectedCsc = serial.build(COLUMNSPACE);
+
+		MathThreadPool& pool = MathThreadPool::getInstance();
+		unsigned int threadsBefore = pool.getNumThreads();
+		pool.setNumThreads(4);
+
+		MathSparseMatrixBuilder builder(size, size);
+		const unsigned int numTasks = 16;
+		pool.parallelFor(numTasks, [&](unsigned int task)
+		{
+			for (unsigned int i = task; i < numTriplets; i += numTasks)
+			{
+				builder.add(i % size, (i / size) % size, (double)(i % 5));
+			}
+		});
+		MathSparseMatrix csr = builder.build();
+		MathSparseMatrix csc = builder.build(COLUMNSPACE);
+		pool.setNumThreads(threadsBefore);
+
+		// Small integers add up exactly in any order
+		EXPECT_EQ(csr.getNumNonZeros(), size * size);
+		EXPECT_EQ(csr.getOffsets(), expected.getOffsets());
+		EXPECT_EQ(csr.getIndices(), expected.getIndices());
+		EXPECT_EQ(csr.getValues(), expected.getValues());
+		EXPECT_EQ(csc.getOffsets(), expectedCsc.getOffsets());
+		EXPECT_EQ(csc.getIndices(), expectedCsc.getIndices());
+		EXPECT_EQ(csc.getValues(), expectedCsc.getValues());
+	}
+
+	TEST(SparseMatrixBuilderTests, DENSIFY_MATCHES_BUILD)
+	{
+		MathSparseMatrixBuilder builder(30, 20);
+		unsigned long long state = 1;
+		for (unsigned int i = 0; i < 2000; ++i)
+		{
+			// nextRandom is in [-1, 1), so the row and column are always in range
+			unsigned int row = (unsigned int)((nextRandom(state) + 1.0) * 15.0);
+			unsigned int col = (unsigned int)((nextRandom(state) + 1.0) * 10.0);
+			EXPECT_TRUE(builder.add(row, col, nextRandom(state) * 10.0));
+		}
+
+		EXPECT_LT(maxDifference(builder.toDense(), builder.build().toDense()), 1e-12);
+		EXPECT_LT(maxDifference(builder.toDense(), builder.build(COLUMNSPACE).toDense()), 1e-12);
+	}
+}
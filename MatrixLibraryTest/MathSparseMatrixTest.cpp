@@ -0,0 +1,222 @@
+#include "pch.h"
+
+#include "../MatrixLibrary/MathMatrix.h"
+#include "../MatrixLibrary/MathSparseMatrix.h"
+#include "../MatrixLibrary/MathThreadPool.h"
+#include "TestHelpers.h"
+#include <cmath>
+#include <ostream>
+
+namespace SPARSE_MATRIX_TESTS {
+
+	// About one element in @ref every is a pseudo random nonzero in [-1, 1)
+	static MathMatrix makeSparseDense(unsigned int rows, unsigned int cols, unsigned int every,
+		unsigned int seed)
+	{
+		MathMatrix m(rows, cols);
+		unsigned long long state = seed;
+		for (unsigned int r = 0; r < rows; ++r)
+		{
+			for (unsigned int c = 0; c < cols; ++c)
+			{
+				double val = nextRandom(state);
+				if ((state >> 33) % every == 0)
+				{
+					m.setVal(r, c, val);
+				}
+			}
+		}
+		return m;
+	}
+
+	static MathVector makeVector(unsigned int size)
+	{
+		MathVector v(size);
+		for (unsigned int i = 0; i < size; ++i) v[i] = (double)(i % 7) - 3.0;
+		return v;
+	}
+
+	static MathVector denseProduct(const MathMatrix& a, const MathVector& x)
+	{
+		MathVector y(a.getNumRows());
+		for (unsigned int r = 0; r < a.getNumRows(); ++r)
+			for (unsigned int c = 0; c < a.getNumCols(); ++c)
+				y[r] += a.getVal(r, c) * x[c];
+		return y;
+	}
+
+	TEST(SparseMatrixTests, COMPRESSES_A_DENSE_MATRIX_IN_EITHER_SPACE)
+	{
+		MathMatrix dense = { {1, 0, 2}, {0, 0, 0}, {0, 3, 0} };
+
+		MathSparseMatrix csr(dense.getView());
+		EXPECT_EQ(csr.getNumNonZeros(), 3);
+		EXPECT_EQ(csr.getOffsets(), std::vector<size_t>({ 0, 2, 2, 3 }));
+		EXPECT_EQ(csr.getIndices(), std::vector<unsigned int>({ 0, 2, 1 }));
+		EXPECT_EQ(csr.getValues(), std::vector<double>({ 1, 2, 3 }));
+
+		MathSparseMatrix csc(dense.getView(), COLUMNSPACE);
+		EXPECT_EQ(csc.getOffsets(), std::vector<size_t>({ 0, 1, 2, 3 }));
+		EXPECT_EQ(csc.getIndices(), std::vector<unsigned int>({ 0, 2, 0 }));
+
+		for (const MathSparseMatrix* s : { &csr, &csc })
+		{
+			EXPECT_EQ(s->getVal(0, 2), 2);
+			EXPECT_EQ(s->getVal(1, 1), 0);
+			EXPECT_TRUE(std::isnan(s->getVal(3, 0)));
+			EXPECT_LT(maxDifference(s->toDense(), dense), 1e-15);
+		}
+
+		// Small elements can be dropped
+		MathMatrix noisy = { {1, 1e-12}, {-1e-13, 2} };
+		EXPECT_EQ(MathSparseMatrix(noisy.getView(), ROWSPACE, 1e-10).getNumNonZeros(), 2);
+	}
+
+	TEST(SparseMatrixTests, SET_COMPRESSED_VALIDATES_THE_ARRAYS)
+	{
+		MathSparseMatrix s;
+		EXPECT_TRUE(s.setCompressed(2, 3, ROWSPACE, { 0, 1, 3 }, { 2, 0, 1 }, { 5, 6, 7 }));
+		EXPECT_EQ(s.getVal(0, 2), 5);
+		EXPECT_EQ(s.getVal(1, 1), 7);
+
+		// Wrong number of offsets, unsorted indices, an index out of range, mismatched sizes
+		EXPECT_FALSE(s.setCompressed(2, 3, ROWSPACE, { 0, 3 }, { 0, 1, 2 }, { 1, 1, 1 }));
+		EXPECT_FALSE(s.setCompressed(2, 3, ROWSPACE, { 0, 2, 2 }, { 1, 0 }, { 1, 1 }));
+		EXPECT_FALSE(s.setCompressed(2, 3, ROWSPACE, { 0, 1, 1 }, { 3 }, { 1 }));
+		EXPECT_FALSE(s.setCompressed(2, 3, COLUMNSPACE, { 0, 1, 1, 2 }, { 0, 1 }, { 1 }));
+
+		// Failures leave the old matrix alone
+		EXPECT_EQ(s.getNumRows(), 2);
+		EXPECT_EQ(s.getVal(0, 2), 5);
+	}
+
+	TEST(SparseMatrixTests, TRANSPOSE_AND_CONVERT)
+	{
+		MathMatrix dense = makeSparseDense(40, 25, 4, 1);
+		MathSparseMatrix csr(dense.getView());
+
+		MathSparseMatrix csc = csr.convertTo(COLUMNSPACE);
+		EXPECT_EQ(csc.getSpaceToRepresentMatrixAs(), COLUMNSPACE);
+		EXPECT_EQ(csc.getNumNonZeros(), csr.getNumNonZeros());
+		EXPECT_LT(maxDifference(csc.toDense(), dense), 1e-15);
+		EXPECT_EQ(csc.convertTo(ROWSPACE).getIndices(), csr.getIndices());
+
+		MathSparseMatrix t = csr;
+		t.transpose();
+		EXPECT_EQ(t.getNumRows(), 25);
+		EXPECT_EQ(t.getSpaceToRepresentMatrixAs(), COLUMNSPACE);
+		MathMatrix denseT = dense;
+		denseT.transpose();
+		EXPECT_LT(maxDifference(t.toDense(), denseT), 1e-15);
+	}
+
+	TEST(SparseMatrixTests, MATRIX_VECTOR_PRODUCTS_MATCH_DENSE)
+	{
+		MathMatrix dense = makeSparseDense(60, 45, 3, 2);
+		MathMatrix denseT = dense;
+		denseT.transpose();
+		MathVector x = makeVector(45);
+		MathVector xT = makeVector(60);
+
+		for (vector_space_t space : { ROWSPACE, COLUMNSPACE })
+		{
+			MathSparseMatrix s(dense.getView(), space);
+
+			MathVector y = s * x;
+			MathVector expected = denseProduct(dense, x);
+			ASSERT_EQ(y.getSize(), 60);
+			for (unsigned int i = 0; i < 60; ++i) EXPECT_NEAR(y[i], expected[i], 1e-12);
+
+			MathVector yT = transposeMultiply(s, xT);
+			MathVector expectedT = denseProduct(denseT, xT);
+			ASSERT_EQ(yT.getSize(), 45);
+			for (unsigned int i = 0; i < 45; ++i) EXPECT_NEAR(yT[i], expectedT[i], 1e-12);
+
+			// y = 2 * A * x - y in place
+			MathVector z = expected;
+			EXPECT_TRUE(multiply(s, x, z, 2.0, -1.0));
+			for (unsigned int i = 0; i < 60; ++i) EXPECT_NEAR(z[i], expected[i], 1e-12);
+
+			MathVector wrong(59);
+			EXPECT_FALSE(multiply(s, x, wrong, 1.0, 1.0));
+			EXPECT_FALSE(multiply(s, xT, wrong));
+			EXPECT_EQ((s * xT).getSize(), 0);
+		}
+	}
+
+	TEST(SparseMatrixTests, SPARSE_TIMES_DENSE_MATCHES_DENSE)
+	{
+		MathMatrix dense = makeSparseDense(50, 30, 5, 3);
+		MathMatrix b = makeSparseDense(30, 7, 1, 4);
+		MathMatrix bRows(7, 30);
+		bRows.transpose();
+		for (unsigned int r = 0; r < 30; ++r)
+			for (unsigned int c = 0; c < 7; ++c)
+				bRows.setVal(r, c, b.getVal(r, c));
+
+		MathMatrix expected = dense * b;
+		for (vector_space_t space : { ROWSPACE, COLUMNSPACE })
+		{
+			MathSparseMatrix s(dense.getView(), space);
+			EXPECT_LT(maxDifference(s * b, expected), 1e-12);
+			EXPECT_LT(maxDifference(s * bRows, expected), 1e-12);
+		}
+		EXPECT_EQ((MathSparseMatrix(dense.getView()) * dense).getNumRows(), 0);
+	}
+
+	TEST(SparseMatrixTests, PARALLEL_PRODUCTS_WITH_UNEVEN_ROWS)
+	{
+		// A few dense rows among many nearly empty ones
+		const unsigned int m = 3000, n = 2000;
+		std::vector<size_t> offsets(1, 0);
+		std::vector<unsigned int> indices;
+		std::vector<double> values;
+		for (unsigned int r = 0; r < m; ++r)
+		{
+			unsigned int step = (r % 500 == 0) ? 1 : 97;
+			for (unsigned int c = r % step; c < n; c += step)
+			{
+				indices.push_back(c);
+				values.push_back(1.0 + (double)((r + c) % 13) / 13.0);
+			}
+			offsets.push_back(indices.size());
+		}
+
+		MathSparseMatrix csr;
+		ASSERT_TRUE(csr.setCompressed(m, n, ROWSPACE, offsets, indices, values));
+		MathSparseMatrix csc = csr.convertTo(COLUMNSPACE);
+		MathVector x = makeVector(n);
+		MathVector xT = makeVector(m);
+		MathMatrix b = makeSparseDense(n, 3, 1, 5);
+
+		MathVector serial = csr * x;
+		MathVector serialT = transposeMultiply(csr, xT);
+		MathMatrix serialB = csr * b;
+
+		MathThreadPool& pool = MathThreadPool::getInstance();
+		unsigned int threadsBefore = pool.getNumThreads();
+		pool.setNumThreads(4);
+		MathVector parallel = csr * x;
+		MathVector parallelCsc = csc * x;
+		MathVector parallelT = transposeMultiply(csr, xT);
+		MathMatrix parallelB = csc * b;
+		pool.setNumThreads(threadsBefore);
+
+		for (unsigned int i = 0; i < m; ++i)
+		{
+			EXPECT_NEAR(parallel[i], serial[i], 1e-10);
+			EXPECT_NEAR(parallelCsc[i], serial[i], 1e-10);
+		}
+		for (unsigned int i = 0; i < n; ++i) EXPECT_NEAR(parallelT[i], serialT[i], 1e-10);
+		EXPECT_LT(maxDifference(parallelB, serialB), 1e-10);
+	}
+
+	TEST(SparseMatrixTests, MEMORY_SCALES_WITH_NONZEROS)
+	{
+		MathSparseMatrix empty(100000, 100000);
+		EXPECT_EQ(empty.getNumNonZeros(), 0);
+		EXPECT_EQ(empty.getVal(99999, 5), 0);
+		EXPECT_LT(empty.getMemoryUsage(), 100001 * sizeof(size_t) + 64);
+		EXPECT_EQ((empty * MathVector(100000)).getSize(), 100000);
+	}
+}
@@ -0,0 +1,127 @@
+#include "pch.h"
+
+#include "../MatrixLibrary/MathStrassen.h"
+#include "../MatrixLibrary/MathMatrixMultiply.h"
+#include "TestHelpers.h"
+#include <cmath>
+
+namespace STRASSEN_TESTS {
+
+	TEST(StrassenTests, MATCHES_GEMM_FOR_ODD_AND_RECTANGULAR_SIZES)
+	{
+		// A small crossover so each size goes through several levels with odd dimensions in them
+		MathStrassen strassen(16);
+		struct { unsigned int m, n, k; } sizes[] = { {64, 64, 64}, {99, 77, 133}, {130, 35, 67}, {17, 200, 90} };
+		vector_space_t spaces[] = { ROWSPACE, COLUMNSPACE };
+
+		for (const auto& size : sizes)
+		{
+			for (vector_space_t aSpace : spaces)
+			{
+				for (vector_space_t bSpace : spaces)
+				{
+					MathMatrix a = makeRandomMatrix<double>(size.m, size.k, aSpace, 1);
+					MathMatrix b = makeRandomMatrix<double>(size.k, size.n, bSpace, 2);
+					MathMatrix c = strassen.multiply(a, b);
+					ASSERT_EQ(c.getNumRows(), size.m);
+					ASSERT_EQ(c.getNumCols(), size.n);
+					EXPECT_LT(maxDifference(c, a * b), 1e-11);
+				}
+			}
+		}
+	}
+
+	TEST(StrassenTests, WRITES_INTO_VIEWS_AND_REUSES_THE_WORKSPACE)
+	{
+		MathStrassen strassen(16);
+		MathMatrix big = makeRandomMatrix<double>(150, 150, COLUMNSPACE, 3);
+		MathMatrix a = makeRandomMatrix<double>(100, 80, ROWSPACE, 4);
+		MathMatrix b = makeRandomMatrix<double>(80, 90, COLUMNSPACE, 5);
+
+		// Write the product into the middle of a larger ROWSPACE matrix
+		MathMatrix c = makeRandomMatrix<double>(120, 110, ROWSPACE, 6);
+		MathMatrix before = c;
+		ASSERT_TRUE(strassen.multiply(a, b, c.getView(10, 15, 100, 90)));
+		size_t capacity = strassen.getWorkspaceCapacity();
+		EXPECT_EQ(capacity, strassen.getWorkspaceSize(100, 90, 80));
+		EXPECT_GT(capacity, 0u);
+
+		MathMatrix expected = a * b;
+		double worst = 0.0;
+		for (unsigned int r = 0; r < c.getNumRows(); ++r)
+		{
+			for (unsigned int col = 0; col < c.getNumCols(); ++col)
+			{
+				bool inside = r >= 10 && r < 110 && col >= 15 && col < 105;
+				double want = inside ? expected.getVal(r - 10, col - 15) : before.getVal(r, col);
+				worst = std::fmax(worst, std::fabs(c.getVal(r, col) - want));
+			}
+		}
+		EXPECT_LT(worst, 1e-11);
+
+		// Operands that are views into another matrix, and a second product no larger
+		MathMatrixView bigBlock = big.getView(5, 7, 60, 80), bBlock = b.getView(0, 0, 80, 70);
+		MathMatrix product(60, 70), reference(60, 70);
+		ASSERT_TRUE(strassen.multiply(bigBlock, bBlock, product));
+		gemm(60, 70, 80, 1.0, bigBlock.getData(), bigBlock.getRowStride(), bigBlock.getColStride(),
+			bBlock.getData(), bBlock.getRowStride(), bBlock.getColStride(), 0.0, reference.getData(),
+			reference.getRowStride(), reference.getColStride());
+		EXPECT_LT(maxDifference(product, reference), 1e-11);
+		EXPECT_EQ(strassen.getWorkspaceCapacity(), capacity);
+	}
+
+	TEST(StrassenTests, ERROR_STAYS_WITHIN_THE_DOCUMENTED_BOUND)
+	{
+		const unsigned int n = 256, crossover = 32;
+		MathStrassenF strassen(crossover);
+		MathMatrixF a = makeRandomMatrix<float>(n, n, COLUMNSPACE, 7);
+		MathMatrixF b = makeRandomMatrix<float>(n, n, ROWSPACE, 8);
+		MathMatrixF c = strassen.multiply(a, b);
+
+		// The exact product, near enough, in double
+		MathMatrix exact(n, n);
+		for (unsigned int r = 0; r < n; ++r)
+		{
+			for (unsigned int col = 0; col < n; ++col)
+			{
+				double sum = 0.0;
+				for (unsigned int p = 0; p < n; ++p) sum += (double)a.getVal(r, p) * (double)b.getVal(p, col);
+				exact.setVal(r, col, sum);
+			}
+		}
+
+		// Three levels down to 32 x 32 products, and max|a| = max|b| = 1
+		const double u = std::ldexp(1.0, -24), n0 = 32.0, levels = 3.0;
+		const double bound = ((n0 * n0 + 6.0 * n0) * std::pow(18.0, levels) - 6.0 * n) * u;
+		double worst = 0.0;
+		for (unsigned int r = 0; r < n; ++r)
+		{
+			for (unsigned int col = 0; col < n; ++col)
+			{
+				worst = std::fmax(worst, std::fabs((double)c.getVal(r, col) - exact.getVal(r, col)));
+			}
+		}
+		EXPECT_LT(worst, bound);
+		EXPECT_LT(worst, 1e-3);
+	}
+
+	TEST(StrassenTests, SIZE_MISMATCH_AND_CROSSOVER)
+	{
+		MathStrassen strassen(4);
+		EXPECT_EQ(strassen.getCrossover(), 16u);
+		strassen.setCrossover(64);
+		EXPECT_EQ(strassen.getCrossover(), 64u);
+		EXPECT_EQ(strassen.getWorkspaceSize(64, 500, 500), 0u);
+
+		MathMatrix a(10, 20), b(21, 5), c(10, 5);
+		c.setVal(0, 0, 3.0);
+		EXPECT_FALSE(strassen.multiply(a, b, c));
+		EXPECT_EQ(c.getVal(0, 0), 3.0);
+		EXPECT_EQ(strassen.multiply(a, b).getNumRows(), 0u);
+
+		// Below the crossover the product is just gemm
+		MathMatrix small = makeRandomMatrix<double>(30, 30, COLUMNSPACE, 9);
+		EXPECT_EQ(maxDifference(strassen.multiply(small, small), small * small), 0.0);
+		EXPECT_EQ(strassen.getWorkspaceCapacity(), 0u);
+	}
+}
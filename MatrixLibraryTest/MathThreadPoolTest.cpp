@@ -0,0 +1,71 @@
+#include "pch.h"
+
+#include "../MatrixLibrary/MathThreadPool.h"
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace MATH_THREAD_POOL_TESTS {
+
+	TEST(ThreadPoolTests, PARALLEL_FOR_RUNS_EVERY_TASK_EXACTLY_ONCE)
+	{
+		MathThreadPool& pool = MathThreadPool::getInstance();
+		unsigned int threadsBefore = pool.getNumThreads();
+		pool.setNumThreads(3);
+
+		for (unsigned int numTasks : { 1u, 2u, 17u, 1000u })
+		{
+			std::vector<std::atomic<int>> timesRun(numTasks);
+			pool.parallelFor(numTasks, [&](unsigned int i) { ++timesRun[i]; });
+
+			for (unsigned int i = 0; i < numTasks; ++i)
+			{
+				ASSERT_EQ(timesRun[i].load(), 1);
+			}
+		}
+
+		pool.setNumThreads(threadsBefore);
+	}
+
+	TEST(ThreadPoolTests, NESTED_PARALLEL_FOR_RUNS_ON_THE_CALLING_THREAD)
+	{
+		MathThreadPool& pool = MathThreadPool::getInstance();
+		unsigned int threadsBefore = pool.getNumThreads();
+		pool.setNumThreads(2);
+
+		std::atomic<int> total(0);
+		pool.parallelFor(4, [&](unsigned int)
+		{
+			pool.parallelFor(5, [&](unsigned int) { ++total; });
+		});
+		EXPECT_EQ(total.load(), 20);
+
+		pool.setNumThreads(threadsBefore);
+	}
+
+	TEST(ThreadPoolTests, NUM_THREADS_CHANGES_WHILE_ANOTHER_THREAD_RUNS_JOBS)
+	{
+		MathThreadPool& pool = MathThreadPool::getInstance();
+		unsigned int threadsBefore = pool.getNumThreads();
+
+		std::atomic<bool> done(false);
+		std::thread resizer([&]
+		{
+			for (unsigned int i = 0; !done.load(); ++i) pool.setNumThreads(1 + i % 4);
+		});
+
+		for (int job = 0; job < 200; ++job)
+		{
+			std::vector<std::atomic<int>> timesRun(pool.getNumThreads() * 4);
+			pool.parallelFor((unsigned int)timesRun.size(), [&](unsigned int i) { ++timesRun[i]; });
+			for (std::atomic<int>& times : timesRun)
+			{
+				EXPECT_EQ(times.load(), 1);
+			}
+		}
+
+		done = true;
+		resizer.join();
+		pool.setNumThreads(threadsBefore);
+	}
+}
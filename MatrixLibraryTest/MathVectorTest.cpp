@@ -2,6 +2,9 @@
 
 #include "../MatrixLibrary/MathVector.h"
 #include <ostream>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 namespace MATH_VECTOR_TESTS{
 
@@ -281,6 +284,20 @@ namespace MATH_VECTOR_TESTS{
 	}
 
 
+	TEST(VectorSubtractionTests, MINUS_EQUALS_OPERATOR_SUBTRACTS_SAME_SIZE_VECTORS)
+	{
+		MathVector v1 = { 2, 4, 0.356, -1, 8 };
+		MathVector v2 = { 5.37, 8.73, 729.00, -1, 0 };
+
+		EXPECT_TRUE(v1 -= v2);
+		EXPECT_TRUE(v1.isEqualTo({ -3.37, -4.73, -728.644, 0, 8 }));
+		EXPECT_TRUE(v2.isEqualTo({ 5.37, 8.73, 729.00, -1, 0 }));
+
+		MathVector v3 = { 1, 2 };
+		EXPECT_FALSE(v1 -= v3);
+		EXPECT_TRUE(v1.isEqualTo({ -3.37, -4.73, -728.644, 0, 8 }));
+	}
+
 	TEST(VectorScalarMultTests, TIMES_EQUALS_OPERATOR_WORKS_AS_INTENDED)
 	{
 		MathVector v1({ 4.0, 5.0, -3 });
@@ -348,4 +365,149 @@ namespace MATH_VECTOR_TESTS{
 		EXPECT_NEAR(allPos.dotProduct(allNeg), -31.3, 0.001);
 	}
 
+	TEST(VectorMoveTests, MOVING_A_VECTOR_TAKES_ITS_BUFFER_AND_LEAVES_IT_EMPTY)
+	{
+		static_assert(std::is_nothrow_move_constructible<MathVector>::value, "");
+		static_assert(std::is_nothrow_move_assignable<MathVector>::value, "");
+
+		MathVector v1 = { 1, 2, 3 };
+		double* buffer = &v1[0];
+
+		MathVector v2(std::move(v1));
+		EXPECT_EQ(&v2[0], buffer);
+		EXPECT_TRUE(v2.isEqualTo({ 1, 2, 3 }));
+		EXPECT_EQ(v1.getSize(), 0);
+
+		MathVector v3 = { 4, 5 };
+		v3 = std::move(v2);
+		EXPECT_EQ(&v3[0], buffer);
+		EXPECT_TRUE(v3.isEqualTo({ 1, 2, 3 }));
+
+		// A moved from vector can be used again
+		v1.push_back(6);
+		EXPECT_TRUE(v1.isEqualTo({ 6 }));
+	}
+
+	TEST(VectorMoveTests, COPY_HOLDS_ONLY_THE_ELEMENTS_AND_CAN_STILL_GROW)
+	{
+		MathVector v1;
+		for (int i = 0; i < 5; ++i) v1.push_back(i);
+
+		MathVector v2 = v1;
+		v2 = v2;
+		EXPECT_TRUE(v2.isEqualTo({ 0, 1, 2, 3, 4 }));
+
+		v2.push_back(5);
+		EXPECT_TRUE(v2.isEqualTo({ 0, 1, 2, 3, 4, 5 }));
+		EXPECT_TRUE(v1.isEqualTo({ 0, 1, 2, 3, 4 }));
+
+		MathVector empty;
+		MathVector emptyCopy = empty;
+		EXPECT_EQ(emptyCopy.getSize(), 0);
+		emptyCopy.push_back(1);
+		EXPECT_TRUE(emptyCopy.isEqualTo({ 1 }));
+	}
+
+	TEST(VectorMoveTests, STD_VECTOR_OF_VECTORS_DOES_NOT_COPY_ON_REALLOCATION)
+	{
+		std::vector<MathVector> vectors;
+		vectors.push_back(MathVector({ 1, 2, 3 }));
+		double* buffer = &vectors[0][0];
+
+		for (unsigned int i = 0; i < 100; ++i)
+		{
+			vectors.push_back(MathVector(4));
+		}
+		EXPECT_EQ(&vectors[0][0], buffer);
+	}
+
+	TEST(VectorExpressionTests, FUSED_EXPRESSION_MATCHES_ELEMENT_BY_ELEMENT_RESULT)
+	{
+		MathVector a = { 1, 2, 3, 4, 5 };
+		MathVector b = { -1, 0.5, 2, 0, 7 };
+		MathVector c = { 3, 3, -3, 1, 0.25 };
+		double alpha = -2.0;
+
+		MathVector v = a + 2.0 * b + c * alpha - (a - b) * 0.5;
+		ASSERT_EQ(v.getSize(), 5);
+		for (int i = 0; i < 5; ++i)
+		{
+			EXPECT_DOUBLE_EQ(v[i], a[i] + 2.0 * b[i] + c[i] * alpha - (a[i] - b[i]) * 0.5);
+		}
+	}
+
+	TEST(VectorExpressionTests, ASSIGNING_TO_A_VECTOR_OF_THE_SAME_SIZE_DOES_NOT_REALLOCATE)
+	{
+		MathVector a = { 1, 2, 3 };
+		MathVector b = { 4, 5, 6 };
+		MathVector v(3);
+		double* buffer = &v[0];
+
+		v = a + 2.0 * b;
+		EXPECT_EQ(&v[0], buffer);
+		EXPECT_TRUE(v.isEqualTo({ 9, 12, 15 }));
+
+		EXPECT_TRUE(v += a * 3.0 - b);
+		EXPECT_EQ(&v[0], buffer);
+		EXPECT_TRUE(v.isEqualTo({ 8, 13, 18 }));
+
+		EXPECT_TRUE(v -= 2.0 * a);
+		EXPECT_TRUE(v.isEqualTo({ 6, 9, 12 }));
+
+		// The vector being assigned to can be part of the expression
+		v = v - a + v * 0.5;
+		EXPECT_EQ(&v[0], buffer);
+		EXPECT_TRUE(v.isEqualTo({ 8, 11.5, 15 }));
+	}
+
+	TEST(VectorExpressionTests, EXPRESSION_OF_DIFFERENT_SIZE_VECTORS_IS_EMPTY)
+	{
+		MathVector a = { 1, 2, 3 };
+		MathVector b = { 1, 2 };
+		MathVector v = { 5, 5, 5 };
+
+		MathVector sum = a + 2.0 * b;
+		EXPECT_EQ(sum.getSize(), 0);
+
+		EXPECT_FALSE(v += a - b);
+		EXPECT_TRUE(v.isEqualTo({ 5, 5, 5 }));
+
+		v = a + b;
+		EXPECT_EQ(v.getSize(), 0);
+
+		// Assigning a valid expression to an empty vector allocates it
+		v = a * 2.0;
+		EXPECT_TRUE(v.isEqualTo({ 2, 4, 6 }));
+	}
+
+
+	TEST(FloatVectorTests, FLOAT_VECTORS_BEHAVE_LIKE_DOUBLE_VECTORS)
+	{
+		MathVectorF a = { 1, 2, 3, 4, 5 };
+		MathVectorF b = { -1, 0.5f, 2, 0, 7 };
+		static_assert(std::is_same<decltype(a[0]), float&>::value, "float elements");
+		static_assert(std::is_same<decltype(a * b), float>::value, "float dot product");
+
+		// Scaling by a double still evaluates in float
+		MathVectorF v = a + 2.0 * b - a * 0.5;
+		static_assert(std::is_same<decltype((a + 2.0 * b)[0]), float>::value, "float expression");
+		EXPECT_TRUE(v.isEqualTo({ -1.5f, 2, 5.5f, 2, 16.5f }));
+
+		EXPECT_EQ(a * b, 41.0f);
+		EXPECT_EQ(dotProduct(a, b), 41.0f);
+		EXPECT_FLOAT_EQ(MathVectorF({ 3, 4 }).getMagnitude(), 5.0f);
+		EXPECT_TRUE(a += b);
+		EXPECT_TRUE(a == MathVectorF({ 0, 2.5f, 5, 4, 12 }));
+		EXPECT_TRUE(a *= 2);
+		EXPECT_TRUE(a.isEqualTo({ 0, 5, 10, 8, 24 }));
+		EXPECT_TRUE(findProjection(MathVectorF({ 1, 1 }), MathVectorF({ 2, 0 })).isEqualTo({ 1, 0 }));
+
+		// The tails of the float kernels are exercised past every vector width
+		MathVectorF longVector(37);
+		for (unsigned int i = 0; i < 37; ++i) longVector[i] = (float)i;
+		EXPECT_EQ(longVector * longVector, 16206.0f);
+		EXPECT_TRUE(longVector.push_back(37));
+		EXPECT_EQ(longVector.getSize(), 38);
+	}
+
 }
\ No newline at end of file
@@ -0,0 +1,94 @@
+//
+// TestHelpers.h : Matrix factories, comparisons and loops shared by the test files
+//
+
+#pragma once
+
+#ifndef __TEST_HELPERS_H
+#define __TEST_HELPERS_H
+
+#include "../MatrixLibrary/MathFixedMatrix.h"
+#include "../MatrixLibrary/MathMatrix.h"
+#include "../MatrixLibrary/MathSimdKernels.h"
+#include "gtest/gtest.h"
+#include <cmath>
+
+// The next pseudo random number in [-1, 1) of a linear congruential generator
+inline double nextRandom(unsigned long long& state)
+{
+	state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+	return (double)(state >> 11) / (double)(1ULL << 52) - 1.0;
+}
+
+/**
+ * @brief A rows x cols matrix stored as @ref space, element (r, c) set to element(r, c).
+ * @note A ROWSPACE matrix is made as the transpose of a COLUMNSPACE one, which only changes
+ *     how the storage is read.
+ */
+template <typename T = double, typename Element>
+MathMatrixT<T> makeMatrix(unsigned int rows, unsigned int cols, vector_space_t space, Element element)
+{
+	MathMatrixT<T> m(rows, cols);
+	if (space == ROWSPACE)
+	{
+		m = MathMatrixT<T>(cols, rows);
+		m.transpose();
+	}
+	for (unsigned int r = 0; r < rows; ++r)
+	{
+		for (unsigned int c = 0; c < cols; ++c) m.setVal(r, c, (T)element(r, c));
+	}
+	return m;
+}
+
+// Pseudo random elements in [-1, 1), a different matrix for every seed
+template <typename T = double>
+MathMatrixT<T> makeRandomMatrix(unsigned int rows, unsigned int cols, vector_space_t space, unsigned int seed)
+{
+	unsigned long long state = seed;
+	return makeMatrix<T>(rows, cols, space, [&](unsigned int, unsigned int) { return nextRandom(state); });
+}
+
+// The largest difference between two elements at the same place, compared in double
+template <typename T>
+double maxDifference(const MathMatrixT<T>& a, const MathMatrixT<T>& b)
+{
+	double worst = 0.0;
+	for (unsigned int r = 0; r < a.getNumRows(); ++r)
+	{
+		for (unsigned int c = 0; c < a.getNumCols(); ++c)
+		{
+			worst = std::fmax(worst, std::fabs((double)a.getVal(r, c) - (double)b.getVal(r, c)));
+		}
+	}
+	return worst;
+}
+
+template <unsigned int R, unsigned int C>
+double maxDifference(const MathFixedMatrix<R, C>& a, const MathFixedMatrix<R, C>& b)
+{
+	double worst = 0.0;
+	for (unsigned int r = 0; r < R; ++r)
+	{
+		for (unsigned int c = 0; c < C; ++c) worst = std::fmax(worst, std::fabs(a(r, c) - b(r, c)));
+	}
+	return worst;
+}
+
+// Runs test once with every instruction set this machine supports
+template <typename Test>
+void forEachSupportedInstructionSet(Test test)
+{
+	simd_instruction_set_t before = getSimdInstructionSet();
+
+	for (int set = SIMD_SCALAR; set <= getSupportedSimdInstructionSet(); ++set)
+	{
+		ASSERT_TRUE(setSimdInstructionSet((simd_instruction_set_t)set));
+		ASSERT_EQ(getSimdInstructionSet(), (simd_instruction_set_t)set);
+		test();
+	}
+
+	setSimdInstructionSet(before);
+}
+
+#endif // __TEST_HELPERS_H